@@ -87,6 +87,9 @@ NS_SWIFT_NAME(HtmlConfig)
 /// `nil` for no limit.
 @property(nonatomic, strong, nullable) NSValue *spreadsheetLimit;
 @property(nonatomic) BOOL spreadsheetLimitByContent;
+/// Rows and columns per tile of a sheet fetched as it scrolls into view; `nil`
+/// writes each sheet as one table.
+@property(nonatomic, strong, nullable) NSValue *spreadsheetTile;
 @property(nonatomic) ODRHtmlTableGridlines spreadsheetGridlines;
 
 @property(nonatomic) ODRHtmlViewportMode viewportMode;
@@ -113,9 +116,19 @@ NS_SWIFT_NAME(HtmlConfig)
 @property(nonatomic) uint32_t pageRangeBegin;
 @property(nonatomic, strong, nullable) NSNumber *pageRangeEnd;
 
+/// Page a plain text file by this many lines. `nil` keeps the one view.
+@property(nonatomic, strong, nullable) NSNumber *textLinesPerPage;
+
 @property(nonatomic) ODRPdfTextMode pdfTextMode;
 @property(nonatomic, copy) NSArray<NSString *> *pdfDualLayerFallbackFonts;
 @property(nonatomic) double pdfDualLayerFallbackFontSizeAdjust;
+/// Threads pdf pages render on; 0 is one per core, 1 the caller's alone.
+@property(nonatomic) uint32_t renderThreads;
+/// 1 deflates images fastest, 9 smallest.
+@property(nonatomic) uint32_t pngCompressionLevel;
+/// Bounds on the translation cache under a cache path; 0 lifts a bound.
+@property(nonatomic) uint32_t cacheMaxMegabytes;
+@property(nonatomic) uint32_t cacheMaxAgeDays;
 
 /// @deprecated Inert.
 @property(nonatomic) BOOL noDrm;
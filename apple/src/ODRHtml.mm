@@ -96,6 +96,12 @@ std::vector<std::string> to_strings(NSArray<NSString *> *strings) {
                                        objCType:@encode(ODRTableDimensions)];
   }
   _spreadsheetLimitByContent = config.spreadsheet_limit_by_content ? YES : NO;
+  if (config.spreadsheet_tile.has_value()) {
+    const ODRTableDimensions tile = ODRTableDimensionsMake(
+        config.spreadsheet_tile->rows, config.spreadsheet_tile->columns);
+    _spreadsheetTile = [NSValue valueWithBytes:&tile
+                                      objCType:@encode(ODRTableDimensions)];
+  }
   _spreadsheetGridlines =
       static_cast<ODRHtmlTableGridlines>(config.spreadsheet_gridlines);
   _viewportMode = static_cast<ODRHtmlViewportMode>(config.viewport_mode);
@@ -120,10 +126,18 @@ std::vector<std::string> to_strings(NSArray<NSString *> *strings) {
   _pageRangeEnd = config.page_range_end.has_value()
                       ? @(static_cast<unsigned int>(*config.page_range_end))
                       : nil;
+  _textLinesPerPage =
+      config.text_lines_per_page.has_value()
+          ? @(static_cast<unsigned int>(*config.text_lines_per_page))
+          : nil;
   _pdfTextMode = static_cast<ODRPdfTextMode>(config.pdf_text_mode);
   _pdfDualLayerFallbackFonts = to_nsarray(config.pdf_dual_layer_fallback_fonts);
   _pdfDualLayerFallbackFontSizeAdjust =
       config.pdf_dual_layer_fallback_font_size_adjust;
+  _renderThreads = config.render_threads;
+  _pngCompressionLevel = config.png_compression_level;
+  _cacheMaxMegabytes = config.cache_max_megabytes;
+  _cacheMaxAgeDays = config.cache_max_age_days;
   _noDrm = config.no_drm ? YES : NO;
   _embedOutline = config.embed_outline ? YES : NO;
   _outputPath =
@@ -160,6 +174,13 @@ std::vector<std::string> to_strings(NSArray<NSString *> *strings) {
     config.spreadsheet_limit.reset();
   }
   config.spreadsheet_limit_by_content = _spreadsheetLimitByContent == YES;
+  if (_spreadsheetTile != nil) {
+    ODRTableDimensions tile{};
+    [_spreadsheetTile getValue:&tile size:sizeof(tile)];
+    config.spreadsheet_tile = odr::TableDimensions(tile.rows, tile.columns);
+  } else {
+    config.spreadsheet_tile.reset();
+  }
   config.spreadsheet_gridlines =
       static_cast<odr::HtmlTableGridlines>(_spreadsheetGridlines);
   config.viewport_mode = static_cast<odr::HtmlViewportMode>(_viewportMode);
@@ -197,10 +218,20 @@ std::vector<std::string> to_strings(NSArray<NSString *> *strings) {
   } else {
     config.page_range_end.reset();
   }
+  if (_textLinesPerPage != nil) {
+    config.text_lines_per_page =
+        static_cast<std::uint32_t>(_textLinesPerPage.unsignedIntValue);
+  } else {
+    config.text_lines_per_page.reset();
+  }
   config.pdf_text_mode = static_cast<odr::PdfTextMode>(_pdfTextMode);
   config.pdf_dual_layer_fallback_fonts = to_strings(_pdfDualLayerFallbackFonts);
   config.pdf_dual_layer_fallback_font_size_adjust =
       _pdfDualLayerFallbackFontSizeAdjust;
+  config.render_threads = _renderThreads;
+  config.png_compression_level = _pngCompressionLevel;
+  config.cache_max_megabytes = _cacheMaxMegabytes;
+  config.cache_max_age_days = _cacheMaxAgeDays;
   config.no_drm = _noDrm == YES;
   config.embed_outline = _embedOutline == YES;
   if (_outputPath != nil) {
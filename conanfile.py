@@ -102,3 +102,5 @@ class OpenDocumentCoreConan(ConanFile):
 
     def package_info(self):
         self.cpp_info.libs = ["odr"]
+        if self.settings.os in ["Linux", "FreeBSD"]:
+            self.cpp_info.system_libs = ["pthread"]
@@ -29,6 +29,11 @@ public final class HtmlConfig {
   /** {@code null} disables the spreadsheet limit. */
   public TableDimensions spreadsheetLimit = new TableDimensions(10000, 500);
   public boolean spreadsheetLimitByContent = true;
+  /**
+   * Rows and columns per tile of a sheet fetched as it scrolls into view;
+   * {@code null} writes each sheet as one table.
+   */
+  public TableDimensions spreadsheetTile = null;
   public HtmlTableGridlines spreadsheetGridlines = HtmlTableGridlines.SOFT;
 
   /** Initial zoom on mobile. */
@@ -56,11 +61,21 @@ public final class HtmlConfig {
   /** {@code null} renders to the end of the document. */
   public Integer pageRangeEnd;
 
+  /** Pages a plain text file by this many lines; {@code null} keeps one. */
+  public Integer textLinesPerPage;
+
   public PdfTextMode pdfTextMode = PdfTextMode.DUAL_LAYER;
   public String[] pdfDualLayerFallbackFonts = {
     "Arial", "Helvetica", "Liberation Sans", "DejaVu Sans", "Nimbus Sans"
   };
   public double pdfDualLayerFallbackFontSizeAdjust = 0.5;
+  /** 0 takes one per hardware thread, 1 renders on the caller's alone. */
+  public int renderThreads = 1;
+  /** 1 deflates images fastest, 9 smallest. */
+  public int pngCompressionLevel = 6;
+  /** Bounds on the translation cache under a cache path; 0 lifts a bound. */
+  public int cacheMaxMegabytes = 1024;
+  public int cacheMaxAgeDays = 30;
 
   /** @deprecated Inert. */
   @Deprecated public boolean noDrm = false;
@@ -353,6 +353,10 @@ jobject html_config_to_java(JNIEnv *env, const odr::HtmlConfig &config) {
                  ? make_table_dimensions(env, *config.spreadsheet_limit)
                  : nullptr);
   set_boolean("spreadsheetLimitByContent", config.spreadsheet_limit_by_content);
+  set_object("spreadsheetTile", "Lapp/opendocument/core/TableDimensions;",
+             config.spreadsheet_tile.has_value()
+                 ? make_table_dimensions(env, *config.spreadsheet_tile)
+                 : nullptr);
   set_object("spreadsheetGridlines",
              "Lapp/opendocument/core/HtmlTableGridlines;",
              enum_from_code(env, "app/opendocument/core/HtmlTableGridlines",
@@ -380,6 +384,8 @@ jobject html_config_to_java(JNIEnv *env, const odr::HtmlConfig &config) {
   set_int("pageRangeBegin", static_cast<jint>(config.page_range_begin));
   set_object("pageRangeEnd", "Ljava/lang/Integer;",
              box_integer(env, config.page_range_end));
+  set_object("textLinesPerPage", "Ljava/lang/Integer;",
+             box_integer(env, config.text_lines_per_page));
   set_object("pdfTextMode", "Lapp/opendocument/core/PdfTextMode;",
              enum_from_code(env, "app/opendocument/core/PdfTextMode",
                             static_cast<jint>(config.pdf_text_mode)));
@@ -400,6 +406,11 @@ jobject html_config_to_java(JNIEnv *env, const odr::HtmlConfig &config) {
   }
   set_double("pdfDualLayerFallbackFontSizeAdjust",
              config.pdf_dual_layer_fallback_font_size_adjust);
+  set_int("renderThreads", static_cast<jint>(config.render_threads));
+  set_int("pngCompressionLevel",
+          static_cast<jint>(config.png_compression_level));
+  set_int("cacheMaxMegabytes", static_cast<jint>(config.cache_max_megabytes));
+  set_int("cacheMaxAgeDays", static_cast<jint>(config.cache_max_age_days));
   set_boolean("noDrm", config.no_drm);
   set_boolean("embedOutline", config.embed_outline);
   set_object("outputPath", "Ljava/lang/String;",
@@ -487,6 +498,23 @@ odr::HtmlConfig html_config_from_java(JNIEnv *env, jobject config) {
   }
   result.spreadsheet_limit_by_content =
       get_boolean("spreadsheetLimitByContent");
+  {
+    jobject tile = get_object("spreadsheetTile",
+                              "Lapp/opendocument/core/TableDimensions;");
+    if (tile == nullptr) {
+      result.spreadsheet_tile = std::nullopt;
+    } else {
+      jclass dimensions_cls = env->GetObjectClass(tile);
+      const jint rows =
+          env->GetIntField(tile, env->GetFieldID(dimensions_cls, "rows", "I"));
+      const jint columns = env->GetIntField(
+          tile, env->GetFieldID(dimensions_cls, "columns", "I"));
+      result.spreadsheet_tile =
+          odr::TableDimensions(static_cast<std::uint32_t>(rows),
+                               static_cast<std::uint32_t>(columns));
+      env->DeleteLocalRef(dimensions_cls);
+    }
+  }
   {
     const jint code = enum_ordinal(
         env, get_object("spreadsheetGridlines",
@@ -557,6 +585,18 @@ odr::HtmlConfig html_config_from_java(JNIEnv *env, jobject config) {
       env->DeleteLocalRef(integer_cls);
     }
   }
+  {
+    jobject lines = get_object("textLinesPerPage", "Ljava/lang/Integer;");
+    if (lines == nullptr) {
+      result.text_lines_per_page = std::nullopt;
+    } else {
+      jclass integer_cls = env->GetObjectClass(lines);
+      jmethodID int_value = env->GetMethodID(integer_cls, "intValue", "()I");
+      result.text_lines_per_page =
+          static_cast<std::uint32_t>(env->CallIntMethod(lines, int_value));
+      env->DeleteLocalRef(integer_cls);
+    }
+  }
   {
     const jint code = enum_ordinal(
         env, get_object("pdfTextMode", "Lapp/opendocument/core/PdfTextMode;"));
@@ -579,6 +619,13 @@ odr::HtmlConfig html_config_from_java(JNIEnv *env, jobject config) {
   }
   result.pdf_dual_layer_fallback_font_size_adjust =
       get_double("pdfDualLayerFallbackFontSizeAdjust");
+  result.render_threads = static_cast<std::uint32_t>(get_int("renderThreads"));
+  result.png_compression_level =
+      static_cast<std::uint32_t>(get_int("pngCompressionLevel"));
+  result.cache_max_megabytes =
+      static_cast<std::uint32_t>(get_int("cacheMaxMegabytes"));
+  result.cache_max_age_days =
+      static_cast<std::uint32_t>(get_int("cacheMaxAgeDays"));
   result.no_drm = get_boolean("noDrm");
   result.embed_outline = get_boolean("embedOutline");
   result.output_path = get_string_opt("outputPath");
@@ -84,6 +84,7 @@ void odr_python::bind_html(py::module_ &m) {
       .def_readwrite("spreadsheet_limit", &odr::HtmlConfig::spreadsheet_limit)
       .def_readwrite("spreadsheet_limit_by_content",
                      &odr::HtmlConfig::spreadsheet_limit_by_content)
+      .def_readwrite("spreadsheet_tile", &odr::HtmlConfig::spreadsheet_tile)
       .def_readwrite("spreadsheet_gridlines",
                      &odr::HtmlConfig::spreadsheet_gridlines)
       .def_readwrite("viewport_mode", &odr::HtmlConfig::viewport_mode)
@@ -103,11 +104,19 @@ void odr_python::bind_html(py::module_ &m) {
                      "Deprecated and inert.")
       .def_readwrite("page_range_begin", &odr::HtmlConfig::page_range_begin)
       .def_readwrite("page_range_end", &odr::HtmlConfig::page_range_end)
+      .def_readwrite("text_lines_per_page",
+                     &odr::HtmlConfig::text_lines_per_page)
       .def_readwrite("pdf_text_mode", &odr::HtmlConfig::pdf_text_mode)
       .def_readwrite("pdf_dual_layer_fallback_fonts",
                      &odr::HtmlConfig::pdf_dual_layer_fallback_fonts)
       .def_readwrite("pdf_dual_layer_fallback_font_size_adjust",
                      &odr::HtmlConfig::pdf_dual_layer_fallback_font_size_adjust)
+      .def_readwrite("render_threads", &odr::HtmlConfig::render_threads)
+      .def_readwrite("png_compression_level",
+                     &odr::HtmlConfig::png_compression_level)
+      .def_readwrite("cache_max_megabytes",
+                     &odr::HtmlConfig::cache_max_megabytes)
+      .def_readwrite("cache_max_age_days", &odr::HtmlConfig::cache_max_age_days)
       .def_readwrite("no_drm", &odr::HtmlConfig::no_drm,
                      "Deprecated and inert.")
       .def_readwrite("embed_outline", &odr::HtmlConfig::embed_outline,
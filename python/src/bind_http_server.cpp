@@ -14,11 +14,22 @@ void odr_python::bind_http_server(py::module_ &m) {
   py::class_<odr::HttpServer> server(m, "HttpServer",
                                      "Serves translated files over HTTP.");
 
-  py::class_<odr::HttpServer::Config>(
-      server, "Config",
-      "Server-wide settings, empty for now: what a service was translated "
-      "into belongs to whoever translated it.")
-      .def(py::init<>());
+  py::class_<odr::HttpServer::Config>(server, "Config",
+                                      "Server-wide settings.")
+      .def(py::init<>())
+      .def_readwrite("response_cache_budget",
+                     &odr::HttpServer::Config::response_cache_budget,
+                     "Bytes of rendered responses kept for repeat requests; "
+                     "0 keeps none.")
+      .def_readwrite("cache_control", &odr::HttpServer::Config::cache_control,
+                     "`Cache-Control` sent with every file.")
+      .def_readwrite("stream_buffer", &odr::HttpServer::Config::stream_buffer,
+                     "Bytes of a streamed response held between the renderer "
+                     "and the socket.")
+      .def_readwrite("compression_level",
+                     &odr::HttpServer::Config::compression_level,
+                     "Deflate level of compressible files, 1 to 9; 0 sends "
+                     "every file as is.");
 
   py::class_<odr::HttpServer::Options>(server, "Options",
                                        "Socket options for `bind`.")
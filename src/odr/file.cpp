@@ -7,6 +7,7 @@
 
 #include <odr/internal/abstract/file.hpp>
 #include <odr/internal/common/file.hpp>
+#include <odr/internal/common/mapped_file.hpp>
 #include <odr/internal/csv/csv_file.hpp>
 #include <odr/internal/encoding/transcode.hpp>
 #include <odr/internal/magic.hpp>
@@ -33,7 +34,7 @@ deref(const std::shared_ptr<internal::abstract::File> &impl) {
 } // namespace
 
 File File::from_disk(const std::string &path) {
-  return File(std::make_shared<internal::DiskFile>(path));
+  return File(internal::open_disk_file(internal::AbsPath(path)));
 }
 
 File File::from_memory(std::string data) {
@@ -50,7 +51,7 @@ File::File(std::shared_ptr<internal::abstract::File> impl)
 }
 
 File::File(const std::string &path)
-    : m_impl{std::make_shared<internal::DiskFile>(path)} {}
+    : m_impl{internal::open_disk_file(internal::AbsPath(path))} {}
 
 /// `noexcept` leaves no way to report a null impl, hence `unknown`.
 FileLocation File::location() const noexcept {
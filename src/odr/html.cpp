@@ -16,6 +16,7 @@
 #include <odr/internal/html/media_file.hpp>
 #include <odr/internal/html/pdf_file.hpp>
 #include <odr/internal/html/text_file.hpp>
+#include <odr/internal/html/translation_cache.hpp>
 #include <odr/internal/html/xml_file.hpp>
 #include <odr/internal/util/file_util.hpp>
 
@@ -47,6 +48,24 @@ void bring_offline(const HtmlResources &resources,
   }
 }
 
+/// @p file's translation, served from the cache under @p cache_path when
+/// there is one. An encrypted file is never cached: its rendering would sit on
+/// disk in the clear, and outlive the password.
+template <typename Decoded>
+HtmlService translate_cached(const Decoded &file,
+                             const std::string &cache_path,
+                             const HtmlConfig &config, const Logger &logger) {
+  const auto translate = [file, config, logger] {
+    return html::translate(file, config, logger);
+  };
+  if (cache_path.empty() || file.password_encrypted() ||
+      file.encryption_state() == EncryptionState::decrypted) {
+    return translate();
+  }
+  return internal::html::create_cached_service(cache_path, file, config,
+                                               logger, translate);
+}
+
 } // namespace
 
 HtmlConfig::HtmlConfig() { init(); }
@@ -324,50 +343,50 @@ HtmlService html::translate(const Document &document, const HtmlConfig &config,
   return internal::html::create_document_service(document, config, logger);
 }
 
-// The `cache_path` overloads. Nothing reads the path: no renderer has since the
-// output became a set of streams, and the `create_directories` that used to sit
-// here made a directory nobody wrote into.
+// The `cache_path` overloads of a file keep its translation on disk, keyed by
+// its bytes; see `internal::html::create_cached_service`. A filesystem, archive
+// or document has no bytes to key by and is translated as is.
 
 HtmlService html::translate(const DecodedFile &file,
-                            const std::string & /*cache_path*/,
+                            const std::string &cache_path,
                             const HtmlConfig &config, const Logger &logger) {
-  return translate(file, config, logger);
+  return translate_cached(file, cache_path, config, logger);
 }
 
 HtmlService html::translate(const TextFile &text_file,
-                            const std::string & /*cache_path*/,
+                            const std::string &cache_path,
                             const HtmlConfig &config, const Logger &logger) {
-  return translate(text_file, config, logger);
+  return translate_cached(text_file, cache_path, config, logger);
 }
 
 HtmlService html::translate(const ImageFile &image_file,
-                            const std::string & /*cache_path*/,
+                            const std::string &cache_path,
                             const HtmlConfig &config, const Logger &logger) {
-  return translate(image_file, config, logger);
+  return translate_cached(image_file, cache_path, config, logger);
 }
 
 HtmlService html::translate(const ArchiveFile &archive_file,
-                            const std::string & /*cache_path*/,
+                            const std::string &cache_path,
                             const HtmlConfig &config, const Logger &logger) {
-  return translate(archive_file, config, logger);
+  return translate_cached(archive_file, cache_path, config, logger);
 }
 
 HtmlService html::translate(const DocumentFile &document_file,
-                            const std::string & /*cache_path*/,
+                            const std::string &cache_path,
                             const HtmlConfig &config, const Logger &logger) {
-  return translate(document_file, config, logger);
+  return translate_cached(document_file, cache_path, config, logger);
 }
 
 HtmlService html::translate(const PdfFile &pdf_file,
-                            const std::string & /*cache_path*/,
+                            const std::string &cache_path,
                             const HtmlConfig &config, const Logger &logger) {
-  return translate(pdf_file, config, logger);
+  return translate_cached(pdf_file, cache_path, config, logger);
 }
 
 HtmlService html::translate(const FontFile &font_file,
-                            const std::string & /*cache_path*/,
+                            const std::string &cache_path,
                             const HtmlConfig &config, const Logger &logger) {
-  return translate(font_file, config, logger);
+  return translate_cached(font_file, cache_path, config, logger);
 }
 
 HtmlService html::translate(const Filesystem &filesystem,
@@ -113,6 +113,8 @@ struct HtmlConfig {
   std::string page_output_file_name{"page{index}.html"};
 
   /// Embed images as data urls rather than writing them beside the document.
+  /// A pdf's fonts go with its images: written out, each distinct one is a
+  /// single resource under `pdf/`, however many pages and views use it.
   bool embed_images{true};
   /// Write the renderer's own css and js into every document rather than beside
   /// it as one shared file the documents link.
@@ -138,6 +140,12 @@ struct HtmlConfig {
   std::optional<TableDimensions> spreadsheet_limit{TableDimensions(10000, 500)};
   /// Trim a sheet to the cells it uses before @ref spreadsheet_limit applies.
   bool spreadsheet_limit_by_content{true};
+  /// Write a sheet view as a shell that fetches its cells in tiles of this
+  /// many rows and columns as they scroll into view, rather than as one table.
+  /// The shell spans the whole sheet; @ref spreadsheet_limit does not apply.
+  /// The tiles are written on demand by @ref HtmlService::write, so a tiled
+  /// view needs a host serving it and is not brought offline.
+  std::optional<TableDimensions> spreadsheet_tile;
   /// Which gridlines a sheet paints.
   HtmlTableGridlines spreadsheet_gridlines{HtmlTableGridlines::soft};
 
@@ -169,6 +177,12 @@ struct HtmlConfig {
   std::uint32_t page_range_begin{0};
   std::optional<std::uint32_t> page_range_end;
 
+  /// Splits a plain text file into pages of this many lines, served as views
+  /// named like pdf pages (@ref page_output_file_name) besides the whole-file
+  /// `text.html`; a page numbers its lines as the file does. Unset or 0 keeps
+  /// the one view.
+  std::optional<std::uint32_t> text_lines_per_page;
+
   /// How pdf text is written; see @ref PdfTextMode.
   PdfTextMode pdf_text_mode{PdfTextMode::dual_layer};
   /// System fonts `dual_layer` sets its selection layer in, first that
@@ -178,6 +192,23 @@ struct HtmlConfig {
   /// Shrinks the fallback's metrics toward the pdf's (0-1) so css justify can
   /// fill the box. Safe to underestimate: the excess is clipped, not shrunk.
   double pdf_dual_layer_fallback_font_size_adjust{0.5};
+  /// Threads that extract pdf pages while one writes them out in order; 0 takes
+  /// one per hardware thread, 1 renders on the caller's alone. The output is
+  /// the same for any value.
+  std::uint32_t render_threads{1};
+  /// How hard images converted to png, the rasters of a pdf, are deflated: 1
+  /// is fastest, for serving while the reader waits, 9 smallest, for @ref
+  /// HtmlService::bring_offline. An image of more than a megabyte deflates in
+  /// pieces on @ref render_threads threads, unless it is converted on one of
+  /// them already.
+  std::uint32_t png_compression_level{6};
+
+  /// Bounds on the on-disk cache the `cache_path` overloads of @ref
+  /// html::translate keep: entries unused for longer than the age go first,
+  /// then the least recently used until the cache fits the size. 0 lifts a
+  /// bound.
+  std::uint32_t cache_max_megabytes{1024};
+  std::uint32_t cache_max_age_days{30};
 
   /// @deprecated Inert: no output carries a restriction to lift.
   bool no_drm{false};
@@ -311,9 +342,14 @@ HtmlService translate(const Document &document, const HtmlConfig &config,
 
 /// @name Translation with a cache path
 ///
-/// `cache_path` is ignored — nothing on the render path writes to disk, and no
-/// renderer has read it since the output became a set of streams. Kept so
-/// existing callers keep compiling; prefer the overloads above.
+/// A file's translation is kept under `cache_path`, keyed by the file's bytes,
+/// how it was decoded, the config and the library version: a later translation
+/// of the same bytes is served from disk without decoding them again. The cache
+/// is bounded by @ref HtmlConfig::cache_max_megabytes and @ref
+/// HtmlConfig::cache_max_age_days. It lives in `odr-translation-cache` under
+/// `cache_path` and leaves everything else there alone. An empty `cache_path`
+/// and an encrypted file are translated as is, as are a filesystem, an archive
+/// and a document, which have no bytes to key by.
 /// @{
 HtmlService translate(const DecodedFile &file, const std::string &cache_path,
                       const HtmlConfig &config,
@@ -4,25 +4,400 @@
 #include <odr/file.hpp>
 #include <odr/html.hpp>
 
+#include <odr/internal/common/random.hpp>
+#include <odr/internal/crypto/crypto_util.hpp>
+#include <odr/internal/util/string_util.hpp>
+
 #include <httplib/httplib.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
-#include <sstream>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 
 namespace odr {
 
+namespace {
+
+/// A response that has rendered whole within this many bytes is sent with a
+/// `Content-Length`, and with a status that can still say the rendering failed.
+/// A larger one is streamed as it renders.
+constexpr std::size_t first_chunk = 64 * 1024;
+
+/// A service as connected under a prefix.
+struct Content {
+  HtmlService service;
+  /// Tells the responses of this connection from those of an earlier one
+  /// under the same prefix, in the cache and in the `ETag`.
+  std::uint64_t connection{0};
+};
+
+/// A file as rendered, to be served again as is.
+struct CachedResponse {
+  std::string body;
+  std::string mime_type;
+  /// The content coding of `body`, empty for none.
+  std::string encoding;
+};
+
+/// Least-recently-used map from a connection's path to what it rendered,
+/// under a byte budget. Entries are handed out shared, so evicting one never
+/// pulls it from under a request still sending it.
+///
+/// Every member is safe to call concurrently.
+class ResponseCache final {
+public:
+  explicit ResponseCache(const std::size_t budget) : m_budget{budget} {}
+
+  [[nodiscard]] std::shared_ptr<const CachedResponse>
+  find(const std::string &key) {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return nullptr;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->response;
+  }
+
+  /// Caches @p response, then evicts from the least recently used end until
+  /// the budget holds again; a response alone over budget is not kept.
+  void insert(const std::string &key,
+              std::shared_ptr<const CachedResponse> response) {
+    const std::size_t size =
+        key.size() + response->body.size() + response->mime_type.size();
+
+    std::lock_guard lock(m_mutex);
+    if (m_index.contains(key)) {
+      // rendered twice by concurrent requests; the first one stays
+      return;
+    }
+    m_entries.push_front({key, std::move(response), size});
+    m_index.emplace(key, m_entries.begin());
+    m_bytes += size;
+    while (m_bytes > m_budget && !m_entries.empty()) {
+      m_bytes -= m_entries.back().size;
+      m_index.erase(m_entries.back().key);
+      m_entries.pop_back();
+    }
+  }
+
+  void clear() {
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+  }
+
+  [[nodiscard]] std::size_t budget() const { return m_budget; }
+
+private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const CachedResponse> response;
+    std::size_t size{0};
+  };
+
+  std::mutex m_mutex;
+  std::size_t m_budget{0};
+  std::size_t m_bytes{0};
+  /// most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+};
+
+/// A bounded pipe from a renderer on a thread of its own to the request
+/// handler writing to the socket. The renderer waits while the pipe is full,
+/// so a response in flight holds at most the capacity however large it
+/// renders; closing the pipe fails the renderer's next write.
+///
+/// Every member is safe to call concurrently.
+class ResponsePipe final {
+public:
+  explicit ResponsePipe(const std::size_t capacity)
+      : m_capacity{std::max<std::size_t>(capacity, 1)} {}
+
+  /// Appends @p data, waiting for room. False once the pipe is closed.
+  bool write(const char *data, std::size_t size) {
+    std::unique_lock lock(m_mutex);
+    while (size > 0) {
+      m_changed.wait(
+          lock, [this] { return m_closed || m_buffer.size() < m_capacity; });
+      if (m_closed) {
+        return false;
+      }
+      const std::size_t part = std::min(size, m_capacity - m_buffer.size());
+      m_buffer.append(data, part);
+      data += part;
+      size -= part;
+      m_changed.notify_all();
+    }
+    return true;
+  }
+
+  /// Ends the response, cut short by @p error if that is set.
+  void finish(std::exception_ptr error) {
+    std::lock_guard lock(m_mutex);
+    m_finished = true;
+    m_error = std::move(error);
+    m_changed.notify_all();
+  }
+
+  /// Waits until @p bytes are buffered, or as many as fit, or the response
+  /// has ended. Returns whether it has.
+  bool wait_for(std::size_t bytes) {
+    bytes = std::min(bytes, m_capacity);
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock,
+                   [&] { return m_finished || m_buffer.size() >= bytes; });
+    return m_finished;
+  }
+
+  /// Takes what is buffered, waiting for something if there is nothing yet.
+  /// Empty once the response has ended and everything was taken.
+  std::string take() {
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock, [this] {
+      return m_closed || m_finished || !m_buffer.empty();
+    });
+    std::string result;
+    result.swap(m_buffer);
+    m_changed.notify_all();
+    return result;
+  }
+
+  [[nodiscard]] std::exception_ptr error() const {
+    std::lock_guard lock(m_mutex);
+    return m_error;
+  }
+
+  void close() {
+    std::lock_guard lock(m_mutex);
+    m_closed = true;
+    m_changed.notify_all();
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::size_t m_capacity{0};
+  std::string m_buffer;
+  bool m_finished{false};
+  bool m_closed{false};
+  std::exception_ptr m_error;
+};
+
+/// The renderer's end of a ResponsePipe, which gathers small writes.
+class PipeBuffer final : public std::streambuf {
+public:
+  explicit PipeBuffer(ResponsePipe &pipe) : m_pipe{&pipe} {
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+  }
+
+protected:
+  int_type overflow(const int_type c) override {
+    if (!flush_()) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() override { return flush_() ? 0 : -1; }
+
+private:
+  ResponsePipe *m_pipe;
+  std::array<char, 16 * 1024> m_buffer{};
+
+  bool flush_() {
+    const auto size = static_cast<std::size_t>(pptr() - pbase());
+    if (size > 0 && !m_pipe->write(pbase(), size)) {
+      return false;
+    }
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    return true;
+  }
+};
+
+/// A path of a service rendering into a pipe on a thread of its own.
+/// Destroying it closes the pipe, which fails the renderer's next write, and
+/// waits for the thread.
+class Rendering final {
+public:
+  Rendering(HtmlService service, std::string path, const std::size_t capacity)
+      : m_pipe{capacity},
+        m_thread{[this, service = std::move(service), path = std::move(path)] {
+          render_(service, path);
+        }} {}
+
+  ~Rendering() {
+    m_pipe.close();
+    m_thread.join();
+  }
+
+  Rendering(const Rendering &) = delete;
+  Rendering &operator=(const Rendering &) = delete;
+
+  [[nodiscard]] ResponsePipe &pipe() { return m_pipe; }
+
+private:
+  ResponsePipe m_pipe;
+  // last, so the thread starts with the pipe in place
+  std::thread m_thread;
+
+  void render_(const HtmlService &service, const std::string &path) {
+    std::exception_ptr error;
+    try {
+      PipeBuffer buffer(m_pipe);
+      std::ostream out(&buffer);
+      // a closed pipe stops the renderer rather than letting it run on into
+      // a stream that drops everything
+      out.exceptions(std::ios::badbit);
+      service.write(path, out);
+      out.flush();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    m_pipe.finish(std::move(error));
+  }
+};
+
+/// What a streamed response's content provider keeps between its calls.
+struct Streamed {
+  std::unique_ptr<Rendering> rendering;
+  /// A copy of what was sent, for the cache, while it fits the budget.
+  std::string copy;
+  bool keep_copy{true};
+  /// Compresses what is sent, if the client takes a coding of it.
+  std::unique_ptr<internal::crypto::util::Deflater> deflater;
+};
+
+/// The content coding an `Accept-Encoding` header takes best, of `gzip` and
+/// `deflate`; empty if it takes neither.
+std::string negotiate_encoding(const std::string_view accept_encoding) {
+  static constexpr std::string_view space = " \t";
+  const auto trim = [](std::string_view string) {
+    string.remove_prefix(
+        std::min(string.find_first_not_of(space), string.size()));
+    string.remove_suffix(string.size() - (string.find_last_not_of(space) + 1));
+    return string;
+  };
+
+  std::optional<double> gzip;
+  std::optional<double> deflate;
+  std::optional<double> any;
+  std::size_t at = 0;
+  while (at <= accept_encoding.size()) {
+    std::size_t end = accept_encoding.find(',', at);
+    if (end == std::string_view::npos) {
+      end = accept_encoding.size();
+    }
+    const std::string_view item = accept_encoding.substr(at, end - at);
+    at = end + 1;
+
+    const std::size_t parameters = item.find(';');
+    const std::string_view coding = trim(item.substr(0, parameters));
+    double quality = 1;
+    if (parameters != std::string_view::npos) {
+      const std::string_view parameter = trim(item.substr(parameters + 1));
+      if (parameter.starts_with("q=") || parameter.starts_with("Q=")) {
+        quality =
+            std::strtod(std::string(parameter.substr(2)).c_str(), nullptr);
+      }
+    }
+
+    if (internal::util::string::equals_ignore_case(coding, "gzip") ||
+        internal::util::string::equals_ignore_case(coding, "x-gzip")) {
+      gzip = quality;
+    } else if (internal::util::string::equals_ignore_case(coding, "deflate")) {
+      deflate = quality;
+    } else if (coding == "*") {
+      any = quality;
+    }
+  }
+
+  const double gzip_quality = gzip.value_or(any.value_or(0));
+  const double deflate_quality = deflate.value_or(any.value_or(0));
+  if (gzip_quality <= 0 && deflate_quality <= 0) {
+    return {};
+  }
+  return gzip_quality >= deflate_quality ? "gzip" : "deflate";
+}
+
+internal::crypto::util::DeflateFormat
+deflate_format(const std::string_view encoding) {
+  return encoding == "gzip" ? internal::crypto::util::DeflateFormat::gzip
+                            : internal::crypto::util::DeflateFormat::zlib;
+}
+
+/// Whether a response of @p mime_type gets smaller deflated: text, markup,
+/// scripts and the uncompressed font formats, but not images, woff fonts or
+/// media, which are compressed already.
+bool is_compressible(std::string_view mime_type) {
+  mime_type = mime_type.substr(0, mime_type.find(';'));
+  return mime_type.starts_with("text/") || mime_type.ends_with("/xml") ||
+         mime_type.ends_with("+xml") || mime_type.ends_with("/json") ||
+         mime_type.ends_with("/javascript") || mime_type == "font/ttf" ||
+         mime_type == "font/otf" ||
+         mime_type == "application/vnd.ms-fontobject";
+}
+
+/// Whether an `If-None-Match` list names @p etag. The weak comparison, as a
+/// GET asks for: a `W/` prefix is ignored.
+bool matches_etag(const std::string_view if_none_match,
+                  const std::string_view etag) {
+  static constexpr std::string_view space = " \t";
+
+  std::size_t at = 0;
+  while (at <= if_none_match.size()) {
+    std::size_t end = if_none_match.find(',', at);
+    if (end == std::string_view::npos) {
+      end = if_none_match.size();
+    }
+    std::string_view candidate = if_none_match.substr(at, end - at);
+    candidate.remove_prefix(
+        std::min(candidate.find_first_not_of(space), candidate.size()));
+    candidate.remove_suffix(candidate.size() -
+                            (candidate.find_last_not_of(space) + 1));
+    if (candidate.starts_with("W/")) {
+      candidate.remove_prefix(2);
+    }
+    if (candidate == etag) {
+      return true;
+    }
+    at = end + 1;
+  }
+  return false;
+}
+
+} // namespace
+
 class HttpServer::Impl : public std::enable_shared_from_this<Impl> {
 public:
   /// What a HttpServer holds: a second reference whose deleter stops the server
   /// rather than destroying it. ~Impl cannot be that signal - listen() keeps a
   /// reference of its own, so the impl outlives the handles while it serves.
-  static std::shared_ptr<Impl> create(const Logger &logger) {
-    std::shared_ptr<Impl> owner = std::make_shared<Impl>(logger);
+  static std::shared_ptr<Impl> create(const Config &config,
+                                      const Logger &logger) {
+    std::shared_ptr<Impl> owner = std::make_shared<Impl>(config, logger);
     Impl *const impl = owner.get();
 
     // shared_from_this() stays bound to the control block make_shared put
@@ -33,8 +408,14 @@ public:
         }};
   }
 
-  explicit Impl(const Logger &logger)
-      : m_logger{logger}, m_server{std::make_shared<httplib::Server>()} {
+  Impl(const Config &config, const Logger &logger)
+      : m_logger{logger}, m_cache_control{config.cache_control},
+        m_stream_buffer{config.stream_buffer},
+        m_compression_level{std::min(config.compression_level, 9u)},
+        m_cache{config.response_cache_budget},
+        // a restarted server may number its connections the same again
+        m_instance{internal::random_string(8)},
+        m_server{std::make_shared<httplib::Server>()} {
     // an exception escaping a handler tears down the process otherwise
     m_server->set_exception_handler([this](const httplib::Request & /*req*/,
                                            httplib::Response &res,
@@ -96,10 +477,10 @@ public:
         res.status = 404;
         return;
       }
-      const HtmlService service = it->second.service;
+      const Content content = it->second;
       lock.unlock();
 
-      serve_file(res, service, path);
+      serve_file(req, res, content, path);
     } catch (const std::exception &e) {
       ODR_ERROR(m_logger, "Error handling request: " << e.what());
       res.status = 500;
@@ -111,8 +492,53 @@ public:
     }
   }
 
-  void serve_file(httplib::Response &res, const HtmlService &service,
-                  const std::string &path) const {
+  void serve_file(const httplib::Request &req, httplib::Response &res,
+                  const Content &content, const std::string &path) {
+    const HtmlService &service = content.service;
+    const std::string encoding =
+        m_compression_level == 0
+            ? std::string()
+            : negotiate_encoding(req.get_header_value("Accept-Encoding"));
+    // strong: a connected service renders a path to the same bytes each time,
+    // and the connection number changes with the service. The coding the
+    // client takes is part of it, as the bytes differ by it; a file that is
+    // never compressed has a tag per coding all the same, as telling it apart
+    // would take asking the service
+    const std::string etag =
+        "\"" + m_instance + "-" + std::to_string(content.connection) + "-" +
+        std::to_string(std::hash<std::string>{}(path)) +
+        (encoding.empty() ? "" : "-" + encoding) + "\"";
+
+    if (matches_etag(req.get_header_value("If-None-Match"), etag)) {
+      ODR_VERBOSE(m_logger, "Not modified: " << path);
+      res.status = 304;
+      set_headers_(res, etag, "");
+      return;
+    }
+
+    const std::string key = std::to_string(content.connection) + "/" + path;
+    const std::string encoded_key =
+        encoding.empty() ? key : key + ";" + encoding;
+
+    std::shared_ptr<const CachedResponse> response = m_cache.find(encoded_key);
+    if (response == nullptr && !encoding.empty()) {
+      // rendered already, and compressed from there rather than again
+      if (const std::shared_ptr<const CachedResponse> identity =
+              m_cache.find(key);
+          identity != nullptr) {
+        response = identity;
+        if (is_compressible(identity->mime_type)) {
+          response = compress_(*identity, encoding);
+          m_cache.insert(encoded_key, response);
+        }
+      }
+    }
+    if (response != nullptr) {
+      ODR_VERBOSE(m_logger, "Serving cached file: " << path);
+      send_(res, etag, *response);
+      return;
+    }
+
     if (!service.exists(path)) {
       ODR_ERROR(m_logger, "File not found: " << path);
       res.status = 404;
@@ -121,22 +547,97 @@ public:
 
     ODR_VERBOSE(m_logger, "Serving file: " << path);
 
-    // buffered rather than streamed: a chunked ContentProviderWithoutLength
-    // crashes httplib::Server::write_response_core when the client disconnects,
-    // the content generation throws, or the server stops mid-request
-    try {
-      std::ostringstream buffer;
-      service.write(path, buffer);
-      res.set_content(buffer.str(), service.mimetype(path));
-    } catch (const std::exception &e) {
-      ODR_ERROR(m_logger, "Error serving file " << path << ": " << e.what());
-      res.status = 500;
-      res.set_content("Internal Server Error", "text/plain");
-    } catch (...) {
-      ODR_ERROR(m_logger, "Unknown error serving file: " << path);
-      res.status = 500;
-      res.set_content("Internal Server Error", "text/plain");
+    const std::string mime_type = service.mimetype(path);
+    const bool compress = !encoding.empty() && is_compressible(mime_type);
+    auto rendering =
+        std::make_unique<Rendering>(service, path, m_stream_buffer);
+
+    if (rendering->pipe().wait_for(first_chunk)) {
+      if (const std::exception_ptr error = rendering->pipe().error();
+          error != nullptr) {
+        log_render_error_(path, error);
+        res.status = 500;
+        res.set_content("Internal Server Error", "text/plain");
+        return;
+      }
+
+      response = std::make_shared<const CachedResponse>(
+          CachedResponse{rendering->pipe().take(), mime_type, ""});
+      m_cache.insert(key, response);
+      if (compress) {
+        response = compress_(*response, encoding);
+        m_cache.insert(encoded_key, response);
+      }
+      send_(res, etag, *response);
+      return;
+    }
+
+    set_headers_(res, etag, compress ? encoding : "");
+    // the provider owns what it reads and never throws: an exception out of
+    // it, or a provider outliving what it captured, is what took
+    // httplib::Server::write_response_core down when the client disconnected,
+    // the rendering threw or the server stopped mid-request. Returning false
+    // makes httplib drop the connection, which is all a response whose status
+    // is out already can do to say it is cut short. The response is destroyed
+    // before stop() has joined the thread pool, and the rendering with it.
+    const auto streamed = std::make_shared<Streamed>();
+    streamed->rendering = std::move(rendering);
+    if (compress) {
+      streamed->deflater = std::make_unique<internal::crypto::util::Deflater>(
+          deflate_format(encoding), m_compression_level);
     }
+    const std::string cached_key = compress ? encoded_key : key;
+    const std::string cached_encoding = compress ? encoding : "";
+    res.set_chunked_content_provider(
+        mime_type, [this, streamed, cached_key, cached_encoding, path,
+                    mime_type](std::size_t /*offset*/,
+                               httplib::DataSink &sink) {
+          try {
+            if (m_stopping.load(std::memory_order_acquire)) {
+              return false;
+            }
+
+            ResponsePipe &pipe = streamed->rendering->pipe();
+            std::string chunk = pipe.take();
+            const bool end = chunk.empty();
+            if (end) {
+              if (const std::exception_ptr error = pipe.error();
+                  error != nullptr) {
+                log_render_error_(path, error);
+                return false;
+              }
+            }
+            if (streamed->deflater != nullptr) {
+              chunk = end ? streamed->deflater->finish()
+                          : streamed->deflater->put(chunk);
+            }
+
+            if (streamed->keep_copy) {
+              if (streamed->copy.size() + chunk.size() <= m_cache.budget()) {
+                streamed->copy += chunk;
+              } else {
+                streamed->keep_copy = false;
+                std::string().swap(streamed->copy);
+              }
+            }
+            if (!chunk.empty() && !sink.write(chunk.data(), chunk.size())) {
+              return false;
+            }
+
+            if (end) {
+              sink.done();
+              if (streamed->keep_copy) {
+                m_cache.insert(cached_key,
+                               std::make_shared<const CachedResponse>(
+                                   CachedResponse{std::move(streamed->copy),
+                                                  mime_type, cached_encoding}));
+              }
+            }
+            return true;
+          } catch (...) {
+            return false;
+          }
+        });
   }
 
   void connect_service(HtmlService service, const std::string &prefix) {
@@ -148,7 +649,7 @@ public:
       throw PrefixInUse(prefix);
     }
 
-    m_content.emplace(prefix, Content{std::move(service)});
+    m_content.emplace(prefix, Content{std::move(service), ++m_connections});
   }
 
   std::uint32_t bind(const std::string &host, const std::uint32_t port,
@@ -256,6 +757,7 @@ public:
     std::unique_lock lock{m_mutex};
 
     m_content.clear();
+    m_cache.clear();
   }
 
   void stop() {
@@ -307,6 +809,46 @@ public:
   }
 
 private:
+  /// @p response deflated in the content coding @p encoding.
+  std::shared_ptr<const CachedResponse>
+  compress_(const CachedResponse &response, const std::string &encoding) const {
+    internal::crypto::util::Deflater deflater(deflate_format(encoding),
+                                              m_compression_level);
+    std::string body = deflater.put(response.body);
+    body += deflater.finish();
+    return std::make_shared<const CachedResponse>(
+        CachedResponse{std::move(body), response.mime_type, encoding});
+  }
+
+  /// The headers every file response carries; @p encoding is the content
+  /// coding of its body, empty for none.
+  void set_headers_(httplib::Response &res, const std::string &etag,
+                    const std::string &encoding) const {
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", m_cache_control);
+    res.set_header("Vary", "Accept-Encoding");
+    if (!encoding.empty()) {
+      res.set_header("Content-Encoding", encoding);
+    }
+  }
+
+  void send_(httplib::Response &res, const std::string &etag,
+             const CachedResponse &response) const {
+    set_headers_(res, etag, response.encoding);
+    res.set_content(response.body, response.mime_type);
+  }
+
+  void log_render_error_(const std::string &path,
+                         const std::exception_ptr &error) const {
+    try {
+      std::rethrow_exception(error);
+    } catch (const std::exception &e) {
+      ODR_ERROR(m_logger, "Error serving file " << path << ": " << e.what());
+    } catch (...) {
+      ODR_ERROR(m_logger, "Unknown error serving file: " << path);
+    }
+  }
+
   /// Marks a listen() as done however it leaves, so stop() can wait for it.
   struct ListenGuard {
     Impl &impl;
@@ -321,6 +863,9 @@ private:
   };
 
   Logger m_logger;
+  std::string m_cache_control;
+  std::size_t m_stream_buffer{0};
+  unsigned m_compression_level{0};
 
   // guards the lifecycle state below as well as m_content
   mutable std::mutex m_mutex;
@@ -336,11 +881,12 @@ private:
   // server that never bound one
   bool m_bound{false};
 
-  struct Content {
-    HtmlService service;
-  };
-
   std::unordered_map<std::string, Content> m_content;
+  // connect_service() calls so far
+  std::uint64_t m_connections{0};
+
+  ResponseCache m_cache;
+  std::string m_instance;
 
   // Shared rather than unique: listen() takes a reference of its own, so the
   // server outlives an overlapping stop() and is destroyed - joining the thread
@@ -348,8 +894,8 @@ private:
   std::shared_ptr<httplib::Server> m_server;
 };
 
-HttpServer::HttpServer(const Config & /*config*/, const Logger &logger)
-    : m_impl{Impl::create(logger)} {}
+HttpServer::HttpServer(const Config &config, const Logger &logger)
+    : m_impl{Impl::create(config, logger)} {}
 
 void HttpServer::connect_service(HtmlService service,
                                  const std::string &prefix) const {
@@ -3,6 +3,7 @@
 #include <odr/html.hpp>
 #include <odr/logger.hpp>
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -13,10 +14,24 @@ class Filesystem;
 struct HtmlConfig;
 class HtmlService;
 
-/// Server-wide settings for HttpServer. Empty since cache_path went with
-/// serve_file: what a service was translated into belongs to whoever
-/// translated it.
-struct HttpServerConfig {};
+/// Server-wide settings for HttpServer. What a service was translated into
+/// belongs to whoever translated it; the server only keeps what it rendered.
+struct HttpServerConfig {
+  /// Bytes of rendered responses kept to answer a repeat request without
+  /// rendering it again, least recently used out first. 0 keeps none.
+  std::size_t response_cache_budget{64 * 1024 * 1024};
+  /// `Cache-Control` sent with every file. The default has the client ask
+  /// again each time, which the file's `ETag` answers with a bodiless 304.
+  std::string cache_control{"no-cache"};
+  /// Bytes of a response held between the renderer and the socket. A file
+  /// that renders to more than 64 KiB goes out chunked as it renders, the
+  /// renderer waiting while this much is unsent.
+  std::size_t stream_buffer{1024 * 1024};
+  /// Deflate level, 1 to 9, of the text, markup, scripts and uncompressed
+  /// fonts sent to a client that takes `gzip` or `deflate`; 0 sends every file
+  /// as is. A compressed file is cached compressed.
+  unsigned compression_level{6};
+};
 
 /// Socket options for HttpServer::bind(). POSIX only: Windows keeps
 /// cpp-httplib's exclusive-address defaults, where these flags mean the
@@ -29,12 +44,18 @@ struct HttpServerOptions {
                             ///< connections between them, hence off
 };
 
-/// Serves connected HtmlServices over HTTP. listen() blocks and therefore runs
-/// on a thread of the caller's; stop() - and destroying the last handle, which
-/// stops the server too - returns only once that thread is out of listen()
-/// again, so neither may be called from a request handler. A thread that has
-/// not entered listen() yet is invisible to both: as with any call on an object
-/// being destroyed, it has to be in before the last handle goes.
+/// Serves connected HtmlServices over HTTP. Every file goes out with a strong
+/// `ETag` that names the connection and the path, so an `If-None-Match`
+/// carrying it is answered with 304 before the service is asked anything. A
+/// file is rendered on a thread of its own and streamed from there, so a large
+/// one starts going out before it is rendered whole; a failure, a client that
+/// goes away or stop() cuts such a response short by closing the connection.
+/// listen() blocks and therefore runs on a thread of the caller's; stop() - and
+/// destroying the last handle, which stops the server too - returns only once
+/// that thread is out of listen() again, so neither may be called from a
+/// request handler. A thread that has not entered listen() yet is invisible to
+/// both: as with any call on an object being destroyed, it has to be in before
+/// the last handle goes.
 class HttpServer {
 public:
   constexpr static auto prefix_pattern = R"(([a-zA-Z0-9_-]+))";
@@ -64,8 +85,8 @@ public:
   /// is what stop() waits for.
   bool is_running() const;
 
-  /// Drops the connected services. Files they were translated into are the
-  /// caller's, and are left alone.
+  /// Drops the connected services and the responses cached for them. Files
+  /// they were translated into are the caller's, and are left alone.
   void clear() const;
 
   /// Stops listen() and releases the socket, blocking until listen() has
@@ -147,34 +147,20 @@ bool SystemFilesystem::move(const AbsPath &from, const AbsPath &to) {
 }
 
 namespace {
+/// Walks the subtree of a shared tree in place. The tree is never changed
+/// while shared, so the walk sees the entries as they were when it began.
 class VirtualFileWalker final : public abstract::FileWalker {
 public:
-  using Files = std::map<AbsPath, std::shared_ptr<abstract::File>>;
-
-  VirtualFileWalker(AbsPath root, const Files &files)
-      : m_root{std::move(root)} {
-    for (const auto &[path, file] : files) {
-      if (path.descendant_of(m_root)) {
-        m_files[path] = file;
-      }
-    }
-
-    m_iterator = std::begin(m_files);
-  }
-
-  /// The iterator has to be re-seated into the copied map.
-  VirtualFileWalker(const VirtualFileWalker &other)
-      : m_root{other.m_root}, m_files{other.m_files} {
-    m_iterator = other.m_iterator == std::end(other.m_files)
-                     ? std::end(m_files)
-                     : m_files.find(other.m_iterator->first);
-  }
+  VirtualFileWalker(AbsPath root,
+                    std::shared_ptr<const VirtualFilesystem::Tree> tree)
+      : m_root{std::move(root)}, m_tree{std::move(tree)},
+        m_iterator{m_tree->upper_bound(m_root)} {}
 
   [[nodiscard]] std::unique_ptr<FileWalker> clone() const override {
     return std::make_unique<VirtualFileWalker>(*this);
   }
 
-  /// The iterators belong to different maps, so only the keys can be compared.
+  /// Walkers may hold different trees, so only the keys can be compared.
   [[nodiscard]] bool equals(const FileWalker &rhs_) const override {
     const auto *rhs = dynamic_cast<const VirtualFileWalker *>(&rhs_);
     if (rhs == nullptr) {
@@ -186,8 +172,10 @@ public:
     return m_iterator->first == rhs->m_iterator->first;
   }
 
+  /// The subtree is contiguous; the first entry outside it ends the walk.
   [[nodiscard]] bool end() const override {
-    return m_iterator == std::end(m_files);
+    return m_iterator == std::end(*m_tree) ||
+           !m_iterator->first.descendant_of(m_root);
   }
 
   /// 0 directly in the walked root, as `recursive_directory_iterator`.
@@ -213,20 +201,14 @@ public:
   void flat_next() override { skip_subtree_(m_iterator->first); }
 
 private:
-  /// Ordered component-wise, so that a subtree is contiguous and can be
-  /// skipped by walking it. By string it is not: "/a" < "/a-b" < "/a/b".
-  using DepthFirstFiles =
-      std::map<AbsPath, std::shared_ptr<abstract::File>,
-               decltype(std::ranges::lexicographical_compare)>;
-
   AbsPath m_root;
-  DepthFirstFiles m_files;
-  DepthFirstFiles::iterator m_iterator;
+  std::shared_ptr<const VirtualFilesystem::Tree> m_tree;
+  VirtualFilesystem::Tree::const_iterator m_iterator;
 
   void skip_subtree_(const AbsPath &path) {
     do {
       ++m_iterator;
-    } while (m_iterator != std::end(m_files) &&
+    } while (m_iterator != std::end(*m_tree) &&
              m_iterator->first.descendant_of(path));
   }
 };
@@ -254,14 +236,12 @@ bool VirtualFilesystem::is_directory(const AbsPath &path) const {
   }
   // An intermediate directory need not be an entry of its own - a zip may name
   // only its files.
-  return std::ranges::any_of(m_files, [&path](const auto &entry) {
-    return entry.first.descendant_of(path);
-  });
+  return m_descendants.contains(path);
 }
 
 std::unique_ptr<abstract::FileWalker>
 VirtualFilesystem::file_walker(const AbsPath &path) const {
-  return std::make_unique<VirtualFileWalker>(path, m_files);
+  return std::make_unique<VirtualFileWalker>(path, m_tree);
 }
 
 std::shared_ptr<abstract::File>
@@ -284,16 +264,15 @@ bool VirtualFilesystem::create_directory(const AbsPath &path) {
   if (m_files.contains(path)) {
     return false;
   }
-  m_files[path] = nullptr;
+  insert_(path, nullptr);
   return true;
 }
 
 bool VirtualFilesystem::remove(const AbsPath &path) {
-  const auto file_it = m_files.find(path);
-  if (file_it == std::end(m_files)) {
+  if (!m_files.contains(path)) {
     return false;
   }
-  m_files.erase(file_it);
+  erase_(path);
   return true;
 }
 
@@ -307,7 +286,7 @@ bool VirtualFilesystem::copy(const AbsPath &from, const AbsPath &to) {
   if (m_files.contains(to)) {
     return false;
   }
-  m_files[to] = from_it->second;
+  insert_(to, from_it->second);
   return true;
 }
 
@@ -323,7 +302,7 @@ VirtualFilesystem::copy(std::shared_ptr<abstract::File> from,
   if (m_files.contains(to)) {
     return {};
   }
-  m_files[to] = from;
+  insert_(to, from);
   return from;
 }
 
@@ -335,4 +314,35 @@ bool VirtualFilesystem::move(const AbsPath &from, const AbsPath &to) {
   return true;
 }
 
+void VirtualFilesystem::insert_(const AbsPath &path,
+                                std::shared_ptr<abstract::File> file) {
+  own_tree_().emplace(path, file);
+  m_files.emplace(path, std::move(file));
+  for (AbsPath parent = path; !parent.root();) {
+    parent = parent.parent();
+    if (!parent.root()) {
+      ++m_descendants[parent];
+    }
+  }
+}
+
+void VirtualFilesystem::erase_(const AbsPath &path) {
+  own_tree_().erase(path);
+  m_files.erase(path);
+  for (AbsPath parent = path; !parent.root();) {
+    parent = parent.parent();
+    if (const auto it = m_descendants.find(parent);
+        it != std::end(m_descendants) && --it->second == 0) {
+      m_descendants.erase(it);
+    }
+  }
+}
+
+VirtualFilesystem::Tree &VirtualFilesystem::own_tree_() {
+  if (m_tree.use_count() > 1) {
+    m_tree = std::make_shared<Tree>(*m_tree);
+  }
+  return *m_tree;
+}
+
 } // namespace odr::internal
@@ -3,9 +3,12 @@
 #include <odr/internal/abstract/filesystem.hpp>
 #include <odr/internal/common/path.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <iosfwd>
 #include <map>
 #include <memory>
+#include <unordered_map>
 
 namespace odr::internal::abstract {
 class File;
@@ -44,8 +47,20 @@ private:
   [[nodiscard]] AbsPath to_system_path_(const AbsPath &path) const;
 };
 
+/// Files and directories held in memory, as an archive's entries are.
+///
+/// Paths are hashed, and so is every directory an entry implies, so `exists`,
+/// `is_file`, `is_directory` and `open` do not depend on the number of
+/// entries. The walkers share one tree of the entries, ordered so that a
+/// subtree is contiguous; a change copies the tree only while a walker still
+/// holds it.
 class VirtualFilesystem final : public abstract::Filesystem {
 public:
+  /// Ordered component-wise, so that a subtree is contiguous and can be
+  /// skipped by walking it. By string it is not: "/a" < "/a-b" < "/a/b".
+  using Tree = std::map<AbsPath, std::shared_ptr<abstract::File>,
+                        decltype(std::ranges::lexicographical_compare)>;
+
   [[nodiscard]] bool exists(const AbsPath &path) const override;
   [[nodiscard]] bool is_file(const AbsPath &path) const override;
   [[nodiscard]] bool is_directory(const AbsPath &path) const override;
@@ -69,7 +84,16 @@ public:
 
 private:
   // TODO consider `const abstract::File`
-  std::map<AbsPath, std::shared_ptr<abstract::File>> m_files;
+  /// every entry; a directory's file is nullptr
+  std::unordered_map<AbsPath, std::shared_ptr<abstract::File>> m_files;
+  /// every directory with entries under it, and how many
+  std::unordered_map<AbsPath, std::size_t> m_descendants;
+  std::shared_ptr<Tree> m_tree{std::make_shared<Tree>()};
+
+  void insert_(const AbsPath &path, std::shared_ptr<abstract::File> file);
+  void erase_(const AbsPath &path);
+  /// The tree, copied first if a walker shares it.
+  Tree &own_tree_();
 };
 
 } // namespace odr::internal
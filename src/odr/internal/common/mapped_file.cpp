@@ -0,0 +1,162 @@
+#include <odr/internal/common/mapped_file.hpp>
+
+#include <odr/exceptions.hpp>
+#include <odr/file.hpp>
+
+#include <odr/internal/common/file.hpp>
+#include <odr/internal/util/stream_util.hpp>
+
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace odr::internal {
+
+class MappedFile::Mapping final {
+public:
+  explicit Mapping(const AbsPath &path) {
+    if (!std::filesystem::is_regular_file(path.path())) {
+      throw FileNotFound(path.string());
+    }
+#ifdef _WIN32
+    const HANDLE file =
+        CreateFileW(path.path().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      throw FileReadError();
+    }
+    // sized through the handle, so a file replaced since the check above
+    // cannot leave the view longer than what it maps
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) == 0) {
+      CloseHandle(file);
+      throw FileReadError();
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    if (m_size == 0) {
+      // nothing to map, and an empty mapping is an error on both platforms
+      CloseHandle(file);
+      return;
+    }
+    const HANDLE mapping =
+        CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // the view keeps the mapping and the mapping the file open
+    CloseHandle(file);
+    if (mapping == nullptr) {
+      throw FileReadError();
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, m_size);
+    CloseHandle(mapping);
+    if (data == nullptr) {
+      throw FileReadError();
+    }
+#else
+    const int file = ::open(path.string().c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+      throw FileReadError();
+    }
+    // sized through the descriptor, so a file replaced since the check above
+    // cannot leave the view longer than what it maps
+    struct stat status;
+    if (::fstat(file, &status) != 0 || !S_ISREG(status.st_mode)) {
+      ::close(file);
+      throw FileReadError();
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    if (m_size == 0) {
+      // nothing to map, and an empty mapping is an error on both platforms
+      ::close(file);
+      return;
+    }
+    void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+    // the mapping keeps its own reference to the file
+    ::close(file);
+    if (data == MAP_FAILED) {
+      throw FileReadError();
+    }
+    // the parsers seek around, but mostly read forward
+    ::madvise(data, m_size, MADV_WILLNEED);
+#endif
+    m_data = static_cast<const char *>(data);
+  }
+
+  Mapping(const Mapping &) = delete;
+  Mapping &operator=(const Mapping &) = delete;
+
+  ~Mapping() {
+    if (m_data == nullptr) {
+      return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+#else
+    ::munmap(const_cast<char *>(m_data), m_size);
+#endif
+  }
+
+  [[nodiscard]] std::string_view view() const { return {m_data, m_size}; }
+
+private:
+  const char *m_data{nullptr};
+  std::size_t m_size{0};
+};
+
+namespace {
+
+/// Keeps the mapping it reads alive.
+class MappedStream final : public util::stream::ViewStream {
+public:
+  explicit MappedStream(std::shared_ptr<const void> mapping,
+                        const std::string_view view)
+      : ViewStream(view), m_mapping{std::move(mapping)} {}
+
+private:
+  std::shared_ptr<const void> m_mapping;
+};
+
+} // namespace
+
+MappedFile::MappedFile(AbsPath path)
+    : m_path{std::move(path)}, m_mapping{std::make_shared<Mapping>(m_path)} {}
+
+FileLocation MappedFile::location() const noexcept {
+  return FileLocation::disk;
+}
+
+std::size_t MappedFile::size() const { return m_mapping->view().size(); }
+
+std::optional<AbsPath> MappedFile::disk_path() const { return m_path; }
+
+std::optional<std::string_view> MappedFile::memory_data() const {
+  return m_mapping->view();
+}
+
+std::unique_ptr<std::istream> MappedFile::stream() const {
+  return std::make_unique<MappedStream>(m_mapping, m_mapping->view());
+}
+
+std::shared_ptr<abstract::File> open_disk_file(AbsPath path) {
+  auto file = std::make_shared<DiskFile>(std::move(path));
+  if (file->size() < MappedFile::threshold) {
+    return file;
+  }
+  try {
+    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+    return std::make_shared<MappedFile>(*file->disk_path());
+  } catch (const FileReadError &) {
+    // no mapping for this file here, say on a filesystem without mmap
+    return file;
+  }
+}
+
+} // namespace odr::internal
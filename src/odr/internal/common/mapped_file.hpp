@@ -0,0 +1,54 @@
+#pragma once
+
+#include <odr/internal/abstract/file.hpp>
+#include <odr/internal/common/path.hpp>
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace odr {
+enum class FileLocation;
+}
+
+namespace odr::internal {
+
+/// A file on disk mapped read-only into memory, so `memory_data()` views its
+/// bytes without a copy and reads through `stream()` are page faults rather
+/// than syscalls. The pages are shared with the page cache, so mapping a file
+/// does not duplicate it in the process's memory the way `MemoryFile` does.
+///
+/// The file must not be truncated while mapped: reading past its new end is a
+/// bus error, not an exception.
+class MappedFile final : public abstract::File {
+public:
+  /// Below this size the mapping's setup costs more than the reads it saves.
+  static constexpr std::size_t threshold = 4 * 1024 * 1024;
+
+  /// Throws `FileNotFound` if @p path is no regular file, `FileReadError` if
+  /// it cannot be mapped.
+  explicit MappedFile(AbsPath path);
+
+  [[nodiscard]] FileLocation location() const noexcept override;
+  [[nodiscard]] std::size_t size() const override;
+
+  [[nodiscard]] std::optional<AbsPath> disk_path() const override;
+  [[nodiscard]] std::optional<std::string_view> memory_data() const override;
+
+  /// Each stream shares the mapping, so it stays valid past the file.
+  [[nodiscard]] std::unique_ptr<std::istream> stream() const override;
+
+private:
+  class Mapping;
+
+  AbsPath m_path;
+  std::shared_ptr<const Mapping> m_mapping;
+};
+
+/// A `MappedFile` for a regular file of at least `MappedFile::threshold`
+/// bytes, falling back to a `DiskFile` when it is smaller or cannot be mapped.
+[[nodiscard]] std::shared_ptr<abstract::File> open_disk_file(AbsPath path);
+
+} // namespace odr::internal
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace odr::internal {
+
+/// Whether the calling thread is a worker of an `OrderedTaskQueue`, whatever
+/// its type.
+inline thread_local bool on_ordered_task_worker{false};
+
+/// Runs `task(0)`, …, `task(count - 1)` and hands out their results in that
+/// order, one per `next()`. With more than one thread the tasks run on workers
+/// of the queue's own, at most two per worker ahead of the consumer, so memory
+/// stays bounded however many tasks there are; with one they run inline, in
+/// `next()`, and no thread is started. A queue made on another queue's worker
+/// runs with one: the outer queue's workers take the threads there are, and
+/// nesting would multiply them.
+///
+/// A task's exception is rethrown by the `next()` that would have returned its
+/// result. Destruction lets running tasks finish and starts no more.
+template <typename T> class OrderedTaskQueue final {
+public:
+  using Task = std::function<T(std::size_t)>;
+
+  /// 0 @p threads takes one per hardware thread.
+  OrderedTaskQueue(const std::size_t count, std::uint32_t threads, Task task)
+      : m_count{count}, m_task{std::move(task)} {
+    if (on_ordered_task_worker) {
+      threads = 1;
+    } else if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t workers = std::min<std::size_t>(threads, count);
+    if (workers <= 1) {
+      return;
+    }
+
+    m_slots.resize(std::min(2 * workers, count));
+    m_workers.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+      m_workers.emplace_back([this] { work(); });
+    }
+  }
+
+  OrderedTaskQueue(const OrderedTaskQueue &) = delete;
+  OrderedTaskQueue &operator=(const OrderedTaskQueue &) = delete;
+
+  ~OrderedTaskQueue() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stopped = true;
+    }
+    m_condition.notify_all();
+    for (std::thread &worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const { return m_count; }
+
+  /// The next result in order. Calling it more than `size()` times is
+  /// undefined.
+  [[nodiscard]] T next() {
+    if (m_workers.empty()) {
+      return m_task(m_consumed++);
+    }
+
+    std::unique_lock lock(m_mutex);
+    std::optional<Result> &slot = m_slots[m_consumed % m_slots.size()];
+    m_condition.wait(lock, [&] { return slot.has_value(); });
+    Result result = std::move(*slot);
+    slot.reset();
+    ++m_consumed;
+    lock.unlock();
+    m_condition.notify_all();
+
+    if (result.error) {
+      std::rethrow_exception(result.error);
+    }
+    // a result without an error always carries a value
+    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+    return std::move(*result.value);
+  }
+
+private:
+  struct Result {
+    std::optional<T> value;
+    std::exception_ptr error;
+  };
+
+  void work() {
+    on_ordered_task_worker = true;
+    while (true) {
+      std::size_t index = 0;
+      {
+        std::unique_lock lock(m_mutex);
+        // task `index` may start once the slot it lands in has been consumed
+        m_condition.wait(lock, [&] {
+          return m_stopped || m_claimed >= m_count ||
+                 m_claimed < m_consumed + m_slots.size();
+        });
+        if (m_stopped || m_claimed >= m_count) {
+          return;
+        }
+        index = m_claimed++;
+      }
+
+      Result result;
+      try {
+        result.value.emplace(m_task(index));
+      } catch (...) {
+        result.error = std::current_exception();
+      }
+
+      {
+        std::lock_guard lock(m_mutex);
+        m_slots[index % m_slots.size()] = std::move(result);
+      }
+      m_condition.notify_all();
+    }
+  }
+
+  std::size_t m_count{0};
+  Task m_task;
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::vector<std::optional<Result>> m_slots;
+  std::size_t m_claimed{0};
+  std::size_t m_consumed{0};
+  bool m_stopped{false};
+
+  std::vector<std::thread> m_workers;
+};
+
+} // namespace odr::internal
@@ -93,7 +93,14 @@ TemporaryDiskFile TemporaryDiskFileFactory::copy(std::istream &in) const {
     file.close();
   }
 
-  util::stream::pipe(in, file);
+  try {
+    util::stream::pipe(in, file);
+  } catch (...) {
+    // a half-written copy has no owner to remove it
+    file.close();
+    remove_quietly(file_path);
+    throw;
+  }
   file.close();
 
   return TemporaryDiskFile(file_path);
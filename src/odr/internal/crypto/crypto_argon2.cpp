@@ -9,10 +9,22 @@
 #include <limits>
 #include <span>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <cryptopp/blake2.h>
 
+#if defined(__AVX2__)
+#define ODR_ARGON2_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ODR_ARGON2_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace odr::internal::crypto {
 
 namespace {
@@ -104,6 +116,275 @@ std::string store_block(const Block &block) {
   return out;
 }
 
+// NOLINTBEGIN(portability-simd-intrinsics): each kernel is guarded by the
+// instruction set it needs, and the scalar one is always there to check them
+
+/// One of the `compress` kernels below.
+using Compress = void (*)(const Block &previous, const Block &reference,
+                          Block &next, bool accumulate);
+
+#if defined(ODR_ARGON2_AVX2)
+
+namespace avx2 {
+
+// The compression function G from [RFC 9106] 3.5 on four words at a time,
+// after the reference implementation's `blamka-round-opt.h`. A block is 32
+// vectors; a row of the 8x8 matrix of 16 byte registers is two of them.
+
+using Vector = __m256i;
+
+Vector rotr32(const Vector x) {
+  return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+Vector rotr24(const Vector x) {
+  return _mm256_shuffle_epi8(
+      x, _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                          3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9,
+                          10));
+}
+
+Vector rotr16(const Vector x) {
+  return _mm256_shuffle_epi8(
+      x, _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                          2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8,
+                          9));
+}
+
+Vector rotr63(const Vector x) {
+  return _mm256_xor_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x));
+}
+
+Vector bla_mka(const Vector x, const Vector y) {
+  const Vector product = _mm256_mul_epu32(x, y);
+  return _mm256_add_epi64(_mm256_add_epi64(x, y),
+                          _mm256_add_epi64(product, product));
+}
+
+/// The BLAKE2b G function over the columns of two 16 word groups at once.
+void mix(Vector &a0, Vector &a1, Vector &b0, Vector &b1, Vector &c0,
+         Vector &c1, Vector &d0, Vector &d1) {
+  a0 = bla_mka(a0, b0);
+  a1 = bla_mka(a1, b1);
+  d0 = rotr32(_mm256_xor_si256(d0, a0));
+  d1 = rotr32(_mm256_xor_si256(d1, a1));
+  c0 = bla_mka(c0, d0);
+  c1 = bla_mka(c1, d1);
+  b0 = rotr24(_mm256_xor_si256(b0, c0));
+  b1 = rotr24(_mm256_xor_si256(b1, c1));
+
+  a0 = bla_mka(a0, b0);
+  a1 = bla_mka(a1, b1);
+  d0 = rotr16(_mm256_xor_si256(d0, a0));
+  d1 = rotr16(_mm256_xor_si256(d1, a1));
+  c0 = bla_mka(c0, d0);
+  c1 = bla_mka(c1, d1);
+  b0 = rotr63(_mm256_xor_si256(b0, c0));
+  b1 = rotr63(_mm256_xor_si256(b1, c1));
+}
+
+/// P over two rows, held in order by `a0, b0, c0, d0` and `a1, b1, c1, d1`:
+/// the diagonals are a word rotation within each vector.
+void permute_row(Vector &a0, Vector &a1, Vector &b0, Vector &b1, Vector &c0,
+                 Vector &c1, Vector &d0, Vector &d1) {
+  mix(a0, a1, b0, b1, c0, c1, d0, d1);
+
+  b0 = _mm256_permute4x64_epi64(b0, _MM_SHUFFLE(0, 3, 2, 1));
+  c0 = _mm256_permute4x64_epi64(c0, _MM_SHUFFLE(1, 0, 3, 2));
+  d0 = _mm256_permute4x64_epi64(d0, _MM_SHUFFLE(2, 1, 0, 3));
+  b1 = _mm256_permute4x64_epi64(b1, _MM_SHUFFLE(0, 3, 2, 1));
+  c1 = _mm256_permute4x64_epi64(c1, _MM_SHUFFLE(1, 0, 3, 2));
+  d1 = _mm256_permute4x64_epi64(d1, _MM_SHUFFLE(2, 1, 0, 3));
+
+  mix(a0, a1, b0, b1, c0, c1, d0, d1);
+
+  b0 = _mm256_permute4x64_epi64(b0, _MM_SHUFFLE(2, 1, 0, 3));
+  c0 = _mm256_permute4x64_epi64(c0, _MM_SHUFFLE(1, 0, 3, 2));
+  d0 = _mm256_permute4x64_epi64(d0, _MM_SHUFFLE(0, 3, 2, 1));
+  b1 = _mm256_permute4x64_epi64(b1, _MM_SHUFFLE(2, 1, 0, 3));
+  c1 = _mm256_permute4x64_epi64(c1, _MM_SHUFFLE(1, 0, 3, 2));
+  d1 = _mm256_permute4x64_epi64(d1, _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+/// P over two columns, whose word pairs are spread over both vectors of each
+/// operand: the diagonals swap halves between them.
+void permute_column(Vector &a0, Vector &a1, Vector &b0, Vector &b1,
+                    Vector &c0, Vector &c1, Vector &d0, Vector &d1) {
+  mix(a0, a1, b0, b1, c0, c1, d0, d1);
+
+  Vector t0 = _mm256_blend_epi32(b0, b1, 0xcc);
+  Vector t1 = _mm256_blend_epi32(b0, b1, 0x33);
+  b1 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));
+  b0 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));
+  std::swap(c0, c1);
+  t0 = _mm256_blend_epi32(d0, d1, 0xcc);
+  t1 = _mm256_blend_epi32(d0, d1, 0x33);
+  d0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));
+  d1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));
+
+  mix(a0, a1, b0, b1, c0, c1, d0, d1);
+
+  t0 = _mm256_blend_epi32(b0, b1, 0xcc);
+  t1 = _mm256_blend_epi32(b0, b1, 0x33);
+  b0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));
+  b1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));
+  std::swap(c0, c1);
+  t0 = _mm256_blend_epi32(d0, d1, 0x33);
+  t1 = _mm256_blend_epi32(d0, d1, 0xcc);
+  d0 = _mm256_permute4x64_epi64(t0, _MM_SHUFFLE(2, 3, 0, 1));
+  d1 = _mm256_permute4x64_epi64(t1, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/// The compression function G from [RFC 9106] 3.5. `accumulate` selects the
+/// later passes, which XOR into `next` instead of overwriting it.
+void compress(const Block &previous, const Block &reference, Block &next,
+              const bool accumulate) {
+  constexpr std::size_t vectors = block_size / sizeof(Vector);
+  const auto load = [](const Block &block, const std::size_t i) {
+    return _mm256_loadu_si256(
+        reinterpret_cast<const Vector *>(block.data()) + i);
+  };
+
+  // plain arrays: std::array drops the vector type's alignment attribute
+  Vector r[vectors];
+  Vector sum[vectors];
+  for (std::size_t i = 0; i < vectors; ++i) {
+    r[i] = _mm256_xor_si256(load(previous, i), load(reference, i));
+    sum[i] = accumulate ? _mm256_xor_si256(r[i], load(next, i)) : r[i];
+  }
+
+  for (std::size_t i = 0; i < 4; ++i) {
+    permute_row(r[8 * i + 0], r[8 * i + 4], r[8 * i + 1], r[8 * i + 5],
+                r[8 * i + 2], r[8 * i + 6], r[8 * i + 3], r[8 * i + 7]);
+  }
+  for (std::size_t i = 0; i < 4; ++i) {
+    permute_column(r[0 + i], r[4 + i], r[8 + i], r[12 + i], r[16 + i],
+                   r[20 + i], r[24 + i], r[28 + i]);
+  }
+
+  for (std::size_t i = 0; i < vectors; ++i) {
+    _mm256_storeu_si256(reinterpret_cast<Vector *>(next.data()) + i,
+                        _mm256_xor_si256(sum[i], r[i]));
+  }
+}
+
+} // namespace avx2
+
+#endif
+
+#if defined(ODR_ARGON2_SSE2)
+
+namespace sse2 {
+
+// The compression function G from [RFC 9106] 3.5 on two words at a time,
+// after the reference implementation's `blamka-round-opt.h`. A block is 64
+// vectors, an 8x8 matrix whose rows and columns are the 16 word groups P
+// permutes.
+
+using Vector = __m128i;
+
+template <int bits> Vector rotr(const Vector x) {
+  if constexpr (bits == 32) {
+    return _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+  } else if constexpr (bits == 63) {
+    return _mm_xor_si128(_mm_srli_epi64(x, 63), _mm_add_epi64(x, x));
+  } else {
+    return _mm_xor_si128(_mm_srli_epi64(x, bits), _mm_slli_epi64(x, 64 - bits));
+  }
+}
+
+Vector bla_mka(const Vector x, const Vector y) {
+  const Vector product = _mm_mul_epu32(x, y);
+  return _mm_add_epi64(_mm_add_epi64(x, y), _mm_add_epi64(product, product));
+}
+
+/// The BLAKE2b G function over four columns of four words, two per vector.
+void mix(Vector &a0, Vector &a1, Vector &b0, Vector &b1, Vector &c0,
+         Vector &c1, Vector &d0, Vector &d1) {
+  a0 = bla_mka(a0, b0);
+  a1 = bla_mka(a1, b1);
+  d0 = rotr<32>(_mm_xor_si128(d0, a0));
+  d1 = rotr<32>(_mm_xor_si128(d1, a1));
+  c0 = bla_mka(c0, d0);
+  c1 = bla_mka(c1, d1);
+  b0 = rotr<24>(_mm_xor_si128(b0, c0));
+  b1 = rotr<24>(_mm_xor_si128(b1, c1));
+
+  a0 = bla_mka(a0, b0);
+  a1 = bla_mka(a1, b1);
+  d0 = rotr<16>(_mm_xor_si128(d0, a0));
+  d1 = rotr<16>(_mm_xor_si128(d1, a1));
+  c0 = bla_mka(c0, d0);
+  c1 = bla_mka(c1, d1);
+  b0 = rotr<63>(_mm_xor_si128(b0, c0));
+  b1 = rotr<63>(_mm_xor_si128(b1, c1));
+}
+
+/// The permutation P from [RFC 9106] 3.6 over 16 words held in order by
+/// `a0, a1, b0, b1, c0, c1, d0, d1`: the diagonals are a word rotation across
+/// each pair of vectors.
+void permute(Vector &a0, Vector &a1, Vector &b0, Vector &b1, Vector &c0,
+             Vector &c1, Vector &d0, Vector &d1) {
+  mix(a0, a1, b0, b1, c0, c1, d0, d1);
+
+  Vector t0 = d0;
+  Vector t1 = b0;
+  std::swap(c0, c1);
+  d0 = _mm_unpackhi_epi64(d1, _mm_unpacklo_epi64(t0, t0));
+  d1 = _mm_unpackhi_epi64(t0, _mm_unpacklo_epi64(d1, d1));
+  b0 = _mm_unpackhi_epi64(b0, _mm_unpacklo_epi64(b1, b1));
+  b1 = _mm_unpackhi_epi64(b1, _mm_unpacklo_epi64(t1, t1));
+
+  mix(a0, a1, b0, b1, c0, c1, d0, d1);
+
+  t0 = b0;
+  t1 = d0;
+  std::swap(c0, c1);
+  b0 = _mm_unpackhi_epi64(b1, _mm_unpacklo_epi64(b0, b0));
+  b1 = _mm_unpackhi_epi64(t0, _mm_unpacklo_epi64(b1, b1));
+  d0 = _mm_unpackhi_epi64(d0, _mm_unpacklo_epi64(d1, d1));
+  d1 = _mm_unpackhi_epi64(d1, _mm_unpacklo_epi64(t1, t1));
+}
+
+/// The compression function G from [RFC 9106] 3.5. `accumulate` selects the
+/// later passes, which XOR into `next` instead of overwriting it.
+void compress(const Block &previous, const Block &reference, Block &next,
+              const bool accumulate) {
+  constexpr std::size_t vectors = block_size / sizeof(Vector);
+  const auto load = [](const Block &block, const std::size_t i) {
+    return _mm_loadu_si128(reinterpret_cast<const Vector *>(block.data()) +
+                           i);
+  };
+
+  // plain arrays: std::array drops the vector type's alignment attribute
+  Vector r[vectors];
+  Vector sum[vectors];
+  for (std::size_t i = 0; i < vectors; ++i) {
+    r[i] = _mm_xor_si128(load(previous, i), load(reference, i));
+    sum[i] = accumulate ? _mm_xor_si128(r[i], load(next, i)) : r[i];
+  }
+
+  for (std::size_t i = 0; i < 8; ++i) {
+    permute(r[8 * i + 0], r[8 * i + 1], r[8 * i + 2], r[8 * i + 3],
+            r[8 * i + 4], r[8 * i + 5], r[8 * i + 6], r[8 * i + 7]);
+  }
+  for (std::size_t i = 0; i < 8; ++i) {
+    permute(r[8 * 0 + i], r[8 * 1 + i], r[8 * 2 + i], r[8 * 3 + i],
+            r[8 * 4 + i], r[8 * 5 + i], r[8 * 6 + i], r[8 * 7 + i]);
+  }
+
+  for (std::size_t i = 0; i < vectors; ++i) {
+    _mm_storeu_si128(reinterpret_cast<Vector *>(next.data()) + i,
+                     _mm_xor_si128(sum[i], r[i]));
+  }
+}
+
+} // namespace sse2
+
+#endif
+
+namespace scalar {
+
 std::uint64_t bla_mka(const std::uint64_t x, const std::uint64_t y) {
   return x + y + 2 * (x & max_uint32) * (y & max_uint32);
 }
@@ -168,8 +449,29 @@ void compress(const Block &previous, const Block &reference, Block &next,
   }
 }
 
+} // namespace scalar
+
+// NOLINTEND(portability-simd-intrinsics)
+
+Compress compress_of(const argon2::Kernel kernel) {
+  switch (kernel) {
+  case argon2::Kernel::scalar:
+    return scalar::compress;
+#if defined(ODR_ARGON2_SSE2)
+  case argon2::Kernel::sse2:
+    return sse2::compress;
+#endif
+#if defined(ODR_ARGON2_AVX2)
+  case argon2::Kernel::avx2:
+    return avx2::compress;
+#endif
+  default:
+    throw std::invalid_argument("argon2id: kernel not compiled in");
+  }
+}
+
 /// Refills `addresses` with the next 128 data-independent selectors.
-void next_addresses(Block &addresses, Block &input) {
+void next_addresses(const Compress compress, Block &addresses, Block &input) {
   constexpr Block zero{};
   ++input[6];
   compress(zero, input, addresses, false);
@@ -208,13 +510,123 @@ reference_index(const std::uint32_t pass, const std::uint32_t slice,
   return static_cast<std::uint32_t>((start + relative) % lane_length);
 }
 
+/// The blocks of all lanes, and the shape they are laid out in.
+struct Memory {
+  std::uint32_t passes;
+  std::uint32_t lane_count;
+  std::uint32_t segment_length;
+  std::uint32_t lane_length;
+  std::uint32_t block_count;
+  std::vector<Block> blocks;
+  Compress compress;
+};
+
+/// Fills the segment of `lane` in `slice` of `pass`. It reads the other lanes
+/// only in segments of earlier slices, so the lanes of one slice can be filled
+/// concurrently.
+void fill_segment(Memory &memory, const std::uint32_t pass,
+                  const std::uint32_t slice, const std::uint32_t lane) {
+  const std::uint32_t segment_length = memory.segment_length;
+  const std::uint32_t lane_length = memory.lane_length;
+  std::vector<Block> &blocks = memory.blocks;
+
+  // Argon2id indexes the first half of the first pass without looking at the
+  // data, and everything after it like Argon2d.
+  const bool independent = pass == 0 && slice < slices / 2;
+  Block address_input{};
+  Block addresses;
+  if (independent) {
+    address_input[0] = pass;
+    address_input[1] = lane;
+    address_input[2] = slice;
+    address_input[3] = memory.block_count;
+    address_input[4] = memory.passes;
+    address_input[5] = argon2id_type;
+  }
+
+  std::uint32_t index = 0;
+  if (pass == 0 && slice == 0) {
+    index = 2; // the first two blocks of the lane are already filled
+    if (independent) {
+      next_addresses(memory.compress, addresses, address_input);
+    }
+  }
+
+  for (; index < segment_length; ++index) {
+    const std::uint32_t current =
+        lane * lane_length + slice * segment_length + index;
+    const std::uint32_t previous =
+        current % lane_length == 0 ? current + lane_length - 1 : current - 1;
+
+    std::uint64_t selector;
+    if (independent) {
+      if (index % block_words == 0) {
+        next_addresses(memory.compress, addresses, address_input);
+      }
+      selector = addresses[index % block_words];
+    } else {
+      selector = blocks[previous][0];
+    }
+
+    // The first slice of the first pass has no other lane to point at.
+    const std::uint32_t reference_lane =
+        pass == 0 && slice == 0
+            ? lane
+            : static_cast<std::uint32_t>((selector >> 32) % memory.lane_count);
+    const std::uint32_t reference =
+        reference_lane * lane_length +
+        reference_index(pass, slice, index, segment_length, lane_length,
+                        reference_lane == lane, selector);
+
+    memory.compress(blocks[previous], blocks[reference], blocks[current],
+                    pass != 0);
+  }
+}
+
+/// Fills every block, one slice after the other, spreading the lanes of each
+/// slice over `threads` threads. Joining them at the end of the slice is the
+/// synchronisation point [RFC 9106] 3.4 asks for.
+void fill_memory(Memory &memory, const std::uint32_t threads) {
+  const auto fill_lanes = [&memory, threads](const std::uint32_t pass,
+                                             const std::uint32_t slice,
+                                             const std::uint32_t first) {
+    for (std::uint32_t lane = first; lane < memory.lane_count;
+         lane += threads) {
+      fill_segment(memory, pass, slice, lane);
+    }
+  };
+
+  for (std::uint32_t pass = 0; pass < memory.passes; ++pass) {
+    for (std::uint32_t slice = 0; slice < slices; ++slice) {
+      std::vector<std::thread> workers;
+      workers.reserve(threads - 1);
+      const auto join = [&workers] {
+        for (std::thread &worker : workers) {
+          worker.join();
+        }
+      };
+      try {
+        for (std::uint32_t first = 1; first < threads; ++first) {
+          workers.emplace_back(fill_lanes, pass, slice, first);
+        }
+      } catch (...) {
+        join();
+        throw;
+      }
+      fill_lanes(pass, slice, 0);
+      join();
+    }
+  }
+}
+
 } // namespace
 
 std::string argon2::id(const std::size_t tag_size,
                        const std::string_view password,
                        const std::string_view salt,
                        const std::size_t iterations, const std::size_t memory,
-                       const std::size_t lanes) {
+                       const std::size_t lanes, const std::size_t threads,
+                       const Kernel kernel) {
   if (tag_size < 4 || tag_size > max_uint32) {
     throw std::invalid_argument("argon2id: tag size out of range");
   }
@@ -230,6 +642,7 @@ std::string argon2::id(const std::size_t tag_size,
   if (memory < 8 * lanes || memory > max_uint32) {
     throw std::invalid_argument("argon2id: memory out of range");
   }
+  const Compress compress = compress_of(kernel);
 
   const auto passes = static_cast<std::uint32_t>(iterations);
   const auto lane_count = static_cast<std::uint32_t>(lanes);
@@ -260,7 +673,10 @@ std::string argon2::id(const std::size_t tag_size,
   std::span index_bytes = std::span(prehash).subspan(prehash_size, 4);
   std::span lane_bytes = std::span(prehash).subspan(prehash_size + 4, 4);
 
-  std::vector<Block> blocks(block_count);
+  Memory instance{passes,      lane_count,  segment_length,
+                  lane_length, block_count, std::vector<Block>(block_count),
+                  compress};
+  std::vector<Block> &blocks = instance.blocks;
   for (std::uint32_t lane = 0; lane < lane_count; ++lane) {
     const std::size_t offset = static_cast<std::size_t>(lane) * lane_length;
     util::byte::to_little_endian(lane, lane_bytes);
@@ -273,65 +689,11 @@ std::string argon2::id(const std::size_t tag_size,
     }
   }
 
-  Block address_input;
-  Block addresses;
-  for (std::uint32_t pass = 0; pass < passes; ++pass) {
-    for (std::uint32_t slice = 0; slice < slices; ++slice) {
-      for (std::uint32_t lane = 0; lane < lane_count; ++lane) {
-        // Argon2id indexes the first half of the first pass without looking at
-        // the data, and everything after it like Argon2d.
-        const bool independent = pass == 0 && slice < slices / 2;
-        if (independent) {
-          address_input = {};
-          address_input[0] = pass;
-          address_input[1] = lane;
-          address_input[2] = slice;
-          address_input[3] = block_count;
-          address_input[4] = passes;
-          address_input[5] = argon2id_type;
-        }
-
-        std::uint32_t index = 0;
-        if (pass == 0 && slice == 0) {
-          index = 2; // the first two blocks of the lane are already filled
-          if (independent) {
-            next_addresses(addresses, address_input);
-          }
-        }
-
-        for (; index < segment_length; ++index) {
-          const std::uint32_t current =
-              lane * lane_length + slice * segment_length + index;
-          const std::uint32_t previous = current % lane_length == 0
-                                             ? current + lane_length - 1
-                                             : current - 1;
-
-          std::uint64_t selector;
-          if (independent) {
-            if (index % block_words == 0) {
-              next_addresses(addresses, address_input);
-            }
-            selector = addresses[index % block_words];
-          } else {
-            selector = blocks[previous][0];
-          }
-
-          // The first slice of the first pass has no other lane to point at.
-          const std::uint32_t reference_lane =
-              pass == 0 && slice == 0
-                  ? lane
-                  : static_cast<std::uint32_t>((selector >> 32) % lane_count);
-          const std::uint32_t reference =
-              reference_lane * lane_length +
-              reference_index(pass, slice, index, segment_length, lane_length,
-                              reference_lane == lane, selector);
-
-          compress(blocks[previous], blocks[reference], blocks[current],
-                   pass != 0);
-        }
-      }
-    }
+  std::size_t workers = threads;
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
   }
+  fill_memory(instance, static_cast<std::uint32_t>(std::min(workers, lanes)));
 
   Block result = blocks[lane_length - 1];
   for (std::uint32_t lane = 1; lane < lane_count; ++lane) {
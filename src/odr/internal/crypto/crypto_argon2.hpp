@@ -6,12 +6,31 @@
 
 namespace odr::internal::crypto::argon2 {
 
+/// The kernels of the compression function G. `scalar` is always compiled in;
+/// `sse2` and `avx2` only where the compiler targets that instruction set.
+enum class Kernel { scalar, sse2, avx2 };
+
+/// The fastest kernel compiled in.
+constexpr Kernel native_kernel() {
+#if defined(__AVX2__)
+  return Kernel::avx2;
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  return Kernel::sse2;
+#else
+  return Kernel::scalar;
+#endif
+}
+
 /// Argon2id [RFC 9106], version 0x13, without secret or associated data.
-/// `memory` is in KiB and is rounded down to a multiple of `4 * lanes`. Lanes
-/// are computed sequentially. Throws `std::invalid_argument` for parameters
-/// outside the ranges the spec allows.
+/// `memory` is in KiB and is rounded down to a multiple of `4 * lanes`. The
+/// lanes of each slice are filled on up to `threads` threads, 0 being one per
+/// hardware thread; neither it nor `kernel` changes the tag. Throws
+/// `std::invalid_argument` for parameters outside the ranges the spec allows
+/// and for a kernel that is not compiled in.
 std::string id(std::size_t tag_size, std::string_view password,
                std::string_view salt, std::size_t iterations,
-               std::size_t memory, std::size_t lanes);
+               std::size_t memory, std::size_t lanes, std::size_t threads = 0,
+               Kernel kernel = native_kernel());
 
 } // namespace odr::internal::crypto::argon2
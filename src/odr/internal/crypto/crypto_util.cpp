@@ -1,16 +1,23 @@
 #include <odr/internal/crypto/crypto_util.hpp>
 
+#include <odr/internal/common/ordered_task_queue.hpp>
 #include <odr/internal/crypto/crypto_argon2.hpp>
+#include <odr/internal/util/stream_util.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
+#include <istream>
 #include <stdexcept>
+#include <streambuf>
+#include <utility>
 
 // RC4 and MD5 are retained in Crypto++ only for legacy formats (here: the PDF
 // standard security handler, R 2-4); opt in to the Weak:: namespace.
 #define CRYPTOPP_ENABLE_NAMESPACE_WEAK 1
 
+#include <cryptopp/adler32.h>
 #include <cryptopp/aes.h>
 #include <cryptopp/arc4.h>
 #include <cryptopp/base64.h>
@@ -19,11 +26,13 @@
 #include <cryptopp/des.h>
 #include <cryptopp/filters.h>
 #include <cryptopp/gcm.h>
+#include <cryptopp/gzip.h>
 #include <cryptopp/hex.h>
 #include <cryptopp/md5.h>
 #include <cryptopp/modes.h>
 #include <cryptopp/pwdbased.h>
 #include <cryptopp/sha.h>
+#include <cryptopp/zdeflate.h>
 #include <cryptopp/zinflate.h>
 #include <cryptopp/zlib.h>
 
@@ -103,6 +112,19 @@ std::string util::sha256(const std::string_view in) {
   return {reinterpret_cast<char *>(out.data()), out.size()};
 }
 
+std::string util::sha256(std::istream &in) {
+  CryptoPP::SHA256 hash;
+  std::array<char, 64 * 1024> buffer;
+  while (in) {
+    in.read(buffer.data(), buffer.size());
+    hash.Update(reinterpret_cast<const byte *>(buffer.data()),
+                static_cast<std::size_t>(in.gcount()));
+  }
+  std::array<byte, CryptoPP::SHA256::DIGESTSIZE> out;
+  hash.Final(out.data());
+  return {reinterpret_cast<char *>(out.data()), out.size()};
+}
+
 std::string util::sha384(const std::string_view in) {
   std::array<byte, CryptoPP::SHA384::DIGESTSIZE> out;
   CryptoPP::SHA384().CalculateDigest(
@@ -292,6 +314,152 @@ std::size_t util::padding(const std::string_view input) {
   return inflator.GetPadding();
 }
 
+namespace {
+/// Pumps ciphertext through a decrypt -> inflate chain a buffer at a time,
+/// handing out what comes out the other end.
+class DecryptInflateBuffer final : public std::streambuf {
+public:
+  static constexpr std::size_t buffer_size = 64 * 1024;
+
+  DecryptInflateBuffer(std::unique_ptr<std::istream> input,
+                       std::unique_ptr<CryptoPP::StreamTransformation> cipher,
+                       const bool authenticated)
+      : m_input{std::move(input)}, m_cipher{std::move(cipher)},
+        m_buffer(buffer_size, '\0') {
+    auto *inflator = new MyInflator(new CryptoPP::StringSink(m_output));
+    if (authenticated) {
+      m_filter = std::make_unique<CryptoPP::AuthenticatedDecryptionFilter>(
+          dynamic_cast<CryptoPP::AuthenticatedSymmetricCipher &>(*m_cipher),
+          inflator);
+    } else {
+      m_filter = std::make_unique<CryptoPP::StreamTransformationFilter>(
+          *m_cipher, inflator, CryptoPP::BlockPaddingSchemeDef::NO_PADDING);
+    }
+  }
+
+protected:
+  int_type underflow() override {
+    // a block of ciphertext may not complete a block of deflate output
+    while (m_output.empty() && !m_ended) {
+      m_input->read(m_buffer.data(),
+                    static_cast<std::streamsize>(m_buffer.size()));
+      const auto read = static_cast<std::size_t>(m_input->gcount());
+      if (read > 0) {
+        m_filter->Put(reinterpret_cast<const byte *>(m_buffer.data()), read);
+      }
+      if (read < m_buffer.size()) {
+        m_filter->MessageEnd();
+        m_ended = true;
+      }
+    }
+    if (m_output.empty()) {
+      return traits_type::eof();
+    }
+
+    // the sink appends to `m_output`, so it has to stay the same object
+    m_current.swap(m_output);
+    m_output.clear();
+    setg(m_current.data(), m_current.data(),
+         m_current.data() + m_current.size());
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  std::unique_ptr<std::istream> m_input;
+  std::unique_ptr<CryptoPP::StreamTransformation> m_cipher;
+  std::unique_ptr<CryptoPP::BufferedTransformation> m_filter;
+  std::string m_buffer;
+  std::string m_output;
+  std::string m_current;
+  bool m_ended{false};
+};
+
+class DecryptInflateStream final : public std::istream {
+public:
+  explicit DecryptInflateStream(std::unique_ptr<DecryptInflateBuffer> sbuf)
+      : std::istream(sbuf.get()), m_sbuf{std::move(sbuf)} {
+    // rethrow what the chain throws instead of reporting a short read
+    exceptions(std::ios::badbit);
+  }
+
+private:
+  std::unique_ptr<DecryptInflateBuffer> m_sbuf;
+};
+
+template <typename Decryption>
+std::unique_ptr<CryptoPP::StreamTransformation>
+keyed(const std::string_view key, const std::string_view iv) {
+  auto result = std::make_unique<Decryption>();
+  result->SetKeyWithIV(reinterpret_cast<const byte *>(key.data()), key.size(),
+                       reinterpret_cast<const byte *>(iv.data()), iv.size());
+  return result;
+}
+} // namespace
+
+std::unique_ptr<std::istream>
+util::decrypt_inflate(std::unique_ptr<std::istream> input,
+                      const StreamCipher cipher, const std::string_view key,
+                      const std::string_view iv) {
+  std::unique_ptr<CryptoPP::StreamTransformation> decryption;
+  switch (cipher) {
+  case StreamCipher::aes_cbc:
+    decryption = keyed<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption>(key, iv);
+    break;
+  case StreamCipher::aes_gcm: {
+    // the input repeats the IV ahead of the ciphertext, see `decrypt_aes_gcm`
+    const std::string prefix = util::stream::read(*input, iv.size());
+    if (prefix != iv) {
+      throw std::runtime_error("IV mismatch");
+    }
+    decryption = keyed<CryptoPP::GCM<CryptoPP::AES>::Decryption>(key, iv);
+    break;
+  }
+  case StreamCipher::triple_des_cbc:
+    decryption =
+        keyed<CryptoPP::CBC_Mode<CryptoPP::DES_EDE3>::Decryption>(key, iv);
+    break;
+  case StreamCipher::blowfish_cfb:
+    decryption =
+        keyed<CryptoPP::CFB_Mode<CryptoPP::Blowfish>::Decryption>(key, iv);
+    break;
+  default:
+    throw std::invalid_argument("cipher");
+  }
+  return std::make_unique<DecryptInflateStream>(
+      std::make_unique<DecryptInflateBuffer>(
+          std::move(input), std::move(decryption),
+          cipher == StreamCipher::aes_gcm));
+}
+
+bool util::verify_aes_gcm(std::istream &input, const std::string_view key,
+                          const std::string_view iv) {
+  if (util::stream::read(input, iv.size()) != iv) {
+    return false;
+  }
+  CryptoPP::GCM<CryptoPP::AES>::Decryption decryption;
+  decryption.SetKeyWithIV(reinterpret_cast<const byte *>(key.data()),
+                          key.size(), reinterpret_cast<const byte *>(iv.data()),
+                          iv.size());
+  // the plaintext goes nowhere; only the verdict is kept
+  CryptoPP::AuthenticatedDecryptionFilter filter(
+      decryption, new CryptoPP::Redirector(CryptoPP::TheBitBucket()),
+      CryptoPP::AuthenticatedDecryptionFilter::MAC_AT_END);
+
+  std::string buffer(64 * 1024, '\0');
+  try {
+    while (input) {
+      input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      filter.Put(reinterpret_cast<const byte *>(buffer.data()),
+                 static_cast<std::size_t>(input.gcount()));
+    }
+    filter.MessageEnd();
+  } catch (const CryptoPP::Exception &) {
+    // too short to hold a tag
+    return false;
+  }
+  return filter.GetLastResult();
+}
+
 namespace {
 /// Drops the ADLER32 check (RFC 1950 2.2), which real producers truncate, and
 /// clears the queue so trailing bytes stay out of the output.
@@ -322,4 +490,77 @@ std::string util::zlib_deflate(const std::string_view input) {
   return out;
 }
 
+std::string util::zlib_deflate(const std::string_view input,
+                               const unsigned level,
+                               const std::size_t piece_size,
+                               const std::uint32_t threads) {
+  const std::size_t pieces =
+      std::max<std::size_t>(1, (input.size() + piece_size - 1) / piece_size);
+  OrderedTaskQueue<std::string> queue(
+      pieces, threads, [&](const std::size_t i) {
+        const std::string_view piece = input.substr(i * piece_size, piece_size);
+        std::string out;
+        CryptoPP::Deflator deflator(new CryptoPP::StringSink(out),
+                                    static_cast<int>(level));
+        deflator.Put(reinterpret_cast<const CryptoPP::byte *>(piece.data()),
+                     piece.size());
+        if (i + 1 < pieces) {
+          // A hard flush ends on an empty stored block, which leaves the stream
+          // open and byte aligned, so the next piece's blocks follow on.
+          deflator.Flush(true);
+        } else {
+          deflator.MessageEnd();
+        }
+        return out;
+      });
+
+  // RFC 1950 2.2: deflate with a 32 KiB window, the level class, and a check
+  // making the two bytes a multiple of 31.
+  const unsigned cmf = 0x78;
+  unsigned flg = (level <= 1 ? 0u : level <= 5 ? 1u : level == 6 ? 2u : 3u)
+                 << 6;
+  flg += (31 - (cmf << 8 | flg) % 31) % 31;
+  std::string out;
+  out.push_back(static_cast<char>(cmf));
+  out.push_back(static_cast<char>(flg));
+  for (std::size_t i = 0; i < pieces; ++i) {
+    out += queue.next();
+  }
+
+  CryptoPP::Adler32 adler;
+  adler.Update(reinterpret_cast<const CryptoPP::byte *>(input.data()),
+               input.size());
+  std::array<CryptoPP::byte, CryptoPP::Adler32::DIGESTSIZE> digest{};
+  adler.Final(digest.data());
+  out.append(reinterpret_cast<const char *>(digest.data()), digest.size());
+  return out;
+}
+
+util::Deflater::Deflater(const DeflateFormat format, const unsigned level) {
+  // the sink appends to m_output, which put() and finish() empty in place
+  auto *const sink = new CryptoPP::StringSink(m_output);
+  if (format == DeflateFormat::gzip) {
+    m_filter = std::make_unique<CryptoPP::Gzip>(sink, level);
+  } else {
+    m_filter = std::make_unique<CryptoPP::ZlibCompressor>(sink, level);
+  }
+}
+
+util::Deflater::~Deflater() = default;
+
+std::string util::Deflater::put(const std::string_view input) {
+  m_filter->Put(reinterpret_cast<const CryptoPP::byte *>(input.data()),
+                input.size());
+  std::string result;
+  result.swap(m_output);
+  return result;
+}
+
+std::string util::Deflater::finish() {
+  m_filter->MessageEnd();
+  std::string result;
+  result.swap(m_output);
+  return result;
+}
+
 } // namespace odr::internal::crypto
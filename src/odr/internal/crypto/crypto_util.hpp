@@ -6,6 +6,10 @@
 #include <string>
 #include <string_view>
 
+namespace CryptoPP {
+class BufferedTransformation;
+}
+
 namespace odr::internal::crypto::util {
 
 std::string base64_encode(std::string_view);
@@ -19,6 +23,8 @@ std::uint32_t crc32(std::string_view input);
 std::string md5(std::string_view);
 std::string sha1(std::string_view);
 std::string sha256(std::string_view);
+/// SHA-256 of what is left of @p in, read a block at a time.
+std::string sha256(std::istream &in);
 std::string sha384(std::string_view);
 std::string sha512(std::string_view);
 
@@ -51,8 +57,57 @@ std::string decrypt_blowfish(std::string_view key, std::string_view iv,
 std::string inflate(std::string_view input);
 std::size_t padding(std::string_view input);
 
+/// The ciphers `decrypt_inflate` reads.
+enum class StreamCipher { aes_cbc, aes_gcm, triple_des_cbc, blowfish_cfb };
+
+/// Decrypts @p input like `decrypt_aes_cbc` and its siblings and inflates the
+/// result like `inflate`, as the returned stream is read: neither the
+/// ciphertext nor the plaintext is ever held whole. A failure is thrown from
+/// the read that meets it. An AES-GCM tag can only be checked at the end of
+/// the input, so a tampered entry reads as far as that before it throws;
+/// `verify_aes_gcm` checks it ahead.
+std::unique_ptr<std::istream>
+decrypt_inflate(std::unique_ptr<std::istream> input, StreamCipher cipher,
+                std::string_view key, std::string_view iv);
+
+/// Whether the tag of @p input, AES-GCM ciphertext as `decrypt_inflate` reads
+/// it, verifies under @p key. The input is read through a buffer at a time and
+/// none of the plaintext is kept.
+bool verify_aes_gcm(std::istream &input, std::string_view key,
+                    std::string_view iv);
+
 /// Inflates a zlib stream, ignoring its ADLER32 trailer.
 std::string zlib_inflate(std::string_view input);
 std::string zlib_deflate(std::string_view input);
+/// `zlib_deflate` at @p level, from 1, fastest, to 9, smallest, in pieces of
+/// @p piece_size deflated apart from each other and joined into one stream, as
+/// pigz does. The pieces deflate on @p threads threads, 0 taking one per
+/// hardware thread. A piece does not see the window of the one before, which
+/// costs a little size; the output is the same for any @p threads.
+std::string zlib_deflate(std::string_view input, unsigned level,
+                         std::size_t piece_size, std::uint32_t threads);
+
+/// The containers a `Deflater` wraps its output in: RFC 1950, which http
+/// calls `deflate`, and RFC 1952.
+enum class DeflateFormat { zlib, gzip };
+
+/// Deflates its input piece by piece as it is put, where `zlib_deflate` takes
+/// it whole. @p level runs from 1, fastest, to 9, smallest.
+class Deflater final {
+public:
+  explicit Deflater(DeflateFormat format, unsigned level = 6);
+  ~Deflater();
+  Deflater(const Deflater &) = delete;
+  Deflater &operator=(const Deflater &) = delete;
+
+  /// Deflates @p input and returns the output that is ready, which may be none.
+  [[nodiscard]] std::string put(std::string_view input);
+  /// Ends the stream and returns the rest of the output.
+  [[nodiscard]] std::string finish();
+
+private:
+  std::string m_output;
+  std::unique_ptr<CryptoPP::BufferedTransformation> m_filter;
+};
 
 } // namespace odr::internal::crypto::util
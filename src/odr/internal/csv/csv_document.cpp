@@ -13,7 +13,9 @@
 
 #include <algorithm>
 #include <istream>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <utility>
 
 namespace odr::internal::csv {
@@ -248,13 +250,33 @@ private:
 
 } // namespace
 
-CsvDocument::CsvDocument(const abstract::File &file,
+CsvDocument::CsvDocument(std::shared_ptr<abstract::File> file,
                          const TextEncoding encoding, const Dialect dialect,
                          const bool skip_first_line)
     : internal::Document(FileType::comma_separated_values,
-                         DocumentType::spreadsheet, nullptr) {
-  const std::unique_ptr<std::istream> in = file.stream();
-  std::string text = encoding::to_utf8(util::stream::read(*in), encoding);
+                         DocumentType::spreadsheet, nullptr),
+      m_file{std::move(file)} {
+  // utf-8 in memory, or mapped, is read where it is; anything else is read,
+  // and decoded unless it turns out to be utf-8 already
+  if (const std::optional<std::string_view> data = m_file->memory_data();
+      data.has_value()) {
+    m_file_text = encoding::as_utf8(*data, encoding);
+    if (!m_file_text.has_value()) {
+      m_decoded = encoding::to_utf8(*data, encoding);
+    }
+  } else {
+    const std::unique_ptr<std::istream> in = m_file->stream();
+    std::string bytes = util::stream::read(*in);
+    if (const std::optional<std::string_view> utf8 =
+            encoding::as_utf8(bytes, encoding);
+        utf8.has_value()) {
+      bytes.erase(0, bytes.size() - utf8->size()); // the byte order mark
+      m_decoded = std::move(bytes);
+    } else {
+      m_decoded = encoding::to_utf8(bytes, encoding);
+    }
+  }
+  const std::string_view text = this->text();
 
   std::string_view remainder = text;
   if (skip_first_line) {
@@ -268,14 +290,34 @@ CsvDocument::CsvDocument(const abstract::File &file,
   }
 
   RecordReader reader(remainder, dialect);
-  std::vector<std::string> fields;
+  std::vector<RecordReader::Field> fields;
   std::uint32_t columns = 0;
   while (reader.read(fields)) {
     columns = std::max(columns, static_cast<std::uint32_t>(fields.size()));
-    m_rows.push_back(fields);
+    m_row_begins.push_back(m_cell_offsets.size());
+    for (const RecordReader::Field &field : fields) {
+      std::uint64_t offset = 0;
+      std::size_t size = 0;
+      if (field.escaped) {
+        const std::string value = reader.unescape(field.text);
+        offset = m_unescaped.size() | unescaped_bit;
+        size = value.size();
+        m_unescaped += value;
+      } else {
+        offset = static_cast<std::uint64_t>(field.text.data() - text.data());
+        size = field.text.size();
+      }
+      if (size > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("csv field longer than 4 GiB");
+      }
+      m_cell_offsets.push_back(offset);
+      m_cell_sizes.push_back(static_cast<std::uint32_t>(size));
+    }
   }
+  m_row_begins.push_back(m_cell_offsets.size());
 
-  m_dimensions = {static_cast<std::uint32_t>(m_rows.size()), columns};
+  const auto rows = static_cast<std::uint32_t>(m_row_begins.size() - 1);
+  m_dimensions = {rows, columns};
 
   // Walks the fields that exist rather than the rectangle they span: one wide
   // record widens every row, and scanning `rows * columns` synthesized cells
@@ -285,10 +327,11 @@ CsvDocument::CsvDocument(const abstract::File &file,
   // every column prose.
   std::vector<bool> has_value(columns, false);
   m_numeric_columns.assign(columns, true);
-  for (std::size_t row = 1; row < m_rows.size(); ++row) {
-    const std::vector<std::string> &fields = m_rows[row];
-    for (std::size_t column = 0; column < fields.size(); ++column) {
-      const std::string &value = fields[column];
+  for (std::uint32_t row = 1; row < rows; ++row) {
+    const auto row_size =
+        static_cast<std::uint32_t>(m_row_begins[row + 1] - m_row_begins[row]);
+    for (std::uint32_t column = 0; column < row_size; ++column) {
+      const std::string_view value = cell(column, row);
       if (value.empty()) {
         continue;
       }
@@ -324,15 +367,22 @@ void CsvDocument::save([[maybe_unused]] const Path &path,
 
 std::string_view CsvDocument::cell(const std::uint32_t column,
                                    const std::uint32_t row) const {
-  if (row >= m_rows.size()) {
+  if (row >= m_dimensions.rows) {
     return {};
   }
   // the sheet is rectangular even where the file is not
-  const std::vector<std::string> &fields = m_rows[row];
-  if (column >= fields.size()) {
+  const std::uint64_t index = m_row_begins[row] + column;
+  if (index >= m_row_begins[row + 1]) {
     return {};
   }
-  return fields[column];
+  const std::uint64_t offset = m_cell_offsets[index];
+  const std::string_view source =
+      (offset & unescaped_bit) != 0 ? std::string_view(m_unescaped) : text();
+  return source.substr(offset & ~unescaped_bit, m_cell_sizes[index]);
+}
+
+std::string_view CsvDocument::text() const noexcept {
+  return m_file_text.has_value() ? *m_file_text : m_decoded;
 }
 
 TableDimensions CsvDocument::dimensions() const noexcept {
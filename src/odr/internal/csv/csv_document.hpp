@@ -8,6 +8,8 @@
 #include <odr/internal/csv/csv_util.hpp>
 
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -23,9 +25,13 @@ namespace odr::internal::csv {
 /// Cells are not registry elements; an id encodes the coordinate. The whole
 /// file is held decoded and reached only through @ref cell and @ref dimensions,
 /// so what is behind those can change. See `AGENTS.md`.
+///
+/// The text is one buffer — the file's own memory when it is valid UTF-8 and
+/// held or mapped in memory, a decoded copy otherwise — and a cell is a range
+/// of it. Only a field that unescaping rewrites has its value copied out.
 class CsvDocument final : public internal::Document {
 public:
-  CsvDocument(const abstract::File &file, TextEncoding encoding,
+  CsvDocument(std::shared_ptr<abstract::File> file, TextEncoding encoding,
               Dialect dialect, bool skip_first_line);
 
   [[nodiscard]] bool is_editable() const noexcept override;
@@ -45,7 +51,26 @@ public:
                                      std::uint32_t row) const;
 
 private:
-  std::vector<std::vector<std::string>> m_rows;
+  /// Marks a cell offset into @ref m_unescaped rather than the text.
+  static constexpr std::uint64_t unescaped_bit = std::uint64_t{1} << 63;
+
+  [[nodiscard]] std::string_view text() const noexcept;
+
+  /// Kept alive for @ref m_file_text.
+  std::shared_ptr<abstract::File> m_file;
+  /// The file's bytes, if they can be read in place.
+  std::optional<std::string_view> m_file_text;
+  /// The decoded file, unless @ref m_file_text is set.
+  std::string m_decoded;
+  /// The values of the fields unescaping rewrote, back to back.
+  std::string m_unescaped;
+
+  /// Per row, the index of its first cell, and the end of the last row's.
+  std::vector<std::uint64_t> m_row_begins;
+  /// Per cell, where its value starts and how long it is.
+  std::vector<std::uint64_t> m_cell_offsets;
+  std::vector<std::uint32_t> m_cell_sizes;
+
   TableDimensions m_dimensions;
   /// Per column, whether every value below the first row is a number.
   std::vector<bool> m_numeric_columns;
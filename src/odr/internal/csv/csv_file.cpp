@@ -85,7 +85,7 @@ std::shared_ptr<abstract::Document> CsvFile::document() const {
   if (!is_decodable()) {
     throw UnsupportedTextEncoding(encoding());
   }
-  return std::make_shared<CsvDocument>(*m_file->file(), encoding(), m_dialect,
+  return std::make_shared<CsvDocument>(m_file->file(), encoding(), m_dialect,
                                        m_separator_directive);
 }
 
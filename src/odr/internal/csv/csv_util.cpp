@@ -192,13 +192,47 @@ csv::RecordReader::RecordReader(const std::string_view text,
 
 bool csv::RecordReader::read(std::vector<std::string> &fields) {
   fields.clear();
-  std::string field;
+  std::vector<Field> views;
+  if (!read(views)) {
+    return false;
+  }
+  for (const Field &field : views) {
+    fields.push_back(field.escaped ? unescape(field.text)
+                                   : std::string(field.text));
+  }
+  return true;
+}
+
+bool csv::RecordReader::read(std::vector<Field> &fields) {
+  fields.clear();
   bool quoted = false;
   bool started = false;
 
+  /// How much of the raw field its value is so far.
+  enum class Shape {
+    empty,  ///< nothing yet
+    bare,   ///< unquoted text, `[value, value_end)`
+    quoted, ///< inside quotes, `[value, value_end)`
+    closed, ///< quotes closed around `[value, value_end)`
+    escaped ///< only @ref unescape gets the value
+  };
+  Shape shape = Shape::empty;
+  std::size_t raw = m_position;
+  std::size_t value = m_position;
+  std::size_t value_end = m_position;
+  // a CR is dropped, so one inside an unquoted value splits it
+  bool carriage_return = false;
+
   const auto end_field = [&] {
-    fields.push_back(std::move(field));
-    field.clear();
+    if (shape == Shape::escaped) {
+      fields.push_back({m_text.substr(raw, m_position - raw), true});
+    } else {
+      fields.push_back({m_text.substr(value, value_end - value), false});
+    }
+    shape = Shape::empty;
+    raw = m_position + 1;
+    value = value_end = raw;
+    carriage_return = false;
   };
 
   for (; m_position < m_text.size(); ++m_position) {
@@ -206,37 +240,57 @@ bool csv::RecordReader::read(std::vector<std::string> &fields) {
 
     if (quoted) {
       if (c != m_dialect.quote) {
-        field.push_back(c);
+        value_end = m_position + 1;
         continue;
       }
       // a doubled quote is an escaped one and stays inside the field
       if (m_position + 1 < m_text.size() &&
           m_text[m_position + 1] == m_dialect.quote) {
         ++m_position;
-        field.push_back(m_dialect.quote);
+        shape = Shape::escaped;
         continue;
       }
       quoted = false;
+      if (shape == Shape::quoted) {
+        shape = Shape::closed;
+      }
       continue;
     }
 
     if (c == m_dialect.quote) {
       quoted = true;
       started = true;
+      if (shape == Shape::empty) {
+        shape = Shape::quoted;
+        value = value_end = m_position + 1;
+      } else {
+        shape = Shape::escaped;
+      }
     } else if (c == m_dialect.separator) {
       end_field();
       started = true;
     } else if (c == '\r') {
       // CRLF, and a lone CR
+      carriage_return = shape != Shape::empty;
+      if (!started) {
+        raw = value = value_end = m_position + 1;
+      }
     } else if (c == '\n') {
       if (!started) {
+        raw = value = value_end = m_position + 1;
         continue; // empty line
       }
       end_field();
       ++m_position;
       return true;
     } else {
-      field.push_back(c);
+      if (shape == Shape::empty) {
+        shape = Shape::bare;
+        value = m_position;
+      } else if (shape != Shape::bare || carriage_return) {
+        shape = Shape::escaped;
+      }
+      value_end = m_position + 1;
       started = true;
     }
   }
@@ -253,6 +307,26 @@ bool csv::RecordReader::read(std::vector<std::string> &fields) {
   return true;
 }
 
+std::string csv::RecordReader::unescape(const std::string_view raw) const {
+  std::string result;
+  result.reserve(raw.size());
+  bool quoted = false;
+  for (std::size_t i = 0; i < raw.size(); ++i) {
+    const char c = raw[i];
+    if (c == m_dialect.quote) {
+      if (quoted && i + 1 < raw.size() && raw[i + 1] == m_dialect.quote) {
+        result.push_back(c);
+        ++i;
+      } else {
+        quoted = !quoted;
+      }
+    } else if (quoted || c != '\r') {
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
 bool csv::RecordReader::unterminated() const noexcept { return m_unterminated; }
 
 csv::Probe csv::probe(const std::string_view text, const bool complete,
@@ -26,11 +26,25 @@ struct Dialect final {
 /// and sets @ref unterminated. Refusing a file is detection's job.
 class RecordReader final {
 public:
+  /// A field as it stands in the text. Most are their value verbatim, quoted
+  /// ones without their quotes; only one that needs rewriting — an escaped
+  /// quote, quotes around part of it, a stray CR — is handed out raw.
+  struct Field final {
+    /// The value, or the raw field to @ref unescape if @ref escaped.
+    std::string_view text;
+    bool escaped{false};
+  };
+
   RecordReader(std::string_view text, Dialect dialect) noexcept;
 
   /// Reads the next record into @p fields; `false` once the text is exhausted.
   /// An empty line yields no record, so a trailing newline is not a row.
   bool read(std::vector<std::string> &fields);
+  /// As above, without copying: every field views the text.
+  bool read(std::vector<Field> &fields);
+
+  /// The value of a raw field @ref read handed out as `escaped`.
+  [[nodiscard]] std::string unescape(std::string_view raw) const;
 
   /// Whether the text ran out inside a quoted field.
   [[nodiscard]] bool unterminated() const noexcept;
@@ -3,6 +3,8 @@
 #include <odr/internal/encoding/encoding_data.hpp>
 #include <odr/internal/encoding/text_encoding_table.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <stdexcept>
@@ -192,30 +194,19 @@ std::string decode_utf32(const std::string_view bytes, const bool little) {
   return result;
 }
 
-} // namespace
-
-std::string encoding::to_utf8(const std::string_view bytes,
-                              const TextEncoding encoding) {
-  const auto *row = text_encoding_table::find(encoding);
-  if (row == nullptr || !row->decodable) {
-    throw std::runtime_error("text encoding cannot be decoded");
-  }
-
-  const std::string_view bom = own_bom(encoding);
-  const std::string_view body =
-      starts_with(bytes, bom) ? bytes.substr(bom.size()) : bytes;
-
+/// @p bytes, less any byte order mark, decoded.
+std::string decode(const std::string_view bytes, const TextEncoding encoding) {
   switch (encoding) {
   case TextEncoding::utf8:
-    return utf8::replace_invalid(body);
+    return utf8::replace_invalid(bytes);
   case TextEncoding::utf16le:
-    return decode_utf16(body, true);
+    return decode_utf16(bytes, true);
   case TextEncoding::utf16be:
-    return decode_utf16(body, false);
+    return decode_utf16(bytes, false);
   case TextEncoding::utf32le:
-    return decode_utf32(body, true);
+    return decode_utf32(bytes, true);
   case TextEncoding::utf32be:
-    return decode_utf32(body, false);
+    return decode_utf32(bytes, false);
   default:
     break;
   }
@@ -224,7 +215,118 @@ std::string encoding::to_utf8(const std::string_view bytes,
   if (table == nullptr) {
     throw std::runtime_error("text encoding cannot be decoded");
   }
-  return decode_single_byte(body, *table);
+  return decode_single_byte(bytes, *table);
+}
+
+void check_decodable(const TextEncoding encoding) {
+  const auto *row = encoding::text_encoding_table::find(encoding);
+  if (row == nullptr || !row->decodable) {
+    throw std::runtime_error("text encoding cannot be decoded");
+  }
+}
+
+/// How many bytes at the end of @p bytes begin a character they do not
+/// finish, and so have to wait for the next piece.
+std::size_t unfinished_tail(const std::string_view bytes,
+                            const TextEncoding encoding) {
+  switch (encoding) {
+  case TextEncoding::utf8:
+    // the last lead byte, if the sequence it announces runs past the end
+    for (std::size_t back = 1; back <= std::min<std::size_t>(3, bytes.size());
+         ++back) {
+      const std::uint8_t byte = byte_at(bytes, bytes.size() - back);
+      if ((byte & 0xc0) == 0x80) {
+        continue;
+      }
+      const std::size_t length = byte >= 0xf0   ? 4
+                                 : byte >= 0xe0 ? 3
+                                 : byte >= 0xc0 ? 2
+                                                : 1;
+      return length > back ? back : 0;
+    }
+    return 0;
+  case TextEncoding::utf16le:
+  case TextEncoding::utf16be: {
+    std::size_t tail = bytes.size() % 2;
+    // a high surrogate waits for its low one
+    if (bytes.size() - tail >= 2) {
+      const std::size_t at = bytes.size() - tail - 2;
+      const std::uint8_t high = encoding == TextEncoding::utf16le
+                                    ? byte_at(bytes, at + 1)
+                                    : byte_at(bytes, at);
+      if (high >= 0xd8 && high <= 0xdb) {
+        tail += 2;
+      }
+    }
+    return tail;
+  }
+  case TextEncoding::utf32le:
+  case TextEncoding::utf32be:
+    return bytes.size() % 4;
+  default:
+    return 0;
+  }
+}
+
+} // namespace
+
+std::string encoding::to_utf8(const std::string_view bytes,
+                              const TextEncoding encoding) {
+  check_decodable(encoding);
+
+  const std::string_view bom = own_bom(encoding);
+  return decode(starts_with(bytes, bom) ? bytes.substr(bom.size()) : bytes,
+                encoding);
+}
+
+encoding::Utf8Decoder::Utf8Decoder(const TextEncoding encoding,
+                                   const bool at_start)
+    : m_encoding{encoding}, m_bom{at_start ? own_bom(encoding) : ""} {
+  check_decodable(encoding);
+}
+
+std::string encoding::Utf8Decoder::put(const std::string_view bytes) {
+  m_held.append(bytes);
+
+  if (!m_bom.empty()) {
+    // too little to tell a mark from text yet
+    if (m_held.size() < m_bom.size() && m_bom.starts_with(m_held)) {
+      return {};
+    }
+    if (starts_with(m_held, m_bom)) {
+      m_held.erase(0, m_bom.size());
+    }
+    m_bom = {};
+  }
+
+  const std::size_t complete =
+      m_held.size() - unfinished_tail(m_held, m_encoding);
+  std::string result =
+      decode(std::string_view(m_held).substr(0, complete), m_encoding);
+  m_held.erase(0, complete);
+  return result;
+}
+
+std::string encoding::Utf8Decoder::finish() {
+  // whatever is held, a cut character or the start of a mark that never came,
+  // is decoded as it is
+  m_bom = {};
+  std::string result = decode(m_held, m_encoding);
+  m_held.clear();
+  return result;
+}
+
+std::optional<std::string_view>
+encoding::as_utf8(const std::string_view bytes, const TextEncoding encoding) {
+  if (encoding != TextEncoding::utf8) {
+    return std::nullopt;
+  }
+  const std::string_view body =
+      starts_with(bytes, utf8_bom) ? bytes.substr(utf8_bom.size()) : bytes;
+  if (!utf8::is_valid(body)) {
+    return std::nullopt;
+  }
+  return body;
 }
 
 } // namespace odr::internal
@@ -2,6 +2,7 @@
 
 #include <odr/file.hpp>
 
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -15,4 +16,33 @@ namespace odr::internal::encoding {
 [[nodiscard]] std::string to_utf8(std::string_view bytes,
                                   TextEncoding encoding);
 
+/// Decodes a file to UTF-8 piece by piece, with constant memory: a character
+/// a piece ends in the middle of is held for the next one, so the pieces
+/// decode to what @ref to_utf8 makes of all of them.
+class Utf8Decoder final {
+public:
+  /// @p at_start says whether the bytes begin the file, where @p encoding's
+  /// byte order mark is stripped; a decoder started mid-file strips none.
+  ///
+  /// @throws std::runtime_error if @p encoding is not decodable.
+  explicit Utf8Decoder(TextEncoding encoding, bool at_start = true);
+
+  /// The next piece decoded, up to the last character it completes.
+  [[nodiscard]] std::string put(std::string_view bytes);
+  /// What is still held, decoded as the end of the input.
+  [[nodiscard]] std::string finish();
+
+private:
+  TextEncoding m_encoding;
+  /// the mark still to look for, empty once past it
+  std::string_view m_bom;
+  std::string m_held;
+};
+
+/// @p bytes as UTF-8 without a copy, where they are that already: valid UTF-8
+/// declared as such, less its byte order mark. nullopt where @ref to_utf8 has
+/// to decode.
+[[nodiscard]] std::optional<std::string_view> as_utf8(std::string_view bytes,
+                                                      TextEncoding encoding);
+
 } // namespace odr::internal::encoding
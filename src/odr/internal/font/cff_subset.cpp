@@ -0,0 +1,754 @@
+#include <odr/internal/font/cff_subset.hpp>
+
+#include <odr/internal/util/byte_string.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace odr::internal::font::cff {
+
+namespace {
+
+namespace bs = util::byte_string;
+
+/// Two-byte operators (`escape b`) are folded into the one-byte keyspace as
+/// `escape_op_base + b`, as in `cff_font.cpp`.
+constexpr std::uint16_t escape_op_base = 1200;
+
+/// The DICT operators whose operands are offsets (or, for `Private`, a size
+/// and an offset) and so move with the layout.
+enum Operator : std::uint16_t {
+  op_charset = 15,
+  op_encoding = 16,
+  op_char_strings = 17,
+  op_private = 18,
+  op_subrs = 19,
+  op_charstring_type = 1206,
+  op_fd_array = 1236,
+  op_fd_select = 1237,
+};
+
+/// The Type2 charstring operators that decide what a charstring calls and
+/// how many hint mask bytes follow (Adobe TN #5177).
+enum CharstringOp : std::uint8_t {
+  cs_hstem = 1,
+  cs_vstem = 3,
+  cs_callsubr = 10,
+  cs_return = 11,
+  cs_escape = 12,
+  cs_endchar = 14,
+  cs_hstemhm = 18,
+  cs_hintmask = 19,
+  cs_cntrmask = 20,
+  cs_vstemhm = 23,
+  cs_shortint = 28,
+  cs_callgsubr = 29,
+};
+
+/// Type2's limit on subroutine nesting (Adobe TN #5177 Appendix B).
+constexpr int max_subr_depth = 10;
+
+/// What an unused glyph and an unused subroutine are emptied to.
+constexpr std::string_view empty_glyph = "\x0e";      // endchar
+constexpr std::string_view empty_subroutine = "\x0b"; // return
+
+/// @p d from absolute offset @p p on; empty past its end, which
+/// `byte_string` reports as a (throwing) short read.
+std::string_view at(const std::string_view d, const std::size_t p) {
+  return p <= d.size() ? d.substr(p) : std::string_view{};
+}
+
+/// An INDEX's members as views into the font, and the offset just past it.
+struct Index {
+  std::vector<std::string_view> members;
+  std::size_t end{0};
+};
+
+Index read_index(const std::string_view d, const std::size_t offset) {
+  Index index;
+  const std::uint16_t count = bs::read_u16_be(at(d, offset));
+  if (count == 0) {
+    index.end = offset + 2;
+    return index;
+  }
+  const std::uint8_t off_size = bs::read_u8(at(d, offset + 2));
+  if (off_size < 1 || off_size > 4) {
+    throw std::runtime_error("cff: bad INDEX offSize");
+  }
+  const std::size_t offsets = offset + 3;
+  const std::size_t data_base = offsets + (count + 1) * off_size - 1;
+
+  index.members.reserve(count);
+  std::uint32_t prev = bs::read_uint_be(at(d, offsets), off_size);
+  for (std::size_t i = 1; i <= count; ++i) {
+    const std::uint32_t next =
+        bs::read_uint_be(at(d, offsets + i * off_size), off_size);
+    if (next < prev || data_base + next > d.size()) {
+      throw std::runtime_error("cff: bad INDEX offsets");
+    }
+    index.members.push_back(d.substr(data_base + prev, next - prev));
+    prev = next;
+  }
+  index.end = data_base + prev;
+  return index;
+}
+
+std::string write_index(const std::vector<std::string_view> &members) {
+  std::string out;
+  bs::put_u16_be(out, static_cast<std::uint16_t>(members.size()));
+  if (members.empty()) {
+    return out;
+  }
+
+  std::size_t last_offset = 1;
+  for (const std::string_view member : members) {
+    last_offset += member.size();
+  }
+  std::uint8_t off_size = 4;
+  if (last_offset <= 0xff) {
+    off_size = 1;
+  } else if (last_offset <= 0xffff) {
+    off_size = 2;
+  } else if (last_offset <= 0xffffff) {
+    off_size = 3;
+  }
+  bs::put_u8(out, off_size);
+
+  const auto put_offset = [&](const std::size_t offset) {
+    for (int shift = 8 * (off_size - 1); shift >= 0; shift -= 8) {
+      out += static_cast<char>((offset >> shift) & 0xff);
+    }
+  };
+  std::size_t offset = 1;
+  put_offset(offset);
+  for (const std::string_view member : members) {
+    offset += member.size();
+    put_offset(offset);
+  }
+  for (const std::string_view member : members) {
+    out += member;
+  }
+  return out;
+}
+
+/// One DICT operator with its operands.
+struct DictEntry {
+  std::uint16_t op{0};
+  /// A real operand reads as 0; no offset is a real.
+  std::vector<std::int32_t> operands;
+  /// The operands and the operator as encoded, for copying through.
+  std::string_view raw;
+};
+
+using Dict = std::vector<DictEntry>;
+
+/// Parse the DICT that is exactly @p d.
+Dict read_dict(const std::string_view d) {
+  Dict dict;
+  std::vector<std::int32_t> operands;
+  std::size_t begin = 0;
+  std::size_t p = 0;
+  while (p < d.size()) {
+    const std::uint8_t b0 = bs::read_u8(at(d, p));
+    if (b0 <= 21) {
+      std::uint16_t op = b0;
+      ++p;
+      if (b0 == cs_escape) {
+        op = escape_op_base + bs::read_u8(at(d, p));
+        ++p;
+      }
+      dict.push_back({op, std::move(operands), d.substr(begin, p - begin)});
+      operands.clear();
+      begin = p;
+    } else if (b0 == 28) {
+      operands.push_back(
+          static_cast<std::int16_t>(bs::read_u16_be(at(d, p + 1))));
+      p += 3;
+    } else if (b0 == 29) {
+      operands.push_back(
+          static_cast<std::int32_t>(bs::read_u32_be(at(d, p + 1))));
+      p += 5;
+    } else if (b0 == 30) {
+      // packed BCD, up to and including the byte with the 0xf end nibble
+      ++p;
+      while (true) {
+        const std::uint8_t byte = bs::read_u8(at(d, p++));
+        if ((byte >> 4) == 0x0f || (byte & 0x0f) == 0x0f) {
+          break;
+        }
+      }
+      operands.push_back(0);
+    } else if (b0 >= 32 && b0 <= 246) {
+      operands.push_back(static_cast<std::int32_t>(b0) - 139);
+      ++p;
+    } else if (b0 >= 247 && b0 <= 250) {
+      operands.push_back((static_cast<std::int32_t>(b0) - 247) * 256 +
+                         bs::read_u8(at(d, p + 1)) + 108);
+      p += 2;
+    } else if (b0 >= 251 && b0 <= 254) {
+      operands.push_back(-(static_cast<std::int32_t>(b0) - 251) * 256 -
+                         bs::read_u8(at(d, p + 1)) - 108);
+      p += 2;
+    } else {
+      throw std::runtime_error("cff: invalid DICT byte");
+    }
+  }
+  return dict;
+}
+
+const DictEntry *find(const Dict &dict, const std::uint16_t op) {
+  for (const DictEntry &entry : dict) {
+    if (entry.op == op) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+/// Operand @p i of @p entry as an offset into @p d.
+std::size_t offset_operand(const std::string_view d, const DictEntry &entry,
+                           const std::size_t i = 0) {
+  if (i >= entry.operands.size() || entry.operands[i] < 0 ||
+      static_cast<std::size_t>(entry.operands[i]) > d.size()) {
+    throw std::runtime_error("cff: bad DICT offset");
+  }
+  return static_cast<std::size_t>(entry.operands[i]);
+}
+
+/// @p dict re-encoded, the operands of the operators in @p replaced swapped
+/// for the values mapped to, in the fixed 5-byte form: a DICT's size never
+/// depends on the offsets it holds, so the layout resolves in one pass.
+std::string
+write_dict(const Dict &dict,
+           const std::map<std::uint16_t, std::vector<std::int32_t>> &replaced) {
+  std::string out;
+  for (const DictEntry &entry : dict) {
+    const auto it = replaced.find(entry.op);
+    if (it == replaced.end()) {
+      out += entry.raw;
+      continue;
+    }
+    for (const std::int32_t value : it->second) {
+      out += static_cast<char>(29);
+      bs::put_u32_be(out, static_cast<std::uint32_t>(value));
+    }
+    if (entry.op >= escape_op_base) {
+      out += static_cast<char>(cs_escape);
+      out += static_cast<char>(entry.op - escape_op_base);
+    } else {
+      out += static_cast<char>(entry.op);
+    }
+  }
+  return out;
+}
+
+/// A subroutine INDEX and which of its members a kept glyph reaches.
+struct Subrs {
+  Subrs() : Subrs(std::vector<std::string_view>{}) {}
+  explicit Subrs(std::vector<std::string_view> subrs)
+      : members{std::move(subrs)}, used(members.size()) {
+    // Type2 biases the subroutine number by the INDEX's size
+    if (members.size() < 1240) {
+      bias = 107;
+    } else if (members.size() < 33900) {
+      bias = 1131;
+    } else {
+      bias = 32768;
+    }
+  }
+
+  std::vector<std::string_view> members;
+  std::vector<bool> used;
+  std::int32_t bias{0};
+
+  void use_all() { used.assign(members.size(), true); }
+
+  /// The members, unused ones emptied.
+  [[nodiscard]] std::vector<std::string_view> subset() const {
+    std::vector<std::string_view> result;
+    result.reserve(members.size());
+    for (std::size_t i = 0; i < members.size(); ++i) {
+      result.push_back(used[i] ? members[i] : empty_subroutine);
+    }
+    return result;
+  }
+};
+
+/// A Private DICT and the local subroutines it points to.
+struct Private {
+  Dict dict;
+  Subrs subrs;
+};
+
+Private read_private(const std::string_view d, const DictEntry &entry) {
+  const std::size_t size = offset_operand(d, entry, 0);
+  const std::size_t offset = offset_operand(d, entry, 1);
+  if (offset + size > d.size()) {
+    throw std::runtime_error("cff: bad Private DICT range");
+  }
+  Private result;
+  result.dict = read_dict(d.substr(offset, size));
+  if (const DictEntry *subrs = find(result.dict, op_subrs)) {
+    result.subrs =
+        Subrs(read_index(d, offset + offset_operand(d, *subrs)).members);
+  }
+  return result;
+}
+
+/// A Private DICT laid out with its local subroutines straight after it.
+struct PrivateBlock {
+  std::string bytes;
+  std::size_t dict_size{0};
+};
+
+PrivateBlock write_private(const Private &p) {
+  PrivateBlock block;
+  std::map<std::uint16_t, std::vector<std::int32_t>> replaced;
+  if (find(p.dict, op_subrs) == nullptr) {
+    block.bytes = write_dict(p.dict, replaced);
+    block.dict_size = block.bytes.size();
+    return block;
+  }
+  replaced[op_subrs] = {0};
+  block.dict_size = write_dict(p.dict, replaced).size();
+  // the Subrs offset is relative to the Private DICT
+  replaced[op_subrs] = {static_cast<std::int32_t>(block.dict_size)};
+  block.bytes = write_dict(p.dict, replaced) + write_index(p.subrs.subset());
+  return block;
+}
+
+std::size_t charset_length(const std::string_view d, const std::size_t offset,
+                           const std::size_t glyph_count) {
+  const std::uint8_t format = bs::read_u8(at(d, offset));
+  if (format == 0) {
+    return 1 + 2 * (glyph_count > 0 ? glyph_count - 1 : 0);
+  }
+  if (format != 1 && format != 2) {
+    throw std::runtime_error("cff: unknown charset format");
+  }
+  const std::size_t n_left_size = format == 1 ? 1 : 2;
+  std::size_t p = offset + 1;
+  for (std::size_t covered = 1; covered < glyph_count;) {
+    covered += 1 + bs::read_uint_be(at(d, p + 2), n_left_size);
+    p += 2 + n_left_size;
+  }
+  return p - offset;
+}
+
+std::size_t encoding_length(const std::string_view d,
+                            const std::size_t offset) {
+  const std::uint8_t format = bs::read_u8(at(d, offset));
+  const std::uint8_t count = bs::read_u8(at(d, offset + 1));
+  std::size_t length = 0;
+  switch (format & 0x7f) {
+  case 0:
+    length = 2 + count;
+    break;
+  case 1:
+    length = 2 + 2 * static_cast<std::size_t>(count);
+    break;
+  default:
+    throw std::runtime_error("cff: unknown Encoding format");
+  }
+  if ((format & 0x80) != 0) {
+    // supplements: a count, then (code, SID) pairs
+    length += 1 + 3 * static_cast<std::size_t>(
+                          bs::read_u8(at(d, offset + length)));
+  }
+  return length;
+}
+
+/// The FD of every glyph, from the FDSelect at @p offset; @p length receives
+/// its size.
+std::vector<std::uint8_t> read_fd_select(const std::string_view d,
+                                         const std::size_t offset,
+                                         const std::size_t glyph_count,
+                                         std::size_t &length) {
+  std::vector<std::uint8_t> result(glyph_count, 0);
+  const std::uint8_t format = bs::read_u8(at(d, offset));
+  if (format == 0) {
+    for (std::size_t glyph = 0; glyph < glyph_count; ++glyph) {
+      result[glyph] = bs::read_u8(at(d, offset + 1 + glyph));
+    }
+    length = 1 + glyph_count;
+    return result;
+  }
+  if (format != 3) {
+    throw std::runtime_error("cff: unknown FDSelect format");
+  }
+  const std::uint16_t ranges = bs::read_u16_be(at(d, offset + 1));
+  for (std::size_t i = 0; i < ranges; ++i) {
+    const std::size_t entry = offset + 3 + 3 * i;
+    const std::uint16_t first = bs::read_u16_be(at(d, entry));
+    const std::uint8_t fd = bs::read_u8(at(d, entry + 2));
+    const std::uint16_t next = bs::read_u16_be(at(d, entry + 3));
+    for (std::size_t glyph = first; glyph < next && glyph < glyph_count;
+         ++glyph) {
+      result[glyph] = fd;
+    }
+  }
+  length = 3 + 3 * static_cast<std::size_t>(ranges) + 2;
+  return result;
+}
+
+/// Follows Type2 charstrings through their subroutine calls, marking every
+/// subroutine reached.
+class Closure final {
+public:
+  explicit Closure(Subrs &global) : m_global{&global} {}
+
+  /// Whether some glyph composes itself with `seac`, whose glyphs are named
+  /// by standard encoding code, not id.
+  [[nodiscard]] bool seac() const { return m_seac; }
+
+  /// Walks glyph @p charstring with @p local as its local subroutines; false
+  /// when a call's target is not a literal number.
+  bool walk_glyph(const std::string_view charstring, Subrs &local) {
+    State state;
+    return walk(charstring, state, local, 0);
+  }
+
+private:
+  struct State {
+    std::vector<std::int32_t> stack;
+    std::uint32_t stems{0};
+    bool ended{false};
+  };
+
+  bool walk(const std::string_view cs, State &state, Subrs &local,
+            const int depth) {
+    std::size_t p = 0;
+    while (p < cs.size() && !state.ended) {
+      const std::uint8_t b0 = bs::read_u8(at(cs, p));
+      if (b0 == cs_shortint) {
+        state.stack.push_back(
+            static_cast<std::int16_t>(bs::read_u16_be(at(cs, p + 1))));
+        p += 3;
+        continue;
+      }
+      if (b0 >= 32) {
+        if (b0 <= 246) {
+          state.stack.push_back(static_cast<std::int32_t>(b0) - 139);
+          p += 1;
+        } else if (b0 <= 250) {
+          state.stack.push_back((static_cast<std::int32_t>(b0) - 247) * 256 +
+                                bs::read_u8(at(cs, p + 1)) + 108);
+          p += 2;
+        } else if (b0 <= 254) {
+          state.stack.push_back(-(static_cast<std::int32_t>(b0) - 251) * 256 -
+                                bs::read_u8(at(cs, p + 1)) - 108);
+          p += 2;
+        } else {
+          // 16.16 fixed; only its integer part could name a subroutine
+          state.stack.push_back(
+              static_cast<std::int32_t>(bs::read_u32_be(at(cs, p + 1))) >>
+              16);
+          p += 5;
+        }
+        continue;
+      }
+
+      ++p;
+      switch (b0) {
+      case cs_escape:
+        // flex and the arithmetic operators; a call after arithmetic finds an
+        // empty stack and gives up
+        ++p;
+        state.stack.clear();
+        break;
+      case cs_hstem:
+      case cs_vstem:
+      case cs_hstemhm:
+      case cs_vstemhm:
+        state.stems += static_cast<std::uint32_t>(state.stack.size() / 2);
+        state.stack.clear();
+        break;
+      case cs_hintmask:
+      case cs_cntrmask:
+        // operands left before a mask are an implied vstem
+        state.stems += static_cast<std::uint32_t>(state.stack.size() / 2);
+        state.stack.clear();
+        p += (state.stems + 7) / 8;
+        break;
+      case cs_callsubr:
+      case cs_callgsubr: {
+        Subrs &subrs = b0 == cs_callsubr ? local : *m_global;
+        if (state.stack.empty() || depth >= max_subr_depth) {
+          return false;
+        }
+        const std::int64_t index =
+            static_cast<std::int64_t>(state.stack.back()) + subrs.bias;
+        state.stack.pop_back();
+        if (index < 0 ||
+            static_cast<std::size_t>(index) >= subrs.members.size()) {
+          return false;
+        }
+        subrs.used[static_cast<std::size_t>(index)] = true;
+        if (!walk(subrs.members[static_cast<std::size_t>(index)], state, local,
+                  depth + 1)) {
+          return false;
+        }
+        break;
+      }
+      case cs_return:
+        return true;
+      case cs_endchar:
+        // four operands (five with a width) are the deprecated `seac`
+        if (state.stack.size() >= 4) {
+          m_seac = true;
+        }
+        state.ended = true;
+        return true;
+      default:
+        state.stack.clear();
+        break;
+      }
+    }
+    return true;
+  }
+
+  Subrs *m_global;
+  bool m_seac{false};
+};
+
+} // namespace
+
+std::string subset(const std::string_view d,
+                   const std::set<std::uint16_t> &glyphs) {
+  if (d.size() < 4) {
+    throw std::runtime_error("cff: not a CFF font");
+  }
+  const std::uint8_t header_size = bs::read_u8(d.substr(2));
+  const Index names = read_index(d, header_size);
+  const Index top_dicts = read_index(d, names.end);
+  if (top_dicts.members.empty()) {
+    throw std::runtime_error("cff: empty Top DICT INDEX");
+  }
+  const Index strings = read_index(d, top_dicts.end);
+  Subrs global(read_index(d, strings.end).members);
+  const Dict top = read_dict(top_dicts.members.front());
+
+  if (const DictEntry *type = find(top, op_charstring_type);
+      type != nullptr && !type->operands.empty() && type->operands[0] != 2) {
+    throw std::runtime_error("cff: only Type2 charstrings subset");
+  }
+  const DictEntry *char_strings_entry = find(top, op_char_strings);
+  if (char_strings_entry == nullptr) {
+    throw std::runtime_error("cff: no CharStrings");
+  }
+  const std::vector<std::string_view> char_strings =
+      read_index(d, offset_operand(d, *char_strings_entry)).members;
+  const std::size_t glyph_count = char_strings.size();
+
+  // charset, Encoding and FDSelect are copied through; 0..2 respectively 0..1
+  // name a predefined charset or encoding rather than an offset
+  std::string_view charset;
+  if (const DictEntry *entry = find(top, op_charset);
+      entry != nullptr && offset_operand(d, *entry) > 2) {
+    const std::size_t offset = offset_operand(d, *entry);
+    charset = at(d, offset).substr(0, charset_length(d, offset, glyph_count));
+  }
+  std::string_view encoding;
+  if (const DictEntry *entry = find(top, op_encoding);
+      entry != nullptr && offset_operand(d, *entry) > 1) {
+    const std::size_t offset = offset_operand(d, *entry);
+    encoding = at(d, offset).substr(0, encoding_length(d, offset));
+  }
+  std::string_view fd_select;
+  std::vector<std::uint8_t> fd_of_glyph;
+  if (const DictEntry *entry = find(top, op_fd_select)) {
+    const std::size_t offset = offset_operand(d, *entry);
+    std::size_t length = 0;
+    fd_of_glyph = read_fd_select(d, offset, glyph_count, length);
+    fd_select = at(d, offset).substr(0, length);
+  }
+
+  std::optional<Private> top_private;
+  if (const DictEntry *entry = find(top, op_private)) {
+    top_private = read_private(d, *entry);
+  }
+  std::vector<Dict> font_dicts;
+  std::vector<Private> fd_privates;
+  if (const DictEntry *entry = find(top, op_fd_array)) {
+    for (const std::string_view member :
+         read_index(d, offset_operand(d, *entry)).members) {
+      Dict &font_dict = font_dicts.emplace_back(read_dict(member));
+      const DictEntry *private_entry = find(font_dict, op_private);
+      fd_privates.push_back(private_entry != nullptr
+                                ? read_private(d, *private_entry)
+                                : Private{});
+    }
+  }
+
+  // what every kept glyph reaches
+  std::vector<bool> kept(glyph_count, false);
+  if (glyph_count > 0) {
+    kept[0] = true;
+  }
+  for (const std::uint16_t glyph : glyphs) {
+    if (glyph < glyph_count) {
+      kept[glyph] = true;
+    }
+  }
+  Subrs no_local;
+  const auto local_subrs = [&](const std::size_t glyph) -> Subrs & {
+    if (!fd_privates.empty()) {
+      const std::size_t fd =
+          glyph < fd_of_glyph.size() ? fd_of_glyph[glyph] : 0;
+      return fd < fd_privates.size() ? fd_privates[fd].subrs : no_local;
+    }
+    return top_private.has_value() ? top_private->subrs : no_local;
+  };
+  Closure closure(global);
+  bool traced = true;
+  for (std::size_t glyph = 0; glyph < glyph_count && traced; ++glyph) {
+    if (kept[glyph]) {
+      traced = closure.walk_glyph(char_strings[glyph], local_subrs(glyph));
+    }
+  }
+  if (closure.seac()) {
+    return std::string(d);
+  }
+  if (!traced) {
+    global.use_all();
+    if (top_private.has_value()) {
+      top_private->subrs.use_all();
+    }
+    for (Private &p : fd_privates) {
+      p.subrs.use_all();
+    }
+  }
+
+  std::vector<std::string_view> subset_char_strings;
+  subset_char_strings.reserve(glyph_count);
+  for (std::size_t glyph = 0; glyph < glyph_count; ++glyph) {
+    subset_char_strings.push_back(kept[glyph] ? char_strings[glyph]
+                                              : empty_glyph);
+  }
+
+  // Lay out afresh: header, Name, Top DICT, String and Global Subr INDEXes,
+  // charset, Encoding, FDSelect, CharStrings, FDArray, then each Private DICT
+  // followed by its Subrs.
+  const std::string_view header = d.substr(0, header_size);
+  const std::string_view name_index =
+      d.substr(header_size, names.end - header_size);
+  const std::string_view string_index =
+      d.substr(top_dicts.end, strings.end - top_dicts.end);
+  const std::string global_subr_index = write_index(global.subset());
+  const std::string char_strings_index = write_index(subset_char_strings);
+  const std::optional<PrivateBlock> top_private_block =
+      top_private.has_value() ? std::optional(write_private(*top_private))
+                              : std::nullopt;
+  std::vector<PrivateBlock> fd_private_blocks;
+  fd_private_blocks.reserve(fd_privates.size());
+  for (const Private &p : fd_privates) {
+    fd_private_blocks.push_back(write_private(p));
+  }
+
+  struct Layout {
+    std::int32_t charset{0};
+    std::int32_t encoding{0};
+    std::int32_t fd_select{0};
+    std::int32_t char_strings{0};
+    std::int32_t fd_array{0};
+    std::int32_t top_private{0};
+    std::vector<std::int32_t> fd_privates;
+  };
+  const auto write_font_dicts = [&](const Layout &layout) {
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i < font_dicts.size(); ++i) {
+      std::map<std::uint16_t, std::vector<std::int32_t>> replaced;
+      if (find(font_dicts[i], op_private) != nullptr) {
+        replaced[op_private] = {
+            static_cast<std::int32_t>(fd_private_blocks[i].dict_size),
+            layout.fd_privates[i]};
+      }
+      result.push_back(write_dict(font_dicts[i], replaced));
+    }
+    return result;
+  };
+  const auto write_fd_array = [&](const Layout &layout) {
+    const std::vector<std::string> dicts = write_font_dicts(layout);
+    return write_index(
+        std::vector<std::string_view>(dicts.begin(), dicts.end()));
+  };
+  const auto write_top = [&](const Layout &layout) {
+    std::map<std::uint16_t, std::vector<std::int32_t>> replaced;
+    replaced[op_char_strings] = {layout.char_strings};
+    if (!charset.empty()) {
+      replaced[op_charset] = {layout.charset};
+    }
+    if (!encoding.empty()) {
+      replaced[op_encoding] = {layout.encoding};
+    }
+    if (!fd_select.empty()) {
+      replaced[op_fd_select] = {layout.fd_select};
+    }
+    if (!font_dicts.empty()) {
+      replaced[op_fd_array] = {layout.fd_array};
+    }
+    if (top_private_block.has_value()) {
+      replaced[op_private] = {
+          static_cast<std::int32_t>(top_private_block->dict_size),
+          layout.top_private};
+    }
+    return write_index({write_dict(top, replaced)});
+  };
+
+  // every offset is fixed-width, so sizing with zeros sizes the real thing
+  Layout layout;
+  layout.fd_privates.assign(fd_privates.size(), 0);
+  std::size_t position = header.size() + name_index.size() +
+                         write_top(layout).size() + string_index.size() +
+                         global_subr_index.size();
+  const auto place = [&position](std::int32_t &offset, const std::size_t size) {
+    offset = static_cast<std::int32_t>(position);
+    position += size;
+  };
+  place(layout.charset, charset.size());
+  place(layout.encoding, encoding.size());
+  place(layout.fd_select, fd_select.size());
+  place(layout.char_strings, char_strings_index.size());
+  place(layout.fd_array,
+        font_dicts.empty() ? 0 : write_fd_array(layout).size());
+  place(layout.top_private,
+        top_private_block.has_value() ? top_private_block->bytes.size() : 0);
+  for (std::size_t i = 0; i < fd_private_blocks.size(); ++i) {
+    place(layout.fd_privates[i], fd_private_blocks[i].bytes.size());
+  }
+  if (position > 0x7fffffff) {
+    throw std::runtime_error("cff: subset too large");
+  }
+
+  std::string out;
+  out.reserve(position);
+  out += header;
+  out += name_index;
+  out += write_top(layout);
+  out += string_index;
+  out += global_subr_index;
+  out += charset;
+  out += encoding;
+  out += fd_select;
+  out += char_strings_index;
+  if (!font_dicts.empty()) {
+    out += write_fd_array(layout);
+  }
+  if (top_private_block.has_value()) {
+    out += top_private_block->bytes;
+  }
+  for (const PrivateBlock &block : fd_private_blocks) {
+    out += block.bytes;
+  }
+  return out;
+}
+
+} // namespace odr::internal::font::cff
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace odr::internal::font::cff {
+
+/// Subset a bare CFF font program (format 1, Type2 charstrings) to @p glyphs.
+///
+/// Glyph ids are kept, so the `pua_code_point`s text was written with still
+/// address the same glyphs: a glyph outside @p glyphs keeps its CharStrings
+/// slot but is emptied to a bare `endchar`, and a global or local subroutine
+/// no kept glyph calls is emptied to a bare `return`. `.notdef` is always
+/// kept. Every structure the font had (charset, Encoding, FDArray, FDSelect,
+/// Private DICTs) is carried over and the whole program is laid out afresh,
+/// so what is left behind takes no space.
+///
+/// Subroutine numbers are followed statically; a charstring that computes
+/// one, or composes an accented glyph with `seac`, keeps every subroutine
+/// respectively every glyph instead. Throws `std::runtime_error` on a
+/// structurally invalid CFF or one with Type1 charstrings.
+[[nodiscard]] std::string subset(std::string_view cff,
+                                 const std::set<std::uint16_t> &glyphs);
+
+} // namespace odr::internal::font::cff
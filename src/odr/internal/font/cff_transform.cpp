@@ -1,6 +1,7 @@
 #include <odr/internal/font/cff_transform.hpp>
 
 #include <odr/internal/font/cff_font.hpp>
+#include <odr/internal/font/cff_subset.hpp>
 #include <odr/internal/font/sfnt_transform.hpp>
 #include <odr/internal/util/byte_string.hpp>
 
@@ -8,6 +9,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <map>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -127,14 +129,9 @@ void sanitize_name_index(std::string &cff) {
   }
 }
 
-} // namespace
-
-} // namespace odr::internal::font::cff
-
-namespace odr::internal::font {
-
-std::string cff::wrap_to_otf(const CffFont &font,
-                             const std::map<char32_t, std::uint16_t> &extra) {
+/// `wrap_to_otf` around @p cff_table, the font's CFF as it is to be embedded.
+std::string wrap(const CffFont &font, std::string cff_table,
+                 const std::map<char32_t, std::uint16_t> &extra) {
   const std::uint16_t glyphs = font.glyph_count();
 
   // Glyphs past the 6400-slot BMP PUA overflow into Supplementary PUA-A, which
@@ -152,7 +149,6 @@ std::string cff::wrap_to_otf(const CffFont &font,
   const char32_t first = pua.empty() ? 0 : pua.begin()->first;
   const char32_t last = pua.empty() ? 0 : pua.rbegin()->first;
 
-  std::string cff_table{font.data()};
   sanitize_name_index(cff_table);
 
   std::vector<std::pair<std::string, std::string>> tables;
@@ -176,4 +172,21 @@ std::string cff::wrap_to_otf(const CffFont &font,
   return build_sfnt(0x4f54544f /* 'OTTO' */, std::move(tables));
 }
 
+} // namespace
+
+} // namespace odr::internal::font::cff
+
+namespace odr::internal::font {
+
+std::string cff::wrap_to_otf(const CffFont &font,
+                             const std::map<char32_t, std::uint16_t> &extra) {
+  return wrap(font, std::string(font.data()), extra);
+}
+
+std::string cff::wrap_to_otf(const CffFont &font,
+                             const std::map<char32_t, std::uint16_t> &extra,
+                             const std::set<std::uint16_t> &glyphs) {
+  return wrap(font, subset(font.data(), glyphs), extra);
+}
+
 } // namespace odr::internal::font
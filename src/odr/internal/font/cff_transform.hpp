@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <map>
+#include <set>
 #include <string>
 
 namespace odr::internal::font::cff {
@@ -23,4 +24,10 @@ class CffFont;
 wrap_to_otf(const CffFont &font,
             const std::map<char32_t, std::uint16_t> &extra = {});
 
+/// `wrap_to_otf` with the `CFF ` table subset to @p glyphs (`cff::subset`);
+/// glyph ids, and so the `cmap`, are kept.
+[[nodiscard]] std::string
+wrap_to_otf(const CffFont &font, const std::map<char32_t, std::uint16_t> &extra,
+            const std::set<std::uint16_t> &glyphs);
+
 } // namespace odr::internal::font::cff
@@ -1,5 +1,6 @@
 #include <odr/internal/font/sfnt_font.hpp>
 
+#include <odr/internal/font/cff_subset.hpp>
 #include <odr/internal/font/sfnt_transform.hpp>
 #include <odr/internal/util/byte_string.hpp>
 #include <odr/internal/util/string_util.hpp>
@@ -7,6 +8,7 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -503,7 +505,14 @@ void SfntFont::set_cmap(std::map<char32_t, std::uint16_t> cmap) {
   update_reverse();
 }
 
-std::string SfntFont::write() const {
+std::string SfntFont::write() const { return write_tables(nullptr); }
+
+std::string SfntFont::write(const std::set<std::uint16_t> &glyphs) const {
+  return write_tables(&glyphs);
+}
+
+std::string
+SfntFont::write_tables(const std::set<std::uint16_t> *const glyphs) const {
   std::vector<std::pair<std::string, std::string>> tables;
   tables.reserve(m_tables.size() + 1);
   for (const auto &[tag, location] : m_tables) {
@@ -513,6 +522,30 @@ std::string SfntFont::write() const {
     }
     tables.emplace_back(tag, m_data.substr(location.offset, location.length));
   }
+
+  if (glyphs != nullptr) {
+    const auto find = [&](const std::string_view tag) {
+      return std::ranges::find(tables, tag, [](const auto &e) {
+        return std::string_view(e.first);
+      });
+    };
+    const auto head = find("head");
+    const auto glyf = find("glyf");
+    const auto loca = find("loca");
+    if (head != tables.end() && glyf != tables.end() && loca != tables.end() &&
+        head->second.size() >= 54) {
+      // `head.indexToLocFormat`, at offset 50
+      const bool long_offsets = bs::read_u16_be(head->second.substr(50)) != 0;
+      GlyfSubset subset = subset_glyf(glyf->second, loca->second,
+                                      long_offsets, m_glyph_count, *glyphs);
+      glyf->second = std::move(subset.glyf);
+      loca->second = std::move(subset.loca);
+      bs::write_u16_be(head->second, 50, subset.long_offsets ? 1 : 0);
+    }
+    if (const auto cff = find("CFF "); cff != tables.end()) {
+      cff->second = cff::subset(cff->second, *glyphs);
+    }
+  }
   tables.emplace_back("cmap", serialize_cmap(m_cmap));
 
   // OTS rejects a font missing `post` / `name` / `OS/2`, and PDF-embedded
@@ -6,6 +6,7 @@
 #include <functional>
 #include <map>
 #include <optional>
+#include <set>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -55,7 +56,16 @@ public:
   /// source stream, with a freshly computed table directory and checksums.
   [[nodiscard]] std::string write() const;
 
+  /// Like `write()`, but with the outlines of only @p glyphs (see
+  /// `subset_glyf` and `cff::subset`); glyph ids are kept. Other outline
+  /// formats are written whole.
+  [[nodiscard]] std::string write(const std::set<std::uint16_t> &glyphs) const;
+
 private:
+  /// `write()`, subset to @p glyphs unless null.
+  [[nodiscard]] std::string
+  write_tables(const std::set<std::uint16_t> *glyphs) const;
+
   /// Parse the facts from `m_data` (called by both constructors).
   void parse();
 
@@ -9,6 +9,9 @@
 #include <limits>
 #include <map>
 #include <ranges>
+#include <set>
+#include <stdexcept>
+#include <string_view>
 #include <utility>
 
 namespace odr::internal::font {
@@ -70,6 +73,42 @@ SearchHints search_hints(const std::uint16_t count, const std::uint16_t unit) {
   return {search_range, entry_selector, range_shift};
 }
 
+/// Composite glyph component flags (OpenType `glyf`).
+enum ComponentFlag : std::uint16_t {
+  arg_1_and_2_are_words = 0x0001,
+  we_have_a_scale = 0x0008,
+  more_components = 0x0020,
+  we_have_an_x_and_y_scale = 0x0040,
+  we_have_a_two_by_two = 0x0080,
+};
+
+/// The glyphs composite glyph @p outline is built from; none for a simple
+/// glyph.
+std::vector<std::uint16_t> components(const std::string_view outline) {
+  std::vector<std::uint16_t> result;
+  // numberOfContours is negative for a composite, then a 10-byte header
+  if (outline.size() < 10 ||
+      static_cast<std::int16_t>(bs::read_u16_be(outline)) >= 0) {
+    return result;
+  }
+  std::size_t p = 10;
+  while (true) {
+    const std::uint16_t flags = bs::read_u16_be(outline.substr(p));
+    result.push_back(bs::read_u16_be(outline.substr(p + 2)));
+    p += 4 + ((flags & arg_1_and_2_are_words) != 0 ? 4 : 2);
+    if ((flags & we_have_a_scale) != 0) {
+      p += 2;
+    } else if ((flags & we_have_an_x_and_y_scale) != 0) {
+      p += 4;
+    } else if ((flags & we_have_a_two_by_two) != 0) {
+      p += 8;
+    }
+    if ((flags & more_components) == 0 || p >= outline.size()) {
+      return result;
+    }
+  }
+}
+
 } // namespace
 
 } // namespace odr::internal::font
@@ -402,6 +441,78 @@ font::pua_cmap(const std::uint16_t glyph_count,
   return map;
 }
 
+font::GlyfSubset font::subset_glyf(const std::string_view glyf,
+                                   const std::string_view loca,
+                                   const bool long_offsets,
+                                   const std::uint16_t glyph_count,
+                                   const std::set<std::uint16_t> &glyphs) {
+  const std::size_t entry_size = long_offsets ? 4 : 2;
+  if (loca.size() < (static_cast<std::size_t>(glyph_count) + 1) * entry_size) {
+    throw std::runtime_error("sfnt: loca too short");
+  }
+  const auto outline = [&](const std::uint16_t glyph) {
+    const std::string_view entry = loca.substr(glyph * entry_size);
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    if (long_offsets) {
+      begin = bs::read_u32_be(entry);
+      end = bs::read_u32_be(entry.substr(4));
+    } else {
+      // short offsets are stored halved
+      begin = 2 * static_cast<std::size_t>(bs::read_u16_be(entry));
+      end = 2 * static_cast<std::size_t>(bs::read_u16_be(entry.substr(2)));
+    }
+    if (begin > end || end > glyf.size()) {
+      throw std::runtime_error("sfnt: bad loca offsets");
+    }
+    return glyf.substr(begin, end - begin);
+  };
+
+  // .notdef is always kept; composites pull in their components
+  std::vector<bool> kept(glyph_count, false);
+  std::vector<std::uint16_t> pending;
+  const auto keep = [&](const std::uint16_t glyph) {
+    if (glyph < glyph_count && !kept[glyph]) {
+      kept[glyph] = true;
+      pending.push_back(glyph);
+    }
+  };
+  keep(0);
+  for (const std::uint16_t glyph : glyphs) {
+    keep(glyph);
+  }
+  while (!pending.empty()) {
+    const std::uint16_t glyph = pending.back();
+    pending.pop_back();
+    for (const std::uint16_t component : components(outline(glyph))) {
+      keep(component);
+    }
+  }
+
+  GlyfSubset result;
+  std::vector<std::size_t> offsets;
+  offsets.reserve(static_cast<std::size_t>(glyph_count) + 1);
+  for (std::uint16_t glyph = 0; glyph < glyph_count; ++glyph) {
+    offsets.push_back(result.glyf.size());
+    if (kept[glyph]) {
+      result.glyf += outline(glyph);
+      pad4(result.glyf);
+    }
+  }
+  offsets.push_back(result.glyf.size());
+
+  // halved, short offsets reach 128 KiB
+  result.long_offsets = result.glyf.size() > 0x1fffe;
+  for (const std::size_t offset : offsets) {
+    if (result.long_offsets) {
+      bs::put_u32_be(result.loca, static_cast<std::uint32_t>(offset));
+    } else {
+      bs::put_u16_be(result.loca, static_cast<std::uint16_t>(offset / 2));
+    }
+  }
+  return result;
+}
+
 void font::reencode_to_pua(sfnt::SfntFont &font,
                            const std::map<char32_t, std::uint16_t> &extra) {
   font.set_cmap(pua_cmap(font.glyph_count(), extra));
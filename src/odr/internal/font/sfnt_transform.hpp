@@ -2,7 +2,9 @@
 
 #include <cstdint>
 #include <map>
+#include <set>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -66,6 +68,22 @@ serialize_cmap(const std::map<char32_t, std::uint16_t> &map);
                                         std::uint16_t first_char,
                                         std::uint16_t last_char);
 
+/// TrueType outlines (`glyf` + `loca`) cut down to @p glyphs, the glyphs their
+/// composites are built from and `.notdef`. Glyph ids are kept: every other
+/// glyph stays in `loca` with an empty outline, so the `pua_code_point`s text
+/// was written with still address the same glyphs. @p long_offsets is
+/// `head.indexToLocFormat`; the result picks its own, to be patched back into
+/// `head`.
+struct GlyfSubset {
+  std::string glyf;
+  std::string loca;
+  bool long_offsets{false};
+};
+[[nodiscard]] GlyfSubset subset_glyf(std::string_view glyf,
+                                     std::string_view loca, bool long_offsets,
+                                     std::uint16_t glyph_count,
+                                     const std::set<std::uint16_t> &glyphs);
+
 /// Re-encode @p font in place for the browser: replace its `cmap` with a fresh
 /// map from the deterministic PUA code points (`pua_code_point`) to *every*
 /// glyph, so the font renders every glyph — including ones the original `cmap`
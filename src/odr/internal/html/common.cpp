@@ -11,6 +11,7 @@
 #include <odr/style.hpp>
 
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
@@ -144,26 +145,67 @@ void html::write_zoom_style(HtmlWriter &out, const HtmlConfig &config,
 }
 
 std::string html::escape_text(std::string text) {
-  if (text.empty()) {
-    return text;
-  }
+  std::string result;
+  append_escaped_text(result, text);
+  return result;
+}
 
-  util::string::replace_all(text, "&", "&amp;");
-  util::string::replace_all(text, "<", "&lt;");
-  util::string::replace_all(text, ">", "&gt;");
+namespace {
 
-  if (text.front() == ' ') {
-    text = "&nbsp;" + text.substr(1);
+/// The bytes @ref html::append_escaped_text stops at; every other byte is
+/// copied along with its run.
+constexpr std::array<bool, 256> special_text_bytes = [] {
+  std::array<bool, 256> result{};
+  for (const unsigned char c : {'&', '<', '>', ' ', '\t'}) {
+    result[c] = true;
   }
-  if (text.back() == ' ') {
-    text = text.substr(0, text.length() - 1) + "&nbsp;";
+  return result;
+}();
+
+} // namespace
+
+void html::append_escaped_text(std::string &out, const std::string_view text) {
+  // A space at either end becomes `&nbsp;`, and so does every second one of a
+  // run between them, which keeps the run from collapsing. `run` counts the
+  // latter.
+  const std::size_t size = text.size();
+  std::size_t run = 0;
+  std::size_t begin = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    const char c = text[i];
+    if (!special_text_bytes[static_cast<unsigned char>(c)]) {
+      continue;
+    }
+    out.append(text.substr(begin, i - begin));
+    begin = i + 1;
+    switch (c) {
+    case '&':
+      out.append("&amp;");
+      break;
+    case '<':
+      out.append("&lt;");
+      break;
+    case '>':
+      out.append("&gt;");
+      break;
+    case '\t':
+      // TODO `&emsp;` is not a tab
+      out.append("&emsp;");
+      break;
+    default:
+      if (i == 0 || i + 1 == size) {
+        out.append("&nbsp;");
+      } else {
+        if (text[i - 1] != ' ') {
+          run = 0;
+        }
+        out.append(run % 2 == 1 ? "&nbsp;" : " ");
+        ++run;
+      }
+      break;
+    }
   }
-  util::string::replace_all(text, "  ", " &nbsp;");
-
-  // TODO `&emsp;` is not a tab
-  util::string::replace_all(text, "\t", "&emsp;");
-
-  return text;
+  out.append(text.substr(begin));
 }
 
 std::string html::escape_attribute(std::string value) {
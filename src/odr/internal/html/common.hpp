@@ -65,6 +65,9 @@ void write_zoom_style(HtmlWriter &out, const HtmlConfig &config, bool fits,
                       std::optional<double> content_pixels);
 
 std::string escape_text(std::string text);
+/// Appends @p text to @p out escaped as @ref escape_text does, in one pass and
+/// without a copy of its own.
+void append_escaped_text(std::string &out, std::string_view text);
 
 /// Escape a string for use as an HTML double-quoted attribute value (`&`, `"`,
 /// `<`, `>`). Unlike `escape_text`, it leaves leading/trailing spaces intact.
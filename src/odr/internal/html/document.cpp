@@ -6,6 +6,8 @@
 #include <odr/file.hpp>
 #include <odr/html.hpp>
 #include <odr/style.hpp>
+#include <odr/table_dimension.hpp>
+#include <odr/table_position.hpp>
 
 #include <odr/internal/abstract/html_service.hpp>
 #include <odr/internal/common/null_stream.hpp>
@@ -18,7 +20,10 @@
 #include <odr/internal/util/string_util.hpp>
 
 #include <algorithm>
+#include <charconv>
 #include <mutex>
+#include <string_view>
+#include <utility>
 
 namespace odr::internal::html {
 namespace {
@@ -191,6 +196,15 @@ public:
 
   virtual void write_fragment(HtmlWriter &out, WritingState &state) const = 0;
 
+  /// The tile of this view at @p path, if it is one: its column and row band.
+  [[nodiscard]] virtual std::optional<TablePosition>
+  tile_at(const std::string & /*path*/) const {
+    return std::nullopt;
+  }
+  /// Writes a tile @ref tile_at found.
+  virtual void write_tile(const TablePosition & /*tile*/,
+                          WritingState & /*state*/) const {}
+
   /// The width this one view lays out, which is what it is fitted against.
   [[nodiscard]] virtual std::optional<double> content_pixels() const = 0;
 
@@ -282,9 +296,14 @@ public:
       return true;
     }
 
+    if (tile_at_(path).has_value()) {
+      return true;
+    }
+
     warmup();
 
-    return resource_at(m_resources, path) != nullptr;
+    return resource_at(m_resources, path) != nullptr ||
+           tile_resource_(path).has_value();
   }
 
   std::string mimetype(const std::string &path) const override {
@@ -293,6 +312,9 @@ public:
         })) {
       return "text/html";
     }
+    if (tile_at_(path).has_value()) {
+      return "text/html";
+    }
 
     warmup();
 
@@ -300,6 +322,10 @@ public:
         resource != nullptr) {
       return resource->mime_type();
     }
+    if (const std::optional<odr::HtmlResource> resource = tile_resource_(path);
+        resource.has_value()) {
+      return resource->mime_type();
+    }
 
     throw FileNotFound("Unknown path: " + path);
   }
@@ -312,6 +338,16 @@ public:
         return;
       }
     }
+    if (const auto tile = tile_at_(path); tile.has_value()) {
+      HtmlResources resources;
+      {
+        HtmlWriter writer(out, config());
+        WritingState state(writer, config(), resources);
+        tile->first->write_tile(tile->second, state);
+      }
+      add_tile_resources_(resources);
+      return;
+    }
 
     warmup();
 
@@ -320,6 +356,11 @@ public:
       resource->write_resource(out);
       return;
     }
+    if (const std::optional<odr::HtmlResource> resource = tile_resource_(path);
+        resource.has_value()) {
+      resource->write_resource(out);
+      return;
+    }
 
     throw FileNotFound("Unknown path: " + path);
   }
@@ -365,6 +406,43 @@ protected:
   mutable std::mutex m_mutex;
   mutable bool m_warm = false;
   mutable HtmlResources m_resources;
+
+  /// What tiles wrote that the views did not, as the tiles are asked for.
+  mutable std::mutex m_tile_mutex;
+  mutable HtmlResources m_tile_resources;
+
+  [[nodiscard]] std::optional<
+      std::pair<const HtmlFragmentBase *, TablePosition>>
+  tile_at_(const std::string &path) const {
+    for (const auto &fragment : m_fragments) {
+      if (const std::optional<TablePosition> tile = fragment->tile_at(path);
+          tile.has_value()) {
+        return std::pair(fragment.get(), *tile);
+      }
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] std::optional<odr::HtmlResource>
+  tile_resource_(const std::string &path) const {
+    std::lock_guard lock(m_tile_mutex);
+    if (const odr::HtmlResource *resource =
+            resource_at(m_tile_resources, path);
+        resource != nullptr) {
+      return *resource;
+    }
+    return std::nullopt;
+  }
+
+  void add_tile_resources_(const HtmlResources &resources) const {
+    std::lock_guard lock(m_tile_mutex);
+    for (const auto &[resource, location] : resources) {
+      if (location.has_value() &&
+          resource_at(m_tile_resources, *location) == nullptr) {
+        m_tile_resources.emplace_back(resource, location);
+      }
+    }
+  }
 };
 
 class TextHtmlFragment final : public HtmlFragmentBase {
@@ -434,9 +512,102 @@ private:
 };
 
 using SlideHtmlFragment = ElementHtmlFragment<Slide, translate_slide>;
-using SheetHtmlFragment = ElementHtmlFragment<Sheet, translate_sheet>;
 using PageHtmlFragment = ElementHtmlFragment<Page, translate_page>;
 
+/// A sheet, written whole or, with @ref HtmlConfig::spreadsheet_tile, as a
+/// shell whose tiles sit next to it: `sheet0.html` fetches `sheet0/r0c0.html`
+/// and on.
+class SheetHtmlFragment final : public HtmlFragmentBase {
+public:
+  SheetHtmlFragment(std::string name, const std::size_t index,
+                    std::string path, Document document, const Sheet &sheet,
+                    const HtmlConfig &config)
+      : HtmlFragmentBase(std::move(name), index, std::move(path),
+                         std::move(document)),
+        m_sheet{sheet} {
+    if (config.spreadsheet_tile.has_value()) {
+      m_tile = TableDimensions(std::max(1u, config.spreadsheet_tile->rows),
+                               std::max(1u, config.spreadsheet_tile->columns));
+      const std::size_t slash = m_path.rfind('/');
+      const std::size_t dot = m_path.rfind('.');
+      m_tile_path = m_path.substr(
+          0, dot != std::string::npos &&
+                     (slash == std::string::npos || dot > slash)
+                 ? dot
+                 : m_path.size());
+      m_tile_path += '/';
+      m_limit_by_content = config.spreadsheet_limit_by_content;
+    }
+  }
+
+  [[nodiscard]] std::optional<double> content_pixels() const override {
+    return fragment_content_pixels(m_sheet);
+  }
+
+  void write_fragment(HtmlWriter &, WritingState &state) const override {
+    if (!m_tile.has_value()) {
+      translate_sheet(m_sheet, state);
+      return;
+    }
+    translate_sheet_shell(m_sheet, extent_(), *m_tile, m_tile_path, state);
+  }
+
+  /// `<tile path>r<row band>c<column band>.html`, within the sheet.
+  [[nodiscard]] std::optional<TablePosition>
+  tile_at(const std::string &path) const override {
+    if (!m_tile.has_value() || !path.starts_with(m_tile_path)) {
+      return std::nullopt;
+    }
+
+    const char *it = path.data() + m_tile_path.size();
+    const char *end = path.data() + path.size();
+    const auto band = [&it, end](const char prefix, std::uint32_t &result) {
+      if (it == end || *it != prefix) {
+        return false;
+      }
+      const auto [ptr, ec] = std::from_chars(it + 1, end, result);
+      it = ptr;
+      return ec == std::errc();
+    };
+    TablePosition tile;
+    if (!band('r', tile.row) || !band('c', tile.column) ||
+        std::string_view(it, end) != ".html") {
+      return std::nullopt;
+    }
+
+    const TableDimensions &extent = extent_();
+    if (std::uint64_t(tile.row) * m_tile->rows >= extent.rows ||
+        std::uint64_t(tile.column) * m_tile->columns >= extent.columns) {
+      return std::nullopt;
+    }
+    return tile;
+  }
+
+  void write_tile(const TablePosition &tile,
+                  WritingState &state) const override {
+    translate_sheet_tile(m_sheet, extent_(), *m_tile, tile.row, tile.column,
+                         state);
+  }
+
+private:
+  Sheet m_sheet;
+  std::optional<TableDimensions> m_tile;
+  std::string m_tile_path;
+  bool m_limit_by_content{true};
+
+  /// Every tile is cut from the same extent, and finding the content of a
+  /// large sheet is not cheap, so it is found once.
+  mutable std::once_flag m_extent_once;
+  mutable TableDimensions m_extent;
+
+  [[nodiscard]] const TableDimensions &extent_() const {
+    std::call_once(m_extent_once, [this] {
+      m_extent = sheet_extent(m_sheet, m_limit_by_content, std::nullopt);
+    });
+    return m_extent;
+  }
+};
+
 } // namespace
 } // namespace odr::internal::html
 
@@ -467,7 +638,7 @@ HtmlService html::create_document_service(const Document &document,
       fragments.push_back(std::make_unique<SheetHtmlFragment>(
           sheet.name(), i + 1,
           fill_path_variables(config.sheet_output_file_name, i), document,
-          sheet));
+          sheet, config));
       ++i;
     }
   } else if (document.document_type() == DocumentType::drawing) {
@@ -13,6 +13,12 @@
 #include <odr/internal/html/html_writer.hpp>
 #include <odr/internal/html/image_file.hpp>
 
+#include <array>
+#include <charconv>
+#include <span>
+#include <string>
+#include <string_view>
+
 namespace odr::internal {
 
 void html::translate_children(const ElementRange &range,
@@ -79,112 +85,131 @@ void html::translate_element(const Element &element,
   }
 }
 
-void html::translate_sheet(const Sheet &sheet, const WritingState &state) {
-  state.out().write_element_begin("table",
-                                  HtmlElementOptions().set_class("odr-sheet"));
-
-  const TableDimensions dimensions = sheet.dimensions();
-  std::uint32_t end_column = dimensions.columns;
-  std::uint32_t end_row = dimensions.rows;
-  if (state.config().spreadsheet_limit_by_content) {
-    const TableDimensions content =
-        sheet.content(state.config().spreadsheet_limit);
-    end_column = content.columns;
-    end_row = content.rows;
+namespace {
+
+/// The `colspan` and `rowspan` of a cell spanning more than one column or row,
+/// formatted in place.
+class SpanAttributes final {
+public:
+  explicit SpanAttributes(const TableDimensions &span) {
+    if (span.columns > 1) {
+      add_("colspan", span.columns);
+    }
+    if (span.rows > 1) {
+      add_("rowspan", span.rows);
+    }
   }
-  if (state.config().spreadsheet_limit) {
-    end_column =
-        std::min(end_column, state.config().spreadsheet_limit->columns);
-    end_row = std::min(end_row, state.config().spreadsheet_limit->rows);
+  SpanAttributes(const SpanAttributes &) = delete;
+  SpanAttributes &operator=(const SpanAttributes &) = delete;
+
+  [[nodiscard]] std::span<const html::HtmlAttribute> attributes() const {
+    return {m_attributes.data(), m_size};
   }
-  end_column = std::max(1u, end_column);
-  end_row = std::max(1u, end_row);
 
-  state.out().write_element_begin("col",
-                                  HtmlElementOptions()
-                                      .set_close_type(HtmlCloseType::none)
-                                      .set_class("odr-sheet-gutter"));
+private:
+  std::array<std::array<char, 10>, 2> m_values{};
+  std::array<html::HtmlAttribute, 2> m_attributes{};
+  std::size_t m_size{0};
 
-  for (std::uint32_t column_index = 0; column_index < end_column;
+  void add_(const std::string_view name, const std::uint32_t value) {
+    char *begin = m_values[m_size].data();
+    const char *end =
+        std::to_chars(begin, begin + m_values[m_size].size(), value).ptr;
+    m_attributes[m_size++] = {name, std::string_view(begin, end - begin)};
+  }
+};
+
+} // namespace
+
+namespace {
+
+/// The `<col>`s and the ruler of a sheet @p extent large.
+void write_sheet_head(const Sheet &sheet, const TableDimensions &extent,
+                      html::HtmlWriter &out) {
+  out.write_tag_begin("col", {.close_type = html::HtmlCloseType::none,
+                              .clazz = "odr-sheet-gutter"});
+
+  for (std::uint32_t column_index = 0; column_index < extent.columns;
        ++column_index) {
     const TableColumnStyle table_column_style =
         sheet.column_style(column_index);
 
-    state.out().write_element_begin(
+    out.write_tag_begin(
         "col",
-        HtmlElementOptions()
-            .set_close_type(HtmlCloseType::none)
-            .set_style(translate_table_column_style(table_column_style)));
+        {.close_type = html::HtmlCloseType::none,
+         .style = {html::translate_table_column_style(table_column_style)}});
   }
 
   // No `scope`: the letters and numbers are a ruler, not headers of what they
   // label.
-  {
-    state.out().write_element_begin("thead");
-    state.out().write_element_begin("tr");
-
-    // Under `table-layout:fixed` the first row sizes the columns, and `ch`
-    // resolves against the ruler's font — so the gutter width sits here rather
-    // than on the `<col>`.
-    state.out().write_element_begin(
-        "th",
-        HtmlElementOptions()
-            .set_inline(true)
-            .set_class("odr-sheet-corner")
-            .set_style("width:calc(" +
-                       std::to_string(
-                           TablePosition::to_row_string(end_row - 1).size()) +
-                       "ch + 14px);"));
-    state.out().write_element_end("th");
-
-    for (std::uint32_t column_index = 0; column_index < end_column;
-         ++column_index) {
-      state.out().write_element_begin(
-          "th", HtmlElementOptions().set_inline(true).set_class(
-                    "odr-sheet-column-header"));
-      state.out().write_raw(TablePosition::to_column_string(column_index));
-      state.out().write_element_end("th");
-    }
-
-    state.out().write_element_end("tr");
-    state.out().write_element_end("thead");
+  out.write_tag_begin("thead");
+  out.write_tag_begin("tr");
+
+  // Under `table-layout:fixed` the first row sizes the columns, and `ch`
+  // resolves against the ruler's font — so the gutter width sits here rather
+  // than on the `<col>`.
+  const std::string gutter_ch =
+      std::to_string(TablePosition::to_row_string(extent.rows - 1).size());
+  out.write_tag_begin(
+      "th", {.inline_element = true,
+             .clazz = "odr-sheet-corner",
+             .style = {"width:calc(", gutter_ch, "ch + 14px);"}});
+  out.write_element_end("th");
+
+  for (std::uint32_t column_index = 0; column_index < extent.columns;
+       ++column_index) {
+    out.write_tag_begin("th", {.inline_element = true,
+                               .clazz = "odr-sheet-column-header"});
+    out.write_raw(TablePosition::to_column_string(column_index));
+    out.write_element_end("th");
   }
 
-  state.out().write_element_begin("tbody");
+  out.write_element_end("tr");
+  out.write_element_end("thead");
+}
+
+/// One `<tr>` per row from @p begin up to @p end, each with the cells of the
+/// columns between them. A span is cut where the block ends, and a position
+/// covered from outside the block is an empty cell, so blocks written next to
+/// each other line up. The row headers are written with the first column.
+void write_sheet_rows(const Sheet &sheet, const TablePosition &begin,
+                      const TablePosition &end,
+                      const html::WritingState &state) {
+  html::HtmlWriter &out = state.out();
 
+  // relative to `begin`
   TableCursor cursor;
-  for (std::uint32_t row_index = cursor.row(); row_index < end_row;
-       row_index = cursor.row()) {
+  for (std::uint32_t row_index = begin.row + cursor.row();
+       row_index < end.row; row_index = begin.row + cursor.row()) {
     const TableRowStyle table_row_style = sheet.row_style(row_index);
 
-    state.out().write_element_begin(
-        "tr", HtmlElementOptions().set_style(
-                  translate_table_row_style(table_row_style)));
-
-    state.out().write_element_begin(
-        "th", HtmlElementOptions()
-                  .set_inline(true)
-                  .set_class("odr-sheet-row-header")
-                  .set_style([&]() -> std::optional<HtmlWritable> {
-                    const std::optional<Measure> height =
-                        table_row_style.height;
-                    if (!height.has_value()) {
-                      return std::nullopt;
-                    }
-                    return "height:" + height->to_string() +
-                           ";max-height:" + height->to_string() + ";";
-                  }()));
-    state.out().write_raw(TablePosition::to_row_string(row_index));
-    state.out().write_element_end("th");
-
-    for (std::uint32_t column_index = cursor.column();
-         column_index < end_column; column_index = cursor.column()) {
+    out.write_tag_begin(
+        "tr", {.style = {html::translate_table_row_style(table_row_style)}});
+
+    if (begin.column == 0) {
+      std::string height;
+      if (table_row_style.height.has_value()) {
+        const std::string measure = table_row_style.height->to_string();
+        height.append("height:").append(measure);
+        height.append(";max-height:").append(measure).append(";");
+      }
+      out.write_tag_begin("th", {.inline_element = true,
+                                 .clazz = "odr-sheet-row-header",
+                                 .style = {height}});
+      out.write_raw(TablePosition::to_row_string(row_index));
+      out.write_element_end("th");
+    }
+
+    for (std::uint32_t column_index = begin.column + cursor.column();
+         column_index < end.column;
+         column_index = begin.column + cursor.column()) {
       const SheetCell cell = sheet.cell(column_index, row_index);
 
       if (cell.is_covered()) {
-        // normally unreachable: the cursor skips positions covered by an
-        // anchor's span; advance one column so inconsistent spans cannot
-        // starve the loop
+        // the anchor is outside the block, or its span is inconsistent; an
+        // empty cell keeps the columns in step either way
+        out.write_tag_begin("td");
+        out.write_element_end("td");
         cursor.add_cell();
         continue;
       }
@@ -193,45 +218,141 @@ void html::translate_sheet(const Sheet &sheet, const WritingState &state) {
       // there could be a struct to get all the info?
       const TableCellStyle cell_style =
           sheet.cell_style(column_index, row_index);
-      const TableDimensions cell_span = cell.span();
+      const TableDimensions cell_span(
+          std::min(cell.span().rows, end.row - row_index),
+          std::min(cell.span().columns, end.column - column_index));
       const ValueType cell_value_type = cell.value_type();
 
-      state.out().write_element_begin(
-          "td",
-          HtmlElementOptions()
-              .set_attributes([&](const HtmlAttributeWriterCallback &clb) {
-                if (cell_span.columns > 1) {
-                  clb("colspan", std::to_string(cell_span.columns));
-                }
-                if (cell_span.rows > 1) {
-                  clb("rowspan", std::to_string(cell_span.rows));
-                }
-              })
-              .set_style(translate_table_cell_style(cell_style))
-              .set_class([&]() -> std::optional<HtmlWritable> {
-                if (cell_value_type == ValueType::float_number) {
-                  return "odr-value-type-float";
-                }
-                return std::nullopt;
-              }()));
+      const SpanAttributes span_attributes(cell_span);
+      out.write_tag_begin(
+          "td", {.clazz = cell_value_type == ValueType::float_number
+                              ? "odr-value-type-float"
+                              : "",
+                 .style = {html::translate_table_cell_style(cell_style)},
+                 .attributes = span_attributes.attributes()});
       if (column_index == 0 && row_index == 0) {
         for (const Element shape : sheet.shapes()) {
-          translate_element(shape, state);
+          html::translate_element(shape, state);
         }
       }
-      translate_children(cell.children(), state);
-      state.out().write_element_end("td");
+      html::translate_children(cell.children(), state);
+      out.write_element_end("td");
 
       cursor.add_cell(cell_span.columns, cell_span.rows);
     }
 
-    state.out().write_element_end("tr");
+    out.write_element_end("tr");
 
     cursor.add_row();
   }
+}
 
-  state.out().write_element_end("tbody");
-  state.out().write_element_end("table");
+/// How many of @p size fit @p extent, the last one partly.
+std::uint32_t band_count(const std::uint32_t extent, const std::uint32_t size) {
+  return (extent + size - 1) / size;
+}
+
+} // namespace
+
+TableDimensions
+html::sheet_extent(const Sheet &sheet, const bool by_content,
+                   const std::optional<TableDimensions> &limit) {
+  TableDimensions result = sheet.dimensions();
+  if (by_content) {
+    result = sheet.content(limit);
+  }
+  if (limit.has_value()) {
+    result.columns = std::min(result.columns, limit->columns);
+    result.rows = std::min(result.rows, limit->rows);
+  }
+  result.columns = std::max(1u, result.columns);
+  result.rows = std::max(1u, result.rows);
+  return result;
+}
+
+void html::translate_sheet(const Sheet &sheet, const WritingState &state) {
+  HtmlWriter &out = state.out();
+  out.write_tag_begin("table", {.clazz = "odr-sheet"});
+
+  const TableDimensions extent =
+      sheet_extent(sheet, state.config().spreadsheet_limit_by_content,
+                   state.config().spreadsheet_limit);
+
+  write_sheet_head(sheet, extent, out);
+
+  out.write_tag_begin("tbody");
+  write_sheet_rows(sheet, TablePosition(0, 0),
+                   TablePosition(extent.columns, extent.rows), state);
+  out.write_element_end("tbody");
+
+  out.write_element_end("table");
+}
+
+void html::translate_sheet_shell(const Sheet &sheet,
+                                 const TableDimensions &extent,
+                                 const TableDimensions &tile,
+                                 const std::string &tile_path,
+                                 const WritingState &state) {
+  HtmlWriter &out = state.out();
+
+  const std::string rows = std::to_string(extent.rows);
+  const std::string columns = std::to_string(extent.columns);
+  const std::string tile_rows = std::to_string(tile.rows);
+  const std::string tile_columns = std::to_string(tile.columns);
+  const HtmlAttribute attributes[]{
+      {"data-odr-tile-path", tile_path},   {"data-odr-rows", rows},
+      {"data-odr-columns", columns},       {"data-odr-tile-rows", tile_rows},
+      {"data-odr-tile-columns", tile_columns}};
+  out.write_tag_begin("table",
+                      {.clazz = "odr-sheet", .attributes = attributes});
+
+  write_sheet_head(sheet, extent, out);
+
+  // One `<tbody>` per band of rows, holding a placeholder about as tall as the
+  // rows it stands for until the script swaps them in.
+  const HtmlAttribute pending_attributes[]{{"colspan", columns}};
+  for (std::uint32_t band = 0; band < band_count(extent.rows, tile.rows);
+       ++band) {
+    const std::string band_string = std::to_string(band);
+    const std::string band_rows = std::to_string(
+        std::min(tile.rows, extent.rows - band * tile.rows));
+    const HtmlAttribute band_attributes[]{{"data-odr-tile", band_string}};
+    out.write_tag_begin("tbody", {.clazz = "odr-sheet-tile",
+                                  .attributes = band_attributes});
+    out.write_tag_begin(
+        "tr", {.clazz = "odr-sheet-pending",
+               .style = {"height:calc(", band_rows,
+                         " * var(--odr-sheet-row-estimate));"}});
+    out.write_tag_begin("th", {.inline_element = true,
+                               .clazz = "odr-sheet-row-header"});
+    out.write_element_end("th");
+    out.write_tag_begin("td", {.inline_element = true,
+                               .attributes = pending_attributes});
+    out.write_element_end("td");
+    out.write_element_end("tr");
+    out.write_element_end("tbody");
+  }
+
+  out.write_element_end("table");
+}
+
+bool html::translate_sheet_tile(const Sheet &sheet,
+                                const TableDimensions &extent,
+                                const TableDimensions &tile,
+                                const std::uint32_t row_band,
+                                const std::uint32_t column_band,
+                                const WritingState &state) {
+  if (row_band >= band_count(extent.rows, tile.rows) ||
+      column_band >= band_count(extent.columns, tile.columns)) {
+    return false;
+  }
+
+  const TablePosition begin(column_band * tile.columns, row_band * tile.rows);
+  const TablePosition end(
+      std::min(extent.columns, begin.column + tile.columns),
+      std::min(extent.rows, begin.row + tile.rows));
+  write_sheet_rows(sheet, begin, end, state);
+  return true;
 }
 
 namespace {
@@ -242,11 +363,10 @@ namespace {
 template <typename PageLike>
 void translate_page_like(const PageLike &page,
                          const html::WritingState &state) {
-  state.out().write_element_begin(
+  state.out().write_tag_begin(
       "div",
-      html::HtmlElementOptions()
-          .set_class("odr-page-outer")
-          .set_style(html::translate_outer_page_style(page.page_layout())));
+      {.clazz = "odr-page-outer",
+       .style = {html::translate_outer_page_style(page.page_layout())}});
 
   html::translate_master_page(page.master_page(), state);
   html::translate_children(page.children(), state);
@@ -275,17 +395,18 @@ void html::translate_master_page(const MasterPage &masterPage,
 void html::translate_text(const Element &element, const WritingState &state) {
   const Text text = element.as_text();
 
-  state.out().write_element_begin(
-      "x-s", HtmlElementOptions()
-                 .set_inline(true)
-                 .set_attributes([&](const HtmlAttributeWriterCallback &clb) {
-                   if (state.config().editable && element.is_editable()) {
-                     clb("contenteditable", "true");
-                     clb("data-odr-path", element.document_path().to_string());
-                   }
-                 })
-                 .set_style(translate_text_style(text.style())));
-  state.out().out() << escape_text(text.content());
+  const bool editable = state.config().editable && element.is_editable();
+  const std::string path =
+      editable ? element.document_path().to_string() : std::string();
+  const HtmlAttribute editable_attributes[]{{"contenteditable", "true"},
+                                            {"data-odr-path", path}};
+
+  state.out().write_tag_begin(
+      "x-s", {.inline_element = true,
+              .style = {translate_text_style(text.style())},
+              .attributes = editable ? std::span(editable_attributes)
+                                     : std::span<const HtmlAttribute>()});
+  state.out().write_text(text.content());
   state.out().write_element_end("x-s");
 }
 
@@ -293,11 +414,10 @@ void html::translate_line_break(const Element &element,
                                 const WritingState &state) {
   const LineBreak line_break = element.as_line_break();
 
-  state.out().write_element_begin(
-      "br", HtmlElementOptions().set_close_type(HtmlCloseType::none));
-  state.out().write_element_begin(
-      "x-s", HtmlElementOptions().set_inline(true).set_style(
-                 translate_text_style(line_break.style())));
+  state.out().write_tag_begin("br", {.close_type = HtmlCloseType::none});
+  state.out().write_tag_begin(
+      "x-s", {.inline_element = true,
+              .style = {translate_text_style(line_break.style())}});
   state.out().write_element_end("x-s");
 }
 
@@ -336,31 +456,29 @@ void html::translate_paragraph(const Element &element,
                                const std::string &marker) {
   const Paragraph paragraph = element.as_paragraph();
 
-  state.out().write_element_begin(
+  state.out().write_tag_begin(
       "x-p",
-      HtmlElementOptions().set_inline(true).set_style(
-          "display:block;" + translate_paragraph_style(paragraph.style()) +
-          translate_block_font_style(paragraph.text_style())));
+      {.inline_element = true,
+       .style = {"display:block;", translate_paragraph_style(paragraph.style()),
+                 translate_block_font_style(paragraph.text_style())}});
   if (!marker.empty()) {
-    state.out().write_element_begin(
-        "x-s", HtmlElementOptions()
-                   .set_inline(true)
-                   .set_class("odr-list-marker")
-                   .set_style(translate_text_style(paragraph.text_style())));
+    state.out().write_tag_begin(
+        "x-s", {.inline_element = true,
+                .clazz = "odr-list-marker",
+                .style = {translate_text_style(paragraph.text_style())}});
     // The tab separates label from text once copied.
-    state.out().out() << escape_text(marker) << "&#9;";
+    state.out().write_text(marker);
+    state.out().write_raw("&#9;", false);
     state.out().write_element_end("x-s");
   }
   translate_children(paragraph.children(), state);
   if (marker.empty() && !has_content(paragraph.children())) {
     // A line break, not a break opportunity: only a break is copied, so a blank
     // line between two paragraphs survives being pasted somewhere else.
-    state.out().write_element_begin(
-        "br", HtmlElementOptions().set_close_type(HtmlCloseType::none));
+    state.out().write_tag_begin("br", {.close_type = HtmlCloseType::none});
   } else {
     // A paragraph whose content is all out of flow has no line box of its own.
-    state.out().write_element_begin(
-        "wbr", HtmlElementOptions().set_close_type(HtmlCloseType::none));
+    state.out().write_tag_begin("wbr", {.close_type = HtmlCloseType::none});
   }
   state.out().write_element_end("x-p");
 }
@@ -368,9 +486,9 @@ void html::translate_paragraph(const Element &element,
 void html::translate_span(const Element &element, const WritingState &state) {
   const Span span = element.as_span();
 
-  state.out().write_element_begin(
-      "x-s", HtmlElementOptions().set_inline(true).set_style(
-                 translate_text_style(span.style())));
+  state.out().write_tag_begin(
+      "x-s", {.inline_element = true,
+              .style = {translate_text_style(span.style())}});
   translate_children(span.children(), state);
   state.out().write_element_end("x-s");
 }
@@ -378,9 +496,10 @@ void html::translate_span(const Element &element, const WritingState &state) {
 void html::translate_link(const Element &element, const WritingState &state) {
   const Link link = element.as_link();
 
-  state.out().write_element_begin(
-      "a", HtmlElementOptions().set_inline(true).set_attributes(
-               HtmlAttributesVector{{"href", escape_attribute(link.href())}}));
+  const std::string href = escape_attribute(link.href());
+  const HtmlAttribute attributes[]{{"href", href}};
+  state.out().write_tag_begin(
+      "a", {.inline_element = true, .attributes = attributes});
   translate_children(link.children(), state);
   state.out().write_element_end("a");
 }
@@ -389,10 +508,10 @@ void html::translate_bookmark(const Element &element,
                               const WritingState &state) {
   const Bookmark bookmark = element.as_bookmark();
 
-  state.out().write_element_begin(
-      "a",
-      HtmlElementOptions().set_inline(true).set_attributes(
-          HtmlAttributesVector{{"id", escape_attribute(bookmark.name())}}));
+  const std::string id = escape_attribute(bookmark.name());
+  const HtmlAttribute attributes[]{{"id", id}};
+  state.out().write_tag_begin(
+      "a", {.inline_element = true, .attributes = attributes});
   state.out().write_element_end("a");
 }
 
@@ -400,10 +519,9 @@ void html::translate_list(const Element &element, const WritingState &state) {
   // `div`s, not `ul`/`li`: an importer that draws its own marker over the one
   // we write shows both, and the macOS rich-text one does exactly that whatever
   // `list-style` says. The roles keep what a screen reader needs.
-  state.out().write_element_begin(
-      "div", HtmlElementOptions()
-                 .set_class("odr-list")
-                 .set_attributes(HtmlAttributesVector{{"role", "list"}}));
+  static constexpr HtmlAttribute attributes[]{{"role", "list"}};
+  state.out().write_tag_begin(
+      "div", {.clazz = "odr-list", .attributes = attributes});
   translate_children(element.children(), state);
   state.out().write_element_end("div");
 }
@@ -412,11 +530,11 @@ void html::translate_list_item(const Element &element,
                                const WritingState &state) {
   const ListItem list_item = element.as_list_item();
 
-  state.out().write_element_begin(
-      "div", HtmlElementOptions()
-                 .set_class("odr-list-item")
-                 .set_attributes(HtmlAttributesVector{{"role", "listitem"}})
-                 .set_style(translate_text_style(list_item.style())));
+  static constexpr HtmlAttribute attributes[]{{"role", "listitem"}};
+  state.out().write_tag_begin(
+      "div", {.clazz = "odr-list-item",
+              .style = {translate_text_style(list_item.style())},
+              .attributes = attributes});
 
   // Inside the first paragraph, not beside it: a sibling of that block copies
   // onto a line of its own.
@@ -436,29 +554,25 @@ void html::translate_list_item(const Element &element,
 void html::translate_table(const Element &element, const WritingState &state) {
   const Table table = element.as_table();
 
-  state.out().write_element_begin(
-      "table",
-      HtmlElementOptions()
-          .set_attributes(HtmlAttributesVector{
-              {"cellpadding", "0"}, {"border", "0"}, {"cellspacing", "0"}})
-          .set_style(translate_table_style(table.style())));
+  static constexpr HtmlAttribute attributes[]{
+      {"cellpadding", "0"}, {"border", "0"}, {"cellspacing", "0"}};
+  state.out().write_tag_begin(
+      "table", {.style = {translate_table_style(table.style())},
+                .attributes = attributes});
 
   for (Element column : table.columns()) {
     TableColumn table_column = column.as_table_column();
 
-    state.out().write_element_begin(
-        "col",
-        HtmlElementOptions()
-            .set_close_type(HtmlCloseType::none)
-            .set_style(translate_table_column_style(table_column.style())));
+    state.out().write_tag_begin(
+        "col", {.close_type = HtmlCloseType::none,
+                .style = {translate_table_column_style(table_column.style())}});
   }
 
   for (Element row : table.rows()) {
     TableRow table_row = row.as_table_row();
 
-    state.out().write_element_begin(
-        "tr", HtmlElementOptions().set_style(
-                  translate_table_row_style(table_row.style())));
+    state.out().write_tag_begin(
+        "tr", {.style = {translate_table_row_style(table_row.style())}});
 
     for (Element cell : table_row.children()) {
       TableCell table_cell = cell.as_table_cell();
@@ -469,18 +583,10 @@ void html::translate_table(const Element &element, const WritingState &state) {
 
       TableDimensions cell_span = table_cell.span();
 
-      state.out().write_element_begin(
-          "td",
-          HtmlElementOptions()
-              .set_attributes([&](const HtmlAttributeWriterCallback &clb) {
-                if (cell_span.columns > 1) {
-                  clb("colspan", std::to_string(cell_span.columns));
-                }
-                if (cell_span.rows > 1) {
-                  clb("rowspan", std::to_string(cell_span.rows));
-                }
-              })
-              .set_style(translate_table_cell_style(table_cell.style())));
+      const SpanAttributes span_attributes(cell_span);
+      state.out().write_tag_begin(
+          "td", {.style = {translate_table_cell_style(table_cell.style())},
+                 .attributes = span_attributes.attributes()});
 
       translate_children(cell.children(), state);
 
@@ -537,9 +643,9 @@ void html::translate_frame(const Element &element, const WritingState &state) {
   const Frame frame = element.as_frame();
   const GraphicStyle style = frame.style();
 
-  state.out().write_element_begin(
-      "div", HtmlElementOptions().set_style(translate_frame_properties(frame) +
-                                            translate_drawing_style(style)));
+  state.out().write_tag_begin(
+      "div", {.style = {translate_frame_properties(frame),
+                        translate_drawing_style(style)}});
   translate_children(frame.children(), state);
   state.out().write_element_end("div");
 }
@@ -548,9 +654,9 @@ void html::translate_rect(const Element &element, const WritingState &state) {
   const Rect rect = element.as_rect();
   const GraphicStyle style = rect.style();
 
-  state.out().write_element_begin(
-      "div", HtmlElementOptions().set_style(translate_rect_properties(rect) +
-                                            translate_drawing_style(style)));
+  state.out().write_tag_begin(
+      "div", {.style = {translate_rect_properties(rect),
+                        translate_drawing_style(style)}});
   translate_children(rect.children(), state);
   state.out().write_new_line();
   state.out().write_raw(
@@ -562,23 +668,23 @@ void html::translate_line(const Element &element, const WritingState &state) {
   const Line line = element.as_line();
   const GraphicStyle style = line.style();
 
-  state.out().write_element_begin(
-      "svg", HtmlElementOptions()
-                 .set_attributes(HtmlAttributesVector{
-                     {"xmlns", "http://www.w3.org/2000/svg"},
-                     {"version", "1.1"},
-                     {"overflow", "visible"}})
-                 .set_style("z-index:-1;position:absolute;top:0;left:0;" +
-                            translate_drawing_style(style)));
-
-  state.out().write_element_begin(
-      "line",
-      HtmlElementOptions()
-          .set_close_type(HtmlCloseType::trailing)
-          .set_attributes(HtmlAttributesVector{{"x1", line.x1().to_string()},
-                                               {"y1", line.y1().to_string()},
-                                               {"x2", line.x2().to_string()},
-                                               {"y2", line.y2().to_string()}}));
+  static constexpr HtmlAttribute svg_attributes[]{
+      {"xmlns", "http://www.w3.org/2000/svg"},
+      {"version", "1.1"},
+      {"overflow", "visible"}};
+  state.out().write_tag_begin(
+      "svg", {.style = {"z-index:-1;position:absolute;top:0;left:0;",
+                        translate_drawing_style(style)},
+              .attributes = svg_attributes});
+
+  const std::string x1 = line.x1().to_string();
+  const std::string y1 = line.y1().to_string();
+  const std::string x2 = line.x2().to_string();
+  const std::string y2 = line.y2().to_string();
+  const HtmlAttribute line_attributes[]{
+      {"x1", x1}, {"y1", y1}, {"x2", x2}, {"y2", y2}};
+  state.out().write_tag_begin("line", {.close_type = HtmlCloseType::trailing,
+                                       .attributes = line_attributes});
 
   state.out().write_element_end("svg");
 }
@@ -587,10 +693,9 @@ void html::translate_circle(const Element &element, const WritingState &state) {
   const Circle circle = element.as_circle();
   const GraphicStyle style = circle.style();
 
-  state.out().write_element_begin(
-      "div",
-      HtmlElementOptions().set_style(translate_circle_properties(circle) +
-                                     translate_drawing_style(style)));
+  state.out().write_tag_begin(
+      "div", {.style = {translate_circle_properties(circle),
+                        translate_drawing_style(style)}});
   state.out().write_new_line();
   translate_children(circle.children(), state);
   state.out().write_raw(
@@ -603,10 +708,9 @@ void html::translate_custom_shape(const Element &element,
   const CustomShape custom_shape = element.as_custom_shape();
   const GraphicStyle style = custom_shape.style();
 
-  state.out().write_element_begin(
-      "div", HtmlElementOptions().set_style(
-                 translate_custom_shape_properties(custom_shape) +
-                 translate_drawing_style(style)));
+  state.out().write_tag_begin(
+      "div", {.style = {translate_custom_shape_properties(custom_shape),
+                        translate_drawing_style(style)}});
   translate_children(custom_shape.children(), state);
   // TODO draw shape in svg
   state.out().write_element_end("div");
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 namespace odr {
+struct TableDimensions;
 class Element;
 class ElementRange;
 class MasterPage;
@@ -20,6 +23,23 @@ void translate_element(const Element &element, const WritingState &state);
 
 void translate_slide(const Slide &slide, const WritingState &state);
 void translate_sheet(const Sheet &sheet, const WritingState &state);
+
+/// The rows and columns a sheet is written to: its content, @p by_content, or
+/// else its dimensions, within @p limit.
+TableDimensions sheet_extent(const Sheet &sheet, bool by_content,
+                             const std::optional<TableDimensions> &limit);
+/// A sheet @p extent large as its ruler and one placeholder per band of
+/// @p tile rows; the spreadsheet script fills them from
+/// `<tile_path>r<row band>c<column band>.html` as they scroll into view.
+void translate_sheet_shell(const Sheet &sheet, const TableDimensions &extent,
+                           const TableDimensions &tile,
+                           const std::string &tile_path,
+                           const WritingState &state);
+/// The `<tr>`s of one tile of @p sheet, alone; `false` when the bands are past
+/// @p extent and nothing is written.
+bool translate_sheet_tile(const Sheet &sheet, const TableDimensions &extent,
+                          const TableDimensions &tile, std::uint32_t row_band,
+                          std::uint32_t column_band, const WritingState &state);
 void translate_page(const Page &page, const WritingState &state);
 
 void translate_master_page(const MasterPage &masterPage,
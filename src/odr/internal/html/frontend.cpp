@@ -75,6 +75,7 @@ constexpr std::string_view spreadsheet_css = R"css(
 --odr-sheet-wash-pinned:rgba(0,0,0,.09);
 --odr-sheet-wash-ruler:rgba(0,0,0,.10);
 --odr-sheet-focus:#3c78dc;
+--odr-sheet-row-estimate:20px;
 --odr-sheet-font:-apple-system,BlinkMacSystemFont,"Segoe UI",Roboto,"Helvetica Neue",Arial,sans-serif;
 }
 /* A sheet is not a page: past the last row and column is canvas. */
@@ -95,6 +96,8 @@ body{margin:0;background:var(--odr-sheet-canvas)}
 .odr-gridlines-soft .odr-sheet td{border-top:1px solid var(--odr-sheet-line);border-left:1px solid var(--odr-sheet-line)}
 .odr-gridlines-hard .odr-sheet td{border:1px solid var(--odr-sheet-line)!important}
 .odr-sheet td.odr-value-type-float{text-align:right}
+/* Rows and columns of a tiled sheet that are not fetched yet. */
+.odr-sheet .odr-sheet-pending>td,.odr-sheet td.odr-sheet-pending{background:var(--odr-sheet-canvas)}
 /* `background-image` layers over the document's own cell background instead of
    replacing it, and leaves `box-shadow` to the ruler. */
 .odr-sheet tbody tr:hover>*{background-image:linear-gradient(var(--odr-sheet-wash),var(--odr-sheet-wash))}
@@ -809,10 +812,164 @@ constexpr std::string_view search_js = R"js(
 })();
 )js";
 
+/// Fills a tiled sheet as it scrolls into view: a band of rows is fetched once
+/// it nears the viewport, its columns from the left as far as the view reaches,
+/// and the columns not fetched yet are one placeholder at the end of each row.
+///
 /// Highlights the row and column under the pointer, and pins them on a click.
 /// A column has no `:hover` selector, so one generated `:nth-child` rule lights
 /// it — free per cell, but only correct while cell and column line up.
 constexpr std::string_view spreadsheet_js = R"js(
+(function () {
+  "use strict";
+
+  var tiled = document.querySelectorAll(".odr-sheet[data-odr-tile-path]");
+  if (tiled.length === 0) {
+    return;
+  }
+
+  var sheets = [];
+  var scheduled = false;
+
+  // The column headers are all there from the start, so they tell how far
+  // right the view reaches; a viewport ahead is fetched with it.
+  function columnsInView(sheet) {
+    var headers = sheet.headers;
+    var reach = window.innerWidth * 2;
+    var low = 0;
+    var high = headers.length;
+    while (low < high) {
+      var middle = (low + high) >> 1;
+      if (headers[middle].getBoundingClientRect().left < reach) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    return Math.max(1, low);
+  }
+
+  function pending(colspan) {
+    var cell = document.createElement("td");
+    cell.className = "odr-sheet-pending";
+    cell.colSpan = colspan;
+    return cell;
+  }
+
+  function merge(sheet, body, column, html) {
+    var holder = document.createElement("tbody");
+    holder.innerHTML = html;
+    var fresh = Array.prototype.slice.call(holder.rows);
+    var rest =
+      sheet.columns - Math.min(sheet.columns, (column + 1) * sheet.tileColumns);
+
+    if (column === 0) {
+      body.textContent = "";
+      for (var i = 0; i < fresh.length; ++i) {
+        if (rest > 0) {
+          fresh[i].appendChild(pending(rest));
+        }
+        body.appendChild(fresh[i]);
+      }
+      return;
+    }
+
+    var rows = body.rows;
+    for (var j = 0; j < fresh.length && j < rows.length; ++j) {
+      var placeholder = rows[j].lastElementChild;
+      var cells = document.createDocumentFragment();
+      while (fresh[j].firstChild !== null) {
+        cells.appendChild(fresh[j].firstChild);
+      }
+      rows[j].insertBefore(cells, placeholder);
+      if (rest > 0) {
+        placeholder.colSpan = rest;
+      } else {
+        rows[j].removeChild(placeholder);
+      }
+    }
+  }
+
+  // One fetch at a time per band, so its columns arrive in order.
+  function fill(sheet, body) {
+    var state = body.odrTile;
+    var wanted = Math.ceil(columnsInView(sheet) / sheet.tileColumns);
+    if (state.busy || !state.visible || state.loaded >= wanted) {
+      return;
+    }
+    state.busy = true;
+    var column = state.loaded;
+    fetch(sheet.path + "r" + state.row + "c" + column + ".html")
+      .then(function (response) {
+        if (!response.ok) {
+          throw new Error(response.statusText);
+        }
+        return response.text();
+      })
+      .then(function (html) {
+        merge(sheet, body, column, html);
+        state.loaded = column + 1;
+        state.busy = false;
+        fill(sheet, body);
+      })
+      .catch(function () {
+        // left as a placeholder; the next scroll asks again
+        state.busy = false;
+      });
+  }
+
+  function fillVisible() {
+    scheduled = false;
+    for (var i = 0; i < sheets.length; ++i) {
+      for (var j = 0; j < sheets[i].bodies.length; ++j) {
+        fill(sheets[i], sheets[i].bodies[j]);
+      }
+    }
+  }
+
+  function schedule() {
+    if (!scheduled) {
+      scheduled = true;
+      window.requestAnimationFrame(fillVisible);
+    }
+  }
+
+  var observer = new IntersectionObserver(
+    function (entries) {
+      for (var i = 0; i < entries.length; ++i) {
+        entries[i].target.odrTile.visible = entries[i].isIntersecting;
+      }
+      schedule();
+    },
+    { rootMargin: "100% 0px" }
+  );
+
+  for (var i = 0; i < tiled.length; ++i) {
+    var table = tiled[i];
+    var sheet = {
+      path: table.getAttribute("data-odr-tile-path"),
+      columns: Number(table.getAttribute("data-odr-columns")),
+      tileColumns: Number(table.getAttribute("data-odr-tile-columns")),
+      headers: table.querySelectorAll(".odr-sheet-column-header"),
+      bodies: table.querySelectorAll("tbody.odr-sheet-tile"),
+    };
+    for (var j = 0; j < sheet.bodies.length; ++j) {
+      var body = sheet.bodies[j];
+      body.odrTile = {
+        row: Number(body.getAttribute("data-odr-tile")),
+        loaded: 0,
+        busy: false,
+        visible: false,
+      };
+      observer.observe(body);
+    }
+    sheets.push(sheet);
+  }
+
+  window.addEventListener("scroll", schedule, true);
+  window.addEventListener("resize", schedule);
+})();
+
 (function () {
   "use strict";
 
@@ -821,7 +978,10 @@ constexpr std::string_view spreadsheet_js = R"js(
     return;
   }
 
-  var merged = table.querySelector("td[colspan],td[rowspan]") !== null;
+  // The placeholders of a tiled sheet span columns like a merge does.
+  var merged =
+    table.hasAttribute("data-odr-tile-path") ||
+    table.querySelector("td[colspan],td[rowspan]") !== null;
 
   var style = document.createElement("style");
   document.head.appendChild(style);
@@ -1007,7 +1167,8 @@ constexpr std::string_view spreadsheet_js = R"js(
   }
 
   // A `rowspan` would reach into a row no longer beneath it and a `colspan`
-  // breaks the column index, so a merged sheet gets no sort control.
+  // breaks the column index, so a merged sheet gets no sort control. Neither
+  // does a tiled one, which holds only the rows fetched so far.
   if (!merged) {
     var headers = table.tHead.rows[0].children;
     for (var column = 1; column < headers.length; ++column) {
@@ -1063,6 +1224,8 @@ constexpr std::string_view text_js = R"js(
   function TextEditor(textNr, textBody) {
     this.textNr = textNr;
     this.textBody = textBody;
+    // a page of a longer file numbers on from where the page starts
+    this.firstLine = Number(textNr.dataset.first || 1);
     this.past = [];
     this.future = [];
 
@@ -1077,7 +1240,7 @@ constexpr std::string_view text_js = R"js(
       var lineCount = self.textBody.querySelectorAll("div").length;
       for (var i = nrCount + 1; i <= lineCount; ++i) {
         var nrCell = document.createElement("div");
-        nrCell.textContent = String(i);
+        nrCell.textContent = String(self.firstLine + i - 1);
         self.textNr.appendChild(nrCell);
       }
       for (var j = nrCount; j > lineCount; --j) {
@@ -1253,7 +1416,9 @@ constexpr std::string_view text_js = R"js(
 
         this.textNr.appendChild(document.createElement("div"));
         // the line is already in, so the count is the number the cell gets
-        this.textNr.lastChild.textContent = String(this.textBody.children.length);
+        this.textNr.lastChild.textContent = String(
+          this.firstLine + this.textBody.children.length - 1
+        );
       }
 
       if (i === 0) {
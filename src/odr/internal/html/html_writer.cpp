@@ -5,6 +5,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <exception>
+#include <ostream>
 #include <stdexcept>
 #include <utility>
 
@@ -12,6 +14,9 @@ namespace odr::internal::html {
 
 namespace {
 
+/// The buffer goes out to the stream once it holds this much.
+constexpr std::size_t buffer_size = 64 * 1024;
+
 template <class... Ts> struct overloaded : Ts... {
   using Ts::operator()...;
 };
@@ -27,62 +32,6 @@ bool is_empty(const HtmlWritable &writable) {
       writable);
 }
 
-void write_writable(std::ostream &out, const HtmlWritable &writable) {
-  std::visit(overloaded{
-                 [&out](const char *str) { out << str; },
-                 [&out](const std::string &str) { out << str; },
-                 [&out](const HtmlWriteCallback &clb) { clb(out); },
-             },
-             writable);
-}
-
-void write_key_value(std::ostream &out, const HtmlWritable &key,
-                     const HtmlWritable &value) {
-  out << " ";
-  write_writable(out, key);
-  out << "=\"";
-  write_writable(out, value);
-  out << "\"";
-}
-
-void write_attributes(std::ostream &out, const HtmlAttributes &attributes) {
-  std::visit(overloaded{
-                 [&out](const HtmlAttributesVector &vector) {
-                   for (const auto &[key, value] : vector) {
-                     write_key_value(out, key, value);
-                   }
-                 },
-                 [&out](const HtmlAttributeCallback &callback) {
-                   callback([&out](const HtmlWritable &key,
-                                   const HtmlWritable &value) {
-                     write_key_value(out, key, value);
-                   });
-                 },
-             },
-             attributes);
-}
-
-void write_element_options(std::ostream &out,
-                           const HtmlElementOptions &options) {
-  if (options.clazz && !is_empty(*options.clazz)) {
-    out << " class=\"";
-    write_writable(out, *options.clazz);
-    out << "\"";
-  }
-  if (options.style && !is_empty(*options.style)) {
-    out << " style=\"";
-    write_writable(out, *options.style);
-    out << "\"";
-  }
-  if (options.attributes) {
-    write_attributes(out, *options.attributes);
-  }
-  if (options.extra) {
-    out << " ";
-    write_writable(out, *options.extra);
-  }
-}
-
 } // namespace
 
 HtmlElementOptions &HtmlElementOptions::set_inline(const bool is_inline) {
@@ -123,53 +72,70 @@ HtmlElementOptions::set_extra(std::optional<HtmlWritable> _extra) {
 HtmlWriter::HtmlWriter(std::ostream &out, const bool format, std::string indent,
                        const std::uint32_t current_indent)
     : m_out{&out}, m_format{format}, m_indent(std::move(indent)),
-      m_current_indent{current_indent} {}
+      m_current_indent{current_indent} {
+  m_buffer.reserve(buffer_size);
+}
 
 HtmlWriter::HtmlWriter(std::ostream &out, const HtmlConfig &config)
     : HtmlWriter{out, config.format_html,
                  util::string::repeat(config.html_indent_string,
                                       config.html_indent)} {}
 
+HtmlWriter::~HtmlWriter() {
+  // A stream that threw has failed already; unwinding past it must not write
+  // to it again, and a destructor that throws terminates.
+  if (std::uncaught_exceptions() > 0 || !m_out->good()) {
+    return;
+  }
+  try {
+    flush();
+  } catch (...) {
+  }
+}
+
 void HtmlWriter::write_begin() {
-  out() << "<!DOCTYPE html>\n";
-  out() << "<html>";
+  append_("<!DOCTYPE html>\n");
+  append_("<html>");
 }
 
 void HtmlWriter::write_end() {
   write_new_line();
 
-  out() << "</html>";
+  append_("</html>");
+  flush();
 }
 
 void HtmlWriter::write_header_begin() {
   write_new_line();
   ++m_current_indent;
 
-  out() << "<head>";
+  append_("<head>");
 }
 
 void HtmlWriter::write_header_end() {
   --m_current_indent;
   write_new_line();
 
-  out() << "</head>";
+  append_("</head>");
 }
 
 void HtmlWriter::write_header_title(const std::string &title) {
   write_new_line();
 
-  out() << "<title>" << title << "</title>";
+  append_("<title>");
+  append_(title);
+  append_("</title>");
 }
 
 void HtmlWriter::write_header_meta(const std::string &name,
                                    const std::string &content) {
   write_new_line();
 
-  out() << R"(<meta name=")";
-  out() << name;
-  out() << R"(" content=")";
-  out() << content;
-  out() << R"("/>)";
+  append_(R"(<meta name=")");
+  append_(name);
+  append_(R"(" content=")");
+  append_(content);
+  append_(R"("/>)");
 }
 
 void HtmlWriter::write_header_viewport(const std::string &viewport) {
@@ -179,123 +145,164 @@ void HtmlWriter::write_header_viewport(const std::string &viewport) {
 void HtmlWriter::write_header_target(const std::string &target) {
   write_new_line();
 
-  out() << "<base target=\"";
-  out() << target;
-  out() << "\"/>";
+  append_("<base target=\"");
+  append_(target);
+  append_("\"/>");
 }
 
 void HtmlWriter::write_header_charset(const std::string &charset) {
   write_new_line();
 
-  out() << "<meta charset=\"";
-  out() << charset;
-  out() << "\"/>";
+  append_("<meta charset=\"");
+  append_(charset);
+  append_("\"/>");
 }
 
 void HtmlWriter::write_header_style(const std::string &href,
                                     const std::string_view media) {
   write_new_line();
 
-  out() << R"(<link rel="stylesheet" href=")";
-  out() << href;
-  out() << "\"";
+  append_(R"(<link rel="stylesheet" href=")");
+  append_(href);
+  append_("\"");
   if (!media.empty()) {
-    out() << R"( media=")" << media << "\"";
+    append_(R"( media=")");
+    append_(media);
+    append_("\"");
   }
-  out() << "/>";
+  append_("/>");
 }
 
 void HtmlWriter::write_header_style_begin(const std::string_view media) {
   write_new_line();
   ++m_current_indent;
 
-  out() << "<style";
+  append_("<style");
   if (!media.empty()) {
-    out() << R"( media=")" << media << "\"";
+    append_(R"( media=")");
+    append_(media);
+    append_("\"");
   }
-  out() << ">";
+  append_(">");
 }
 
 void HtmlWriter::write_header_style_end() {
   --m_current_indent;
   write_new_line();
 
-  out() << "</style>";
+  append_("</style>");
 }
 
 void HtmlWriter::write_script(const std::string &src) {
   write_new_line();
 
-  out() << R"(<script type="text/javascript" src=")" << src << "\"></script>";
+  append_(R"(<script type="text/javascript" src=")");
+  append_(src);
+  append_("\"></script>");
 }
 
 void HtmlWriter::write_script_begin() {
   write_new_line();
   ++m_current_indent;
 
-  out() << "<script>";
+  append_("<script>");
 }
 
 void HtmlWriter::write_script_end() {
   --m_current_indent;
   write_new_line();
 
-  out() << "</script>";
+  append_("</script>");
 }
 
 void HtmlWriter::write_body_begin(const HtmlElementOptions &options) {
   write_new_line();
   ++m_current_indent;
 
-  out() << "<body";
-  write_element_options(out(), options);
-  out() << ">";
+  append_("<body");
+  append_element_options_(options);
+  append_(">");
 }
 
 void HtmlWriter::write_body_end() {
   --m_current_indent;
   write_new_line();
 
-  out() << "</body>";
+  append_("</body>");
 }
 
-void HtmlWriter::write_element_begin(const std::string &name,
+void HtmlWriter::write_element_begin(const std::string_view name,
                                      const HtmlElementOptions &options) {
   write_new_line();
   if (options.close_type == HtmlCloseType::standard) {
-    ++m_current_indent;
-    m_stack.push_back({name, options.inline_element});
+    push_(name, options.inline_element);
+  }
+
+  append_("<");
+  append_(name);
+  append_element_options_(options);
+  append_(options.close_type == HtmlCloseType::trailing ? "/>" : ">");
+}
+
+void HtmlWriter::write_tag_begin(const std::string_view name,
+                                 const HtmlTag &tag) {
+  write_new_line();
+  if (tag.close_type == HtmlCloseType::standard) {
+    push_(name, tag.inline_element);
   }
 
-  out() << "<" << name;
-  write_element_options(out(), options);
-  if (options.close_type == HtmlCloseType::trailing) {
-    out() << "/>";
-  } else {
-    out() << ">";
+  append_("<");
+  append_(name);
+  if (!tag.clazz.empty()) {
+    append_(" class=\"");
+    append_(tag.clazz);
+    append_("\"");
+  }
+  if (std::ranges::any_of(tag.style, [](const std::string_view piece) {
+        return !piece.empty();
+      })) {
+    append_(" style=\"");
+    for (const std::string_view piece : tag.style) {
+      append_(piece);
+    }
+    append_("\"");
   }
+  for (const auto &[key, value] : tag.attributes) {
+    append_(" ");
+    append_(key);
+    append_("=\"");
+    append_(value);
+    append_("\"");
+  }
+  append_(tag.close_type == HtmlCloseType::trailing ? "/>" : ">");
 }
 
-void HtmlWriter::write_element_end(const std::string &name) {
+void HtmlWriter::write_element_end(const std::string_view name) {
   --m_current_indent;
   write_new_line();
 
   if (m_stack.empty()) {
     throw std::logic_error("stack is empty");
   }
-  if (m_stack.back().name != name) {
+  const StackElement top = m_stack.back();
+  const std::size_t name_begin =
+      m_stack.size() > 1 ? m_stack[m_stack.size() - 2].name_end : 0;
+  if (std::string_view(m_names).substr(name_begin,
+                                       top.name_end - name_begin) != name) {
     throw std::invalid_argument("names do not match");
   }
   m_stack.pop_back();
+  m_names.resize(name_begin);
+  if (top.inline_element) {
+    --m_inline_depth;
+  }
 
-  out() << "</" << name << ">";
+  append_("</");
+  append_(name);
+  append_(">");
 }
 
-bool HtmlWriter::is_inline_mode() const {
-  return std::ranges::any_of(m_stack, [](const StackElement &element) {
-    return element.inline_element;
-  });
-}
+bool HtmlWriter::is_inline_mode() const { return m_inline_depth > 0; }
 
 void HtmlWriter::write_new_line() {
   if (!m_format) {
@@ -305,20 +312,108 @@ void HtmlWriter::write_new_line() {
     return;
   }
 
-  out() << '\n';
+  append_("\n");
   for (std::uint32_t i = 0; i < m_current_indent; ++i) {
-    out() << m_indent;
+    append_(m_indent);
   }
 }
 
-void HtmlWriter::write_raw(const HtmlWritable &writable, const bool new_line) {
+void HtmlWriter::write_raw(const std::string_view raw, const bool new_line) {
   if (new_line) {
     write_new_line();
   }
 
-  write_writable(out(), writable);
+  append_(raw);
+}
+
+void HtmlWriter::write_text(const std::string_view text) {
+  append_escaped_text(m_buffer, text);
+  if (m_buffer.size() >= buffer_size) {
+    flush();
+  }
+}
+
+void HtmlWriter::flush() {
+  if (m_buffer.empty()) {
+    return;
+  }
+  // dropped even when the stream throws, so it is not handed over again
+  try {
+    m_out->write(m_buffer.data(),
+                 static_cast<std::streamsize>(m_buffer.size()));
+  } catch (...) {
+    m_buffer.clear();
+    throw;
+  }
+  m_buffer.clear();
+}
+
+std::ostream &HtmlWriter::out() {
+  flush();
+  return *m_out;
+}
+
+void HtmlWriter::append_(const std::string_view string) {
+  m_buffer.append(string);
+  if (m_buffer.size() >= buffer_size) {
+    flush();
+  }
+}
+
+void HtmlWriter::append_writable_(const HtmlWritable &writable) {
+  std::visit(overloaded{
+                 [this](const char *str) { append_(str); },
+                 [this](const std::string &str) { append_(str); },
+                 [this](const HtmlWriteCallback &clb) { clb(out()); },
+             },
+             writable);
 }
 
-std::ostream &HtmlWriter::out() { return *m_out; }
+void HtmlWriter::append_element_options_(const HtmlElementOptions &options) {
+  if (options.clazz && !is_empty(*options.clazz)) {
+    append_(" class=\"");
+    append_writable_(*options.clazz);
+    append_("\"");
+  }
+  if (options.style && !is_empty(*options.style)) {
+    append_(" style=\"");
+    append_writable_(*options.style);
+    append_("\"");
+  }
+  if (options.attributes) {
+    const auto append_key_value = [this](const HtmlWritable &key,
+                                         const HtmlWritable &value) {
+      append_(" ");
+      append_writable_(key);
+      append_("=\"");
+      append_writable_(value);
+      append_("\"");
+    };
+    std::visit(overloaded{
+                   [&](const HtmlAttributesVector &vector) {
+                     for (const auto &[key, value] : vector) {
+                       append_key_value(key, value);
+                     }
+                   },
+                   [&](const HtmlAttributeCallback &callback) {
+                     callback(append_key_value);
+                   },
+               },
+               *options.attributes);
+  }
+  if (options.extra) {
+    append_(" ");
+    append_writable_(*options.extra);
+  }
+}
+
+void HtmlWriter::push_(const std::string_view name, const bool inline_element) {
+  ++m_current_indent;
+  m_names.append(name);
+  m_stack.push_back({m_names.size(), inline_element});
+  if (inline_element) {
+    ++m_inline_depth;
+  }
+}
 
 } // namespace odr::internal::html
@@ -2,8 +2,11 @@
 
 #include <odr/html.hpp>
 
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <iosfwd>
+#include <span>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -46,11 +49,43 @@ struct HtmlElementOptions {
   HtmlElementOptions &set_extra(std::optional<HtmlWritable> _extra);
 };
 
+/// An attribute of @ref HtmlTag, written as it is.
+struct HtmlAttribute {
+  std::string_view name;
+  std::string_view value;
+};
+
+/// What @ref HtmlElementOptions says, as views: nothing is allocated or called
+/// back per element. The views only have to live until the tag is written.
+struct HtmlTag {
+  bool inline_element{false};
+  HtmlCloseType close_type{HtmlCloseType::standard};
+
+  /// Left out when empty.
+  std::string_view clazz{};
+  /// Pieces of the one `style` attribute, written one after the other; left
+  /// out when they are all empty.
+  std::array<std::string_view, 3> style{};
+  std::span<const HtmlAttribute> attributes{};
+};
+
+/// Writes html into a buffer of its own, which goes out to the stream as it
+/// fills, on @ref flush, at @ref write_end and when the writer is destroyed.
+/// @ref out flushes before handing out the stream, so what is written through
+/// it stays in order.
+///
+/// @ref write_tag_begin, @ref write_text and @ref write_raw are the path for
+/// the many small elements of a sheet or a pdf page: they take views and append
+/// them to the buffer, with no `std::function`, `std::variant` or stream
+/// operator in between.
 class HtmlWriter {
 public:
   HtmlWriter(std::ostream &out, bool format, std::string indent,
              std::uint32_t current_indent = 0);
   HtmlWriter(std::ostream &out, const HtmlConfig &config);
+  HtmlWriter(const HtmlWriter &) = delete;
+  HtmlWriter &operator=(const HtmlWriter &) = delete;
+  ~HtmlWriter();
 
   void write_begin();
   void write_end();
@@ -74,19 +109,28 @@ public:
   void write_body_begin(const HtmlElementOptions &options = {});
   void write_body_end();
 
-  void write_element_begin(const std::string &name,
+  void write_element_begin(std::string_view name,
                            const HtmlElementOptions &options = {});
-  void write_element_end(const std::string &name);
+  /// @ref write_element_begin for an @ref HtmlTag; closed the same way.
+  void write_tag_begin(std::string_view name, const HtmlTag &tag = {});
+  void write_element_end(std::string_view name);
 
   [[nodiscard]] bool is_inline_mode() const;
   void write_new_line();
-  void write_raw(const HtmlWritable &writable, bool new_line = true);
-
+  /// @p raw as it is.
+  void write_raw(std::string_view raw, bool new_line = true);
+  /// @p text escaped as @ref escape_text does.
+  void write_text(std::string_view text);
+
+  /// Hands what is buffered to the stream.
+  void flush();
+  /// The stream, with everything written so far on it.
   std::ostream &out();
 
 private:
   struct StackElement {
-    std::string name;
+    /// where the name ends in `m_names`
+    std::size_t name_end{0};
     bool inline_element{false};
   };
 
@@ -95,6 +139,16 @@ private:
   std::string m_indent;
   std::uint32_t m_current_indent{0};
   std::vector<StackElement> m_stack;
+  /// the names of the open elements, one after the other
+  std::string m_names;
+  /// how many of the open elements are inline
+  std::size_t m_inline_depth{0};
+  std::string m_buffer;
+
+  void append_(std::string_view string);
+  void append_writable_(const HtmlWritable &writable);
+  void append_element_options_(const HtmlElementOptions &options);
+  void push_(std::string_view name, bool inline_element);
 };
 
 } // namespace odr::internal::html
@@ -6,7 +6,10 @@
 
 #include <odr/internal/abstract/file.hpp>
 #include <odr/internal/abstract/font.hpp>
+#include <odr/internal/common/null_stream.hpp>
+#include <odr/internal/common/ordered_task_queue.hpp>
 #include <odr/internal/common/path.hpp>
+#include <odr/internal/crypto/crypto_util.hpp>
 #include <odr/internal/font/cff_font.hpp>
 #include <odr/internal/font/cff_transform.hpp>
 #include <odr/internal/font/sfnt_font.hpp>
@@ -28,11 +31,15 @@
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <charconv>
 #include <cmath>
 #include <functional>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <span>
 #include <sstream>
 #include <string>
@@ -280,6 +287,27 @@ std::vector<LinkOut> collect_page_links(const pdf::Page &page,
   return links;
 }
 
+/// A page's `id="pN"`, the anchor `#pN` links scroll to, formatted in place.
+class PageId final {
+public:
+  explicit PageId(const std::size_t number) {
+    char *end = std::to_chars(m_value.data() + 1,
+                              m_value.data() + m_value.size(), number)
+                    .ptr;
+    m_attribute = {"id", std::string_view(m_value.data(), end)};
+  }
+  PageId(const PageId &) = delete;
+  PageId &operator=(const PageId &) = delete;
+
+  [[nodiscard]] std::span<const HtmlAttribute> attributes() const {
+    return {&m_attribute, 1};
+  }
+
+private:
+  std::array<char, 24> m_value{'p'};
+  HtmlAttribute m_attribute;
+};
+
 /// Write a page's link overlays as absolutely-positioned `<a>` elements (in
 /// page-box points, matching the text layer's unit).
 void write_page_links(HtmlWriter &out, const std::vector<LinkOut> &links) {
@@ -616,6 +644,156 @@ std::string svg_path_fragment(const pdf::PathElement &path,
   return std::move(f).str();
 }
 
+/// Where the linked images and fonts are named, see @ref AssetUrls.
+constexpr std::string_view asset_directory = "pdf/";
+
+/// Whether @p path has the shape of a name @ref AssetUrls gives: the 40 hex
+/// digits of a sha1 and an extension in @ref asset_directory.
+bool is_asset_path(const std::string_view path) {
+  if (!path.starts_with(asset_directory)) {
+    return false;
+  }
+  const std::string_view name = path.substr(asset_directory.size());
+  constexpr std::size_t digits = 40;
+  if (name.size() <= digits + 1 || name[digits] != '.') {
+    return false;
+  }
+  return std::ranges::all_of(name.substr(0, digits),
+                             [](const char c) {
+                               return std::isxdigit(
+                                          static_cast<unsigned char>(c)) != 0;
+                             }) &&
+         std::ranges::all_of(name.substr(digits + 1), [](const char c) {
+           return std::isalnum(static_cast<unsigned char>(c)) != 0;
+         });
+}
+
+/// The images and fonts the renders so far have linked, by location: least
+/// recently used first out under a byte budget. The view that linked each is
+/// kept regardless, so one evicted since can be written again from it.
+///
+/// Every member is safe to call concurrently.
+class AssetCache {
+public:
+  static constexpr std::size_t default_budget = 64 * 1024 * 1024;
+
+  explicit AssetCache(const std::size_t budget = default_budget)
+      : m_budget{budget} {}
+
+  [[nodiscard]] std::optional<odr::HtmlResource>
+  find(const std::string &location) {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_index.find(location);
+    if (it == m_index.end()) {
+      return std::nullopt;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->resource;
+  }
+
+  /// Caches @p resource of @p size bytes, then evicts until the budget holds
+  /// again; one alone over budget is handed out but not kept. Should a
+  /// resource be cached at @p location already, that one is returned instead.
+  odr::HtmlResource insert(const std::string &location,
+                           odr::HtmlResource resource, const std::size_t size) {
+    std::lock_guard lock(m_mutex);
+    if (const auto it = m_index.find(location); it != m_index.end()) {
+      return it->second->resource;
+    }
+    m_entries.push_front({location, resource, size});
+    m_index.emplace(location, m_entries.begin());
+    m_bytes += size;
+    while (m_bytes > m_budget && !m_entries.empty()) {
+      m_bytes -= m_entries.back().size;
+      m_index.erase(m_entries.back().location);
+      m_entries.pop_back();
+    }
+    return resource;
+  }
+
+  void set_view(const std::string &location, const std::string &view) {
+    std::lock_guard lock(m_mutex);
+    m_view_by_location.insert_or_assign(location, view);
+  }
+
+  /// The view that last linked @p location.
+  [[nodiscard]] std::optional<std::string> view(const std::string &location) {
+    std::lock_guard lock(m_mutex);
+    if (const auto it = m_view_by_location.find(location);
+        it != m_view_by_location.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+private:
+  struct Entry {
+    std::string location;
+    odr::HtmlResource resource;
+    std::size_t size{0};
+  };
+
+  std::mutex m_mutex;
+  std::size_t m_budget{0};
+  std::size_t m_bytes{0};
+  /// most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  std::unordered_map<std::string, std::string> m_view_by_location;
+};
+
+/// The images and fonts of one render, as the urls the pages draw them from.
+/// While the config embeds images they are data urls. Otherwise every distinct
+/// content becomes one resource, named by its hash in @ref asset_directory:
+/// the service serves it, and an image on every page is written and cached
+/// once.
+class AssetUrls {
+public:
+  AssetUrls(const HtmlConfig &config, HtmlResources &resources,
+            AssetCache &cache)
+      : m_config{&config}, m_resources{&resources}, m_cache{&cache} {}
+
+  /// `data` of `mime` as a url. A resource is listed in the render's resources
+  /// the first time it is used.
+  std::string url(const HtmlResourceType type, const std::string &data,
+                  const std::string &mime) {
+    if (m_config->embed_images || data.empty()) {
+      return file_to_url(data, mime);
+    }
+
+    std::string extension = mime.substr(mime.find('/') + 1);
+    if (extension == "jpeg") {
+      extension = "jpg";
+    }
+    const std::string path =
+        std::string(asset_directory) +
+        crypto::util::hex_encode(crypto::util::sha1(data)) + "." + extension;
+
+    auto it = m_location_by_path.find(path);
+    if (it == m_location_by_path.end()) {
+      odr::HtmlResource resource =
+          HtmlResource::create(type, mime, path, path, File::from_memory(data),
+                               false, false, true);
+      HtmlResourceLocation location =
+          m_config->resource_locator(resource, *m_config);
+      if (location.has_value()) {
+        // one copy of the bytes for every render that links them
+        resource = m_cache->insert(*location, std::move(resource), data.size());
+        m_resources->emplace_back(std::move(resource), location);
+      }
+      it = m_location_by_path.emplace(path, std::move(location)).first;
+    }
+    return it->second.has_value() ? *it->second : file_to_url(data, mime);
+  }
+
+private:
+  const HtmlConfig *m_config;
+  HtmlResources *m_resources;
+  AssetCache *m_cache;
+  /// what each path resolved to in this render, so its resource is listed once
+  std::unordered_map<std::string, HtmlResourceLocation> m_location_by_path;
+};
+
 /// An image XObject as an SVG `<image>` fragment in the page viewBox, or ""
 /// when it carries no pass-through bytes. The image fills the unit square in
 /// user space (ISO 32000-1 8.10.5), flipped vertically because its first row is
@@ -624,7 +802,7 @@ std::string svg_path_fragment(const pdf::PathElement &path,
 /// would resolve in the image's post-transform unit-square space instead.
 std::string svg_image_fragment(const pdf::ImageElement &image,
                                const util::math::Transform2D &to_box,
-                               const std::string &clip_id) {
+                               const std::string &clip_id, AssetUrls &assets) {
   if (image.data.empty()) {
     return {};
   }
@@ -645,7 +823,8 @@ std::string svg_image_fragment(const pdf::ImageElement &image,
       !blend.empty()) {
     f << " style=\"mix-blend-mode:" << blend << '"';
   }
-  f << " href=\"" << file_to_url(image.data, image.mime) << "\"/>";
+  f << " href=\"" << assets.url(HtmlResourceType::image, image.data, image.mime)
+    << "\"/>";
   if (!clip_id.empty()) {
     f << "</g>";
   }
@@ -812,7 +991,7 @@ public:
   std::string register_pattern(const pdf::Pattern &pattern,
                                const util::math::Transform2D &m,
                                const pdf::GraphicsState::Color &fill_color,
-                               const Logger &logger) {
+                               AssetUrls &assets, const Logger &logger) {
     if (pattern.resources == nullptr || pattern.content.empty() ||
         pattern.x_step == 0 || pattern.y_step == 0) {
       return {};
@@ -842,7 +1021,8 @@ public:
         }
         tile << svg_path_fragment(painted, util::math::Transform2D(), "", "");
       } else if (const auto *image = std::get_if<pdf::ImageElement>(&element)) {
-        tile << svg_image_fragment(*image, util::math::Transform2D(), "");
+        tile << svg_image_fragment(*image, util::math::Transform2D(), "",
+                                   assets);
       }
     }
 
@@ -883,7 +1063,8 @@ std::string render_graphic_fragment(const pdf::PageElement &element,
                                     ClipRegistry &clips,
                                     GradientRegistry &gradients,
                                     PatternRegistry &patterns,
-                                    MaskRegistry &masks, const Logger &logger);
+                                    MaskRegistry &masks, AssetUrls &assets,
+                                    const Logger &logger);
 
 /// A page's soft masks (`/SMask`, ISO 32000-1 11.6.5.2) as `<mask>` defs
 /// (`m<page>_<n>`). The extractor has already rendered each mask's transparency
@@ -897,13 +1078,15 @@ public:
                             const util::math::Transform2D &to_box,
                             const double width, const double height,
                             ClipRegistry &clips, GradientRegistry &gradients,
-                            PatternRegistry &patterns, const Logger &logger) {
+                            PatternRegistry &patterns, AssetUrls &assets,
+                            const Logger &logger) {
     // A fresh `SoftMask` is built for every `gs`, but many are identical (one
     // drop-shadow across a run of glyphs); dedupe on the rendered body.
     std::ostringstream body;
     for (const pdf::PageElement &element : mask.group) {
       body << render_graphic_fragment(element, to_box, width, height, clips,
-                                      gradients, patterns, *this, logger);
+                                      gradients, patterns, *this, assets,
+                                      logger);
     }
     std::string signature = mask.type == pdf::SoftMask::Type::alpha ? "A" : "L";
     if (mask.backdrop.has_value()) {
@@ -944,14 +1127,14 @@ std::string wrap_effects(std::string fragment, const double alpha,
                          const double width, const double height,
                          ClipRegistry &clips, GradientRegistry &gradients,
                          PatternRegistry &patterns, MaskRegistry &masks,
-                         const Logger &logger) {
+                         AssetUrls &assets, const Logger &logger) {
   if (fragment.empty()) {
     return fragment;
   }
   std::string mask_id;
   if (soft_mask != nullptr) {
     mask_id = masks.register_mask(*soft_mask, to_box, width, height, clips,
-                                  gradients, patterns, logger);
+                                  gradients, patterns, assets, logger);
   }
   const std::string blend = blend_mode_to_css(blend_mode);
   if (alpha >= 1 && mask_id.empty() && blend.empty()) {
@@ -978,13 +1161,14 @@ std::string render_graphic_fragment(const pdf::PageElement &element,
                                     ClipRegistry &clips,
                                     GradientRegistry &gradients,
                                     PatternRegistry &patterns,
-                                    MaskRegistry &masks, const Logger &logger) {
+                                    MaskRegistry &masks, AssetUrls &assets,
+                                    const Logger &logger) {
   const auto wrap_mask =
       [&](std::string fragment,
           const std::shared_ptr<const pdf::SoftMask> &soft_mask) {
         return wrap_effects(std::move(fragment), 1.0, soft_mask, "", to_box,
                             width, height, clips, gradients, patterns, masks,
-                            logger);
+                            assets, logger);
       };
   if (const auto *path = std::get_if<pdf::PathElement>(&element)) {
     const std::string clip_id = clips.register_clip(path->clip, to_box);
@@ -995,7 +1179,7 @@ std::string render_graphic_fragment(const pdf::PageElement &element,
     } else if (path->fill_pattern != nullptr) {
       fill_url_id = patterns.register_pattern(*path->fill_pattern,
                                               path->pattern_transform * to_box,
-                                              path->fill_color, logger);
+                                              path->fill_color, assets, logger);
     }
     return wrap_mask(svg_path_fragment(*path, to_box, clip_id, fill_url_id),
                      path->soft_mask);
@@ -1013,7 +1197,7 @@ std::string render_graphic_fragment(const pdf::PageElement &element,
   }
   if (const auto *image = std::get_if<pdf::ImageElement>(&element)) {
     const std::string clip_id = clips.register_clip(image->clip, to_box);
-    return wrap_mask(svg_image_fragment(*image, to_box, clip_id),
+    return wrap_mask(svg_image_fragment(*image, to_box, clip_id, assets),
                      image->soft_mask);
   }
   if (const auto *group = std::get_if<pdf::GroupElement>(&element)) {
@@ -1023,11 +1207,12 @@ std::string render_graphic_fragment(const pdf::PageElement &element,
     std::string inner;
     for (const pdf::PageElement &child : group->children->elements) {
       inner += render_graphic_fragment(child, to_box, width, height, clips,
-                                       gradients, patterns, masks, logger);
+                                       gradients, patterns, masks, assets,
+                                       logger);
     }
     return wrap_effects(std::move(inner), group->alpha, group->soft_mask,
                         group->blend_mode, to_box, width, height, clips,
-                        gradients, patterns, masks, logger);
+                        gradients, patterns, masks, assets, logger);
   }
   return {};
 }
@@ -1152,9 +1337,12 @@ public:
 
     const auto &pdf_file =
         dynamic_cast<const pdf::PdfFile &>(*m_pdf_file.impl());
-    m_parser =
-        std::make_unique<pdf::DocumentParser>(pdf_file.create_parser(m_logger));
-    m_document = m_parser->parse_document();
+    m_parser = pdf_file.create_parser(m_logger);
+    m_parser->set_png_options(
+        {config().png_compression_level, config().render_threads});
+    // Pages resolve their resources as they are extracted, so a page range of
+    // a large file costs what those pages use.
+    m_document = m_parser->parse_document(pdf::ResourceLoading::lazy);
 
     const std::vector<pdf::Page *> pages = m_document->collect_pages();
     m_link_resolver = std::make_unique<LinkResolver>(
@@ -1192,7 +1380,8 @@ public:
   }
 
   [[nodiscard]] bool exists(const std::string &path) const override {
-    return is_view(path) || resource_at(m_resources, path) != nullptr;
+    return is_view(path) || resource_at(m_resources, path) != nullptr ||
+           asset_at_(path).has_value();
   }
 
   [[nodiscard]] std::string mimetype(const std::string &path) const override {
@@ -1203,14 +1392,23 @@ public:
         resource != nullptr) {
       return resource->mime_type();
     }
+    if (const std::optional<odr::HtmlResource> asset = asset_at_(path)) {
+      return asset->mime_type();
+    }
     throw FileNotFound("Unknown path: " + path);
   }
 
   void write(const std::string &path, std::ostream &out) const override {
-    if (const odr::HtmlResource *resource = resource_at(m_resources, path);
-        !is_view(path) && resource != nullptr) {
-      resource->write_resource(out);
-      return;
+    if (!is_view(path)) {
+      if (const odr::HtmlResource *resource = resource_at(m_resources, path);
+          resource != nullptr) {
+        resource->write_resource(out);
+        return;
+      }
+      if (const std::optional<odr::HtmlResource> asset = asset_at_(path)) {
+        asset->write_resource(out);
+        return;
+      }
     }
     HtmlWriter writer(out, config());
     write_html(path, writer);
@@ -1218,19 +1416,14 @@ public:
 
   HtmlResources write_html(const std::string &path,
                            HtmlWriter &out) const override {
-    warmup();
-    // The parser's object cache is shared mutable state; renders are
-    // serialized.
-    std::lock_guard lock(m_mutex);
-    if (path == config().document_output_file_name) {
-      return write_document(out);
-    }
-    for (std::size_t i = 0; i < m_pages.size(); ++i) {
-      if (path == m_views[i + 1].path()) {
-        return write_page(i, out);
+    HtmlResources resources = write_view_(path, out);
+    for (const auto &[resource, location] : resources) {
+      if (location.has_value() &&
+          resource.path().starts_with(asset_directory)) {
+        m_assets.set_view(*location, path);
       }
     }
-    throw FileNotFound("Unknown path: " + path);
+    return resources;
   }
 
   /// Whether the 0-based page index falls inside the rendered page range.
@@ -1318,6 +1511,18 @@ public:
     std::vector<SelRunOut> runs;
   };
 
+  /// A page's content streams, decoded and joined, its resources resolved.
+  /// Safe to call from the render workers.
+  [[nodiscard]] std::string page_content(pdf::Page &page) const {
+    m_parser->resolve_page(page);
+    std::string result;
+    for (const auto &reference : page.contents_reference) {
+      result += m_parser->read_decoded_stream(reference);
+      result += '\n';
+    }
+    return result;
+  }
+
   struct DualPageOut {
     std::string classes;
     double width{0};
@@ -1334,8 +1539,8 @@ public:
                                        const PageHref &page_href) const {
     HtmlResources resources;
     const WritingState state(out, config(), resources);
+    AssetUrls assets(config(), resources, m_assets);
 
-    pdf::DocumentParser &parser = *m_parser;
     LinkResolver &link_resolver = *m_link_resolver;
 
     AtomicStyles styles;
@@ -1350,6 +1555,8 @@ public:
     std::vector<const pdf::Font *> accepted_fonts;
     // Which classes are used: [0]=fv (visible), [1]=fn (invisible).
     std::vector<std::array<bool, 2>> font_class_used;
+    // The glyphs each font paints, which its subset keeps.
+    std::vector<std::set<std::uint16_t>> used_glyphs;
     std::unordered_map<const pdf::Font *, std::uint32_t> family_index;
 
     const auto font_family = [&](const pdf::Font *font) {
@@ -1357,6 +1564,7 @@ public:
                          [&](std::uint32_t) {
                            accepted_fonts.push_back(font);
                            font_class_used.push_back({false, false});
+                           used_glyphs.emplace_back();
                          });
     };
 
@@ -1384,6 +1592,13 @@ public:
       }
     };
 
+    // Extraction runs ahead on the workers; everything that numbers classes,
+    // fonts or ids stays on this thread, in page order.
+    OrderedTaskQueue<std::vector<pdf::PageElement>> extracted(
+        pages.size(), config().render_threads, [&](const std::size_t i) {
+          return page_elements(*pages[i], page_content(*pages[i]), m_logger);
+        });
+
     for (pdf::Page *page : pages) {
       const PageBox pb = begin_page(*page, add_class);
       const double width = pb.width;
@@ -1394,15 +1609,11 @@ public:
       page_out.classes = pb.classes;
       page_out.width = width;
       page_out.height = height;
+      // extracting resolves the page, annotations included
+      const std::vector<pdf::PageElement> elements = extracted.next();
       page_out.links =
           collect_page_links(*page, to_box, link_resolver, page_href);
 
-      std::string stream;
-      for (const auto &ref : page->contents_reference) {
-        stream += parser.read_decoded_stream(ref);
-        stream += '\n';
-      }
-
       ClipRegistry clips(static_cast<std::uint32_t>(pages_out.size()));
       GradientRegistry gradients(static_cast<std::uint32_t>(pages_out.size()));
       PatternRegistry patterns(static_cast<std::uint32_t>(pages_out.size()));
@@ -1438,11 +1649,10 @@ public:
       /// gap no spacer took
       double sel_pending_space = 0;
 
-      for (const pdf::PageElement &element :
-           page_elements(*page, stream, m_logger)) {
+      for (const pdf::PageElement &element : elements) {
         if (handle_graphic_element(
                 element, to_box, width, height, clips, gradients, patterns,
-                masks, m_logger, [&] { vis_close_line(); },
+                masks, assets, m_logger, [&] { vis_close_line(); },
                 [&](std::string frag) {
                   page_out.vis_items.push_back(PathOut{std::move(frag)});
                 })) {
@@ -1519,7 +1729,8 @@ public:
           if (font != 0) {
             // Not `escape_text`: its `&nbsp;` is a different character, which
             // `word-spacing` does not move.
-            run_text = escape_markup(glyph_run_str(*text.font, text.codes));
+            run_text = escape_markup(
+                glyph_run_str(*text.font, text.codes, used_glyphs[font - 1]));
           } else {
             // `margin-left` already spans the word break; rendering it too
             // shifts the glyphs by a space, once per run.
@@ -1713,8 +1924,8 @@ public:
 
     // Post-pass: re-encode accepted fonts PUA-only.
     for (std::uint32_t i = 0; i < family_count; ++i) {
-      write_font_face(*accepted_fonts[i], i, {}, font_class_used[i], font_faces,
-                      font_styles);
+      write_font_face(*accepted_fonts[i], i, {}, std::move(used_glyphs[i]),
+                      font_class_used[i], assets, font_faces, font_styles);
     }
     substitute_faces.append_faces(font_faces);
 
@@ -1722,7 +1933,7 @@ public:
     write_header_common(state, font_faces, font_styles, styles, content, [&] {
       // Visual layer glyph spans: not selectable (selection rides the `.sel`
       // layer).
-      out.out() << ".g{user-select:none}";
+      out.write_raw(".g{user-select:none}", false);
       // Selection-layer fallback font: `size-adjust` shrinks a local system
       // font under the PDF-derived `.sr`/`.sg` widths. CSS justify only ever
       // *adds* spacing, so undershooting is free while overshooting overflows
@@ -1751,32 +1962,32 @@ public:
                               0.0, 1.0) *
                    100.0);
         ff << ";size-adjust:" << adjust_pct << "%}";
-        out.out() << std::move(ff).str();
+        out.write_raw(std::move(ff).str(), false);
       }
       // Transparent text for the selection layer line blocks.
-      out.out() << ".i{color:transparent;font-family:sf,sans-serif}";
+      out.write_raw(".i{color:transparent;font-family:sf,sans-serif}", false);
       // Selection-layer run span. `overflow:hidden` clips a wider system font;
       // `.t`'s inherited `pre` blocks wrapping while preserving a run's own
       // leading/trailing space, which is real PDF content.
-      out.out() << ".sr{display:inline-block;text-align:justify;"
-                   "text-align-last:justify;text-justify:inter-character;"
-                   "overflow:hidden}";
+      out.write_raw(".sr{display:inline-block;text-align:justify;"
+                    "text-align-last:justify;text-justify:inter-character;"
+                    "overflow:hidden}",
+                    false);
       // Selection-layer gap spacer. `overflow:hidden` matches `.sr`: an
       // inline-block baseline-aligns to its bottom margin edge only when
       // overflow isn't visible, so without it the spacer shifts in y.
-      out.out() << ".sg{display:inline-block;overflow:hidden}";
+      out.write_raw(".sg{display:inline-block;overflow:hidden}", false);
       // A lone space cannot be justified to its box, so pad the advance and let
       // the width clip it: else every word break shows a sliver of white.
-      out.out() << ".sw{letter-spacing:1000pt}";
+      out.write_raw(".sw{letter-spacing:1000pt}", false);
     });
 
     const auto write_vis_line = [&](const VisLineOut &line) {
-      out.write_element_begin(
-          "div", HtmlElementOptions().set_inline(true).set_class(line.classes));
+      out.write_tag_begin("div",
+                          {.inline_element = true, .clazz = line.classes});
       for (const VisRunOut &run : line.runs) {
-        out.write_element_begin(
-            "span",
-            HtmlElementOptions().set_inline(true).set_class(run.classes));
+        out.write_tag_begin("span",
+                            {.inline_element = true, .clazz = run.classes});
         out.write_raw(run.text);
         out.write_element_end("span");
       }
@@ -1784,12 +1995,11 @@ public:
     };
 
     const auto write_sel_line = [&](const SelLineOut &line) {
-      out.write_element_begin(
-          "div", HtmlElementOptions().set_inline(true).set_class(line.classes));
+      out.write_tag_begin("div",
+                          {.inline_element = true, .clazz = line.classes});
       for (const SelRunOut &run : line.runs) {
-        out.write_element_begin(
-            "span",
-            HtmlElementOptions().set_inline(true).set_class(run.classes));
+        out.write_tag_begin("span",
+                            {.inline_element = true, .clazz = run.classes});
         if (!run.text.empty()) {
           out.write_raw(run.text);
         }
@@ -1799,25 +2009,22 @@ public:
     };
 
     out.write_body_begin();
-    out.write_element_begin("div", HtmlElementOptions().set_class("d"));
+    out.write_tag_begin("div", {.clazz = "d"});
     std::size_t page_number = first_page_number;
     for (const DualPageOut &page : pages_out) {
-      out.write_element_begin(
-          "div",
-          HtmlElementOptions()
-              .set_class(page.classes)
-              .set_extra(R"(id="p)" + std::to_string(page_number++) + R"(")"));
+      const PageId id(page_number++);
+      out.write_tag_begin(
+          "div", {.clazz = page.classes, .attributes = id.attributes()});
 
       // Visual layer: paint-order graphics and unselectable glyphs.
-      out.write_element_begin("div",
-                              HtmlElementOptions().set_class("vis").set_extra(
-                                  R"(aria-hidden="true")"));
+      static constexpr HtmlAttribute hidden[]{{"aria-hidden", "true"}};
+      out.write_tag_begin("div", {.clazz = "vis", .attributes = hidden});
       write_page_items(out, page.clip_defs, page.vis_items, page.width,
                        page.height, write_vis_line);
       out.write_element_end("div"); // .vis
 
       // Selection layer: transparent, selectable Unicode in reading order.
-      out.write_element_begin("div", HtmlElementOptions().set_class("sel"));
+      out.write_tag_begin("div", {.clazz = "sel"});
       for (const SelLineOut &line : page.sel_lines) {
         write_sel_line(line);
       }
@@ -1887,8 +2094,8 @@ public:
       const std::size_t first_page_number, const PageHref &page_href) const {
     HtmlResources resources;
     const WritingState state(out, config(), resources);
+    AssetUrls assets(config(), resources, m_assets);
 
-    pdf::DocumentParser &parser = *m_parser;
     LinkResolver &link_resolver = *m_link_resolver;
 
     // A real-Unicode scalar gets a cmap entry only inside the BMP and outside
@@ -1917,6 +2124,9 @@ public:
     std::vector<std::map<char32_t, std::uint16_t>> used_unicode;
     // Which per-font classes are used: [0]=fv (visible), [1]=fn (invisible).
     std::vector<std::array<bool, 2>> font_class_used;
+    // The glyphs each font's PUA runs paint, which its subset keeps beside
+    // the `used_unicode` ones.
+    std::vector<std::set<std::uint16_t>> used_glyphs;
     std::unordered_map<const pdf::Font *, std::uint32_t> family_index;
 
     const auto font_family = [&](pdf::Font *font) {
@@ -1926,6 +2136,7 @@ public:
                            glyph_freq.emplace_back();
                            used_unicode.emplace_back();
                            font_class_used.push_back({false, false});
+                           used_glyphs.emplace_back();
                          });
     };
 
@@ -1940,22 +2151,26 @@ public:
     // Build the page streams once (reused for both the pre-pass and main pass).
     std::vector<std::string> page_streams;
     page_streams.reserve(pages.size());
-    for (pdf::Page *page : pages) {
-      std::string stream;
-      for (const auto &ref : page->contents_reference) {
-        stream += parser.read_decoded_stream(ref);
-        stream += '\n';
+    {
+      OrderedTaskQueue<std::string> decoded(
+          pages.size(), config().render_threads,
+          [&](const std::size_t i) { return page_content(*pages[i]); });
+      for (std::size_t pi = 0; pi < pages.size(); ++pi) {
+        page_streams.push_back(decoded.next());
       }
-      page_streams.push_back(std::move(stream));
     }
+    // Both passes extract on the workers and intern on this thread, in order.
+    const auto extract = [&](const std::size_t i) {
+      return page_elements(*pages[i], page_streams[i], m_logger);
+    };
 
     // ---- Pre-pass: frequency analysis ------------------------------------
     // Every page is extracted twice (here and in the main pass): re-parsing an
     // already-decoded stream is cheaper than buffering every page's elements.
+    OrderedTaskQueue<std::vector<pdf::PageElement>> pre_extracted(
+        pages.size(), config().render_threads, extract);
     for (std::size_t pi = 0; pi < pages.size(); ++pi) {
-      const pdf::Page &page = *pages[pi];
-      for (const pdf::PageElement &element :
-           page_elements(page, page_streams[pi], m_logger)) {
+      for (const pdf::PageElement &element : pre_extracted.next()) {
         const auto *text = std::get_if<pdf::TextElement>(&element);
         if (text == nullptr || text->text.empty() || text->font == nullptr) {
           continue;
@@ -2002,6 +2217,8 @@ public:
     std::vector<SinglePageOut> pages_out;
     pages_out.reserve(pages.size());
 
+    OrderedTaskQueue<std::vector<pdf::PageElement>> extracted(
+        pages.size(), config().render_threads, extract);
     for (std::size_t pi = 0; pi < pages.size(); ++pi) {
       const pdf::Page &page = *pages[pi];
       const PageBox pb = begin_page(page, add_class);
@@ -2029,11 +2246,10 @@ public:
       double prev_font_pt = 0;
       const auto close_line = [&] { cur_line = -1; };
 
-      for (const pdf::PageElement &element :
-           page_elements(page, page_streams[pi], m_logger)) {
+      for (const pdf::PageElement &element : extracted.next()) {
         if (handle_graphic_element(
                 element, to_box, width, height, clips, gradients, patterns,
-                masks, m_logger, [&] { close_line(); },
+                masks, assets, m_logger, [&] { close_line(); },
                 [&](std::string frag) {
                   page_out.items.push_back(SinglePathOut{std::move(frag)});
                 })) {
@@ -2097,7 +2313,8 @@ public:
             run.text = escape_markup(
                 std::string(core_text_begin(text), text.text.end()));
           } else {
-            run.glyph_data = glyph_run_str(*text.font, text.codes);
+            run.glyph_data =
+                glyph_run_str(*text.font, text.codes, used_glyphs[font - 1]);
             run.text = escape_markup(text.text); // overlay (empty=no_unicode)
           }
         }
@@ -2189,7 +2406,8 @@ public:
     // ---- Post-pass: re-encode fonts with frequency-winner cmap entries ---
     for (std::uint32_t i = 0; i < family_count; ++i) {
       write_font_face(*accepted_fonts[i], i, used_unicode[i],
-                      font_class_used[i], font_faces, font_styles);
+                      std::move(used_glyphs[i]), font_class_used[i], assets,
+                      font_faces, font_styles);
     }
     substitute_faces.append_faces(font_faces);
 
@@ -2197,32 +2415,38 @@ public:
     const std::optional<double> content = content_pixels(pages_out);
     write_header_common(state, font_faces, font_styles, styles, content, [&] {
       // Invisible text render modes (Tr 3/7).
-      out.out() << ".i{color:transparent}";
+      out.write_raw(".i{color:transparent}", false);
       // Unclean glyphs via generated content, out of the DOM text stream.
-      out.out() << ".gl::before{content:attr(data-g)}";
+      out.write_raw(".gl::before{content:attr(data-g)}", false);
       // The real Unicode of an unclean run: invisible and zero-width, but still
       // found and selected in reading order. `inline-block` is what lets
       // `width:0` apply at all.
-      out.out() << ".ov{display:inline-block;width:0;overflow:hidden;"
-                   "color:transparent;vertical-align:baseline}";
+      out.write_raw(".ov{display:inline-block;width:0;overflow:hidden;"
+                    "color:transparent;vertical-align:baseline}",
+                    false);
       // Width-bearing selectable space for a recovered word break: a real `" "`
       // sized to the gap by a `wN` class, copyable *and* carrying the advance.
       // Deliberately no `overflow:hidden`: it would move the inline-block's
       // baseline to its bottom margin edge and highlight the space at the wrong
       // height, while clipping nothing (the space is transparent).
-      out.out() << ".sp{display:inline-block;"
-                   "color:transparent;vertical-align:baseline}";
+      out.write_raw(".sp{display:inline-block;"
+                    "color:transparent;vertical-align:baseline}",
+                    false);
       // A hit in the overlay is clipped away with it, so the glyphs it belongs
       // to carry the highlight instead - the whole run of them, which is as
       // narrow as the overlay can say.
-      out.out() << ".gl:has(+.ov mark){background:#ff0;"
-                   "mix-blend-mode:multiply}";
-      out.out() << ".gl:has(+.ov mark.current){background:orange}";
+      out.write_raw(".gl:has(+.ov mark){background:#ff0;"
+                    "mix-blend-mode:multiply}",
+                    false);
+      out.write_raw(".gl:has(+.ov mark.current){background:orange}", false);
     });
 
     // A run's span class: `head` plus its optional margin-left and colour.
-    const auto run_class = [](const SingleRunOut &run, const char *head) {
-      std::string cls = head;
+    // One buffer for every class list built below, reused line to line.
+    std::string cls;
+    const auto run_class = [&cls](const SingleRunOut &run,
+                                  const std::string_view head) {
+      cls.assign(head);
       const auto add = [&](const std::string &t) {
         if (t.empty()) {
           return;
@@ -2234,17 +2458,16 @@ public:
       };
       add(run.margin);
       add(run.color);
-      return cls;
+      return std::string_view(cls);
     };
 
     const auto write_line = [&](const SingleLineOut &line) {
-      std::string classes = line.classes;
+      cls.assign(line.classes);
       if (!line.font_class.empty()) {
-        classes += ' ';
-        classes += line.font_class;
+        cls += ' ';
+        cls += line.font_class;
       }
-      out.write_element_begin(
-          "div", HtmlElementOptions().set_inline(true).set_class(classes));
+      out.write_tag_begin("div", {.inline_element = true, .clazz = cls});
       for (const SingleRunOut &run : line.runs) {
         if (run.glyph_data.empty()) {
           // Clean / invisible / fallback: real Unicode renders directly.
@@ -2252,36 +2475,35 @@ public:
             // With a `wN` width the space carries the gap; without one it is a
             // zero-width `.ov` (line-leading or negative gap) that cannot shift
             // the glyphs under `white-space:pre`.
-            const std::string space_cls = run.lead_space_width.empty()
-                                              ? std::string("ov")
-                                              : "sp " + run.lead_space_width;
-            out.write_element_begin(
-                "span",
-                HtmlElementOptions().set_inline(true).set_class(space_cls));
+            if (run.lead_space_width.empty()) {
+              cls.assign("ov");
+            } else {
+              cls.assign("sp ").append(run.lead_space_width);
+            }
+            out.write_tag_begin("span",
+                                {.inline_element = true, .clazz = cls});
             out.write_raw(" ");
             out.write_element_end("span");
           }
-          const std::string cls = run_class(run, "");
-          if (cls.empty()) {
+          if (const std::string_view run_cls = run_class(run, "");
+              run_cls.empty()) {
             out.write_raw(run.text);
           } else {
-            out.write_element_begin(
-                "span", HtmlElementOptions().set_inline(true).set_class(cls));
+            out.write_tag_begin("span",
+                                {.inline_element = true, .clazz = run_cls});
             out.write_raw(run.text);
             out.write_element_end("span");
           }
         } else {
           // Unclean: glyph via generated content, real-unicode overlay.
-          out.write_element_begin(
-              "span", HtmlElementOptions()
-                          .set_inline(true)
-                          .set_class(run_class(run, "gl"))
-                          .set_attributes(HtmlAttributesVector{
-                              {std::string("data-g"), run.glyph_data}}));
+          const HtmlAttribute glyph[]{{"data-g", run.glyph_data}};
+          out.write_tag_begin("span", {.inline_element = true,
+                                       .clazz = run_class(run, "gl"),
+                                       .attributes = glyph});
           out.write_element_end("span");
           if (!run.text.empty()) {
-            out.write_element_begin(
-                "span", HtmlElementOptions().set_inline(true).set_class("ov"));
+            out.write_tag_begin("span",
+                                {.inline_element = true, .clazz = "ov"});
             out.write_raw(run.text);
             out.write_element_end("span");
           }
@@ -2291,14 +2513,12 @@ public:
     };
 
     out.write_body_begin();
-    out.write_element_begin("div", HtmlElementOptions().set_class("d"));
+    out.write_tag_begin("div", {.clazz = "d"});
     std::size_t page_number = first_page_number;
     for (const SinglePageOut &page : pages_out) {
-      out.write_element_begin(
-          "div",
-          HtmlElementOptions()
-              .set_class(page.classes)
-              .set_extra(R"(id="p)" + std::to_string(page_number++) + R"(")"));
+      const PageId id(page_number++);
+      out.write_tag_begin(
+          "div", {.clazz = page.classes, .attributes = id.attributes()});
       write_page_items(out, page.clip_defs, page.items, page.width, page.height,
                        write_line);
       write_page_links(out, page.links);
@@ -2588,33 +2808,37 @@ public:
     write_viewport_meta(out, config(), true);
     write_zoom_style(out, config(), fits_width(config(), true), content);
     out.write_header_style_begin();
-    out.out() << "body{margin:0;background:#525659}";
+    out.write_raw("body{margin:0;background:#525659}", false);
     // `.d`: the page column, sized to the widest page so pages of differing
     // width centre against each other rather than against the viewport. Their
     // side margin is part of that width, so a phone screen keeps a gutter.
-    out.out() << ".d{display:flex;flex-direction:column;align-items:center;"
-                 "gap:16px;padding:16px 0;width:max-content;min-width:100%}";
+    out.write_raw(".d{display:flex;flex-direction:column;align-items:center;"
+                  "gap:16px;padding:16px 0;width:max-content;min-width:100%}",
+                  false);
     // `overflow:hidden` clips to the crop box, as a viewer does: content may
     // sit outside it (a bleed, or an InDesign spread's other page).
-    out.out() << ".p{position:relative;margin:0 16px;background:#fff;"
-                 "overflow:hidden;box-shadow:0 1px 4px rgba(0,0,0,.5)}";
+    out.write_raw(".p{position:relative;margin:0 16px;background:#fff;"
+                  "overflow:hidden;box-shadow:0 1px 4px rgba(0,0,0,.5)}",
+                  false);
     // `.t`: shared base for all absolutely-positioned line blocks.
     // `font-size:0` collapses its strut, which outranks the run it holds and
     // would take the line box's baseline.
-    out.out() << ".t{position:absolute;left:0;top:0;transform-origin:0 0;"
-                 "white-space:pre;line-height:1;font-size:0;font-kerning:none;"
-                 "font-variant-ligatures:none}";
+    out.write_raw(".t{position:absolute;left:0;top:0;transform-origin:0 0;"
+                  "white-space:pre;line-height:1;font-size:0;font-kerning:none;"
+                  "font-variant-ligatures:none}",
+                  false);
     write_mode_css();
     // SVG overlay covering the page box (visual graphics layer).
-    out.out() << ".s{position:absolute;left:0;top:0;width:100%;height:100%;"
-                 "overflow:hidden;pointer-events:none}";
+    out.write_raw(".s{position:absolute;left:0;top:0;width:100%;height:100%;"
+                  "overflow:hidden;pointer-events:none}",
+                  false);
     // Link annotation overlays (absolutely positioned in page-box points).
-    out.out() << ".lk{position:absolute;transform-origin:0 0}";
+    out.write_raw(".lk{position:absolute;transform-origin:0 0}", false);
     // A search hit marks the text layer over the page: the browser's own `mark`
     // colour would paint invisible text, an opaque highlight hide the glyphs.
-    out.out() << "mark{color:inherit;mix-blend-mode:multiply}";
-    out.out() << font_faces;
-    out.out() << font_styles;
+    out.write_raw("mark{color:inherit;mix-blend-mode:multiply}", false);
+    out.write_raw(font_faces, false);
+    out.write_raw(font_styles, false);
     styles.write_rules(out.out());
     out.write_header_style_end();
     write_search_style(state);
@@ -2649,14 +2873,17 @@ public:
 
   /// Serializes `sfnt` re-encoded to the PUA, restoring the cmap
   /// `reencode_to_pua` overwrites — the `SfntFont` is shared by every page, and
-  /// a left-behind PUA cmap makes the next `glyph_for_code` miss.
+  /// a left-behind PUA cmap makes the next `glyph_for_code` miss. Non-null
+  /// `glyphs` subsets the outlines to them.
   static std::string
   write_sfnt_pua(font::sfnt::SfntFont &sfnt,
-                 const std::map<char32_t, std::uint16_t> &extra_unicode) {
+                 const std::map<char32_t, std::uint16_t> &extra_unicode,
+                 const std::set<std::uint16_t> *glyphs = nullptr) {
     std::map<char32_t, std::uint16_t> original_cmap = sfnt.cmap();
     try {
       font::reencode_to_pua(sfnt, extra_unicode);
-      std::string reencoded = sfnt.write();
+      std::string reencoded =
+          glyphs != nullptr ? sfnt.write(*glyphs) : sfnt.write();
       sfnt.set_cmap(std::move(original_cmap));
       return reencoded;
     } catch (...) {
@@ -2713,24 +2940,40 @@ public:
 
   /// Re-encodes `font`'s embedded program, folding `extra_unicode`'s cmap
   /// entries in alongside the PUA range, and appends its `@font-face` plus the
-  /// `.fvN`/`.fnN` rules `class_used` says are needed.
+  /// `.fvN`/`.fnN` rules `class_used` says are needed. The program keeps the
+  /// outlines of `used_glyphs` and the `extra_unicode` glyphs only; should
+  /// subsetting fail, the whole program is embedded. `assets` has the program
+  /// inline or links it.
   static void write_font_face(const pdf::Font &font, const std::uint32_t index,
                               std::map<char32_t, std::uint16_t> extra_unicode,
+                              std::set<std::uint16_t> used_glyphs,
                               const std::array<bool, 2> &class_used,
-                              std::string &font_faces,
+                              AssetUrls &assets, std::string &font_faces,
                               std::string &font_styles) {
     if (const std::uint16_t space = space_glyph(font); space != 0) {
       extra_unicode.emplace(U' ', space);
     }
+    for (const auto &[_, glyph] : extra_unicode) {
+      used_glyphs.insert(glyph);
+    }
     std::string reencoded;
     if (const auto sfnt = std::dynamic_pointer_cast<font::sfnt::SfntFont>(
             font.embedded_font)) {
-      reencoded = write_sfnt_pua(*sfnt, extra_unicode);
+      try {
+        reencoded = write_sfnt_pua(*sfnt, extra_unicode, &used_glyphs);
+      } catch (const std::exception &) {
+        reencoded = write_sfnt_pua(*sfnt, extra_unicode);
+      }
     } else if (const auto cff = std::dynamic_pointer_cast<font::cff::CffFont>(
                    font.embedded_font)) {
-      reencoded = font::cff::wrap_to_otf(*cff, extra_unicode);
+      try {
+        reencoded = font::cff::wrap_to_otf(*cff, extra_unicode, used_glyphs);
+      } catch (const std::exception &) {
+        reencoded = font::cff::wrap_to_otf(*cff, extra_unicode);
+      }
     }
-    const std::string url = file_to_url(reencoded, "font/ttf");
+    const std::string url =
+        assets.url(HtmlResourceType::font, reencoded, "font/ttf");
     const std::string n = std::to_string(index + 1);
     // The overrides sum to one em, so `line-height:1` puts the baseline at
     // exactly the `ascent_em` a run's `top` is derived from.
@@ -2786,8 +3029,11 @@ public:
     return glyph < font.embedded_font->glyph_count() ? glyph : 0;
   }
 
+  /// The PUA text painting `codes` in `font`, adding the glyphs it paints to
+  /// `used_glyphs`.
   static std::string glyph_run_str(const pdf::Font &font,
-                                   const std::string &codes) {
+                                   const std::string &codes,
+                                   std::set<std::uint16_t> &used_glyphs) {
     const std::uint16_t space = space_glyph(font);
     std::string s;
     for (const std::uint32_t code : font.codes(codes)) {
@@ -2795,8 +3041,9 @@ public:
         s += ' ';
         continue;
       }
-      util::string::append_c32(font::pua_code_point(font.glyph_for_code(code)),
-                               s);
+      const std::uint16_t glyph = font.glyph_for_code(code);
+      used_glyphs.insert(glyph);
+      util::string::append_c32(font::pua_code_point(glyph), s);
     }
     return s;
   }
@@ -2833,15 +3080,16 @@ public:
                          const util::math::Transform2D &to_box, double width,
                          double height, ClipRegistry &clips,
                          GradientRegistry &gradients, PatternRegistry &patterns,
-                         MaskRegistry &masks, const Logger &logger,
-                         CloseLine &&close_line, PushSvg &&push_svg) {
+                         MaskRegistry &masks, AssetUrls &assets,
+                         const Logger &logger, CloseLine &&close_line,
+                         PushSvg &&push_svg) {
     // Text is handled by the caller; every other element kind is a graphic.
     if (std::holds_alternative<pdf::TextElement>(element)) {
       return false;
     }
     std::string frag =
         render_graphic_fragment(element, to_box, width, height, clips,
-                                gradients, patterns, masks, logger);
+                                gradients, patterns, masks, assets, logger);
     if (!frag.empty()) {
       close_line();
       push_svg(std::move(frag));
@@ -2866,6 +3114,68 @@ protected:
   mutable std::vector<pdf::Page *> m_pages;
   mutable std::size_t m_first_page{0};
   mutable HtmlViews m_views;
+  /// The images and fonts the renders so far have linked rather than inlined.
+  mutable AssetCache m_assets;
+  /// Every view written once, for assets whose view is not known.
+  mutable std::once_flag m_assets_swept;
+
+  HtmlResources write_view_(const std::string &path, HtmlWriter &out) const {
+    warmup();
+    // The parser reads concurrently, but a render still writes to what it
+    // parsed: re-encoding a font swaps the cmap of its embedded program in
+    // place, and one font serves many pages. Renders are serialized.
+    std::lock_guard lock(m_mutex);
+    if (path == config().document_output_file_name) {
+      return write_document(out);
+    }
+    for (std::size_t i = 0; i < m_pages.size(); ++i) {
+      if (path == m_views[i + 1].path()) {
+        return write_page(i, out);
+      }
+    }
+    throw FileNotFound("Unknown path: " + path);
+  }
+
+  /// The linked image or font at @p path. One not cached, because it was
+  /// evicted or because the page linking it was written by an earlier process,
+  /// is written again from the view that last linked it. Which view that is
+  /// may not be known yet; then every view is written once, for the service's
+  /// lifetime and only for a path shaped like an asset, so no request can have
+  /// the pages rendered again at will. The translation cache keeps the assets
+  /// of a view with it and does not come here for them.
+  [[nodiscard]] std::optional<odr::HtmlResource>
+  asset_at_(const std::string &path) const {
+    if (std::optional<odr::HtmlResource> cached = m_assets.find(path)) {
+      return cached;
+    }
+
+    std::optional<std::string> view = m_assets.view(path);
+    if (!view.has_value() && is_asset_path(path)) {
+      std::call_once(m_assets_swept, [this] {
+        for (const odr::HtmlView &each : list_views()) {
+          NullStream null;
+          HtmlWriter writer(null, config());
+          write_html(each.path(), writer);
+        }
+      });
+      if (std::optional<odr::HtmlResource> cached = m_assets.find(path)) {
+        return cached;
+      }
+      view = m_assets.view(path);
+    }
+    if (!view.has_value()) {
+      return std::nullopt;
+    }
+
+    NullStream null;
+    HtmlWriter writer(null, config());
+    for (auto &[resource, location] : write_html(*view, writer)) {
+      if (location == path) {
+        return std::move(resource);
+      }
+    }
+    return std::nullopt;
+  }
 };
 
 } // namespace
@@ -5,18 +5,188 @@
 #include <odr/html.hpp>
 #include <odr/odr.hpp>
 
-#include <odr/internal/common/null_stream.hpp>
+#include <odr/internal/abstract/file.hpp>
+#include <odr/internal/encoding/transcode.hpp>
 #include <odr/internal/html/common.hpp>
 #include <odr/internal/html/frontend.hpp>
 #include <odr/internal/html/html_service.hpp>
 #include <odr/internal/html/html_writer.hpp>
-#include <odr/internal/util/stream_util.hpp>
 
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
 
 namespace odr::internal::html {
 namespace {
 
+/// Bytes read from the file at a time.
+constexpr std::size_t chunk_size = 64 * 1024;
+/// A line longer than this is escaped and written in pieces of about this
+/// size, so a file that is one huge line costs no more memory than any other.
+constexpr std::size_t line_piece_size = 64 * 1024;
+
+/// The code unit of @p encoding, in which a line feed is the one unit that
+/// reads 0x0a; every other encoding we meet is ASCII compatible.
+std::size_t unit_width(const TextEncoding encoding) {
+  switch (encoding) {
+  case TextEncoding::utf16le:
+  case TextEncoding::utf16be:
+    return 2;
+  case TextEncoding::utf32le:
+  case TextEncoding::utf32be:
+    return 4;
+  default:
+    return 1;
+  }
+}
+
+/// Where in the unit the byte holding a line feed's 0x0a sits.
+std::size_t line_feed_byte(const TextEncoding encoding) {
+  switch (encoding) {
+  case TextEncoding::utf16be:
+    return 1;
+  case TextEncoding::utf32be:
+    return 3;
+  default:
+    return 0;
+  }
+}
+
+/// Where the pages of a file start: the byte offset of every
+/// `lines_per_page`th line, and how many lines there are. Found in one pass
+/// over the bytes, which are not decoded for it, and sparse - a page costs
+/// one offset however long its lines are.
+class LineIndex final {
+public:
+  LineIndex(const abstract::File &file, const TextEncoding encoding,
+            const std::optional<std::uint32_t> lines_per_page) {
+    const std::size_t width = unit_width(encoding);
+    const std::size_t feed = line_feed_byte(encoding);
+    const std::uint64_t page_lines =
+        lines_per_page.value_or(0) == 0 ? 0 : *lines_per_page;
+
+    const std::unique_ptr<std::istream> in = file.stream();
+    std::vector<char> buffer(chunk_size);
+    // the bytes of a unit a read ended in the middle of
+    std::array<char, 4> unit{};
+    std::size_t unit_fill = 0;
+    std::uint64_t offset = 0;
+
+    while (in->read(buffer.data(), static_cast<std::streamsize>(buffer.size())),
+           in->gcount() > 0) {
+      const auto read = static_cast<std::size_t>(in->gcount());
+      for (std::size_t i = 0; i < read; ++i) {
+        unit[unit_fill++] = buffer[i];
+        if (unit_fill < width) {
+          continue;
+        }
+        unit_fill = 0;
+        if (!is_line_feed_(unit, width, feed)) {
+          continue;
+        }
+        ++m_line_count;
+        // a line feed ending a page's last line begins the next page
+        if (page_lines != 0 && (m_line_count - 1) % page_lines == 0) {
+          m_page_offsets.push_back(offset + i + 1);
+        }
+      }
+      offset += read;
+    }
+  }
+
+  [[nodiscard]] std::uint64_t line_count() const { return m_line_count; }
+  [[nodiscard]] std::size_t page_count() const {
+    return m_page_offsets.size();
+  }
+  [[nodiscard]] std::uint64_t page_offset(const std::size_t page) const {
+    return m_page_offsets.at(page);
+  }
+
+private:
+  /// a file of no line feeds is still one, empty line
+  std::uint64_t m_line_count{1};
+  std::vector<std::uint64_t> m_page_offsets{0};
+
+  static bool is_line_feed_(const std::array<char, 4> &unit,
+                            const std::size_t width, const std::size_t feed) {
+    for (std::size_t b = 0; b < width; ++b) {
+      if (unit[b] != (b == feed ? '\n' : '\0')) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+/// Writes decoded text as one `div` per line, for as many lines as asked;
+/// a line is escaped as a whole, or in pieces past @ref line_piece_size.
+class LineWriter final {
+public:
+  LineWriter(HtmlWriter &out, const std::uint64_t lines)
+      : m_out{&out}, m_remaining{lines} {}
+
+  /// Takes the next piece of text. false once the last line asked for is
+  /// written, and whatever follows it is not wanted.
+  bool put(std::string_view text) {
+    while (m_remaining > 0) {
+      const std::size_t feed = text.find('\n');
+      m_line.append(text.substr(0, feed));
+      if (feed == std::string_view::npos) {
+        if (m_line.size() >= line_piece_size) {
+          write_piece_();
+        }
+        return true;
+      }
+      end_line_();
+      text.remove_prefix(feed + 1);
+    }
+    return false;
+  }
+
+  /// Ends the last line, which no line feed ended.
+  void finish() {
+    if (m_remaining > 0) {
+      end_line_();
+    }
+  }
+
+private:
+  HtmlWriter *m_out;
+  std::uint64_t m_remaining;
+  std::string m_line;
+  bool m_begun{false};
+
+  void write_piece_() {
+    if (!m_begun) {
+      m_out->write_tag_begin("div", {.inline_element = true});
+      m_begun = true;
+    }
+    m_out->write_text(m_line);
+    m_line.clear();
+  }
+
+  void end_line_() {
+    if (!m_begun && m_line.empty()) {
+      m_out->write_tag_begin("div", {.inline_element = true});
+      m_out->write_tag_begin("br", {.close_type = HtmlCloseType::trailing});
+    } else {
+      write_piece_();
+    }
+    m_out->write_element_end("div");
+    m_begun = false;
+    --m_remaining;
+  }
+};
+
 class HtmlServiceImpl final : public HtmlService {
 public:
   HtmlServiceImpl(TextFile text_file, HtmlConfig config, const Logger &logger)
@@ -25,18 +195,29 @@ public:
         m_resources{locate_text_resources(this->config())} {
     m_views.emplace_back(
         std::make_shared<HtmlView>(*this, "text", 0, "text.html"));
+
+    // the views have to be known up front, and the index is what counts them
+    if (paged_()) {
+      for (std::size_t i = 0; i < index_().page_count(); ++i) {
+        const auto page = static_cast<std::uint32_t>(i);
+        m_views.emplace_back(std::make_shared<HtmlView>(
+            *this, "page" + std::to_string(i + 1), i + 1,
+            fill_path_variables(this->config().page_output_file_name, page)));
+      }
+    }
   }
 
-  void warmup() const override {}
+  void warmup() const override { std::ignore = index_(); }
 
   [[nodiscard]] const HtmlViews &list_views() const override { return m_views; }
 
   [[nodiscard]] bool exists(const std::string &path) const override {
-    return path == "text.html" || resource_at(m_resources, path) != nullptr;
+    return view_at_(path).has_value() ||
+           resource_at(m_resources, path) != nullptr;
   }
 
   [[nodiscard]] std::string mimetype(const std::string &path) const override {
-    if (path == "text.html") {
+    if (view_at_(path).has_value()) {
       return "text/html";
     }
     if (const odr::HtmlResource *resource = resource_at(m_resources, path);
@@ -48,9 +229,9 @@ public:
   }
 
   void write(const std::string &path, std::ostream &out) const override {
-    if (path == "text.html") {
+    if (const std::optional<std::size_t> view = view_at_(path)) {
       HtmlWriter writer(out, config());
-      write_text(writer);
+      write_text(writer, *view);
       return;
     }
     if (const odr::HtmlResource *resource = resource_at(m_resources, path);
@@ -64,38 +245,47 @@ public:
 
   HtmlResources write_html(const std::string &path,
                            HtmlWriter &out) const override {
-    if (path == "text.html") {
-      return write_text(out);
+    if (const std::optional<std::size_t> view = view_at_(path)) {
+      return write_text(out, *view);
     }
 
     throw FileNotFound("Unknown path: " + path);
   }
 
-  /// The bytes to write and the charset to declare. What we can decode becomes
-  /// UTF-8; what we can only name passes through for the browser, which works
-  /// because those encodings are ASCII-compatible and the page is ASCII.
-  [[nodiscard]] std::pair<std::string, std::string> body_and_charset() const {
+  /// The charset to declare. What we can decode becomes UTF-8; what we can
+  /// only name passes through for the browser, which works because those
+  /// encodings are ASCII-compatible and the page is ASCII.
+  [[nodiscard]] std::string charset() const {
     const TextEncoding encoding = m_text_file.encoding();
-    std::string text = m_text_file.text();
-
     if (encoding == TextEncoding::unknown ||
         text_encoding_is_decodable(encoding)) {
-      return {std::move(text), "UTF-8"};
+      return "UTF-8";
     }
-    return {std::move(text), std::string(text_encoding_to_string(encoding))};
+    return std::string(text_encoding_to_string(encoding));
   }
 
-  HtmlResources write_text(HtmlWriter &out) const {
+  /// Writes view @p view: 0 the whole file, else page `view - 1` of it. The
+  /// file is read as it is written, never whole.
+  HtmlResources write_text(HtmlWriter &out, const std::size_t view) const {
     HtmlResources resources;
     const WritingState state(out, config(), resources);
 
-    const auto [text, charset] = body_and_charset();
+    const LineIndex &index = index_();
+    std::uint64_t first_line = 0;
+    std::uint64_t line_count = index.line_count();
+    std::uint64_t offset = 0;
+    if (view > 0) {
+      const std::uint64_t page_lines = *config().text_lines_per_page;
+      first_line = (view - 1) * page_lines;
+      line_count = std::min(page_lines, index.line_count() - first_line);
+      offset = index.page_offset(view - 1);
+    }
 
     out.write_begin();
 
     out.write_header_begin();
 
-    out.write_header_charset(charset);
+    out.write_header_charset(charset());
     out.write_header_target("_blank");
     out.write_header_title("odr");
     write_viewport_meta(out, config(), false);
@@ -113,18 +303,20 @@ public:
     out.write_element_begin("div", HtmlElementOptions().set_class("odr-text"));
 
     // `aria-hidden`: the numbers are ours, not the file's - nothing reading the
-    // page as content takes them.
-    out.write_element_begin("div", HtmlElementOptions()
-                                       .set_class("odr-text-nr")
-                                       .set_extra(R"(aria-hidden="true")"));
-    std::istringstream in(text);
-    for (std::uint32_t line = 1; !in.eof(); ++line) {
-      out.write_element_begin("div", HtmlElementOptions().set_inline(true));
-      out.out() << line;
+    // page as content takes them. A page numbers its lines as the file does.
+    out.write_element_begin(
+        "div", HtmlElementOptions()
+                   .set_class("odr-text-nr")
+                   .set_extra(R"(aria-hidden="true" data-first=")" +
+                              std::to_string(first_line + 1) + "\""));
+    std::array<char, 24> number{};
+    for (std::uint64_t line = first_line + 1;
+         line <= first_line + line_count; ++line) {
+      out.write_tag_begin("div", {.inline_element = true});
+      const char *end =
+          std::to_chars(number.data(), number.data() + number.size(), line).ptr;
+      out.write_raw(std::string_view(number.data(), end), false);
       out.write_element_end("div");
-
-      NullStream ss_out;
-      util::stream::pipe_line(in, ss_out, false);
     }
     out.write_element_end("div");
 
@@ -136,21 +328,7 @@ public:
                                     clb("contenteditable", "true");
                                   }
                                 }));
-    in = std::istringstream(text);
-    while (!in.eof()) {
-      out.write_element_begin("div", HtmlElementOptions().set_inline(true));
-
-      std::ostringstream ss_out;
-      util::stream::pipe_line(in, ss_out, false);
-      if (std::string line = ss_out.str(); line.empty()) {
-        out.write_element_begin(
-            "br", HtmlElementOptions().set_close_type(HtmlCloseType::trailing));
-      } else {
-        out.out() << escape_text(std::move(line));
-      }
-
-      out.write_element_end("div");
-    }
+    write_lines_(out, offset, line_count);
     out.write_element_end("div");
 
     out.write_element_end("div");
@@ -173,6 +351,67 @@ protected:
   HtmlResources m_resources;
 
   HtmlViews m_views;
+
+  mutable std::once_flag m_index_once;
+  mutable std::optional<LineIndex> m_index;
+
+private:
+  [[nodiscard]] bool paged_() const {
+    return config().text_lines_per_page.value_or(0) != 0;
+  }
+
+  [[nodiscard]] const LineIndex &index_() const {
+    std::call_once(m_index_once, [this] {
+      m_index.emplace(*m_text_file.impl()->file(), m_text_file.encoding(),
+                      config().text_lines_per_page);
+    });
+    return *m_index;
+  }
+
+  [[nodiscard]] std::optional<std::size_t>
+  view_at_(const std::string &path) const {
+    for (const auto &view : m_views) {
+      if (view.path() == path) {
+        return view.index();
+      }
+    }
+    return std::nullopt;
+  }
+
+  /// Streams @p lines lines from byte @p offset into @p out, decoding a
+  /// chunk at a time where the encoding is decodable.
+  void write_lines_(HtmlWriter &out, const std::uint64_t offset,
+                    const std::uint64_t lines) const {
+    const std::unique_ptr<std::istream> in =
+        m_text_file.impl()->file()->stream();
+    in->seekg(static_cast<std::streamoff>(offset));
+    if (!*in) {
+      // not every stream seeks; reading up to the page does the same
+      in->clear();
+      in->ignore(static_cast<std::streamsize>(offset));
+    }
+
+    const TextEncoding encoding = m_text_file.encoding();
+    std::optional<encoding::Utf8Decoder> decoder;
+    if (text_encoding_is_decodable(encoding)) {
+      decoder.emplace(encoding, offset == 0);
+    }
+
+    LineWriter writer(out, lines);
+    std::vector<char> buffer(chunk_size);
+    while (in->read(buffer.data(), static_cast<std::streamsize>(buffer.size())),
+           in->gcount() > 0) {
+      const std::string_view bytes(buffer.data(),
+                                   static_cast<std::size_t>(in->gcount()));
+      if (!writer.put(decoder ? decoder->put(bytes) : std::string(bytes))) {
+        return;
+      }
+    }
+    if (decoder && !writer.put(decoder->finish())) {
+      return;
+    }
+    writer.finish();
+  }
 };
 
 } // namespace
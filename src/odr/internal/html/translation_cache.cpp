@@ -0,0 +1,550 @@
+#include <odr/internal/html/translation_cache.hpp>
+
+#include <odr/exceptions.hpp>
+#include <odr/file.hpp>
+#include <odr/html.hpp>
+#include <odr/logger.hpp>
+#include <odr/odr.hpp>
+
+#include <odr/internal/abstract/html_service.hpp>
+#include <odr/internal/common/random.hpp>
+#include <odr/internal/crypto/crypto_util.hpp>
+#include <odr/internal/html/html_service.hpp>
+#include <odr/internal/html/html_writer.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+namespace odr::internal::html {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::string_view manifest_name = "manifest.json";
+/// Marks a file that is still being written; see `write_atomically`.
+constexpr std::string_view temporary_marker = ".tmp-";
+/// Prefix of an entry that is being removed; see `remove_entry`.
+constexpr std::string_view trash_prefix = ".trash-";
+/// A temporary file this old was left behind by a writer that died.
+constexpr auto stale_temporary_age = std::chrono::hours(1);
+/// Hex digits of a sha256, the name of an entry; see `entry_key`.
+constexpr std::size_t key_digits = 64;
+
+/// Whether @p name has the shape of an entry's, as `entry_key` makes them.
+bool is_entry_key(const std::string_view name) {
+  return name.size() == key_digits &&
+         std::ranges::all_of(name, [](const char c) {
+           return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+         });
+}
+
+/// Whether @p name is that of an entry `remove_entry` was cut short removing.
+bool is_trash(const std::string_view name) {
+  if (!name.starts_with(trash_prefix)) {
+    return false;
+  }
+  const std::string_view rest = name.substr(trash_prefix.size());
+  return rest.size() > key_digits && rest[key_digits] == '-' &&
+         is_entry_key(rest.substr(0, key_digits));
+}
+
+/// Flushes @p path to the disk, so the rename that publishes it cannot get
+/// there first and leave an empty file after a power loss.
+void sync(const fs::path &path) {
+#ifndef _WIN32
+  if (const int fd = ::open(path.c_str(), O_RDONLY); fd >= 0) {
+    ::fsync(fd);
+    ::close(fd);
+  }
+#else
+  (void)path;
+#endif
+}
+
+/// Writes @p path by way of a temporary sibling which @p write fills and which
+/// is then renamed over @p path, so a reader finds the old file or the whole
+/// new one. Returns false if the disk failed us; what @p write throws is
+/// passed on.
+bool write_atomically(const fs::path &path,
+                      const std::function<void(std::ostream &)> &write) {
+  const fs::path temporary =
+      path.parent_path() / (path.filename().string() +
+                            std::string(temporary_marker) + random_string(8));
+  std::error_code error;
+
+  try {
+    std::ofstream out(temporary, std::ios::binary);
+    if (!out) {
+      return false;
+    }
+    write(out);
+    out.close();
+    if (!out) {
+      fs::remove(temporary, error);
+      return false;
+    }
+  } catch (...) {
+    fs::remove(temporary, error);
+    throw;
+  }
+
+  sync(temporary);
+  fs::rename(temporary, path, error);
+  if (error) {
+    fs::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
+/// How @p file was decoded, as far as it changes what is rendered.
+std::string decoding_fingerprint(const DecodedFile &file) {
+  nlohmann::json result;
+  result["file_type"] = static_cast<int>(file.file_type());
+  if (file.is_csv_file()) {
+    const CsvOptions options = file.as_csv_file().options();
+    result["encoding"] =
+        static_cast<int>(options.encoding.value_or(TextEncoding::unknown));
+    result["separator"] = std::string(1, options.separator.value_or('\0'));
+    result["quote"] = std::string(1, options.quote.value_or('\0'));
+  } else if (file.is_text_file()) {
+    result["encoding"] = static_cast<int>(file.as_text_file().encoding());
+  }
+  return result.dump();
+}
+
+std::string entry_key(const DecodedFile &file, const HtmlConfig &config) {
+  const std::string input = crypto::util::sha256(*file.file().stream());
+  return crypto::util::hex_encode(crypto::util::sha256(
+      version() + '\n' + config_fingerprint(config) + '\n' +
+      decoding_fingerprint(file) + '\n' + input));
+}
+
+/// Renames @p directory out of the way before removing it, so no reader sees
+/// half an entry, and a removal cut short is finished by the next prune.
+void remove_entry(const fs::path &directory) {
+  std::error_code error;
+  const fs::path trash =
+      directory.parent_path() /
+      (std::string(trash_prefix) + directory.filename().string() + "-" +
+       random_string(8));
+  fs::rename(directory, trash, error);
+  if (!error) {
+    fs::remove_all(trash, error);
+  }
+}
+
+/// One translation's directory in the cache: the manifest and a file per path
+/// written so far.
+///
+/// The manifest is re-read before every change, so entries shared between
+/// processes merge their paths; a change lost to a concurrent write costs a
+/// render, never a wrong answer.
+class Entry final {
+public:
+  struct View {
+    std::string name;
+    std::size_t index{};
+    std::string path;
+  };
+
+  struct Stored {
+    std::string mime_type;
+    fs::path file;
+  };
+
+  explicit Entry(fs::path directory)
+      : m_directory{std::move(directory)}, m_manifest{read_manifest_()} {}
+
+  [[nodiscard]] std::optional<std::vector<View>> views() const {
+    std::lock_guard lock(m_mutex);
+    if (!m_manifest.contains("views")) {
+      return std::nullopt;
+    }
+    std::vector<View> result;
+    for (const nlohmann::json &view : m_manifest["views"]) {
+      result.push_back({view.at("name").get<std::string>(),
+                        view.at("index").get<std::size_t>(),
+                        view.at("path").get<std::string>()});
+    }
+    return result;
+  }
+
+  [[nodiscard]] bool is_view(const std::string &path) const {
+    std::lock_guard lock(m_mutex);
+    if (!m_manifest.contains("views")) {
+      return false;
+    }
+    return std::ranges::any_of(m_manifest["views"],
+                               [&](const nlohmann::json &view) {
+                                 return view.at("path") == path;
+                               });
+  }
+
+  [[nodiscard]] std::optional<Stored> find(const std::string &path) const {
+    std::lock_guard lock(m_mutex);
+    if (!m_manifest.contains("files") || !m_manifest["files"].contains(path)) {
+      return std::nullopt;
+    }
+    const nlohmann::json &file = m_manifest["files"][path];
+    return Stored{file.at("mime_type").get<std::string>(),
+                  m_directory / file.at("file").get<std::string>()};
+  }
+
+  /// Records @p views. They are known from here on even if the manifest
+  /// could not be written, which returns false.
+  bool store_views(const HtmlViews &views) {
+    nlohmann::json array = nlohmann::json::array();
+    for (const odr::HtmlView &view : views) {
+      array.push_back({{"name", view.name()},
+                       {"index", view.index()},
+                       {"path", view.path()}});
+    }
+
+    std::lock_guard lock(m_mutex);
+    merge_manifest_();
+    m_manifest["views"] = std::move(array);
+    return write_manifest_();
+  }
+
+  /// Writes @p path's file with @p write and records it. Returns the file, or
+  /// nothing if the disk failed us; what @p write throws is passed on.
+  std::optional<fs::path>
+  store(const std::string &path, const std::string &mime_type,
+        const std::function<void(std::ostream &)> &write) {
+    const std::string name =
+        crypto::util::hex_encode(crypto::util::sha1(path));
+    const fs::path file = m_directory / name;
+    if (!write_atomically(file, write)) {
+      return std::nullopt;
+    }
+
+    std::lock_guard lock(m_mutex);
+    merge_manifest_();
+    m_manifest["files"][path] = {{"mime_type", mime_type}, {"file", name}};
+    // the file serves this process either way; only others would miss it
+    write_manifest_();
+    return file;
+  }
+
+private:
+  fs::path m_directory;
+  mutable std::mutex m_mutex;
+  nlohmann::json m_manifest;
+
+  [[nodiscard]] nlohmann::json read_manifest_() const {
+    std::ifstream in(m_directory / manifest_name, std::ios::binary);
+    if (!in) {
+      return nlohmann::json::object();
+    }
+    nlohmann::json result = nlohmann::json::parse(in, nullptr, false);
+    return result.is_object() ? result : nlohmann::json::object();
+  }
+
+  /// Takes in what other processes wrote since, keeping what this one knows.
+  void merge_manifest_() {
+    nlohmann::json merged = read_manifest_();
+    if (!merged.contains("views") && m_manifest.contains("views")) {
+      merged["views"] = m_manifest["views"];
+    }
+    if (m_manifest.contains("files")) {
+      for (const auto &[path, file] : m_manifest["files"].items()) {
+        if (!merged["files"].contains(path)) {
+          merged["files"][path] = file;
+        }
+      }
+    }
+    m_manifest = std::move(merged);
+  }
+
+  bool write_manifest_() const {
+    return write_atomically(m_directory / manifest_name,
+                            [&](std::ostream &out) { out << m_manifest; });
+  }
+};
+
+/// See `create_cached_service`.
+class CachedService final : public HtmlService {
+public:
+  CachedService(fs::path directory, HtmlConfig config, const Logger &logger,
+                std::function<odr::HtmlService()> translate)
+      : HtmlService(std::move(config), logger), m_entry{std::move(directory)},
+        m_translate{std::move(translate)} {}
+
+  [[nodiscard]] const HtmlViews &list_views() const override {
+    std::call_once(m_views_once, [this] {
+      std::optional<std::vector<Entry::View>> views = m_entry.views();
+      if (!views.has_value()) {
+        if (!m_entry.store_views(translation_().list_views())) {
+          ODR_WARNING(m_logger, "could not write the translation cache");
+        }
+        views = m_entry.views();
+      }
+      for (Entry::View &view : *views) {
+        m_views.emplace_back(std::make_shared<HtmlView>(
+            *this, std::move(view.name), view.index, std::move(view.path)));
+      }
+    });
+    return m_views;
+  }
+
+  void warmup() const override {
+    if (!m_entry.views().has_value()) {
+      translation_().warmup();
+    }
+  }
+
+  [[nodiscard]] bool exists(const std::string &path) const override {
+    return m_entry.find(path).has_value() || m_entry.is_view(path) ||
+           translation_().exists(path);
+  }
+
+  [[nodiscard]] std::string mimetype(const std::string &path) const override {
+    if (const std::optional<Entry::Stored> stored = m_entry.find(path);
+        stored.has_value()) {
+      return stored->mime_type;
+    }
+    if (m_entry.is_view(path)) {
+      return "text/html";
+    }
+    return translation_().mimetype(path);
+  }
+
+  void write(const std::string &path, std::ostream &out) const override {
+    if (const std::optional<Entry::Stored> stored = m_entry.find(path);
+        stored.has_value() && copy_(stored->file, out)) {
+      return;
+    }
+
+    const odr::HtmlService &translation = translation_();
+    const bool view = m_entry.is_view(path);
+    HtmlResources linked;
+    const std::optional<fs::path> file = m_entry.store(
+        path, translation.mimetype(path), [&](std::ostream &file_out) {
+          if (view) {
+            HtmlWriter writer(file_out, config());
+            linked = translation.impl()->write_html(path, writer);
+          } else {
+            translation.write(path, file_out);
+          }
+        });
+    store_linked_(linked);
+    if (file.has_value() && copy_(*file, out)) {
+      return;
+    }
+
+    ODR_WARNING(m_logger, "could not write the translation cache");
+    translation.write(path, out);
+  }
+
+  HtmlResources write_html(const std::string &path,
+                           HtmlWriter &out) const override {
+    return translation_().impl()->write_html(path, out);
+  }
+
+private:
+  mutable Entry m_entry;
+  std::function<odr::HtmlService()> m_translate;
+
+  mutable std::once_flag m_translation_once;
+  mutable odr::HtmlService m_translation;
+  mutable std::once_flag m_views_once;
+  mutable HtmlViews m_views;
+
+  /// The translation itself, made the first time something is not cached.
+  const odr::HtmlService &translation_() const {
+    std::call_once(m_translation_once,
+                   [this] { m_translation = m_translate(); });
+    return m_translation;
+  }
+
+  /// Stores the files a view links which the translation serves, its images
+  /// and fonts, so a page read from the cache finds them there too and they
+  /// are not looked for by rendering the translation again.
+  void store_linked_(const HtmlResources &linked) const {
+    for (const auto &[resource, location] : linked) {
+      if (!location.has_value() || resource.is_shipped() ||
+          !resource.file().has_value() || m_entry.find(*location).has_value()) {
+        continue;
+      }
+      m_entry.store(*location, resource.mime_type(),
+                    [&](std::ostream &file_out) {
+                      resource.write_resource(file_out);
+                    });
+    }
+  }
+
+  /// False if @p file cannot be opened, say because a prune removed it.
+  static bool copy_(const fs::path &file, std::ostream &out) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+      return false;
+    }
+    out << in.rdbuf();
+    return true;
+  }
+};
+
+} // namespace
+
+std::string config_fingerprint(const HtmlConfig &config) {
+  const auto optional = [](const auto &value) {
+    return value.has_value() ? nlohmann::json(*value) : nlohmann::json();
+  };
+
+  nlohmann::json result;
+  result["document_output_file_name"] = config.document_output_file_name;
+  result["slide_output_file_name"] = config.slide_output_file_name;
+  result["sheet_output_file_name"] = config.sheet_output_file_name;
+  result["page_output_file_name"] = config.page_output_file_name;
+  result["embed_images"] = config.embed_images;
+  result["embed_shipped_resources"] = config.embed_shipped_resources;
+  result["resource_path"] = config.resource_path;
+  result["relative_resource_paths"] = config.relative_resource_paths;
+  result["editable"] = config.editable;
+  result["text_document_margin"] = config.text_document_margin;
+  result["color_scheme"] = static_cast<int>(config.color_scheme);
+  if (config.spreadsheet_limit.has_value()) {
+    result["spreadsheet_limit"] = {config.spreadsheet_limit->rows,
+                                   config.spreadsheet_limit->columns};
+  } else {
+    result["spreadsheet_limit"] = nullptr;
+  }
+  result["spreadsheet_limit_by_content"] = config.spreadsheet_limit_by_content;
+  if (config.spreadsheet_tile.has_value()) {
+    result["spreadsheet_tile"] = {config.spreadsheet_tile->rows,
+                                  config.spreadsheet_tile->columns};
+  } else {
+    result["spreadsheet_tile"] = nullptr;
+  }
+  result["spreadsheet_gridlines"] =
+      static_cast<int>(config.spreadsheet_gridlines);
+  result["viewport_mode"] = static_cast<int>(config.viewport_mode);
+  if (config.spreadsheet_viewport_mode.has_value()) {
+    result["spreadsheet_viewport_mode"] =
+        static_cast<int>(*config.spreadsheet_viewport_mode);
+  } else {
+    result["spreadsheet_viewport_mode"] = nullptr;
+  }
+  result["viewport_content"] = optional(config.viewport_content);
+  result["viewport_width"] = optional(config.viewport_width);
+  result["initial_zoom"] = optional(config.initial_zoom);
+  result["format_html"] = config.format_html;
+  result["html_indent"] = config.html_indent;
+  result["html_indent_string"] = config.html_indent_string;
+  result["page_range_begin"] = config.page_range_begin;
+  result["page_range_end"] = optional(config.page_range_end);
+  result["text_lines_per_page"] = optional(config.text_lines_per_page);
+  result["pdf_text_mode"] = static_cast<int>(config.pdf_text_mode);
+  result["pdf_dual_layer_fallback_fonts"] =
+      config.pdf_dual_layer_fallback_fonts;
+  result["pdf_dual_layer_fallback_font_size_adjust"] =
+      config.pdf_dual_layer_fallback_font_size_adjust;
+  result["png_compression_level"] = config.png_compression_level;
+  result["output_path"] = optional(config.output_path);
+  result["resource_locator"] = static_cast<bool>(config.resource_locator);
+  return result.dump();
+}
+
+odr::HtmlService
+create_cached_service(const std::string &cache_path, const DecodedFile &file,
+                      const HtmlConfig &config, const Logger &logger,
+                      const std::function<odr::HtmlService()> &translate) {
+  const fs::path root = fs::path(cache_path) / translation_cache_directory;
+  fs::path directory;
+  try {
+    const std::string key = entry_key(file, config);
+    directory = root / key;
+    fs::create_directories(root);
+    prune_translation_cache(
+        cache_path, std::uintmax_t{config.cache_max_megabytes} * 1024 * 1024,
+        std::chrono::hours(24) * config.cache_max_age_days, key);
+    fs::create_directories(directory);
+    // the entry's age is the time it was last asked for
+    fs::last_write_time(directory, fs::file_time_type::clock::now());
+  } catch (const fs::filesystem_error &e) {
+    ODR_WARNING(logger, "translation cache unusable: " << e.what());
+    return translate();
+  }
+
+  ODR_VERBOSE(logger, "translation cache entry " << directory.string());
+  return odr::HtmlService(std::make_shared<CachedService>(
+      std::move(directory), config, logger, translate));
+}
+
+void prune_translation_cache(const fs::path &cache_path,
+                             const std::uintmax_t max_bytes,
+                             const std::chrono::seconds max_age,
+                             const std::string &keep) {
+  struct Found {
+    fs::path directory;
+    fs::file_time_type used;
+    std::uintmax_t bytes{0};
+  };
+
+  const fs::file_time_type now = fs::file_time_type::clock::now();
+  std::error_code error;
+
+  const fs::path store = cache_path / translation_cache_directory;
+  std::vector<Found> entries;
+  std::uintmax_t total = 0;
+  for (const fs::directory_entry &entry :
+       fs::directory_iterator(store, error)) {
+    const std::string name = entry.path().filename().string();
+    if (is_trash(name)) {
+      fs::remove_all(entry.path(), error);
+      continue;
+    }
+    // whatever else someone put here is not ours to remove
+    if (!is_entry_key(name) || !entry.is_directory(error) ||
+        !fs::is_regular_file(entry.path() / manifest_name, error)) {
+      continue;
+    }
+
+    Found found{entry.path(), entry.last_write_time(error)};
+    for (const fs::directory_entry &file :
+         fs::directory_iterator(entry.path(), error)) {
+      if (!file.is_regular_file(error)) {
+        continue;
+      }
+      if (file.path().filename().string().find(temporary_marker) !=
+              std::string::npos &&
+          now - file.last_write_time(error) > stale_temporary_age) {
+        fs::remove(file.path(), error);
+        continue;
+      }
+      if (const std::uintmax_t size = file.file_size(error); !error) {
+        found.bytes += size;
+      }
+    }
+    total += found.bytes;
+    entries.push_back(std::move(found));
+  }
+
+  std::ranges::sort(entries, {}, &Found::used);
+  for (const Found &entry : entries) {
+    if (entry.directory.filename() == keep) {
+      continue;
+    }
+    const bool too_old = max_age.count() > 0 && now - entry.used > max_age;
+    const bool too_big = max_bytes > 0 && total > max_bytes;
+    if (too_old || too_big) {
+      remove_entry(entry.directory);
+      total -= entry.bytes;
+    }
+  }
+}
+
+} // namespace odr::internal::html
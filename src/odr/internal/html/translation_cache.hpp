@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace odr {
+class DecodedFile;
+class HtmlService;
+class Logger;
+struct HtmlConfig;
+} // namespace odr
+
+namespace odr::internal::html {
+
+/// Every field of @p config that changes what a translation writes, in a fixed
+/// order: the part of a translation cache key that comes from the config.
+/// Bounds on the cache itself and the thread count do not change the output
+/// and are left out; a resource locator can only be told apart by whether
+/// there is one.
+[[nodiscard]] std::string config_fingerprint(const HtmlConfig &config);
+
+/// The directory under a `cache_path` the translation cache keeps its entries
+/// in. Nothing else under `cache_path` is written or removed, so it may be a
+/// directory shared with other files.
+constexpr std::string_view translation_cache_directory =
+    "odr-translation-cache";
+
+/// A service that answers from the translation cache under @p cache_path.
+///
+/// An entry is a directory in @ref translation_cache_directory named by the
+/// sha256 of the library version, @p config's fingerprint, how @p file was
+/// decoded and its bytes. It holds a manifest of the views and of every path
+/// written so far, and a file per path. A path found there is copied out
+/// without @p translate ever being called; otherwise @p translate is called
+/// once, the path is rendered into the entry and served from there. A view is
+/// stored with the images and fonts it links, so those are served without a
+/// render too. `write_html` always renders, as the resources it returns hold
+/// files of the translation.
+///
+/// Each file and the manifest are written to a temporary sibling and renamed
+/// over their place, so a crash leaves an entry with a path or two less, never
+/// a torn file. Several processes may share a cache the same way.
+///
+/// The cache is pruned to the bounds in @p config before the service is made.
+/// If the cache cannot be written at all, @p translate is returned as is.
+[[nodiscard]] odr::HtmlService
+create_cached_service(const std::string &cache_path, const DecodedFile &file,
+                      const HtmlConfig &config, const Logger &logger,
+                      const std::function<odr::HtmlService()> &translate);
+
+/// Removes the entries of the translation cache under @p cache_path unused for
+/// longer than @p max_age, then the least recently used until the rest take at
+/// most @p max_bytes, and whatever an interrupted write or removal left behind.
+/// A bound of 0 is no bound; the entry named @p keep stays whatever its age or
+/// size. Only a directory named by a key and holding a manifest counts as an
+/// entry; anything else is left alone.
+void prune_translation_cache(const std::filesystem::path &cache_path,
+                             std::uintmax_t max_bytes,
+                             std::chrono::seconds max_age,
+                             const std::string &keep = {});
+
+} // namespace odr::internal::html
@@ -1,13 +1,35 @@
 #include <odr/internal/json/json_file.hpp>
 
+#include <odr/exceptions.hpp>
+#include <odr/odr.hpp>
+
+#include <odr/internal/encoding/detect.hpp>
+#include <odr/internal/encoding/transcode.hpp>
 #include <odr/internal/json/json_util.hpp>
 
+#include <istream>
+#include <string>
+
 namespace odr::internal::json {
 
-JsonFile::JsonFile(std::shared_ptr<text::TextFile> file)
+JsonFile::JsonFile(std::shared_ptr<text::TextFile> file,
+                   const Validation validation)
     : m_file{std::move(file)} {
-  // TODO use text file?
-  check_json_file(*m_file->file()->stream());
+  if (!text_encoding_is_decodable(m_file->encoding())) {
+    throw NoJsonFile();
+  }
+
+  if (validation == Validation::whole) {
+    check_json_file(m_file->text());
+    return;
+  }
+
+  const std::unique_ptr<std::istream> in = m_file->file()->stream();
+  const std::string bytes = encoding::read_probe(*in);
+  const bool complete = bytes.size() < encoding::default_probe_size;
+  if (!probe(encoding::to_utf8(bytes, m_file->encoding()), complete)) {
+    throw NoJsonFile();
+  }
 }
 
 std::shared_ptr<abstract::File> JsonFile::file() const noexcept {
@@ -8,9 +8,20 @@
 
 namespace odr::internal::json {
 
+/// How much of a file `JsonFile` reads to accept it.
+enum class Validation {
+  /// the opening bytes, by `json::probe`: enough to tell json from other text
+  prefix,
+  /// all of it, by `json::check_json_file`: for a file said to be json
+  whole,
+};
+
 class JsonFile final : public abstract::TextFile {
 public:
-  explicit JsonFile(std::shared_ptr<text::TextFile> file);
+  /// @throws NoJsonFile if @p file does not pass @p validation, or cannot be
+  /// decoded - json is Unicode by definition.
+  explicit JsonFile(std::shared_ptr<text::TextFile> file,
+                    Validation validation = Validation::prefix);
 
   [[nodiscard]] std::shared_ptr<abstract::File> file() const noexcept override;
 
@@ -1,13 +1,75 @@
 #include <odr/internal/json/json_util.hpp>
 
+#include <odr/exceptions.hpp>
+
+#include <cstddef>
+#include <string>
+
 #include <nlohmann/json.hpp>
 
-namespace odr::internal {
+namespace odr::internal::json {
+
+namespace {
+
+/// Keeps nothing; only the verdict of `sax_parse` is wanted. A syntax error
+/// past the last byte is the lexer reading the end of the input - the cut -
+/// rather than a byte of it.
+class Verdict final : public nlohmann::json::json_sax_t {
+public:
+  explicit Verdict(const std::size_t size) : m_size{size} {}
+
+  bool null() override { return true; }
+  bool boolean(bool /*value*/) override { return true; }
+  bool number_integer(number_integer_t /*value*/) override { return true; }
+  bool number_unsigned(number_unsigned_t /*value*/) override { return true; }
+  bool number_float(number_float_t /*value*/,
+                    const string_t & /*text*/) override {
+    return true;
+  }
+  bool string(string_t & /*value*/) override { return true; }
+  bool binary(binary_t & /*value*/) override { return true; }
+  bool start_object(std::size_t /*elements*/) override { return true; }
+  bool key(string_t & /*value*/) override { return true; }
+  bool end_object() override { return true; }
+  bool start_array(std::size_t /*elements*/) override { return true; }
+  bool end_array() override { return true; }
+
+  bool parse_error(const std::size_t position, const std::string & /*token*/,
+                   const nlohmann::json::exception & /*error*/) override {
+    m_cut = position > m_size;
+    return false;
+  }
+
+  [[nodiscard]] bool cut() const { return m_cut; }
+
+private:
+  std::size_t m_size;
+  bool m_cut{false};
+};
+
+} // namespace
+
+void check_json_file(const std::string_view text) {
+  if (!nlohmann::json::accept(text)) {
+    throw NoJsonFile();
+  }
+}
+
+bool probe(std::string_view text, const bool complete) {
+  if (text.starts_with("\xef\xbb\xbf")) {
+    text.remove_prefix(3);
+  }
+  const std::size_t first = text.find_first_not_of(" \t\r\n");
+  if (first == std::string_view::npos ||
+      (text[first] != '{' && text[first] != '[')) {
+    return false;
+  }
 
-void json::check_json_file(std::istream &in) {
-  // TODO limit check size
-  std::ignore = nlohmann::json::parse(in);
-  // TODO check if that even works
+  Verdict verdict(text.size());
+  if (nlohmann::json::sax_parse(text, &verdict)) {
+    return true;
+  }
+  return !complete && verdict.cut();
 }
 
-} // namespace odr::internal
+} // namespace odr::internal::json
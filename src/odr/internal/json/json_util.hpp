@@ -1,9 +1,23 @@
 #pragma once
 
-#include <iosfwd>
+#include <string_view>
 
 namespace odr::internal::json {
 
-void check_json_file(std::istream &in);
+/// Parses all of @p text, decoded UTF-8, and throws the result away. Accepts
+/// what RFC 8259 accepts, a bare scalar included.
+///
+/// @throws NoJsonFile if @p text is not a json document.
+void check_json_file(std::string_view text);
 
-}
+/// Whether @p text, a file's opening bytes decoded to UTF-8, reads as the head
+/// of a json document. @p complete says whether that is the whole file: a
+/// prefix is supposed to end mid-document, so running out of input rejects
+/// only a complete file, and only a syntax error before the cut rejects a
+/// prefix. No dom is built.
+///
+/// A detection heuristic, as `csv::probe` is: the first value has to be an
+/// object or an array, since a bare `42` is also any text or one-column csv.
+[[nodiscard]] bool probe(std::string_view text, bool complete);
+
+} // namespace odr::internal::json
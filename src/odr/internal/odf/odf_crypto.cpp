@@ -10,7 +10,11 @@
 #include <odr/internal/zip/zip_archive.hpp>
 #include <odr/internal/zip/zip_file.hpp>
 
+#include <istream>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
 
 namespace odr::internal {
 
@@ -60,6 +64,32 @@ std::string odf::decrypt(const std::string &input,
   }
 }
 
+std::unique_ptr<std::istream>
+odf::decrypt_inflate(std::unique_ptr<std::istream> input,
+                     const std::string &derived_key,
+                     const std::string &initialisation_vector,
+                     const AlgorithmType algorithm) {
+  crypto::util::StreamCipher cipher;
+  switch (algorithm) {
+  case AlgorithmType::AES256_CBC:
+    cipher = crypto::util::StreamCipher::aes_cbc;
+    break;
+  case AlgorithmType::TRIPLE_DES_CBC:
+    cipher = crypto::util::StreamCipher::triple_des_cbc;
+    break;
+  case AlgorithmType::BLOWFISH_CFB:
+    cipher = crypto::util::StreamCipher::blowfish_cfb;
+    break;
+  case AlgorithmType::AES256_GCM:
+    cipher = crypto::util::StreamCipher::aes_gcm;
+    break;
+  default:
+    throw std::invalid_argument("algorithm");
+  }
+  return crypto::util::decrypt_inflate(std::move(input), cipher, derived_key,
+                                       initialisation_vector);
+}
+
 std::string odf::start_key(const Manifest::Entry &entry,
                            const std::string &password) {
   const std::string result = hash(password, entry.start_key_generation.type);
@@ -113,6 +143,41 @@ bool odf::validate_password(const Manifest::Entry &entry,
 
 namespace odf {
 namespace {
+/// An encrypted entry, decrypted and inflated anew by each `stream()`. The
+/// plaintext is never held whole, in memory or on disk.
+class DecryptedFile final : public abstract::File {
+public:
+  DecryptedFile(std::shared_ptr<abstract::File> source,
+                const Manifest::Entry &entry, std::string derived_key)
+      : m_source{std::move(source)}, m_size{entry.size},
+        m_algorithm{entry.algorithm}, m_derived_key{std::move(derived_key)} {}
+
+  [[nodiscard]] FileLocation location() const noexcept override {
+    return m_source->location();
+  }
+  /// The manifest's size of the plaintext.
+  [[nodiscard]] std::size_t size() const override { return m_size; }
+
+  [[nodiscard]] std::optional<AbsPath> disk_path() const override {
+    return std::nullopt;
+  }
+  [[nodiscard]] std::optional<std::string_view> memory_data() const override {
+    return std::nullopt;
+  }
+
+  [[nodiscard]] std::unique_ptr<std::istream> stream() const override {
+    return decrypt_inflate(m_source->stream(), m_derived_key,
+                           m_algorithm.initialisation_vector,
+                           m_algorithm.type);
+  }
+
+private:
+  std::shared_ptr<abstract::File> m_source;
+  std::size_t m_size;
+  Manifest::Entry::Algorithm m_algorithm;
+  std::string m_derived_key;
+};
+
 class DecryptedFilesystem final : public abstract::ReadableFilesystem {
 public:
   DecryptedFilesystem(std::shared_ptr<ReadableFilesystem> parent,
@@ -146,12 +211,19 @@ public:
     if (!can_decrypt(it->second)) {
       throw UnsupportedCryptoAlgorithm();
     }
-    // TODO stream
-    const auto source = m_parent->open(path)->stream();
-    const std::string input = util::stream::read(*source);
-    std::string result = crypto::util::inflate(
-        derive_key_and_decrypt(it->second, m_start_key, input));
-    return std::make_shared<MemoryFile>(result);
+    // the key is derived once per open, the entry decrypted per stream
+    const Manifest::Entry &entry = it->second;
+    std::shared_ptr<abstract::File> source = m_parent->open(path);
+    std::string derived_key = derive_key(entry, m_start_key);
+    // A GCM tag is only met at the end of the stream, after the parser has
+    // used what came before it, so a tampered entry is refused here instead.
+    if (entry.algorithm.type == AlgorithmType::AES256_GCM &&
+        !crypto::util::verify_aes_gcm(*source->stream(), derived_key,
+                                      entry.algorithm.initialisation_vector)) {
+      throw DecryptionFailed();
+    }
+    return std::make_shared<DecryptedFile>(std::move(source), entry,
+                                           std::move(derived_key));
   }
 
 private:
@@ -173,13 +245,19 @@ odf::decrypt(const std::shared_ptr<abstract::ReadableFilesystem> &filesystem,
       it != std::end(manifest.entries)) {
     try {
       const std::string start_key = odf::start_key(it->second, password);
-      const std::string input =
-          util::stream::read(*filesystem->open(it->first)->stream());
-      std::string decrypt = crypto::util::inflate(
-          derive_key_and_decrypt(it->second, start_key, input));
+      const auto source = filesystem->open(it->first);
+      const auto decrypted = decrypt_inflate(
+          source->stream(), derive_key(it->second, start_key),
+          it->second.algorithm.initialisation_vector,
+          it->second.algorithm.type);
 
-      const auto memory_file = std::make_shared<MemoryFile>(std::move(decrypt));
-      return zip::ZipFile(memory_file).archive()->as_filesystem();
+      // The zip reader seeks, so the inner package is read whole. It stays in
+      // memory, as plaintext of a protected document must not reach the disk,
+      // and the read runs to the end, where a GCM tag is checked, before the
+      // package is handed to the zip reader.
+      const auto package =
+          std::make_shared<MemoryFile>(util::stream::read(*decrypted));
+      return zip::ZipFile(package).archive()->as_filesystem();
     } catch (...) {
       throw WrongPasswordError();
     }
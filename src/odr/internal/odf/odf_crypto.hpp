@@ -3,6 +3,7 @@
 #include <odr/internal/odf/odf_manifest.hpp>
 #include <odr/internal/odf/odf_meta.hpp>
 
+#include <iosfwd>
 #include <memory>
 #include <string>
 
@@ -20,6 +21,13 @@ std::string decrypt(const std::string &input, const std::string &derived_key,
                     const std::string &initialisation_vector,
                     AlgorithmType algorithm);
 
+/// Decrypts and inflates @p input as the returned stream is read.
+std::unique_ptr<std::istream>
+decrypt_inflate(std::unique_ptr<std::istream> input,
+                const std::string &derived_key,
+                const std::string &initialisation_vector,
+                AlgorithmType algorithm);
+
 std::string start_key(const Manifest::Entry &entry,
                       const std::string &password);
 
@@ -94,7 +94,8 @@ std::shared_ptr<abstract::Document> OfficeOpenXmlFile::document() const {
   case FileType::office_open_xml_presentation:
     return std::make_shared<presentation::Document>(m_files);
   case FileType::office_open_xml_workbook:
-    return std::make_shared<spreadsheet::Document>(m_files);
+    return std::make_shared<spreadsheet::Document>(
+        m_files, spreadsheet::SheetLoading::lazy);
   default:
     throw UnsupportedFileType(file_type());
   }
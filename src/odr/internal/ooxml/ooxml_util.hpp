@@ -50,7 +50,6 @@ std::optional<std::string> read_border_node(pugi::xml_node);
 using Relations = std::unordered_map<std::string, std::string>;
 using XmlDocumentsAndRelations =
     std::unordered_map<AbsPath, std::pair<pugi::xml_document, Relations>>;
-using SharedStrings = std::vector<pugi::xml_node>;
 
 std::unordered_map<std::string, std::string>
 parse_relationships(const pugi::xml_document &relations);
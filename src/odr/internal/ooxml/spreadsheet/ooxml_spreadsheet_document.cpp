@@ -10,6 +10,8 @@
 #include <odr/internal/util/document_util.hpp>
 #include <odr/internal/util/xml_util.hpp>
 
+#include <exception>
+#include <mutex>
 #include <utility>
 
 namespace odr::internal::ooxml::spreadsheet {
@@ -19,42 +21,34 @@ std::unique_ptr<abstract::ElementAdapter>
 create_element_adapter(const Document &document, ElementRegistry &registry);
 }
 
-Document::Document(std::shared_ptr<abstract::ReadableFilesystem> files)
+Document::Document(std::shared_ptr<abstract::ReadableFilesystem> files,
+                   const SheetLoading loading)
     : internal::Document(FileType::office_open_xml_workbook,
                          DocumentType::spreadsheet, std::move(files)) {
   const AbsPath workbook_path("/xl/workbook.xml");
   const auto [workbook_xml, workbook_relations] = parse_xml_(workbook_path);
   const auto [styles_xml, _] = parse_xml_(AbsPath("/xl/styles.xml"));
 
-  for (pugi::xml_node sheet_node :
-       workbook_xml.document_element().child("sheets").children("sheet")) {
-    const char *id = sheet_node.attribute("r:id").value();
-    const AbsPath sheet_path =
-        workbook_path.parent().join(RelPath(workbook_relations.at(id)));
-    const auto [sheet_xml, sheet_relationships] = parse_xml_(sheet_path);
-
-    if (const pugi::xml_node drawing =
-            sheet_xml.document_element().child("drawing")) {
-      const AbsPath drawing_path = sheet_path.parent().join(
-          RelPath(sheet_relationships.at(drawing.attribute("r:id").value())));
-      parse_xml_(drawing_path);
+  if (loading == SheetLoading::eager) {
+    for (pugi::xml_node sheet_node :
+         workbook_xml.document_element().child("sheets").children("sheet")) {
+      const char *id = sheet_node.attribute("r:id").value();
+      parse_sheet_xml_(
+          workbook_path.parent().join(RelPath(workbook_relations.at(id))));
     }
   }
 
-  if (m_files->exists(AbsPath("/xl/sharedStrings.xml"))) {
-    const auto [shared_strings_xml, _] =
-        parse_xml_(AbsPath("/xl/sharedStrings.xml"));
-    for (const pugi::xml_node shared_string :
-         shared_strings_xml.document_element()) {
-      m_shared_strings.push_back(shared_string);
-    }
+  if (const AbsPath shared_strings_path("/xl/sharedStrings.xml");
+      m_files->exists(shared_strings_path)) {
+    m_shared_strings = SharedStrings(m_files->open(shared_strings_path));
   }
 
   m_style_registry = StyleRegistry(styles_xml.document_element());
 
-  const ParseContext parse_context(workbook_path, workbook_relations,
-                                   m_xml_documents_and_relations,
-                                   m_shared_strings);
+  const ParseContext parse_context(
+      workbook_path, workbook_relations, m_xml_documents_and_relations,
+      m_shared_strings,
+      loading == SheetLoading::lazy ? &m_unloaded_sheets : nullptr);
   m_root_element = parse_tree(m_element_registry, parse_context,
                               workbook_xml.document_element());
 
@@ -83,8 +77,46 @@ void Document::save(const Path & /*path*/, const char * /*password*/) const {
   throw UnsupportedOperation();
 }
 
+std::shared_lock<std::shared_mutex>
+Document::lock_registry(const ElementIdentifier element_id) const {
+  std::shared_lock lock(m_registry_mutex);
+  if (const auto it = m_failed_sheets.find(element_id);
+      it != std::end(m_failed_sheets)) {
+    std::rethrow_exception(it->second);
+  }
+  if (!m_unloaded_sheets.contains(element_id)) {
+    return lock;
+  }
+  lock.unlock();
+
+  {
+    std::unique_lock exclusive(m_registry_mutex);
+    // another reader may have loaded the sheet in between, or failed to
+    if (const auto it = m_unloaded_sheets.find(element_id);
+        it != std::end(m_unloaded_sheets)) {
+      const AbsPath sheet_path = std::move(it->second);
+      m_unloaded_sheets.erase(it);
+      try {
+        load_sheet_(element_id, sheet_path);
+      } catch (...) {
+        // what got into the registry stays, so the sheet is not parsed into
+        // it a second time; every later access fails the same way instead of
+        // reading a part of the sheet
+        m_failed_sheets.emplace(element_id, std::current_exception());
+        throw;
+      }
+    } else if (const auto failed = m_failed_sheets.find(element_id);
+               failed != std::end(m_failed_sheets)) {
+      std::rethrow_exception(failed->second);
+    }
+  }
+
+  lock.lock();
+  return lock;
+}
+
 std::pair<pugi::xml_document &, Relations &>
-Document::parse_xml_(const AbsPath &path) {
+Document::parse_xml_(const AbsPath &path) const {
   pugi::xml_document document = util::xml::parse(*m_files, path);
   Relations relations = parse_relationships(*m_files, path);
 
@@ -93,6 +125,30 @@ Document::parse_xml_(const AbsPath &path) {
   return {it->second.first, it->second.second};
 }
 
+std::pair<pugi::xml_document &, Relations &>
+Document::parse_sheet_xml_(const AbsPath &sheet_path) const {
+  const auto [sheet_xml, sheet_relations] = parse_xml_(sheet_path);
+
+  if (const pugi::xml_node drawing =
+          sheet_xml.document_element().child("drawing")) {
+    const AbsPath drawing_path = sheet_path.parent().join(
+        RelPath(sheet_relations.at(drawing.attribute("r:id").value())));
+    parse_xml_(drawing_path);
+  }
+
+  return {sheet_xml, sheet_relations};
+}
+
+void Document::load_sheet_(const ElementIdentifier sheet_id,
+                           const AbsPath &sheet_path) const {
+  const auto [sheet_xml, sheet_relations] = parse_sheet_xml_(sheet_path);
+  const ParseContext sheet_context(sheet_path, sheet_relations,
+                                   m_xml_documents_and_relations,
+                                   m_shared_strings);
+  parse_sheet(m_element_registry, sheet_context, sheet_id,
+              sheet_xml.document_element());
+}
+
 namespace {
 
 class ElementAdapter final : public abstract::ElementAdapter,
@@ -111,27 +167,37 @@ public:
 
   [[nodiscard]] ElementType
   element_type(const ElementIdentifier element_id) const override {
+    // fixed when a sheet is registered, so walking the sheets loads none
+    const auto lock = m_document->lock_registry(null_element_id);
     return m_registry->element_at(element_id).type;
   }
 
   [[nodiscard]] ElementIdentifier
   element_parent(const ElementIdentifier element_id) const override {
+    // fixed when a sheet is registered, so walking the sheets loads none
+    const auto lock = m_document->lock_registry(null_element_id);
     return m_registry->element_at(element_id).parent_id;
   }
   [[nodiscard]] ElementIdentifier
   element_first_child(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return m_registry->element_at(element_id).first_child_id;
   }
   [[nodiscard]] ElementIdentifier
   element_last_child(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return m_registry->element_at(element_id).last_child_id;
   }
   [[nodiscard]] ElementIdentifier
   element_previous_sibling(const ElementIdentifier element_id) const override {
+    // fixed when a sheet is registered, so walking the sheets loads none
+    const auto lock = m_document->lock_registry(null_element_id);
     return m_registry->element_at(element_id).previous_sibling_id;
   }
   [[nodiscard]] ElementIdentifier
   element_next_sibling(const ElementIdentifier element_id) const override {
+    // fixed when a sheet is registered, so walking the sheets loads none
+    const auto lock = m_document->lock_registry(null_element_id);
     return m_registry->element_at(element_id).next_sibling_id;
   }
 
@@ -197,10 +263,13 @@ public:
 
   [[nodiscard]] std::string
   sheet_name(const ElementIdentifier element_id) const override {
+    // the name is there before the sheet loads
+    const auto lock = m_document->lock_registry(null_element_id);
     return m_registry->sheet_element_at(element_id).name;
   }
   [[nodiscard]] TableDimensions
   sheet_dimensions(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return m_registry->sheet_element_at(element_id).dimensions;
   }
   [[nodiscard]] TableDimensions
@@ -212,6 +281,7 @@ public:
   [[nodiscard]] ElementIdentifier
   sheet_cell(const ElementIdentifier element_id, const std::uint32_t column,
              const std::uint32_t row) const override {
+    const auto lock = m_document->lock_registry(element_id);
     const ElementRegistry::Sheet &sheet_element =
         m_registry->sheet_element_at(element_id);
     if (const ElementRegistry::Sheet::Cell *cell =
@@ -223,6 +293,7 @@ public:
   }
   [[nodiscard]] ElementIdentifier
   sheet_first_shape(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return m_registry->sheet_element_at(element_id).first_shape_id;
   }
   [[nodiscard]] TableStyle sheet_style(
@@ -232,6 +303,7 @@ public:
   [[nodiscard]] TableColumnStyle
   sheet_column_style(const ElementIdentifier element_id,
                      const std::uint32_t column) const override {
+    const auto lock = m_document->lock_registry(element_id);
     const ElementRegistry::Sheet &sheet_element =
         m_registry->sheet_element_at(element_id);
     const pugi::xml_node column_node = sheet_element.column_node(column);
@@ -245,6 +317,7 @@ public:
   [[nodiscard]] TableRowStyle
   sheet_row_style(const ElementIdentifier element_id,
                   const std::uint32_t row) const override {
+    const auto lock = m_document->lock_registry(element_id);
     const ElementRegistry::Sheet &sheet_element =
         m_registry->sheet_element_at(element_id);
     const pugi::xml_node row_node = sheet_element.row_node(row);
@@ -259,6 +332,7 @@ public:
   sheet_cell_style(const ElementIdentifier element_id,
                    const std::uint32_t column,
                    const std::uint32_t row) const override {
+    const auto lock = m_document->lock_registry(element_id);
     const ElementRegistry::Sheet &sheet_element =
         m_registry->sheet_element_at(element_id);
     const pugi::xml_node cell_node = sheet_element.cell_node(column, row);
@@ -274,20 +348,24 @@ public:
 
   [[nodiscard]] TablePosition
   sheet_cell_position(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return m_registry->sheet_cell_element_at(element_id).position;
   }
   [[nodiscard]] bool
   sheet_cell_is_covered(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return m_registry->sheet_cell_element_at(element_id).is_covered;
   }
   [[nodiscard]] TableDimensions
   sheet_cell_span(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return m_registry->sheet_cell_element_at(element_id).span;
   }
   [[nodiscard]] ValueType
   sheet_cell_value_type(const ElementIdentifier element_id) const override {
     // ECMA-376 `c/@t` defaults to "n" (number); strings come as shared ("s"),
     // inline ("inlineStr"), or formula ("str") cells.
+    const auto lock = m_document->lock_registry(element_id);
     const pugi::xml_node node = get_node(element_id);
     const std::string type = node.attribute("t").value();
     if (type == "s" || type == "str" || type == "inlineStr" || type == "b" ||
@@ -302,25 +380,30 @@ public:
 
   [[nodiscard]] TextStyle
   line_break_style(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return get_intermediate_style(element_id).text_style;
   }
 
   [[nodiscard]] ParagraphStyle
   paragraph_style(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return get_intermediate_style(element_id).paragraph_style;
   }
   [[nodiscard]] TextStyle
   paragraph_text_style(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return get_intermediate_style(element_id).text_style;
   }
 
   [[nodiscard]] TextStyle
   span_style(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return get_intermediate_style(element_id).text_style;
   }
 
   [[nodiscard]] std::string
   text_content(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     const ElementRegistry::Text &text_element =
         m_registry->text_element_at(element_id);
 
@@ -341,6 +424,7 @@ public:
   }
   [[nodiscard]] TextStyle
   text_style(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return get_intermediate_style(element_id).text_style;
   }
 
@@ -355,6 +439,7 @@ public:
   }
   [[nodiscard]] std::optional<Measure>
   frame_x(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return read_emus_attribute(get_node(element_id)
                                    .child("xdr:pic")
                                    .child("xdr:spPr")
@@ -364,6 +449,7 @@ public:
   }
   [[nodiscard]] std::optional<Measure>
   frame_y(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return read_emus_attribute(get_node(element_id)
                                    .child("xdr:pic")
                                    .child("xdr:spPr")
@@ -373,6 +459,7 @@ public:
   }
   [[nodiscard]] std::optional<Measure>
   frame_width(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return read_emus_attribute(get_node(element_id)
                                    .child("xdr:pic")
                                    .child("xdr:spPr")
@@ -382,6 +469,7 @@ public:
   }
   [[nodiscard]] std::optional<Measure>
   frame_height(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     return read_emus_attribute(get_node(element_id)
                                    .child("xdr:pic")
                                    .child("xdr:spPr")
@@ -414,6 +502,7 @@ public:
   }
   [[nodiscard]] std::string
   image_href(const ElementIdentifier element_id) const override {
+    const auto lock = m_document->lock_registry(element_id);
     const pugi::xml_node node = get_node(element_id);
     if (const pugi::xml_attribute ref = node.attribute("r:embed"); ref) {
       if (const auto [relations, origin] = get_relations_and_origin(element_id);
@@ -431,6 +520,8 @@ private:
   const Document *m_document{nullptr};
   ElementRegistry *m_registry{nullptr};
 
+  // the helpers below expect the caller to hold `lock_registry`
+
   [[nodiscard]] pugi::xml_node
   get_node(const ElementIdentifier element_id) const {
     return m_registry->element_at(element_id).node;
@@ -446,8 +537,8 @@ private:
         element_relations != nullptr) {
       return {element_relations->relations, element_relations->origin};
     }
-    const ElementIdentifier parent_id = element_parent(element_id);
-    return get_relations_and_origin(parent_id);
+    return get_relations_and_origin(
+        m_registry->element_at(element_id).parent_id);
   }
 
   [[nodiscard]] static std::string get_text(const pugi::xml_node node) {
@@ -460,7 +551,7 @@ private:
 
   [[nodiscard]] ResolvedStyle
   get_partial_style(const ElementIdentifier element_id) const {
-    if (const ElementType type = element_type(element_id);
+    if (const ElementType type = m_registry->element_at(element_id).type;
         type == ElementType::sheet_cell) {
       return get_partial_cell_style(element_id);
     }
@@ -478,7 +569,8 @@ private:
 
   [[nodiscard]] ResolvedStyle
   get_intermediate_style(const ElementIdentifier element_id) const {
-    const ElementIdentifier parent_id = element_parent(element_id);
+    const ElementIdentifier parent_id =
+        m_registry->element_at(element_id).parent_id;
     if (parent_id == null_element_id) {
       return get_partial_style(element_id);
     }
@@ -4,9 +4,13 @@
 #include <odr/internal/common/path.hpp>
 #include <odr/internal/ooxml/ooxml_util.hpp>
 #include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_element_registry.hpp>
+#include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_parser.hpp>
+#include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_shared_strings.hpp>
 #include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_style.hpp>
 
+#include <exception>
 #include <memory>
+#include <shared_mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -14,9 +18,22 @@
 
 namespace odr::internal::ooxml::spreadsheet {
 
+/// When `Document` parses a worksheet into its element registry.
+enum class SheetLoading {
+  /// every worksheet and drawing, up front
+  eager,
+  /// only the sheet list of `workbook.xml` up front; a worksheet and its
+  /// drawing once `lock_registry` is first asked for its sheet
+  lazy,
+};
+
+/// Reads through the element adapter may run concurrently. Each takes the
+/// registry shared with `lock_registry`, as a lazy document grows it while a
+/// sheet loads.
 class Document final : public internal::Document {
 public:
-  explicit Document(std::shared_ptr<abstract::ReadableFilesystem> files);
+  explicit Document(std::shared_ptr<abstract::ReadableFilesystem> files,
+                    SheetLoading loading = SheetLoading::eager);
 
   [[nodiscard]] const ElementRegistry &element_registry() const;
   [[nodiscard]] const StyleRegistry &style_registry() const;
@@ -27,14 +44,32 @@ public:
   void save(const Path &path) const override;
   void save(const Path &path, const char *password) const override;
 
+  /// Shared access to the element registry, for as long as the lock is held.
+  /// If @p element_id is a sheet not loaded yet, it is loaded first; a read of
+  /// what a sheet has before it loads (its type, parent, siblings and name)
+  /// passes `null_element_id` instead. A sheet that fails to load throws the
+  /// same error on every later call for it.
+  [[nodiscard]] std::shared_lock<std::shared_mutex>
+  lock_registry(ElementIdentifier element_id) const;
+
 private:
-  XmlDocumentsAndRelations m_xml_documents_and_relations;
+  mutable XmlDocumentsAndRelations m_xml_documents_and_relations;
   SharedStrings m_shared_strings;
 
-  ElementRegistry m_element_registry;
+  mutable ElementRegistry m_element_registry;
   StyleRegistry m_style_registry;
 
-  std::pair<pugi::xml_document &, Relations &> parse_xml_(const AbsPath &path);
+  mutable std::shared_mutex m_registry_mutex;
+  mutable UnloadedSheets m_unloaded_sheets;
+  mutable std::unordered_map<ElementIdentifier, std::exception_ptr>
+      m_failed_sheets;
+
+  std::pair<pugi::xml_document &, Relations &>
+  parse_xml_(const AbsPath &path) const;
+  /// Parse @p sheet_path and its drawing, unless they are parsed already.
+  std::pair<pugi::xml_document &, Relations &>
+  parse_sheet_xml_(const AbsPath &sheet_path) const;
+  void load_sheet_(ElementIdentifier sheet_id, const AbsPath &sheet_path) const;
 };
 
 } // namespace odr::internal::ooxml::spreadsheet
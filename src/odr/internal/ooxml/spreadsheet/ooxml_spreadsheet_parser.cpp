@@ -4,6 +4,7 @@
 #include <odr/internal/common/path.hpp>
 #include <odr/internal/common/table_range.hpp>
 #include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_element_registry.hpp>
+#include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_shared_strings.hpp>
 
 #include <algorithm>
 #include <unordered_map>
@@ -64,6 +65,17 @@ void parse_root_children(ElementRegistry &registry, const ParseContext &context,
     const char *id = child_node.attribute("r:id").value();
     const AbsPath sheet_path = context.document_path().parent().join(
         RelPath(context.document_relations().at(id)));
+
+    if (UnloadedSheets *unloaded_sheets = context.unloaded_sheets();
+        unloaded_sheets != nullptr) {
+      const auto &[sheet, unused1, sheet_element] =
+          registry.create_sheet_element(pugi::xml_node());
+      sheet_element.name = child_node.attribute("name").value();
+      registry.append_child(parent_id, sheet);
+      unloaded_sheets->emplace(sheet, sheet_path);
+      continue;
+    }
+
     const auto &[sheet_xml, sheet_relations] =
         context.documents_and_relations().at(sheet_path);
     const ParseContext sheet_context(sheet_path, sheet_relations,
@@ -93,14 +105,11 @@ void parse_sheet_cell_children(ElementRegistry &registry,
   parse_any_element_children(registry, context, parent_id, node);
 }
 
-std::tuple<ElementIdentifier, pugi::xml_node>
-parse_sheet_element(ElementRegistry &registry, const ParseContext &context,
-                    const pugi::xml_node node) {
-  if (!node) {
-    return {null_element_id, pugi::xml_node()};
-  }
-
-  const auto &[element_id, _, sheet] = registry.create_sheet_element(node);
+void parse_sheet_contents(ElementRegistry &registry,
+                          const ParseContext &context,
+                          const ElementIdentifier element_id,
+                          const pugi::xml_node node) {
+  ElementRegistry::Sheet &sheet = registry.sheet_element_at(element_id);
   registry.attach_element_relations(element_id, context.document_relations(),
                                     context.document_path());
 
@@ -198,6 +207,18 @@ parse_sheet_element(ElementRegistry &registry, const ParseContext &context,
       registry.append_shape(element_id, shape);
     }
   }
+}
+
+std::tuple<ElementIdentifier, pugi::xml_node>
+parse_sheet_element(ElementRegistry &registry, const ParseContext &context,
+                    const pugi::xml_node node) {
+  if (!node) {
+    return {null_element_id, pugi::xml_node()};
+  }
+
+  const auto &[element_id, unused1, unused2] =
+      registry.create_sheet_element(node);
+  parse_sheet_contents(registry, context, element_id, node);
 
   return {element_id, node.next_sibling()};
 }
@@ -306,4 +327,12 @@ ElementIdentifier spreadsheet::parse_tree(ElementRegistry &registry,
   return root;
 }
 
+void spreadsheet::parse_sheet(ElementRegistry &registry,
+                              const ParseContext &context,
+                              const ElementIdentifier sheet_id,
+                              const pugi::xml_node node) {
+  registry.element_at(sheet_id).node = node;
+  parse_sheet_contents(registry, context, sheet_id, node);
+}
+
 } // namespace odr::internal::ooxml
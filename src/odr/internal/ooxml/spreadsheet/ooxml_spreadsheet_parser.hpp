@@ -4,23 +4,34 @@
 #include <odr/internal/common/path.hpp>
 #include <odr/internal/ooxml/ooxml_util.hpp>
 
+#include <unordered_map>
+
 namespace pugi {
 class xml_node;
 }
 
 namespace odr::internal::ooxml::spreadsheet {
 class ElementRegistry;
+class SharedStrings;
+
+/// The worksheets a lazy `parse_tree` left for later, by the id of the sheet
+/// element standing in for each, to their part.
+using UnloadedSheets = std::unordered_map<ElementIdentifier, AbsPath>;
 
 class ParseContext {
 public:
+  /// With @p unloaded_sheets, `parse_tree` creates each sheet element empty
+  /// and records it there instead of parsing its worksheet.
   ParseContext(const AbsPath &document_path,
                const Relations &document_relations,
                const XmlDocumentsAndRelations &xml_documents_and_relations,
-               const SharedStrings &shared_strings)
+               const SharedStrings &shared_strings,
+               UnloadedSheets *unloaded_sheets = nullptr)
       : m_document_path(&document_path),
         m_document_relations(&document_relations),
         m_xml_documents_and_relations(&xml_documents_and_relations),
-        m_shared_strings(&shared_strings) {}
+        m_shared_strings(&shared_strings), m_unloaded_sheets(unloaded_sheets) {
+  }
 
   [[nodiscard]] const AbsPath &document_path() const {
     return *m_document_path;
@@ -35,15 +46,24 @@ public:
   [[nodiscard]] const SharedStrings &shared_strings() const {
     return *m_shared_strings;
   }
+  [[nodiscard]] UnloadedSheets *unloaded_sheets() const {
+    return m_unloaded_sheets;
+  }
 
 private:
   const AbsPath *m_document_path{nullptr};
   const Relations *m_document_relations{nullptr};
   const XmlDocumentsAndRelations *m_xml_documents_and_relations{nullptr};
   const SharedStrings *m_shared_strings{nullptr};
+  UnloadedSheets *m_unloaded_sheets{nullptr};
 };
 
 ElementIdentifier parse_tree(ElementRegistry &registry,
                              const ParseContext &context, pugi::xml_node node);
 
+/// Parse the worksheet @p node into the sheet element @p sheet_id a lazy
+/// `parse_tree` created empty. @p context is the worksheet's.
+void parse_sheet(ElementRegistry &registry, const ParseContext &context,
+                 ElementIdentifier sheet_id, pugi::xml_node node);
+
 } // namespace odr::internal::ooxml::spreadsheet
@@ -0,0 +1,170 @@
+#include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_shared_strings.hpp>
+
+#include <odr/exceptions.hpp>
+
+#include <odr/internal/abstract/file.hpp>
+#include <odr/internal/util/stream_util.hpp>
+#include <odr/internal/util/string_util.hpp>
+#include <odr/internal/util/xml_util.hpp>
+
+#include <string_view>
+
+namespace odr::internal::ooxml::spreadsheet {
+
+namespace {
+
+bool is_entry_name(const std::string_view name) {
+  return name == "si" || name.ends_with(":si");
+}
+
+/// Whether byte offsets into @p xml delimit the same markup pugixml sees.
+bool is_utf8(const std::string &xml) {
+  if (xml.starts_with("\xef\xbb\xbf")) {
+    return true;
+  }
+  // utf-16 and utf-32, with or without a byte order mark
+  if (xml.size() >= 2 && (xml[0] == '\0' || xml[1] == '\0' ||
+                          xml.starts_with("\xfe\xff") ||
+                          xml.starts_with("\xff\xfe"))) {
+    return false;
+  }
+  util::stream::ViewStream in(xml);
+  const std::string encoding = util::xml::read_declared_encoding(in);
+  return encoding.empty() ||
+         util::string::equals_ignore_case(encoding, "utf-8");
+}
+
+/// Where the markup starting at @p at ends, one past its last byte. Quoted
+/// attribute values are skipped whole, so a `>` in one closes no tag.
+std::size_t markup_end(const std::string_view xml, const std::size_t at) {
+  const std::string_view rest = xml.substr(at);
+  const auto past = [&](const std::string_view terminator,
+                        const std::size_t from) {
+    const std::size_t end = xml.find(terminator, from);
+    return end == std::string_view::npos ? end : end + terminator.size();
+  };
+
+  if (rest.starts_with("<!--")) {
+    return past("-->", at + 4);
+  }
+  if (rest.starts_with("<![CDATA[")) {
+    return past("]]>", at + 9);
+  }
+  if (rest.starts_with("<?")) {
+    return past("?>", at + 2);
+  }
+
+  char quote = '\0';
+  for (std::size_t i = at + 1; i < xml.size(); ++i) {
+    if (quote != '\0') {
+      if (xml[i] == quote) {
+        quote = '\0';
+      }
+    } else if (xml[i] == '"' || xml[i] == '\'') {
+      quote = xml[i];
+    } else if (xml[i] == '>') {
+      return i + 1;
+    }
+  }
+  return std::string_view::npos;
+}
+
+/// The byte ranges of the `si` children of the document element of @p xml.
+/// Only markup is looked at; text between it is skipped with one `find`.
+std::vector<std::pair<std::size_t, std::size_t>>
+index_entries(const std::string_view xml) {
+  std::vector<std::pair<std::size_t, std::size_t>> result;
+
+  std::size_t depth = 0;
+  std::size_t entry_begin = std::string_view::npos;
+  for (std::size_t at = xml.find('<'); at != std::string_view::npos;
+       at = xml.find('<', at)) {
+    const std::size_t end = markup_end(xml, at);
+    if (end == std::string_view::npos) {
+      throw NoXmlFile();
+    }
+
+    const std::string_view tag = xml.substr(at, end - at);
+    if (tag.starts_with("<!") || tag.starts_with("<?")) {
+      // comment, CDATA section, doctype or processing instruction
+    } else if (tag.starts_with("</")) {
+      if (depth == 0) {
+        throw NoXmlFile();
+      }
+      --depth;
+      if (depth == 1 && entry_begin != std::string_view::npos) {
+        result.emplace_back(entry_begin, end);
+        entry_begin = std::string_view::npos;
+      }
+    } else {
+      const std::string_view name =
+          tag.substr(1, tag.find_first_of(" \t\r\n/>", 1) - 1);
+      const bool is_entry = depth == 1 && is_entry_name(name);
+      if (tag.ends_with("/>")) {
+        if (is_entry) {
+          result.emplace_back(at, end);
+        }
+      } else {
+        if (is_entry) {
+          entry_begin = at;
+        }
+        ++depth;
+      }
+    }
+
+    at = end;
+  }
+
+  return result;
+}
+
+} // namespace
+
+SharedStrings::SharedStrings(std::shared_ptr<abstract::File> file)
+    : m_file{std::move(file)} {}
+
+pugi::xml_node SharedStrings::at(const std::size_t index) const {
+  if (!m_indexed) {
+    index_();
+  }
+
+  if (!m_nodes.empty()) {
+    return m_nodes.at(index);
+  }
+
+  if (const auto it = m_parsed.find(index); it != std::end(m_parsed)) {
+    return it->second.document_element();
+  }
+
+  const auto [begin, end] = m_entries.at(index);
+  pugi::xml_document entry;
+  if (const auto success = entry.load_buffer(
+          m_xml.data() + begin, end - begin, pugi::parse_default,
+          pugi::encoding_utf8);
+      !success) {
+    throw NoXmlFile();
+  }
+  return m_parsed.emplace(index, std::move(entry))
+      .first->second.document_element();
+}
+
+void SharedStrings::index_() const {
+  if (m_file != nullptr) {
+    m_xml = util::stream::read(*m_file->stream());
+    if (is_utf8(m_xml)) {
+      m_entries = index_entries(m_xml);
+    } else {
+      m_xml.clear();
+      m_document = util::xml::parse(*m_file);
+      for (const pugi::xml_node entry : m_document.document_element()) {
+        if (is_entry_name(entry.name())) {
+          m_nodes.push_back(entry);
+        }
+      }
+    }
+  }
+
+  m_indexed = true;
+}
+
+} // namespace odr::internal::ooxml::spreadsheet
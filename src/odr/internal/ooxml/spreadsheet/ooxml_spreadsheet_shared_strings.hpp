@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pugixml.hpp>
+
+namespace odr::internal::abstract {
+class File;
+}
+
+namespace odr::internal::ooxml::spreadsheet {
+
+/// The workbook's shared string table (`xl/sharedStrings.xml`).
+///
+/// Nothing is read until the first `at()`, which reads the part as text and
+/// indexes the byte range of each `<si>` entry; an entry is parsed into a DOM
+/// of its own the first time a cell refers to it. A table that is not utf-8
+/// is parsed whole instead, as the offsets would not hold for it.
+///
+/// Not thread-safe: the document only calls it while it holds its registry
+/// exclusively.
+class SharedStrings final {
+public:
+  SharedStrings() = default;
+  /// @p file may be null for a workbook without a shared string table.
+  explicit SharedStrings(std::shared_ptr<abstract::File> file);
+
+  /// The `<si>` node of entry @p index. Throws `std::out_of_range` past the
+  /// end of the table, and `NoXmlFile` if the table is not well formed.
+  [[nodiscard]] pugi::xml_node at(std::size_t index) const;
+
+private:
+  std::shared_ptr<abstract::File> m_file;
+
+  mutable bool m_indexed{false};
+  mutable std::string m_xml;
+  /// Begin and end of each entry in `m_xml`.
+  mutable std::vector<std::pair<std::size_t, std::size_t>> m_entries;
+  mutable std::unordered_map<std::size_t, pugi::xml_document> m_parsed;
+
+  /// Only for a table that is not utf-8.
+  mutable pugi::xml_document m_document;
+  mutable std::vector<pugi::xml_node> m_nodes;
+
+  void index_() const;
+};
+
+} // namespace odr::internal::ooxml::spreadsheet
@@ -11,8 +11,12 @@
 #include <odr/internal/common/image_file.hpp>
 #include <odr/internal/common/media_file.hpp>
 #include <odr/internal/csv/csv_file.hpp>
+#include <odr/internal/csv/csv_util.hpp>
+#include <odr/internal/encoding/detect.hpp>
+#include <odr/internal/encoding/transcode.hpp>
 #include <odr/internal/font/font_file.hpp>
 #include <odr/internal/json/json_file.hpp>
+#include <odr/internal/json/json_util.hpp>
 #include <odr/internal/magic.hpp>
 #include <odr/internal/odf/odf_file.hpp>
 #include <odr/internal/oldms/oldms_file.hpp>
@@ -24,7 +28,10 @@
 #include <odr/internal/zip/zip_file.hpp>
 
 #include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <optional>
+#include <string>
 
 namespace odr::internal {
 
@@ -181,7 +188,7 @@ open_file_as(const std::shared_ptr<abstract::File> &file, const FileType as,
     ODR_VERBOSE(logger, "open as json");
     try {
       auto text = std::make_shared<text::TextFile>(file);
-      return std::make_unique<json::JsonFile>(text);
+      return std::make_unique<json::JsonFile>(text, json::Validation::whole);
     } catch (...) {
       ODR_VERBOSE(logger, "failed to open as json");
     }
@@ -228,6 +235,13 @@ open_file_as(const std::shared_ptr<abstract::File> &file, const FileType as,
 std::vector<FileType>
 open_strategy::list_file_types(const std::shared_ptr<abstract::File> &file,
                                const Logger &logger) {
+  return list_file_types(file, encoding::default_probe_size, logger);
+}
+
+std::vector<FileType>
+open_strategy::list_file_types(const std::shared_ptr<abstract::File> &file,
+                               const std::size_t probe_size,
+                               const Logger &logger) {
   std::vector<FileType> result;
 
   auto file_type = magic::file_type(*file);
@@ -294,42 +308,58 @@ open_strategy::list_file_types(const std::shared_ptr<abstract::File> &file,
       ODR_VERBOSE(logger, "failed to open as svm");
     }
   } else if (file_type == FileType::unknown) {
+    // Text formats have no magic. One prefix is read and every text format
+    // is probed on it, so naming a file costs the same whatever its size;
+    // what the prefix cannot show, `open_file_as` finds out.
     try {
-      ODR_VERBOSE(logger, "try open as text");
+      ODR_VERBOSE(logger, "probe the first " << probe_size << " bytes");
 
-      auto text = std::make_shared<text::TextFile>(file);
+      const std::string bytes =
+          encoding::read_probe(*file->stream(), probe_size);
+      const bool complete = bytes.size() < probe_size;
+      const TextEncoding encoding = encoding::detect(bytes);
       result.push_back(FileType::text_file);
 
-      try {
-        ODR_VERBOSE(logger, "try open as csv");
-        result.push_back(csv::CsvFile(text).file_type());
-      } catch (...) {
-        ODR_VERBOSE(logger, "failed to open as csv");
-      }
+      if (text_encoding_is_decodable(encoding)) {
+        const std::string text = encoding::to_utf8(bytes, encoding);
 
-      try {
-        ODR_VERBOSE(logger, "try open as json");
-        result.push_back(json::JsonFile(text).file_type());
-      } catch (...) {
-        ODR_VERBOSE(logger, "failed to open as json");
+        try {
+          ODR_VERBOSE(logger, "try probe as csv");
+          if (csv::probe(text, complete).is_csv) {
+            result.push_back(FileType::comma_separated_values);
+          }
+        } catch (...) {
+          ODR_VERBOSE(logger, "failed to probe as csv");
+        }
+
+        try {
+          ODR_VERBOSE(logger, "try probe as json");
+          if (json::probe(text, complete)) {
+            result.push_back(FileType::javascript_object_notation);
+          }
+        } catch (...) {
+          ODR_VERBOSE(logger, "failed to probe as json");
+        }
       }
 
       // an svg has no signature; only the xml root element tells it from plain
       // xml, so both are reported
       try {
-        ODR_VERBOSE(logger, "try open as xml");
-        auto xml_file = std::make_shared<xml::XmlFile>(text);
-        result.push_back(xml_file->file_type());
-
-        if (svg::is_svg_file(*xml_file)) {
-          ODR_VERBOSE(logger, "open as svg");
-          result.push_back(svg::SvgFile(xml_file).file_type());
+        ODR_VERBOSE(logger, "try probe as xml");
+        if (const std::optional<std::string> root_name =
+                xml::probe_root_name(bytes, encoding, complete)) {
+          result.push_back(FileType::xml);
+
+          if (svg::is_svg_root_name(*root_name)) {
+            ODR_VERBOSE(logger, "probe as svg");
+            result.push_back(FileType::scalable_vector_graphics);
+          }
         }
       } catch (...) {
-        ODR_VERBOSE(logger, "failed to open as xml");
+        ODR_VERBOSE(logger, "failed to probe as xml");
       }
     } catch (...) {
-      ODR_VERBOSE(logger, "failed to open as text");
+      ODR_VERBOSE(logger, "failed to probe as text");
     }
   } else {
     ODR_VERBOSE(logger, "anything else");
@@ -433,6 +463,8 @@ open_strategy::open_file(const std::shared_ptr<abstract::File> &file,
 
       try {
         ODR_VERBOSE(logger, "try open as json");
+        // a prefix, like the csv probe above: a json is not decoded, so
+        // there is no parse here to pay for by size
         return std::make_unique<json::JsonFile>(text);
       } catch (...) {
         ODR_VERBOSE(logger, "failed to open as json");
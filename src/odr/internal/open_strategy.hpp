@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -17,9 +18,16 @@ class DocumentFile;
 
 namespace odr::internal::open_strategy {
 
+/// The types @p file may be opened as, the container first and the most
+/// specific last. A file without magic is named from its first @p probe_size
+/// bytes alone - 64 KiB unless given - read once and shared by every text
+/// format, so a candidate listed here may still fail to open.
 std::vector<FileType>
 list_file_types(const std::shared_ptr<abstract::File> &file,
                 const Logger &logger);
+std::vector<FileType>
+list_file_types(const std::shared_ptr<abstract::File> &file,
+                std::size_t probe_size, const Logger &logger);
 
 std::unique_ptr<abstract::DecodedFile>
 open_file(const std::shared_ptr<abstract::File> &file, const Logger &logger);
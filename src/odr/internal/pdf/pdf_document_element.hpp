@@ -71,8 +71,13 @@ struct Pages final : Element {
 struct Page final : Element {
   Pages *parent{nullptr};
 
+  /// Both null and empty until `resolved`; see `ResourceLoading`.
   Resources *resources{nullptr};
   std::vector<Annotation *> annotations;
+  /// The `/Resources` in force, possibly inherited, that `resources` is parsed
+  /// from.
+  Object resources_object;
+  bool resolved{false};
 
   // resolved inheritable attributes (ISO 32000-1 7.7.3.3, Table 30)
   Object media_box;  // rectangle array
@@ -96,7 +101,8 @@ struct Annotation final : Element {
 };
 
 /// A resource dictionary (ISO 32000-1 7.8.3). Every subdictionary is resolved
-/// eagerly at parse time so extraction needs no parser handle. Element pointers
+/// with the page — at parse time, or lazily by `DocumentParser::resolve_page` —
+/// so extraction needs no parser handle. Element pointers
 /// are non-owning (the `Document` arena owns them); the plain value types
 /// (`ColorSpaceDef`, `Shading`, `SoftMaskDef`) are shared because a single one
 /// may be reached from several resources.
@@ -166,7 +172,7 @@ struct XObject final : Element {
   /// isolation, so the alpha/mask in force at `Do` applies to its result as a
   /// whole — even when its own content resets them.
   bool transparency_group{false};
-  std::string content; ///< decoded content stream, read eagerly
+  std::string content; ///< decoded content stream, read with the resources
 
   // --- image (`/Subtype /Image`) ---
   /// Browser-ready bytes: a `DCTDecode` JPEG passed through, or a raster
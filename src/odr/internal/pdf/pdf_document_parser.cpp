@@ -21,6 +21,7 @@
 #include <cctype>
 #include <istream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
 #include <set>
@@ -33,11 +34,13 @@ namespace odr::internal::pdf {
 namespace {
 
 struct State {
-  State(DocumentParser &parser, Document &document)
-      : m_parser(&parser), m_document(&document) {}
+  State(DocumentParser &parser, Document &document,
+        const ResourceLoading loading)
+      : m_parser(&parser), m_document(&document), m_loading{loading} {}
 
   DocumentParser &parser() const { return *m_parser; }
   Document &document() const { return *m_document; }
+  ResourceLoading loading() const { return m_loading; }
 
   [[nodiscard]] XObject *find_x_object(const ObjectReference &reference) const {
     const auto it = m_x_objects.find(reference);
@@ -45,6 +48,7 @@ struct State {
   }
   void cache_x_object(const ObjectReference &reference, XObject *x_object) {
     m_x_objects[reference] = x_object;
+    m_memoized.emplace_back(Memo::x_object, reference);
   }
 
   [[nodiscard]] Font *find_font(const ObjectReference &reference) const {
@@ -53,6 +57,7 @@ struct State {
   }
   void cache_font(const ObjectReference &reference, Font *font) {
     m_fonts[reference] = font;
+    m_memoized.emplace_back(Memo::font, reference);
   }
 
   [[nodiscard]] Pattern *find_pattern(const ObjectReference &reference) const {
@@ -61,6 +66,30 @@ struct State {
   }
   void cache_pattern(const ObjectReference &reference, Pattern *pattern) {
     m_patterns[reference] = pattern;
+    m_memoized.emplace_back(Memo::pattern, reference);
+  }
+
+  /// How many elements have been memoized; see `forget_since`.
+  [[nodiscard]] std::size_t memoized() const { return m_memoized.size(); }
+  /// Forgets every element memoized after the first @p count, as parsing them
+  /// failed and may have left them half built. They stay in the document, only
+  /// nothing finds them any more.
+  void forget_since(const std::size_t count) {
+    while (m_memoized.size() > count) {
+      const auto &[memo, reference] = m_memoized.back();
+      switch (memo) {
+      case Memo::x_object:
+        m_x_objects.erase(reference);
+        break;
+      case Memo::font:
+        m_fonts.erase(reference);
+        break;
+      case Memo::pattern:
+        m_patterns.erase(reference);
+        break;
+      }
+      m_memoized.pop_back();
+    }
   }
 
   /// The `Pages` nodes on the current `/Kids` path. The page tree is required
@@ -76,6 +105,7 @@ struct State {
 private:
   DocumentParser *m_parser{};
   Document *m_document{};
+  ResourceLoading m_loading{ResourceLoading::eager};
 
   /// Memoized XObject elements. Registering one *before* parsing its
   /// `/Resources` is what makes a cyclic form reference resolve to the
@@ -92,6 +122,10 @@ private:
   /// since a tiling pattern's `/Resources` may name patterns (even itself).
   std::map<ObjectReference, Pattern *> m_patterns;
 
+  enum class Memo { x_object, font, pattern };
+  /// What the three memos above gained, in order, for `forget_since`.
+  std::vector<std::pair<Memo, ObjectReference>> m_memoized;
+
   std::set<ObjectReference> m_active_pages;
 };
 
@@ -655,7 +689,7 @@ Font *parse_font(State &state, const ObjectReference &reference) {
   Font *font = state.document().create_element<Font>();
   state.cache_font(reference, font);
 
-  IndirectObject object = parser.read_object(reference);
+  IndirectObject object = *parser.read_object(reference);
   font->object_reference = reference;
   parse_font_dictionary(state, object.object.as_dictionary(), *font);
 
@@ -734,7 +768,9 @@ std::vector<std::uint8_t> resolve_mask_alpha(DocumentParser &parser,
   if (!mask.is_reference()) {
     return {};
   }
-  const IndirectObject &object = parser.read_object(mask.as_reference());
+  const std::shared_ptr<const IndirectObject> held =
+      parser.read_object(mask.as_reference());
+  const IndirectObject &object = *held;
   if (!object.object.is_dictionary()) {
     return {};
   }
@@ -890,7 +926,8 @@ void parse_image_data(DocumentParser &parser, const Dictionary &dictionary,
           parser.read_object_stream(object), filter, decode_parms, width,
           height, bits_per_component, color_space.get(), decode_array, alpha,
           color_key, smask_in_data,
-          jbig2_decode_options(parser, dictionary.get("DecodeParms")))) {
+          jbig2_decode_options(parser, dictionary.get("DecodeParms")),
+          parser.png_options())) {
     x_object.image_data = std::move(encoded->data);
     x_object.image_mime = std::move(encoded->mime);
   }
@@ -912,7 +949,7 @@ XObject *parse_x_object(State &state, const ObjectReference &reference,
   // here rather than recursing forever.
   state.cache_x_object(reference, x_object);
 
-  IndirectObject object = parser.read_object(reference);
+  IndirectObject object = *parser.read_object(reference);
   const Dictionary &dictionary = object.object.as_dictionary();
 
   x_object->object_reference = reference;
@@ -1039,7 +1076,7 @@ Pattern *parse_pattern(State &state, const ObjectReference &reference,
   // element rather than recursing forever.
   state.cache_pattern(reference, pattern);
 
-  IndirectObject object = parser.read_object(reference);
+  IndirectObject object = *parser.read_object(reference);
   if (!object.object.is_dictionary()) {
     return pattern;
   }
@@ -1353,13 +1390,40 @@ Annotation *parse_annotation(State &state, const Dictionary &dictionary) {
 }
 
 Annotation *parse_annotation(State &state, const ObjectReference &reference) {
-  IndirectObject object = state.parser().read_object(reference);
+  IndirectObject object = *state.parser().read_object(reference);
   Annotation *annotation =
       parse_annotation(state, object.object.as_dictionary());
   annotation->object_reference = reference;
   return annotation;
 }
 
+/// What `parse_page` defers under `ResourceLoading::lazy`: `/Resources` and
+/// the annotations, whose appearances are forms with resources of their own.
+void resolve_page_resources(State &state, Page &page) {
+  DocumentParser &parser = state.parser();
+  const Dictionary &dictionary = page.object.as_dictionary();
+
+  page.resources = parse_resources(state, page.resources_object);
+
+  if (dictionary.has_key("Annots")) {
+    // held by name: ranging over `as_array()` of the temporary would outlive it
+    const Object annotations = parser.resolve_object_copy(dictionary["Annots"]);
+    for (const Object &annotation : annotations.as_array()) {
+      // entries are usually indirect references, but inline annotation
+      // dictionaries are equally valid (12.5.2)
+      if (annotation.is_reference()) {
+        page.annotations.push_back(
+            parse_annotation(state, annotation.as_reference()));
+      } else if (annotation.is_dictionary()) {
+        page.annotations.push_back(
+            parse_annotation(state, annotation.as_dictionary()));
+      }
+    }
+  }
+
+  page.resolved = true;
+}
+
 Page *parse_page(State &state, const ObjectReference &reference, Pages *parent,
                  PageAttributes attributes) {
   DocumentParser &parser = state.parser();
@@ -1367,7 +1431,7 @@ Page *parse_page(State &state, const ObjectReference &reference, Pages *parent,
 
   Page *page = document.create_element<Page>();
 
-  IndirectObject object = parser.read_object(reference);
+  IndirectObject object = *parser.read_object(reference);
   const Dictionary &dictionary = object.object.as_dictionary();
 
   page->object_reference = reference;
@@ -1377,8 +1441,7 @@ Page *parse_page(State &state, const ObjectReference &reference, Pages *parent,
   // the page overlays its own inheritable entries, then the accumulated
   // attributes are resolved into the page with Table-30 defaults (7.7.3.4)
   attributes.overlay(dictionary);
-  const Object resources = attributes.resolve_into(*page, parser, reference);
-  page->resources = parse_resources(state, resources);
+  page->resources_object = attributes.resolve_into(*page, parser, reference);
 
   // `/Contents` is optional, and is one stream or an array of them (7.7.3.3).
   // Resolve first, so a reference *to an array* expands rather than being
@@ -1395,21 +1458,8 @@ Page *parse_page(State &state, const ObjectReference &reference, Pages *parent,
     }
   }
 
-  if (dictionary.has_key("Annots")) {
-    // TODO why rvalue not working?
-    const Array annotations =
-        parser.resolve_object_copy(dictionary["Annots"]).as_array();
-    for (const Object &annotation : annotations) {
-      // entries are usually indirect references, but inline annotation
-      // dictionaries are equally valid (12.5.2)
-      if (annotation.is_reference()) {
-        page->annotations.push_back(
-            parse_annotation(state, annotation.as_reference()));
-      } else if (annotation.is_dictionary()) {
-        page->annotations.push_back(
-            parse_annotation(state, annotation.as_dictionary()));
-      }
-    }
+  if (state.loading() == ResourceLoading::eager) {
+    resolve_page_resources(state, *page);
   }
 
   return page;
@@ -1428,7 +1478,7 @@ Pages *parse_pages(State &state, const ObjectReference &reference,
 
   auto *pages = document.create_element<Pages>();
 
-  IndirectObject object = parser.read_object(reference);
+  IndirectObject object = *parser.read_object(reference);
   const Dictionary &dictionary = object.object.as_dictionary();
 
   pages->object_reference = reference;
@@ -1451,7 +1501,7 @@ Element *parse_page_or_pages(State &state, const ObjectReference &reference,
   DocumentParser &parser = state.parser();
 
   // TODO we are parsing twice
-  IndirectObject object = parser.read_object(reference);
+  IndirectObject object = *parser.read_object(reference);
   const Dictionary &dictionary = object.object.as_dictionary();
   const std::string &type = dictionary["Type"].as_string();
 
@@ -1471,7 +1521,7 @@ Catalog *parse_catalog(State &state, const ObjectReference &reference) {
 
   auto *catalog = document.create_element<Catalog>();
 
-  IndirectObject object = parser.read_object(reference);
+  IndirectObject object = *parser.read_object(reference);
   const Dictionary &dictionary = object.object.as_dictionary();
   const ObjectReference &pages_reference = dictionary["Pages"].as_reference();
 
@@ -1482,23 +1532,28 @@ Catalog *parse_catalog(State &state, const ObjectReference &reference) {
   return catalog;
 }
 
-std::unique_ptr<Document> parse_document_impl(DocumentParser &parser,
-                                              const Dictionary &trailer) {
-  auto document = std::make_unique<Document>();
-
-  State state(parser, *document);
-
-  document->catalog = parse_catalog(state, trailer["Root"].as_reference());
-
-  return document;
-}
-
 } // namespace
 
+/// The parse state a lazily loaded document resolves its pages against: it
+/// memoizes the fonts, forms and patterns shared between pages, so they stay
+/// shared however late a page is resolved.
+struct DocumentParser::PageResolver {
+  PageResolver(DocumentParser &parser, Document &document,
+               const ResourceLoading loading)
+      : state(parser, document, loading) {}
+
+  /// Resolving adds elements to the document and fills the memos, both
+  /// shared; one page at a time.
+  std::mutex mutex;
+  State state;
+};
+
 DocumentParser::DocumentParser(std::unique_ptr<std::istream> in,
                                std::optional<Decryptor> decryptor,
                                const Logger &logger)
-    : m_stream(std::move(in)), m_parser(*m_stream), m_logger{logger} {
+    : m_stream(std::move(in)), m_parser(*m_stream), m_logger{logger},
+      m_objects{default_cache_budget / 2},
+      m_object_streams{default_cache_budget / 2} {
   try {
     auto [xref, trailer] = read_trailer_chain();
     m_xref = std::move(xref);
@@ -1513,9 +1568,11 @@ DocumentParser::DocumentParser(std::unique_ptr<std::istream> in,
     // Build an `Authenticator` from the trailer `/Encrypt` and `/ID`
     // (ISO 32000-1 7.6).
 
-    // The `/Encrypt` dictionary's own strings are never encrypted (7.6.2), and
-    // need no self-skip guard: resolving it here, before any decryptor exists,
-    // caches the raw strings that every later lookup then serves.
+    // The `/Encrypt` dictionary's own strings are never encrypted (7.6.2), so
+    // `read_object` leaves them be whenever it is read.
+    if (m_trailer["Encrypt"].is_reference()) {
+      m_encrypt_reference = m_trailer["Encrypt"].as_reference();
+    }
     Object encrypt = m_trailer["Encrypt"];
     resolve_object(encrypt);
     if (!encrypt.is_dictionary()) {
@@ -1579,12 +1636,15 @@ bool DocumentParser::authenticate(const std::string &password) {
   return m_decryptor.has_value();
 }
 
-const IndirectObject &
+std::shared_ptr<const IndirectObject>
 DocumentParser::read_object(const ObjectReference &reference) {
-  if (const auto it = m_objects.find(reference); it != std::end(m_objects)) {
-    return it->second;
+  if (std::shared_ptr<const IndirectObject> cached =
+          m_objects.find(reference)) {
+    return cached;
   }
 
+  const std::lock_guard lock(m_mutex);
+
   IndirectObject object;
   object.reference = reference;
 
@@ -1596,20 +1656,22 @@ DocumentParser::read_object(const ObjectReference &reference) {
   } else if (const Xref::Entry &entry = entry_it->second; entry.is_used()) {
     in().seekg(entry.as_used().position);
     object = parser().read_indirect_object();
-    // Decrypt string leaves (7.6.2). The /Encrypt dictionary needs no special
-    // case here: it is read and cached during construction before the
-    // decryptor is installed, so its un-decrypted /O,/U,… strings are served
-    // from the cache and never reach this path.
-    if (is_encrypted() && !is_authenticated()) {
-      throw UnauthenticatedReadError();
-    }
-    if (m_decryptor.has_value()) {
-      m_decryptor->decrypt_strings(object.object, object.reference);
+    // Decrypt string leaves (7.6.2), except for the /Encrypt dictionary's own
+    // strings, which are never encrypted. It is read before the decryptor
+    // exists, but may be evicted and read again after.
+    if (m_encrypt_reference != reference) {
+      if (is_encrypted() && !is_authenticated()) {
+        throw UnauthenticatedReadError();
+      }
+      if (m_decryptor.has_value()) {
+        m_decryptor->decrypt_strings(object.object, object.reference);
+      }
     }
   } else if (entry.is_compressed()) {
     const auto &[stream_id, index] = entry.as_compressed();
-    const ObjectStream &members =
+    const std::shared_ptr<const ObjectStream> held =
         load_object_stream(ObjectReference(stream_id, 0));
+    const ObjectStream &members = *held;
     if (index >= members.size()) {
       throw std::runtime_error("object stream member index out of range");
     }
@@ -1626,23 +1688,26 @@ DocumentParser::read_object(const ObjectReference &reference) {
                                                "as null");
   }
 
-  return m_objects.emplace(reference, std::move(object)).first->second;
+  return m_objects.insert(reference, std::move(object));
 }
 
-const ObjectStream &
+std::shared_ptr<const ObjectStream>
 DocumentParser::load_object_stream(const ObjectReference &reference) {
-  if (const auto it = m_object_streams.find(reference);
-      it != std::end(m_object_streams)) {
-    return it->second;
+  if (std::shared_ptr<const ObjectStream> cached =
+          m_object_streams.find(reference)) {
+    return cached;
   }
 
+  const std::lock_guard lock(m_mutex);
+
   const ObjectStreamScope scope(*this, reference);
   if (!scope.entered()) {
     throw std::runtime_error("cyclic object stream reference " +
                              reference.to_string());
   }
 
-  const IndirectObject &object = read_object(reference);
+  const std::shared_ptr<const IndirectObject> held = read_object(reference);
+  const IndirectObject &object = *held;
   if (!object.has_stream) {
     throw std::runtime_error("object stream " + reference.to_string() +
                              " has no stream data");
@@ -1655,9 +1720,8 @@ DocumentParser::load_object_stream(const ObjectReference &reference) {
       resolve_object_copy(dictionary["First"]).as_integer();
 
   util::stream::ViewStream in(data);
-  return m_object_streams
-      .emplace(reference, FileParser(in).read_object_stream(n, first))
-      .first->second;
+  return m_object_streams.insert(reference,
+                                 FileParser(in).read_object_stream(n, first));
 }
 
 bool DocumentParser::enter_object_stream(const ObjectReference &reference) {
@@ -1681,22 +1745,27 @@ DocumentParser::ObjectStreamScope::~ObjectStreamScope() {
 
 std::string
 DocumentParser::read_object_stream(const ObjectReference &reference) {
-  return read_object_stream(read_object(reference));
+  return read_object_stream(*read_object(reference));
 }
 
 std::string DocumentParser::read_object_stream(const IndirectObject &object) {
   Object length = object.object.as_dictionary().get("Length");
   resolve_object(length);
 
-  // a stream object always carries a stream position
-  // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
-  in().seekg(object.stream_position.value());
-  // A missing or unresolvable `/Length` is not fatal: the no-argument overload
-  // recovers the extent by scanning to the `endstream`/`endobj` terminator.
-  std::string raw = length.is_integer() && length.as_integer() >= 0
-                        ? m_parser.read_stream(
-                              static_cast<std::uint32_t>(length.as_integer()))
-                        : m_parser.read_stream();
+  std::string raw;
+  {
+    const std::lock_guard lock(m_mutex);
+    // a stream object always carries a stream position
+    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+    in().seekg(object.stream_position.value());
+    // A missing or unresolvable `/Length` is not fatal: the no-argument
+    // overload recovers the extent by scanning to the `endstream`/`endobj`
+    // terminator.
+    raw = length.is_integer() && length.as_integer() >= 0
+              ? m_parser.read_stream(
+                    static_cast<std::uint32_t>(length.as_integer()))
+              : m_parser.read_stream();
+  }
 
   // Decrypt before filter decoding (7.6.2). Cross-reference streams are read
   // during the trailer-chain walk, before the decryptor exists, so they are
@@ -1713,7 +1782,7 @@ std::string DocumentParser::read_object_stream(const IndirectObject &object) {
 
 std::string
 DocumentParser::read_decoded_stream(const ObjectReference &reference) {
-  return read_decoded_stream(read_object(reference));
+  return read_decoded_stream(*read_object(reference));
 }
 
 std::string DocumentParser::read_decoded_stream(const IndirectObject &object) {
@@ -1739,13 +1808,13 @@ std::string DocumentParser::read_decoded_stream(const IndirectObject &object) {
 
 void DocumentParser::resolve_object(Object &object) {
   if (object.is_reference()) {
-    object = read_object(object.as_reference()).object;
+    object = read_object(object.as_reference())->object;
   }
 }
 
 void DocumentParser::deep_resolve_object(Object &object) {
   if (object.is_reference()) {
-    object = read_object(object.as_reference()).object;
+    object = read_object(object.as_reference())->object;
   } else if (object.is_array()) {
     for (Object &e : object.as_array()) {
       deep_resolve_object(e);
@@ -1871,6 +1940,25 @@ std::pair<Xref, Dictionary> DocumentParser::read_trailer_chain() {
   return {std::move(result_xref), std::move(result_trailer).value()};
 }
 
+void DocumentParser::set_cache_budget(const std::size_t bytes) {
+  m_objects.set_budget(bytes / 2);
+  m_object_streams.set_budget(bytes - bytes / 2);
+}
+
+void DocumentParser::set_png_options(const PngOptions &options) {
+  m_png_options = options;
+}
+
+const PngOptions &DocumentParser::png_options() const { return m_png_options; }
+
+ObjectCacheStats DocumentParser::object_cache_stats() const {
+  return m_objects.stats();
+}
+
+ObjectCacheStats DocumentParser::object_stream_cache_stats() const {
+  return m_object_streams.stats();
+}
+
 void DocumentParser::recover_xref() {
   // Offsets from the failed attempt may be wrong, so anything cached from it is
   // suspect.
@@ -1899,7 +1987,9 @@ void DocumentParser::index_object_streams() {
 
   for (const ObjectReference &reference : candidates) {
     try {
-      const IndirectObject &object = read_object(reference);
+      const std::shared_ptr<const IndirectObject> held =
+          read_object(reference);
+      const IndirectObject &object = *held;
       if (!object.has_stream || !object.object.is_dictionary()) {
         continue;
       }
@@ -1908,7 +1998,9 @@ void DocumentParser::index_object_streams() {
           dictionary["Type"].as_name() != "ObjStm") {
         continue;
       }
-      const ObjectStream &members = load_object_stream(reference);
+      const std::shared_ptr<const ObjectStream> members_held =
+          load_object_stream(reference);
+      const ObjectStream &members = *members_held;
       for (std::size_t i = 0; i < members.size(); ++i) {
         // a directly recovered object wins over its compressed copy
         m_xref.table.try_emplace(ObjectReference(members[i].id, 0),
@@ -1929,11 +2021,12 @@ void DocumentParser::recover_root() {
       continue;
     }
     try {
-      const IndirectObject &object = read_object(reference);
-      if (!object.object.is_dictionary()) {
+      const std::shared_ptr<const IndirectObject> object =
+          read_object(reference);
+      if (!object->object.is_dictionary()) {
         continue;
       }
-      const Dictionary &dictionary = object.object.as_dictionary();
+      const Dictionary &dictionary = object->object.as_dictionary();
       if (dictionary.get("Type").is_name() &&
           dictionary["Type"].as_name() == "Catalog") {
         ODR_WARNING(m_logger, "pdf: recovered document catalog " << reference);
@@ -1947,9 +2040,25 @@ void DocumentParser::recover_root() {
   ODR_WARNING(m_logger, "pdf: recovery found no document catalog");
 }
 
-std::unique_ptr<Document> DocumentParser::parse_document() {
+DocumentParser::~DocumentParser() = default;
+
+std::unique_ptr<Document> DocumentParser::parse_document_impl(
+    const ResourceLoading loading) {
+  auto document = std::make_unique<Document>();
+  auto resolver = std::make_unique<PageResolver>(*this, *document, loading);
+
+  document->catalog =
+      parse_catalog(resolver->state, m_trailer["Root"].as_reference());
+
+  m_page_resolver = loading == ResourceLoading::lazy ? std::move(resolver)
+                                                     : nullptr;
+  return document;
+}
+
+std::unique_ptr<Document>
+DocumentParser::parse_document(const ResourceLoading loading) {
   try {
-    return parse_document_impl(*this, m_trailer);
+    return parse_document_impl(loading);
   } catch (const std::exception &e) {
     // The cross-reference table parsed cleanly but does not describe a usable
     // document (no `/Root`, offsets pointing at the wrong objects, …). Scan the
@@ -1960,7 +2069,41 @@ std::unique_ptr<Document> DocumentParser::parse_document() {
     ODR_WARNING(m_logger, "pdf: building the document failed ("
                               << e.what() << "), scanning the file to recover");
     recover_xref();
-    return parse_document_impl(*this, m_trailer);
+    return parse_document_impl(loading);
+  }
+}
+
+void DocumentParser::resolve_page(Page &page) {
+  if (m_page_resolver == nullptr) {
+    return; // parsed eagerly, nothing deferred
+  }
+  const std::lock_guard lock(m_page_resolver->mutex);
+  if (page.resolved) {
+    return;
+  }
+
+  State &state = m_page_resolver->state;
+  const std::size_t memoized = state.memoized();
+  try {
+    resolve_page_resources(state, page);
+  } catch (const std::exception &e) {
+    // What `parse_document` recovers from when it parses eagerly: offsets
+    // pointing at the wrong objects. Scan the file once and parse the page
+    // again from scratch; if recovery already ran, give up.
+    {
+      const std::lock_guard stream_lock(m_mutex);
+      if (m_recovered) {
+        throw;
+      }
+      ODR_WARNING(m_logger, "pdf: resolving a page failed ("
+                                << e.what()
+                                << "), scanning the file to recover");
+      recover_xref();
+    }
+    state.forget_since(memoized);
+    page.resources = nullptr;
+    page.annotations.clear();
+    resolve_page_resources(state, page);
   }
 }
 
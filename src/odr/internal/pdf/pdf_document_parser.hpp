@@ -5,10 +5,12 @@
 #include <odr/internal/pdf/pdf_encryption.hpp>
 #include <odr/internal/pdf/pdf_file_object.hpp>
 #include <odr/internal/pdf/pdf_file_parser.hpp>
+#include <odr/internal/pdf/pdf_image.hpp>
+#include <odr/internal/pdf/pdf_object_cache.hpp>
 
 #include <iosfwd>
-#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
@@ -22,6 +24,16 @@ class Logger;
 namespace odr::internal::pdf {
 
 struct Document;
+struct Page;
+
+/// When `DocumentParser::parse_document` parses a page's resources.
+enum class ResourceLoading {
+  /// all of them, up front, so every page extracts as parsed
+  eager,
+  /// each page's only once `DocumentParser::resolve_page` asks for it, so the
+  /// parse costs the page tree and a page costs what it uses
+  lazy,
+};
 
 /// Resolution/memoization layer on top of the sequential `FileParser`: maps
 /// `ObjectReference`s to file positions via the cross-reference table and hands
@@ -29,12 +41,19 @@ struct Document;
 ///
 /// The caches are intrinsic, not a convenience: reading one compressed object
 /// means inflating and parsing the whole object stream holding it, and only
-/// this class knows from the xref which objects share one. They grow
-/// monotonically and are never evicted, which is safe only because a
-/// `DocumentParser` is transient per render — build one, produce a `Document`,
-/// read its lazy streams, discard it. Never share one across documents.
+/// this class knows from the xref which objects share one. They are bounded by
+/// a byte budget and evict the least recently used entry, since a parser lives
+/// as long as the html service holding it; objects are handed out shared, so an
+/// eviction never invalidates one a caller holds.
+///
+/// Once constructed, authenticated and parsed, reads (`read_*`, `resolve_*`)
+/// may run concurrently: cache hits proceed in parallel, misses take turns on
+/// the one input stream. Never share one across documents.
 class DocumentParser {
 public:
+  /// Split evenly between indirect objects and decoded object streams.
+  static constexpr std::size_t default_cache_budget = 64 * 1024 * 1024;
+
   /// Takes ownership of the input stream (move-only: the parser is the
   /// top-level handle for reading a PDF, so the stream's lifetime is tied to
   /// it). The constructor walks the trailer chain and, if the file declares an
@@ -46,6 +65,7 @@ public:
   explicit DocumentParser(std::unique_ptr<std::istream> in,
                           std::optional<Decryptor> decryptor = std::nullopt,
                           const Logger &logger = Logger::null());
+  ~DocumentParser();
 
   [[nodiscard]] std::istream &in();
   [[nodiscard]] FileParser &parser();
@@ -75,9 +95,17 @@ public:
   /// Parse the page tree into a `Document`. The file must already be readable:
   /// unencrypted, or unlocked via a construction-time decryptor or a successful
   /// `authenticate()`.
-  [[nodiscard]] std::unique_ptr<Document> parse_document();
-
-  [[nodiscard]] const IndirectObject &
+  [[nodiscard]] std::unique_ptr<Document>
+  parse_document(ResourceLoading loading = ResourceLoading::eager);
+  /// Parse what a lazy `parse_document` deferred for `page`: its resources and
+  /// annotations. Once per page, however often called; a no-op after an eager
+  /// parse. `page` must be of the document the last `parse_document` returned,
+  /// which must still be alive. Safe to call concurrently, also with reads. A
+  /// failure has the file scanned for its objects and the page parsed again,
+  /// once per parser, as `parse_document` does.
+  void resolve_page(Page &page);
+
+  [[nodiscard]] std::shared_ptr<const IndirectObject>
   read_object(const ObjectReference &reference);
   [[nodiscard]] std::string
   read_object_stream(const ObjectReference &reference);
@@ -93,6 +121,14 @@ public:
   [[nodiscard]] Object resolve_object_copy(Object object);
   [[nodiscard]] Object deep_resolve_object_copy(Object object);
 
+  /// Bytes the caches may keep alive together; see `default_cache_budget`.
+  void set_cache_budget(std::size_t bytes);
+  /// How the images of pages parsed from now on are written as png.
+  void set_png_options(const PngOptions &options);
+  [[nodiscard]] const PngOptions &png_options() const;
+  [[nodiscard]] ObjectCacheStats object_cache_stats() const;
+  [[nodiscard]] ObjectCacheStats object_stream_cache_stats() const;
+
 private:
   /// Read one cross-reference section (classic table or cross-reference
   /// stream, ISO 32000-1 7.5.4 / 7.5.8) at `position`. The returned
@@ -113,9 +149,12 @@ private:
   /// trailer `/Root`.
   void recover_root();
 
-  [[nodiscard]] const ObjectStream &
+  [[nodiscard]] std::shared_ptr<const ObjectStream>
   load_object_stream(const ObjectReference &reference);
 
+  [[nodiscard]] std::unique_ptr<Document>
+  parse_document_impl(ResourceLoading loading);
+
   /// The object streams currently being loaded. Loading one resolves its
   /// `/Length`, `/N` and `/First`, and a file may put those in an object
   /// compressed inside that very stream; the cache fills only on completion, so
@@ -150,12 +189,22 @@ private:
   bool m_recovered{false};
 
   bool m_is_encrypted{false};
+  std::optional<ObjectReference> m_encrypt_reference;
   std::optional<Authenticator> m_authenticator;
   std::optional<Decryptor> m_decryptor;
 
-  std::map<ObjectReference, IndirectObject> m_objects;
-  std::map<ObjectReference, ObjectStream> m_object_streams;
+  /// Guards the input stream and `m_active_object_streams`. Recursive because
+  /// a read resolves `/Length` and loads object streams, which read again.
+  std::recursive_mutex m_mutex;
+  ObjectCache<IndirectObject> m_objects;
+  ObjectCache<ObjectStream> m_object_streams;
   std::set<ObjectReference> m_active_object_streams;
+
+  PngOptions m_png_options;
+
+  struct PageResolver;
+  /// The state `resolve_page` needs; only after a lazy parse.
+  std::unique_ptr<PageResolver> m_page_resolver;
 };
 
 } // namespace odr::internal::pdf
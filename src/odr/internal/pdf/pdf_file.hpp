@@ -28,7 +28,8 @@ public:
 
   [[nodiscard]] bool is_decodable() const noexcept override;
 
-  [[nodiscard]] DocumentParser
+  /// Heap-allocated: a parser guards its input with a mutex, so cannot move.
+  [[nodiscard]] std::unique_ptr<DocumentParser>
   create_parser(const Logger &logger = Logger::null()) const;
 
 private:
@@ -2,6 +2,7 @@
 
 #include <odr/internal/pdf/pdf_object.hpp>
 
+#include <any>
 #include <array>
 #include <iosfwd>
 #include <map>
@@ -1,112 +1,208 @@
 #include <odr/internal/pdf/pdf_graphics_operator_parser.hpp>
 
 #include <odr/internal/pdf/pdf_graphics_operator.hpp>
-#include <odr/internal/util/map_util.hpp>
+#include <odr/internal/util/stream_util.hpp>
 
 #include <odr/logger.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <optional>
-#include <unordered_map>
+#include <string_view>
 
 namespace odr::internal::pdf {
 
 namespace {
 
-GraphicsOperatorType operator_name_to_type(const std::string &name) {
-  static std::unordered_map<std::string, GraphicsOperatorType> mapping = {
-      {"q", GraphicsOperatorType::save_state},
-      {"Q", GraphicsOperatorType::restore_state},
-
-      {"cm", GraphicsOperatorType::set_matrix},
-
-      {"w", GraphicsOperatorType::set_line_width},
-      {"J", GraphicsOperatorType::set_cap_style},
-      {"j", GraphicsOperatorType::set_join_style},
-      {"M", GraphicsOperatorType::set_miter_limit},
-      {"d", GraphicsOperatorType::set_dash_pattern},
-      {"ri", GraphicsOperatorType::set_color_rendering_intent},
-      {"i", GraphicsOperatorType::set_flatness_tolerance},
-      {"gs", GraphicsOperatorType::set_graphics_state_parameters},
-
-      {"Do", GraphicsOperatorType::draw_object},
-      {"BI", GraphicsOperatorType::begin_inline_image},
-      {"ID", GraphicsOperatorType::begin_inline_image_data},
-      {"EI", GraphicsOperatorType::end_inline_image},
-
-      {"m", GraphicsOperatorType::path_move_to},
-      {"l", GraphicsOperatorType::path_line_to},
-      {"c", GraphicsOperatorType::path_cubic_bezier_to},
-      {"v", GraphicsOperatorType::path_cubic_bezier_0eq1_to},
-      {"y", GraphicsOperatorType::path_cubic_bezier_2eq3_to},
-      {"h", GraphicsOperatorType::close_path},
-      {"re", GraphicsOperatorType::rectangle},
-
-      {"W", GraphicsOperatorType::set_clipping_nonzero},
-      {"W*", GraphicsOperatorType::set_clipping_evenodd},
-      {"sh", GraphicsOperatorType::set_clipping_path_shading},
-
-      {"S", GraphicsOperatorType::stroke},
-      {"s", GraphicsOperatorType::close_stroke},
-      {"f", GraphicsOperatorType::fill_nonzero},
-      {"F", GraphicsOperatorType::fill_nonzero},
-      {"f*", GraphicsOperatorType::fill_evenodd},
-      {"B", GraphicsOperatorType::fill_nonzero_stroke},
-      {"B*", GraphicsOperatorType::fill_evenodd_stroke},
-      {"b", GraphicsOperatorType::close_fill_nonzero_stroke},
-      {"b*", GraphicsOperatorType::close_fill_evenodd_stroke},
-      {"n", GraphicsOperatorType::end_path},
-
-      {"BT", GraphicsOperatorType::begin_text},
-      {"ET", GraphicsOperatorType::end_text},
-
-      {"Tc", GraphicsOperatorType::set_text_char_spacing},
-      {"Tw", GraphicsOperatorType::set_text_word_spacing},
-      {"Tz", GraphicsOperatorType::set_text_horizontal_scaling},
-      {"TL", GraphicsOperatorType::set_text_leading},
-      {"Tf", GraphicsOperatorType::set_text_font_size},
-      {"Tr", GraphicsOperatorType::set_text_rendering_mode},
-      {"Ts", GraphicsOperatorType::set_text_rise},
-
-      {"Td", GraphicsOperatorType::text_next_line_relative},
-      {"TD", GraphicsOperatorType::text_next_line_relative_leading},
-      {"Tm", GraphicsOperatorType::set_text_matrix},
-      {"T*", GraphicsOperatorType::text_next_line},
-
-      {"Tj", GraphicsOperatorType::show_text},
-      {"TJ", GraphicsOperatorType::show_text_manual_spacing},
-      {"'", GraphicsOperatorType::show_text_next_line},
-      {"\"", GraphicsOperatorType::show_text_next_line_set_spacing},
-
-      {"CS", GraphicsOperatorType::set_stroke_color_space},
-      {"SC", GraphicsOperatorType::set_stroke_color},
-      {"SCN", GraphicsOperatorType::set_stroke_color_name},
-      {"G", GraphicsOperatorType::set_stroke_grey_color},
-      {"RG", GraphicsOperatorType::set_stroke_rgb_color},
-      {"K", GraphicsOperatorType::set_stroke_cmyk_color},
-
-      {"cs", GraphicsOperatorType::set_other_color_space},
-      {"sc", GraphicsOperatorType::set_other_color},
-      {"scn", GraphicsOperatorType::set_other_color_name},
-      {"g", GraphicsOperatorType::set_other_grey_color},
-      {"rg", GraphicsOperatorType::set_other_rgb_color},
-      {"k", GraphicsOperatorType::set_other_cmyk_color},
-
-      {"d0", GraphicsOperatorType::set_glyph_width},
-      {"d1", GraphicsOperatorType::set_glyph_width_bounding_box},
-
-      {"MP", GraphicsOperatorType::marked_content_point},
-      {"DP", GraphicsOperatorType::point_with_props},
-      {"BMC", GraphicsOperatorType::begin_marked_content_seq},
-      {"BDC", GraphicsOperatorType::begin_marked_content_seq_props},
-      {"EMC", GraphicsOperatorType::end_marked_content_seq},
-
-      {"BX", GraphicsOperatorType::begin_compat_sec},
-      {"EX", GraphicsOperatorType::end_compat_sec},
-  };
-
-  return util::map::lookup_default(mapping, name,
-                                   GraphicsOperatorType::unknown);
+// Packs an operator keyword of up to three bytes into one integer, so the
+// lookup below is a single `switch` with no hashing of a `std::string`.
+constexpr std::uint32_t operator_key(const std::string_view name) {
+  std::uint32_t key = 0;
+  for (const char c : name) {
+    key = key << 8 | static_cast<unsigned char>(c);
+  }
+  return key;
+}
+
+constexpr std::uint32_t operator""_op(const char *name,
+                                      const std::size_t size) {
+  return operator_key({name, size});
+}
+
+GraphicsOperatorType operator_name_to_type(const std::string_view name) {
+  using enum GraphicsOperatorType;
+
+  // Every operator is one to three bytes long (Annex A).
+  if (name.empty() || name.size() > 3) {
+    return unknown;
+  }
+
+  switch (operator_key(name)) {
+  case "q"_op:
+    return save_state;
+  case "Q"_op:
+    return restore_state;
+
+  case "cm"_op:
+    return set_matrix;
+
+  case "w"_op:
+    return set_line_width;
+  case "J"_op:
+    return set_cap_style;
+  case "j"_op:
+    return set_join_style;
+  case "M"_op:
+    return set_miter_limit;
+  case "d"_op:
+    return set_dash_pattern;
+  case "ri"_op:
+    return set_color_rendering_intent;
+  case "i"_op:
+    return set_flatness_tolerance;
+  case "gs"_op:
+    return set_graphics_state_parameters;
+
+  case "Do"_op:
+    return draw_object;
+  case "BI"_op:
+    return begin_inline_image;
+  case "ID"_op:
+    return begin_inline_image_data;
+  case "EI"_op:
+    return end_inline_image;
+
+  case "m"_op:
+    return path_move_to;
+  case "l"_op:
+    return path_line_to;
+  case "c"_op:
+    return path_cubic_bezier_to;
+  case "v"_op:
+    return path_cubic_bezier_0eq1_to;
+  case "y"_op:
+    return path_cubic_bezier_2eq3_to;
+  case "h"_op:
+    return close_path;
+  case "re"_op:
+    return rectangle;
+
+  case "W"_op:
+    return set_clipping_nonzero;
+  case "W*"_op:
+    return set_clipping_evenodd;
+  case "sh"_op:
+    return set_clipping_path_shading;
+
+  case "S"_op:
+    return stroke;
+  case "s"_op:
+    return close_stroke;
+  case "f"_op:
+  case "F"_op:
+    return fill_nonzero;
+  case "f*"_op:
+    return fill_evenodd;
+  case "B"_op:
+    return fill_nonzero_stroke;
+  case "B*"_op:
+    return fill_evenodd_stroke;
+  case "b"_op:
+    return close_fill_nonzero_stroke;
+  case "b*"_op:
+    return close_fill_evenodd_stroke;
+  case "n"_op:
+    return end_path;
+
+  case "BT"_op:
+    return begin_text;
+  case "ET"_op:
+    return end_text;
+
+  case "Tc"_op:
+    return set_text_char_spacing;
+  case "Tw"_op:
+    return set_text_word_spacing;
+  case "Tz"_op:
+    return set_text_horizontal_scaling;
+  case "TL"_op:
+    return set_text_leading;
+  case "Tf"_op:
+    return set_text_font_size;
+  case "Tr"_op:
+    return set_text_rendering_mode;
+  case "Ts"_op:
+    return set_text_rise;
+
+  case "Td"_op:
+    return text_next_line_relative;
+  case "TD"_op:
+    return text_next_line_relative_leading;
+  case "Tm"_op:
+    return set_text_matrix;
+  case "T*"_op:
+    return text_next_line;
+
+  case "Tj"_op:
+    return show_text;
+  case "TJ"_op:
+    return show_text_manual_spacing;
+  case "'"_op:
+    return show_text_next_line;
+  case "\""_op:
+    return show_text_next_line_set_spacing;
+
+  case "CS"_op:
+    return set_stroke_color_space;
+  case "SC"_op:
+    return set_stroke_color;
+  case "SCN"_op:
+    return set_stroke_color_name;
+  case "G"_op:
+    return set_stroke_grey_color;
+  case "RG"_op:
+    return set_stroke_rgb_color;
+  case "K"_op:
+    return set_stroke_cmyk_color;
+
+  case "cs"_op:
+    return set_other_color_space;
+  case "sc"_op:
+    return set_other_color;
+  case "scn"_op:
+    return set_other_color_name;
+  case "g"_op:
+    return set_other_grey_color;
+  case "rg"_op:
+    return set_other_rgb_color;
+  case "k"_op:
+    return set_other_cmyk_color;
+
+  case "d0"_op:
+    return set_glyph_width;
+  case "d1"_op:
+    return set_glyph_width_bounding_box;
+
+  case "MP"_op:
+    return marked_content_point;
+  case "DP"_op:
+    return point_with_props;
+  case "BMC"_op:
+    return begin_marked_content_seq;
+  case "BDC"_op:
+    return begin_marked_content_seq_props;
+  case "EMC"_op:
+    return end_marked_content_seq;
+
+  case "BX"_op:
+    return begin_compat_sec;
+  case "EX"_op:
+    return end_compat_sec;
+
+  default:
+    return unknown;
+  }
 }
 
 // Fetch an inline image dictionary entry by either its abbreviated or its long
@@ -196,37 +292,49 @@ GraphicsOperatorParser::GraphicsOperatorParser(std::istream &in,
                                                const Logger &logger)
     : m_parser(in), m_logger{logger} {}
 
+GraphicsOperatorParser::GraphicsOperatorParser(const std::string_view content,
+                                               const Logger &logger)
+    : m_view{std::make_unique<util::stream::ViewStream>(content)},
+      m_parser(*m_view), m_logger{logger} {}
+
 std::istream &GraphicsOperatorParser::in() { return m_parser.in(); }
 
 std::streambuf &GraphicsOperatorParser::sb() { return m_parser.sb(); }
 
-std::string GraphicsOperatorParser::read_operator_name() {
-  std::string result;
+void GraphicsOperatorParser::read_operator_name(std::string &out) {
+  out.clear();
 
   while (true) {
     const int_type c = m_parser.geti();
 
     if (c == eof) {
-      return result;
+      return;
     }
     // White space or a delimiter ends the bareword (7.2.2): producers write
     // `Tm(text)Tj` with nothing in between.
     if (ObjectParser::is_whitespace(static_cast<char_type>(c)) ||
         ObjectParser::is_delimiter(static_cast<char_type>(c))) {
-      return result;
+      return;
     }
 
     m_parser.bumpc();
-    result += static_cast<char_type>(c);
+    out += static_cast<char_type>(c);
   }
 }
 
 GraphicsOperator GraphicsOperatorParser::read_operator() {
   GraphicsOperator result;
+  read_operator(result);
+  return result;
+}
+
+void GraphicsOperatorParser::read_operator(GraphicsOperator &result) {
+  result.type = GraphicsOperatorType::unknown;
+  result.arguments.clear();
 
   m_parser.skip_whitespace_and_comments();
 
-  std::string operator_name;
+  std::string &operator_name = m_operator_name;
   while (true) {
     if (m_parser.peek_number()) {
       std::visit([&](auto v) { result.arguments.emplace_back(v); },
@@ -245,7 +353,7 @@ GraphicsOperator GraphicsOperatorParser::read_operator() {
       // dictionaries carry them, 8.9.7) or the operator name ending the
       // arguments. `peek_boolean` cannot tell them apart — `f` and `Tj` share
       // their leading character with the keywords — so read the whole word.
-      operator_name = read_operator_name();
+      read_operator_name(operator_name);
       if (operator_name == "true") {
         result.arguments.emplace_back(Boolean(true));
       } else if (operator_name == "false") {
@@ -292,8 +400,6 @@ GraphicsOperator GraphicsOperatorParser::read_operator() {
   }
 
   m_parser.skip_whitespace_and_comments();
-
-  return result;
 }
 
 Dictionary GraphicsOperatorParser::read_inline_image_dictionary(
@@ -321,15 +427,13 @@ GraphicsOperatorParser::read_inline_image_data(const Dictionary &dictionary) {
   // real `EI`, truncating the image and derailing the rest of the page.
   if (const std::optional<std::size_t> length =
           inline_image_raw_length(dictionary)) {
-    std::string data;
-    data.reserve(*length);
-    for (std::size_t i = 0; i < *length; ++i) {
-      const int_type c = m_parser.geti();
-      if (c == eof) {
-        return data;
-      }
-      m_parser.bumpc();
-      data += static_cast<char_type>(c);
+    std::string data(*length, '\0');
+    const std::streamsize read =
+        sb().sgetn(data.data(), static_cast<std::streamsize>(*length));
+    if (read < static_cast<std::streamsize>(*length)) {
+      data.resize(static_cast<std::size_t>(std::max<std::streamsize>(read, 0)));
+      in().setstate(std::ios::eofbit);
+      return data;
     }
     // Consume the trailing `EI` (and the conventional white-space before it).
     m_parser.skip_whitespace();
@@ -4,7 +4,9 @@
 
 #include <odr/logger.hpp>
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace odr::internal::pdf {
@@ -17,13 +19,21 @@ class GraphicsOperatorParser {
 public:
   explicit GraphicsOperatorParser(std::istream &,
                                   const Logger &logger = Logger::null());
+  /// Reads @p content in place; it has to outlive the parser.
+  explicit GraphicsOperatorParser(std::string_view content,
+                                  const Logger &logger = Logger::null());
 
   [[nodiscard]] std::istream &in();
   [[nodiscard]] std::streambuf &sb();
 
-  [[nodiscard]] std::string read_operator_name();
+  /// Replaces @p out with the bareword at the cursor.
+  void read_operator_name(std::string &out);
 
   [[nodiscard]] GraphicsOperator read_operator();
+  /// @ref read_operator into @p result, whose arguments are cleared but keep
+  /// their storage: one operator read over and over through a content stream
+  /// allocates its operand stack once.
+  void read_operator(GraphicsOperator &result);
 
 private:
   // Fold an inline image's flat name/value argument run into a dictionary
@@ -38,8 +48,12 @@ private:
   [[nodiscard]] std::string
   read_inline_image_data(const Dictionary &dictionary);
 
+  /// the stream over the content, for the `std::string_view` constructor
+  std::unique_ptr<std::istream> m_view;
   ObjectParser m_parser;
   Logger m_logger;
+  /// the operator name being read, kept for its storage
+  std::string m_operator_name;
 };
 
 } // namespace odr::internal::pdf
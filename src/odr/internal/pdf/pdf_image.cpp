@@ -11,6 +11,9 @@
 #include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ranges>
 #include <string_view>
 #include <utility>
 
@@ -29,6 +32,61 @@ void write_chunk(std::string &out, const std::string_view type,
       out, crypto::util::crc32(std::string_view(out).substr(crc_start)));
 }
 
+/// The filtered bytes of a large image are deflated in pieces of this size, on
+/// as many threads as `PngOptions` allows.
+constexpr std::size_t png_deflate_piece = 1024 * 1024;
+
+/// PNG 9.4: of the left, upper and upper-left bytes, the one closest to their
+/// linear estimate.
+std::uint8_t paeth(const std::uint8_t a, const std::uint8_t b,
+                   const std::uint8_t c) {
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+  return pb <= pc ? b : c;
+}
+
+/// Writes @p row filtered with filter @p type (PNG 9.2) to @p out, the bytes
+/// of a pixel being @p bpp apart and @p previous the row above (zeros for the
+/// first). Returns the sum of the filtered bytes taken as signed, the measure
+/// PNG 12.8 suggests picking the filter by.
+std::uint64_t filter_row(const std::uint8_t type, const std::uint8_t *row,
+                         const std::uint8_t *previous, const std::size_t size,
+                         const std::size_t bpp, std::uint8_t *out) {
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    const std::uint8_t left = i >= bpp ? row[i - bpp] : 0;
+    const std::uint8_t up = previous[i];
+    const std::uint8_t up_left = i >= bpp ? previous[i - bpp] : 0;
+    std::uint8_t predicted = 0;
+    switch (type) {
+    case 1:
+      predicted = left;
+      break;
+    case 2:
+      predicted = up;
+      break;
+    case 3:
+      predicted = static_cast<std::uint8_t>((left + up) / 2);
+      break;
+    case 4:
+      predicted = paeth(left, up, up_left);
+      break;
+    default:
+      break;
+    }
+    const auto filtered = static_cast<std::uint8_t>(row[i] - predicted);
+    out[i] = filtered;
+    sum += static_cast<std::uint64_t>(
+        std::abs(static_cast<int>(static_cast<std::int8_t>(filtered))));
+  }
+  return sum;
+}
+
 /// Reads fixed-width big-endian sample values out of a byte buffer, MSB first.
 /// Constructed at a row offset; rows are byte-aligned (8.9.5.2). Reads past the
 /// end yield zero (lenient for a truncated stream).
@@ -69,6 +127,313 @@ std::uint8_t to_byte(const double v) {
   return static_cast<std::uint8_t>(scaled);
 }
 
+/// The device space `to_rgb` comes down to for @p space, when it converts
+/// through nothing but that: `unknown` for any other.
+ColorSpaceKind device_kind(const ColorSpaceDef &space) {
+  const auto checked = [&](const ColorSpaceKind kind,
+                           const std::int32_t components) {
+    return space.components == components ? kind : ColorSpaceKind::unknown;
+  };
+  switch (space.kind) {
+  case ColorSpaceKind::device_gray:
+  case ColorSpaceKind::cal_gray:
+    return checked(ColorSpaceKind::device_gray, 1);
+  case ColorSpaceKind::device_rgb:
+  case ColorSpaceKind::cal_rgb:
+    return checked(ColorSpaceKind::device_rgb, 3);
+  case ColorSpaceKind::device_cmyk:
+    return checked(ColorSpaceKind::device_cmyk, 4);
+  case ColorSpaceKind::icc_based:
+    if (space.alternate != nullptr) {
+      return space.alternate->components == space.components
+                 ? device_kind(*space.alternate)
+                 : ColorSpaceKind::unknown;
+    }
+    if (space.components == 1) {
+      return ColorSpaceKind::device_gray;
+    }
+    if (space.components == 4) {
+      return ColorSpaceKind::device_cmyk;
+    }
+    return checked(ColorSpaceKind::device_rgb, 3);
+  default:
+    return ColorSpaceKind::unknown;
+  }
+}
+
+/// Converts rows of image samples to 8-bit RGB, as `to_rgb` would pixel by
+/// pixel. The common images take a path of their own, with tables built once
+/// per image: a single component of 1, 2, 4, 8 or 16 bits looks the whole
+/// pixel up by its sample, and 8- or 16-bit gray, RGB and CMYK look up each
+/// component. Anything else, or an image with fewer pixels than a table has
+/// entries, goes through `to_rgb` for every pixel.
+class RowConverter {
+public:
+  RowConverter(const ColorSpaceDef &space,
+               const std::int32_t bits_per_component,
+               const std::vector<double> &decode,
+               const std::vector<double> &color_key,
+               const std::size_t pixel_count)
+      : m_space{&space}, m_decode{&decode}, m_color_key{&color_key},
+        m_components{space.components}, m_bits{bits_per_component},
+        m_max_sample{(1u << static_cast<std::uint32_t>(bits_per_component)) -
+                     1u},
+        m_indexed{space.kind == ColorSpaceKind::indexed},
+        m_has_color_key{color_key.size() >=
+                        2 * static_cast<std::size_t>(space.components)} {
+    const bool whole_bytes = m_bits == 8 || m_bits == 16;
+    const bool packed = m_bits == 1 || m_bits == 2 || m_bits == 4;
+    const std::size_t entries = std::size_t{m_max_sample} + 1;
+    if (entries > pixel_count) {
+      return;
+    }
+
+    if (m_components == 1 && (packed || whole_bytes)) {
+      build_palette_(entries);
+      return;
+    }
+    if (!whole_bytes) {
+      return;
+    }
+    switch (device_kind(space)) {
+    case ColorSpaceKind::device_rgb:
+      build_levels_(entries);
+      m_kind = Kind::levels;
+      break;
+    case ColorSpaceKind::device_cmyk:
+      m_values.resize(4 * entries);
+      for (std::size_t k = 0; k < 4; ++k) {
+        for (std::uint32_t sample = 0; sample <= m_max_sample; ++sample) {
+          m_values[k * entries + sample] = component_value_(sample, k);
+        }
+      }
+      m_kind = Kind::cmyk;
+      break;
+    default:
+      break;
+    }
+  }
+
+  /// Writes the RGB of @p width pixels of @p row to @p out, @p channels bytes a
+  /// pixel. With 4 channels the alpha bytes are left as they are, except that a
+  /// pixel the colour key masks gets 0.
+  void convert(const std::string_view row, const std::int32_t width, char *out,
+               const std::size_t channels) {
+    switch (m_kind) {
+    case Kind::palette:
+      convert_palette_(row, width, out, channels);
+      return;
+    case Kind::levels:
+      convert_levels_(row, width, out, channels);
+      return;
+    case Kind::cmyk:
+      convert_cmyk_(row, width, out, channels);
+      return;
+    case Kind::generic:
+      convert_generic_(row, width, out, channels);
+      return;
+    }
+  }
+
+private:
+  enum class Kind { generic, palette, levels, cmyk };
+
+  const ColorSpaceDef *m_space;
+  const std::vector<double> *m_decode;
+  const std::vector<double> *m_color_key;
+  std::int32_t m_components;
+  std::int32_t m_bits;
+  std::uint32_t m_max_sample;
+  bool m_indexed;
+  bool m_has_color_key;
+  Kind m_kind{Kind::generic};
+
+  /// `palette`: the RGB of every sample value, and whether the key masks it.
+  std::vector<std::array<std::uint8_t, 3>> m_palette;
+  std::vector<std::uint8_t> m_keyed;
+  /// `levels`: the output byte of every sample value, component by component.
+  std::vector<std::uint8_t> m_levels;
+  /// `cmyk`: the decoded value of every sample value, component by component.
+  std::vector<double> m_values;
+
+  std::vector<double> m_component_values;
+  std::vector<std::uint32_t> m_raw_samples;
+
+  /// The value `/Decode` maps @p sample of component @p k to (8.9.5.2).
+  [[nodiscard]] double component_value_(const std::uint32_t sample,
+                                        const std::size_t k) const {
+    const std::vector<double> &decode = *m_decode;
+    if (decode.size() >= 2 * (k + 1)) {
+      const double d_min = decode[2 * k];
+      const double d_max = decode[2 * k + 1];
+      return d_min + sample * (d_max - d_min) / m_max_sample;
+    }
+    if (m_indexed) {
+      // Default Indexed /Decode is [0, 2^bpc-1]: the sample is the palette
+      // index, which `to_rgb` looks up directly (8.6.6.3).
+      return sample;
+    }
+    return static_cast<double>(sample) / m_max_sample;
+  }
+
+  /// Sample @p i of @p row, for 1, 2, 4, 8 and 16 bits.
+  [[nodiscard]] std::uint32_t sample_(const std::string_view row,
+                                      const std::size_t i) const {
+    const auto byte = [&](const std::size_t at) {
+      return static_cast<std::uint32_t>(static_cast<std::uint8_t>(row[at]));
+    };
+    switch (m_bits) {
+    case 8:
+      return byte(i);
+    case 16:
+      return byte(2 * i) << 8 | byte(2 * i + 1);
+    default: {
+      const std::size_t bit = i * static_cast<std::size_t>(m_bits);
+      const auto shift = static_cast<std::uint32_t>(8 - m_bits) -
+                         static_cast<std::uint32_t>(bit % 8);
+      return byte(bit / 8) >> shift & m_max_sample;
+    }
+    }
+  }
+
+  [[nodiscard]] bool keyed_(const std::size_t k,
+                            const std::uint32_t sample) const {
+    const std::vector<double> &color_key = *m_color_key;
+    return sample >= color_key[2 * k] && sample <= color_key[2 * k + 1];
+  }
+
+  void build_palette_(const std::size_t entries) {
+    m_palette.resize(entries);
+    m_keyed.resize(entries);
+    std::vector<double> value(1);
+    for (std::uint32_t sample = 0; sample <= m_max_sample; ++sample) {
+      value[0] = component_value_(sample, 0);
+      const std::array<double, 3> rgb = m_space->to_rgb(value);
+      m_palette[sample] = {to_byte(rgb[0]), to_byte(rgb[1]), to_byte(rgb[2])};
+      m_keyed[sample] = m_has_color_key && keyed_(0, sample) ? 1 : 0;
+    }
+    m_kind = Kind::palette;
+  }
+
+  void build_levels_(const std::size_t entries) {
+    m_levels.resize(static_cast<std::size_t>(m_components) * entries);
+    for (std::size_t k = 0; k < static_cast<std::size_t>(m_components); ++k) {
+      for (std::uint32_t sample = 0; sample <= m_max_sample; ++sample) {
+        m_levels[k * entries + sample] = to_byte(component_value_(sample, k));
+      }
+    }
+  }
+
+  /// Zeroes the alpha byte at @p pixel when the key masks the samples of the
+  /// pixel starting at @p first.
+  void apply_color_key_(const std::string_view row, const std::size_t first,
+                        char *pixel) const {
+    for (std::size_t k = 0; k < static_cast<std::size_t>(m_components); ++k) {
+      if (!keyed_(k, sample_(row, first + k))) {
+        return;
+      }
+    }
+    pixel[3] = 0;
+  }
+
+  void convert_palette_(const std::string_view row, const std::int32_t width,
+                        char *out, const std::size_t channels) const {
+    for (std::size_t x = 0; x < static_cast<std::size_t>(width); ++x) {
+      const std::uint32_t sample = sample_(row, x);
+      const std::array<std::uint8_t, 3> &rgb = m_palette[sample];
+      char *pixel = out + x * channels;
+      pixel[0] = static_cast<char>(rgb[0]);
+      pixel[1] = static_cast<char>(rgb[1]);
+      pixel[2] = static_cast<char>(rgb[2]);
+      if (channels == 4 && m_keyed[sample] != 0) {
+        pixel[3] = 0;
+      }
+    }
+  }
+
+  void convert_levels_(const std::string_view row, const std::int32_t width,
+                       char *out, const std::size_t channels) const {
+    const std::size_t entries = std::size_t{m_max_sample} + 1;
+    const std::uint8_t *red = m_levels.data();
+    const std::uint8_t *green = red + entries;
+    const std::uint8_t *blue = green + entries;
+    for (std::size_t x = 0; x < static_cast<std::size_t>(width); ++x) {
+      const std::size_t first = 3 * x;
+      char *pixel = out + x * channels;
+      pixel[0] = static_cast<char>(red[sample_(row, first)]);
+      pixel[1] = static_cast<char>(green[sample_(row, first + 1)]);
+      pixel[2] = static_cast<char>(blue[sample_(row, first + 2)]);
+      if (channels == 4 && m_has_color_key) {
+        apply_color_key_(row, first, pixel);
+      }
+    }
+  }
+
+  void convert_cmyk_(const std::string_view row, const std::int32_t width,
+                     char *out, const std::size_t channels) const {
+    const std::size_t entries = std::size_t{m_max_sample} + 1;
+    // Scans repeat a colour for long runs, paper white above all, and the
+    // polynomial is the cost here: keep the last pixel's result.
+    std::uint64_t last_key = 0;
+    std::array<char, 3> last_rgb{};
+    bool has_last = false;
+    for (std::size_t x = 0; x < static_cast<std::size_t>(width); ++x) {
+      const std::size_t first = 4 * x;
+      std::array<std::uint32_t, 4> samples{};
+      std::uint64_t key = 0;
+      for (std::size_t k = 0; k < 4; ++k) {
+        samples[k] = sample_(row, first + k);
+        key = key << 16 | samples[k];
+      }
+      if (!has_last || key != last_key) {
+        const std::array<double, 3> rgb = cmyk_to_rgb(
+            m_values[samples[0]], m_values[entries + samples[1]],
+            m_values[2 * entries + samples[2]],
+            m_values[3 * entries + samples[3]]);
+        last_rgb = {static_cast<char>(to_byte(rgb[0])),
+                    static_cast<char>(to_byte(rgb[1])),
+                    static_cast<char>(to_byte(rgb[2]))};
+        last_key = key;
+        has_last = true;
+      }
+      char *pixel = out + x * channels;
+      pixel[0] = last_rgb[0];
+      pixel[1] = last_rgb[1];
+      pixel[2] = last_rgb[2];
+      if (channels == 4 && m_has_color_key) {
+        apply_color_key_(row, first, pixel);
+      }
+    }
+  }
+
+  void convert_generic_(const std::string_view row, const std::int32_t width,
+                        char *out, const std::size_t channels) {
+    const auto components = static_cast<std::size_t>(m_components);
+    m_component_values.resize(components);
+    m_raw_samples.resize(components);
+    BitReader reader(row, 0);
+    for (std::size_t x = 0; x < static_cast<std::size_t>(width); ++x) {
+      for (std::size_t k = 0; k < components; ++k) {
+        const std::uint32_t sample = reader.read(m_bits);
+        m_raw_samples[k] = sample;
+        m_component_values[k] = component_value_(sample, k);
+      }
+      const std::array<double, 3> rgb = m_space->to_rgb(m_component_values);
+      char *pixel = out + x * channels;
+      pixel[0] = static_cast<char>(to_byte(rgb[0]));
+      pixel[1] = static_cast<char>(to_byte(rgb[1]));
+      pixel[2] = static_cast<char>(to_byte(rgb[2]));
+      if (channels == 4 && m_has_color_key &&
+          std::ranges::all_of(std::views::iota(std::size_t{0}, components),
+                              [&](const std::size_t k) {
+                                return keyed_(k, m_raw_samples[k]);
+                              })) {
+        pixel[3] = 0;
+      }
+    }
+  }
+};
+
 /// Undo the premultiplication `/SMaskInData 2` declares, leaving the straight
 /// colour a PNG carries.
 void unpremultiply(std::string &samples, const std::int32_t components,
@@ -96,7 +461,8 @@ std::optional<EncodedImage> encode_jpx(const std::string &data,
                                        const std::vector<double> &decode_array,
                                        const std::vector<std::uint8_t> &alpha,
                                        const std::vector<double> &color_key,
-                                       const std::int32_t smask_in_data) {
+                                       const std::int32_t smask_in_data,
+                                       const PngOptions &options) {
   std::optional<JpxImage> image = decode_jpx(data);
   if (!image.has_value()) {
     return std::nullopt;
@@ -131,7 +497,7 @@ std::optional<EncodedImage> encode_jpx(const std::string &data,
 
   const std::string png = encode_image_png(
       image->samples, image->width, image->height, 8, space, decode_array,
-      alpha.empty() ? image->alpha : alpha, color_key);
+      alpha.empty() ? image->alpha : alpha, color_key, options);
   if (png.empty()) {
     return std::nullopt;
   }
@@ -145,7 +511,8 @@ namespace odr::internal {
 
 std::string pdf::write_png(const std::string &pixels, const std::int32_t width,
                            const std::int32_t height,
-                           const std::int32_t channels) {
+                           const std::int32_t channels,
+                           const PngOptions &options) {
   if (width <= 0 || height <= 0 || (channels != 3 && channels != 4)) {
     return {};
   }
@@ -155,13 +522,32 @@ std::string pdf::write_png(const std::string &pixels, const std::int32_t width,
     return {};
   }
 
-  // Filter type 0 (None) prefixes each scanline (PNG 9.2); the rows are then
-  // deflated as one zlib stream into the single IDAT.
-  std::string raw;
-  raw.reserve((stride + 1) * static_cast<std::size_t>(height));
-  for (std::int32_t y = 0; y < height; ++y) {
-    raw.push_back(0);
-    raw.append(pixels, static_cast<std::size_t>(y) * stride, stride);
+  // Each scanline is prefixed by the filter that suits it best (PNG 9.2, 12.8);
+  // the rows are then deflated as one zlib stream into the single IDAT.
+  std::string raw((stride + 1) * static_cast<std::size_t>(height), '\0');
+  const std::vector<std::uint8_t> zeros(stride);
+  std::array<std::vector<std::uint8_t>, 5> candidates;
+  for (std::vector<std::uint8_t> &candidate : candidates) {
+    candidate.resize(stride);
+  }
+  const auto *bytes = reinterpret_cast<const std::uint8_t *>(pixels.data());
+  for (std::size_t y = 0; y < static_cast<std::size_t>(height); ++y) {
+    const std::uint8_t *row = bytes + y * stride;
+    const std::uint8_t *previous = y == 0 ? zeros.data() : row - stride;
+    std::uint8_t best = 0;
+    std::uint64_t best_sum = 0;
+    for (std::uint8_t type = 0; type < candidates.size(); ++type) {
+      const std::uint64_t sum = filter_row(type, row, previous, stride,
+                                           static_cast<std::size_t>(channels),
+                                           candidates[type].data());
+      if (type == 0 || sum < best_sum) {
+        best = type;
+        best_sum = sum;
+      }
+    }
+    char *out_row = raw.data() + y * (stride + 1);
+    out_row[0] = static_cast<char>(best);
+    std::memcpy(out_row + 1, candidates[best].data(), stride);
   }
 
   static constexpr std::array<char, 8> signature = {
@@ -180,7 +566,9 @@ std::string pdf::write_png(const std::string &pixels, const std::int32_t width,
   ihdr.push_back(0); // filter method: adaptive
   ihdr.push_back(0); // interlace: none
   write_chunk(out, "IHDR", ihdr);
-  write_chunk(out, "IDAT", crypto::util::zlib_deflate(raw));
+  write_chunk(out, "IDAT",
+              crypto::util::zlib_deflate(raw, std::clamp(options.level, 1u, 9u),
+                                         png_deflate_piece, options.threads));
   write_chunk(out, "IEND", "");
   return out;
 }
@@ -192,17 +580,14 @@ std::string pdf::encode_image_png(const std::string &samples,
                                   const ColorSpaceDef &color_space,
                                   const std::vector<double> &decode,
                                   const std::vector<std::uint8_t> &alpha,
-                                  const std::vector<double> &color_key) {
+                                  const std::vector<double> &color_key,
+                                  const PngOptions &png) {
   const std::int32_t components = color_space.components;
   if (width <= 0 || height <= 0 || components <= 0 || bits_per_component <= 0 ||
       bits_per_component > 16) {
     return {};
   }
 
-  const std::uint32_t max_sample =
-      (1u << static_cast<std::uint32_t>(bits_per_component)) - 1u;
-  const bool indexed = color_space.kind == ColorSpaceKind::indexed;
-
   const auto row_bits = static_cast<std::size_t>(width) *
                         static_cast<std::size_t>(components) *
                         static_cast<std::size_t>(bits_per_component);
@@ -216,60 +601,39 @@ std::string pdf::encode_image_png(const std::string &samples,
       color_key.size() >= 2 * static_cast<std::size_t>(components);
   const bool has_alpha = alpha.size() == pixel_count || has_color_key;
   const std::size_t channels = has_alpha ? 4 : 3;
+  const std::size_t out_stride = static_cast<std::size_t>(width) * channels;
 
   std::string out;
   out.resize(pixel_count * channels);
 
-  std::vector<double> component_values(static_cast<std::size_t>(components));
-  std::vector<std::uint32_t> raw_samples(static_cast<std::size_t>(components));
-  std::size_t out_index = 0;
-  std::size_t pixel_index = 0;
+  RowConverter converter(color_space, bits_per_component, decode, color_key,
+                         pixel_count);
+  // A truncated stream reads as zero samples past its end.
+  std::string padded_row;
   for (std::int32_t y = 0; y < height; ++y) {
-    BitReader reader(samples, static_cast<std::size_t>(y) * row_bytes);
-    for (std::int32_t x = 0; x < width; ++x) {
-      for (std::int32_t j = 0; j < components; ++j) {
-        const std::uint32_t sample = reader.read(bits_per_component);
-        const auto k = static_cast<std::size_t>(j);
-        raw_samples[k] = sample;
-        if (decode.size() >= 2 * (k + 1)) {
-          const double d_min = decode[2 * k];
-          const double d_max = decode[2 * k + 1];
-          component_values[k] = d_min + sample * (d_max - d_min) / max_sample;
-        } else if (indexed) {
-          // Default Indexed /Decode is [0, 2^bpc-1]: the sample is the palette
-          // index, which `to_rgb` looks up directly (8.6.6.3).
-          component_values[k] = sample;
-        } else {
-          component_values[k] = static_cast<double>(sample) / max_sample;
-        }
-      }
-      const std::array<double, 3> pixel = color_space.to_rgb(component_values);
-      out[out_index++] = static_cast<char>(to_byte(pixel[0]));
-      out[out_index++] = static_cast<char>(to_byte(pixel[1]));
-      out[out_index++] = static_cast<char>(to_byte(pixel[2]));
-      if (has_alpha) {
-        std::uint8_t a =
-            alpha.size() == pixel_count ? alpha[pixel_index] : 0xFF;
-        if (has_color_key) {
-          bool keyed = true;
-          for (std::int32_t j = 0; j < components && keyed; ++j) {
-            const auto k = static_cast<std::size_t>(j);
-            if (raw_samples[k] < color_key[2 * k] ||
-                raw_samples[k] > color_key[2 * k + 1]) {
-              keyed = false;
-            }
-          }
-          if (keyed) {
-            a = 0;
-          }
-        }
-        out[out_index++] = static_cast<char>(a);
+    const std::size_t offset = static_cast<std::size_t>(y) * row_bytes;
+    std::string_view row = std::string_view(samples).substr(
+        std::min(offset, samples.size()), row_bytes);
+    if (row.size() < row_bytes) {
+      padded_row.assign(row);
+      padded_row.resize(row_bytes, '\0');
+      row = padded_row;
+    }
+
+    char *out_row = out.data() + static_cast<std::size_t>(y) * out_stride;
+    if (has_alpha) {
+      // The plane's coverage first; the colour key can only take it away.
+      for (std::size_t x = 0; x < static_cast<std::size_t>(width); ++x) {
+        out_row[x * 4 + 3] = static_cast<char>(
+            alpha.size() == pixel_count
+                ? alpha[static_cast<std::size_t>(y) * width + x]
+                : 0xFF);
       }
-      ++pixel_index;
     }
+    converter.convert(row, width, out_row, channels);
   }
 
-  return write_png(out, width, height, has_alpha ? 4 : 3);
+  return write_png(out, width, height, has_alpha ? 4 : 3, png);
 }
 
 std::vector<std::uint8_t> pdf::decode_mask_alpha(
@@ -333,7 +697,8 @@ std::string pdf::encode_stencil_png(const std::string &samples,
                                     const std::int32_t width,
                                     const std::int32_t height,
                                     const std::array<double, 3> &color,
-                                    const std::vector<double> &decode) {
+                                    const std::vector<double> &decode,
+                                    const PngOptions &png) {
   if (width <= 0 || height <= 0) {
     return {};
   }
@@ -362,7 +727,7 @@ std::string pdf::encode_stencil_png(const std::string &samples,
       rgba[out_index++] = static_cast<char>(paint ? 0xFF : 0x00);
     }
   }
-  return write_png(rgba, width, height, 4);
+  return write_png(rgba, width, height, 4, png);
 }
 
 std::optional<pdf::EncodedImage> pdf::encode_image(
@@ -372,7 +737,7 @@ std::optional<pdf::EncodedImage> pdf::encode_image(
     const std::vector<double> &decode_array,
     const std::vector<std::uint8_t> &alpha,
     const std::vector<double> &color_key, const std::int32_t smask_in_data,
-    const DecodeOptions &options) {
+    const DecodeOptions &options, const PngOptions &png) {
   const std::optional<std::string> terminal = terminal_image_codec(filter);
 
   if (terminal == "DCTDecode") {
@@ -389,7 +754,7 @@ std::optional<pdf::EncodedImage> pdf::encode_image(
       return std::nullopt;
     }
     return encode_jpx(result.data, color_space, decode_array, alpha, color_key,
-                      smask_in_data);
+                      smask_in_data, png);
   }
   if (terminal.has_value() && terminal != "JBIG2Decode") {
     return std::nullopt; // CCITTFax: not decodable
@@ -403,13 +768,13 @@ std::optional<pdf::EncodedImage> pdf::encode_image(
   if (result.stopped_at_filter.has_value()) {
     return std::nullopt;
   }
-  std::string png =
+  std::string encoded =
       encode_image_png(result.data, width, height, bits_per_component,
-                       *color_space, decode_array, alpha, color_key);
-  if (png.empty()) {
+                       *color_space, decode_array, alpha, color_key, png);
+  if (encoded.empty()) {
     return std::nullopt;
   }
-  return EncodedImage{std::move(png), "image/png"};
+  return EncodedImage{std::move(encoded), "image/png"};
 }
 
 } // namespace odr::internal
@@ -13,6 +13,15 @@ namespace odr::internal::pdf {
 class Object;
 struct ColorSpaceDef;
 
+/// How `write_png` compresses: at the zlib @ref level, from 1, fastest, to 9,
+/// smallest, and for an image past a piece on @ref threads threads, 0 taking
+/// one per hardware thread; on one when it is written on a worker of an
+/// `OrderedTaskQueue`. The png is the same for any @ref threads.
+struct PngOptions {
+  unsigned level{6};
+  std::uint32_t threads{1};
+};
+
 /// Browser-ready image bytes and the format naming them (`image/jpeg` or
 /// `image/png`).
 struct EncodedImage {
@@ -37,7 +46,8 @@ encode_image(std::string raw, const Object &filter, const Object &decode_parms,
              const std::vector<double> &decode,
              const std::vector<std::uint8_t> &alpha = {},
              const std::vector<double> &color_key = {},
-             std::int32_t smask_in_data = 0, const DecodeOptions &options = {});
+             std::int32_t smask_in_data = 0, const DecodeOptions &options = {},
+             const PngOptions &png = {});
 
 /// Assemble decoded image samples (ISO 32000-1 8.9.5: MSB-first, rows padded
 /// to a byte boundary, `bits_per_component` of 1/2/4/8/16) into an 8-bit PNG,
@@ -52,7 +62,8 @@ std::string encode_image_png(const std::string &samples, std::int32_t width,
                              const ColorSpaceDef &color_space,
                              const std::vector<double> &decode,
                              const std::vector<std::uint8_t> &alpha = {},
-                             const std::vector<double> &color_key = {});
+                             const std::vector<double> &color_key = {},
+                             const PngOptions &png = {});
 
 /// Resolve a `/SMask` or stencil `/Mask` sub-image into a coverage plane sized
 /// to the *base* image, nearest-neighbour resampled — the two resolutions need
@@ -66,9 +77,12 @@ decode_mask_alpha(const std::string &samples, std::int32_t width,
                   std::int32_t base_width, std::int32_t base_height);
 
 /// Wrap 8-bit pixels (row-major, unpadded) into a PNG: single `IDAT`, no
-/// interlacing. `channels` is 3 (RGB) or 4 (RGBA); anything else yields "".
+/// interlacing, each row filtered the way that leaves the smallest sum of
+/// differences (PNG 12.8). `channels` is 3 (RGB) or 4 (RGBA); anything else
+/// yields "".
 std::string write_png(const std::string &pixels, std::int32_t width,
-                      std::int32_t height, std::int32_t channels);
+                      std::int32_t height, std::int32_t channels,
+                      const PngOptions &options = {});
 
 /// Paint a 1-bpc stencil mask (ISO 32000-1 8.9.6.2) into an RGBA PNG: a sample
 /// decoding to 0 paints `color` (sRGB in [0, 1]) opaquely, a 1 is transparent,
@@ -77,6 +91,7 @@ std::string write_png(const std::string &pixels, std::int32_t width,
 std::string encode_stencil_png(const std::string &samples, std::int32_t width,
                                std::int32_t height,
                                const std::array<double, 3> &color,
-                               const std::vector<double> &decode);
+                               const std::vector<double> &decode,
+                               const PngOptions &png = {});
 
 } // namespace odr::internal::pdf
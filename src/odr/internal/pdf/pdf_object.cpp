@@ -3,6 +3,7 @@
 #include <odr/internal/crypto/crypto_util.hpp>
 #include <odr/internal/util/hash_util.hpp>
 
+#include <algorithm>
 #include <iomanip>
 #include <optional>
 #include <ostream>
@@ -64,10 +65,6 @@ std::string ObjectReference::to_string() const {
   return ss.str();
 }
 
-Object::Object(Array array) : m_holder{std::move(array)} {}
-
-Object::Object(Dictionary dictionary) : m_holder{std::move(dictionary)} {}
-
 const std::string &Object::as_string() const & {
   if (is_standard_string()) {
     return as_standard_string();
@@ -176,6 +173,15 @@ std::string Array::to_string() const {
   return ss.str();
 }
 
+Dictionary::Dictionary(Holder holder) : m_holder{std::move(holder)} {
+  const auto key = [](const Holder::value_type &entry) {
+    return std::string_view(entry.first);
+  };
+  std::ranges::stable_sort(m_holder, {}, key);
+  const auto [first, last] = std::ranges::unique(m_holder, {}, key);
+  m_holder.erase(first, last);
+}
+
 void Dictionary::to_stream(std::ostream &out) const {
   out << "<<";
 
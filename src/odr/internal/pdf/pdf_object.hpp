@@ -1,11 +1,14 @@
 #pragma once
 
-#include <any>
+#include <algorithm>
+#include <concepts>
 #include <cstdint>
 #include <iosfwd>
-#include <map>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -60,8 +63,106 @@ struct ObjectReference final {
   [[nodiscard]] std::string to_string() const;
 };
 
-class Array;
-class Dictionary;
+class Object;
+
+/// The members are defined below @ref Object, which they hold by value.
+class Array final {
+public:
+  using Holder = std::vector<Object>;
+
+  Array() = default;
+  explicit Array(Holder holder);
+  Array(const Array &) = default;
+  Array(Array &&) = default;
+
+  Array &operator=(const Array &) = default;
+  Array &operator=(Array &&) = default;
+
+  [[nodiscard]] Holder &holder() { return m_holder; }
+  [[nodiscard]] const Holder &holder() const { return m_holder; }
+
+  [[nodiscard]] std::size_t size() const;
+  [[nodiscard]] bool empty() const;
+  [[nodiscard]] Holder::iterator begin();
+  [[nodiscard]] Holder::iterator end();
+  [[nodiscard]] Holder::const_iterator begin() const;
+  [[nodiscard]] Holder::const_iterator end() const;
+
+  Object &operator[](std::size_t i);
+  const Object &operator[](std::size_t i) const;
+
+  Object &front();
+  [[nodiscard]] const Object &front() const;
+  Object &back();
+  [[nodiscard]] const Object &back() const;
+
+  void to_stream(std::ostream &) const;
+  [[nodiscard]] std::string to_string() const;
+
+private:
+  Holder m_holder;
+};
+
+/// The entries sorted by key, one per key, in one flat vector: a dictionary is
+/// a single allocation rather than a tree node per entry, and its handful of
+/// keys are found by a binary search over adjacent memory. Inserting shifts the
+/// entries after it, which at the sizes dictionaries come in costs less than
+/// the node allocation it replaces. Any insertion invalidates references to
+/// the entries, as with any vector.
+class Dictionary final {
+public:
+  using Holder = std::vector<std::pair<std::string, Object>>;
+
+  Dictionary() = default;
+  /// Sorts @p holder; of entries with the same key the first is kept, as the
+  /// parser always has.
+  explicit Dictionary(Holder holder);
+
+  Holder &holder() { return m_holder; }
+  [[nodiscard]] const Holder &holder() const { return m_holder; }
+
+  [[nodiscard]] std::size_t size() const { return m_holder.size(); }
+
+  using iterator = Holder::iterator;
+  using const_iterator = Holder::const_iterator;
+
+  [[nodiscard]] iterator begin() { return m_holder.begin(); }
+  [[nodiscard]] iterator end() { return m_holder.end(); }
+  [[nodiscard]] const_iterator begin() const { return m_holder.cbegin(); }
+  [[nodiscard]] const_iterator end() const { return m_holder.cend(); }
+
+  /// Inserts a null under @p name when there is none.
+  Object &operator[](std::string_view name);
+  /// @throws std::out_of_range when there is no @p name.
+  const Object &operator[](std::string_view name) const;
+
+  /// @throws std::out_of_range when there is no @p name.
+  [[nodiscard]] Object &at(std::string_view name);
+  /// @throws std::out_of_range when there is no @p name.
+  [[nodiscard]] const Object &at(std::string_view name) const;
+
+  [[nodiscard]] iterator find(std::string_view name);
+  [[nodiscard]] const_iterator find(std::string_view name) const;
+
+  [[nodiscard]] bool has_key(std::string_view name) const;
+  [[nodiscard]] bool has_value(std::string_view name) const;
+
+  [[nodiscard]] Object &get_emplace(std::string_view name,
+                                    const Object &default_value);
+  [[nodiscard]] Object &get_emplace(std::string_view name);
+  [[nodiscard]] const Object &get(std::string_view name) const;
+  [[nodiscard]] const Object &get(std::string_view name,
+                                  const Object &default_value) const;
+
+  void to_stream(std::ostream &) const;
+  [[nodiscard]] std::string to_string() const;
+
+private:
+  Holder m_holder;
+
+  [[nodiscard]] iterator lower_bound_(std::string_view name);
+  [[nodiscard]] const_iterator lower_bound_(std::string_view name) const;
+};
 
 template <typename T>
 concept ObjectType = std::same_as<T, Boolean> || std::same_as<T, Integer> ||
@@ -70,9 +171,15 @@ concept ObjectType = std::same_as<T, Boolean> || std::same_as<T, Integer> ||
                      std::same_as<T, Array> || std::same_as<T, Dictionary> ||
                      std::same_as<T, ObjectReference>;
 
+/// A tagged union: the scalars and references sit inline, and asking for a type
+/// compares the tag rather than a `typeid`. The strings and containers carry
+/// their own storage, which is inline too for the short names and keys most
+/// objects are made of.
 class Object final {
 public:
-  using Holder = std::any;
+  using Holder =
+      std::variant<std::monostate, Boolean, Integer, Real, StandardString,
+                   HexString, Name, Array, Dictionary, ObjectReference>;
 
   static const Object &null() {
     static const Object cache{};
@@ -86,45 +193,48 @@ public:
   explicit Object(StandardString string) : m_holder{std::move(string)} {}
   explicit Object(HexString string) : m_holder{std::move(string)} {}
   explicit Object(Name name) : m_holder{std::move(name)} {}
-  explicit Object(Array);
-  explicit Object(Dictionary);
+  explicit Object(Array array) : m_holder{std::move(array)} {}
+  explicit Object(Dictionary dictionary) : m_holder{std::move(dictionary)} {}
   explicit Object(ObjectReference reference) : m_holder{reference} {}
 
   [[nodiscard]] Holder &holder() { return m_holder; }
   [[nodiscard]] const Holder &holder() const { return m_holder; }
 
   template <ObjectType T> [[nodiscard]] bool is() const {
-    return m_holder.type() == typeid(T);
+    return std::holds_alternative<T>(m_holder);
   }
+  /// @throws std::bad_variant_access on another type.
   template <ObjectType T> [[nodiscard]] const T &as() const & {
-    return std::any_cast<const T &>(m_holder);
+    return std::get<T>(m_holder);
   }
   template <ObjectType T> [[nodiscard]] T &as() & {
-    return std::any_cast<T &>(m_holder);
+    return std::get<T>(m_holder);
   }
   template <ObjectType T> [[nodiscard]] T &&as() && {
-    return std::any_cast<T &&>(std::move(m_holder));
+    return std::get<T>(std::move(m_holder));
   }
   template <ObjectType T> [[nodiscard]] const T *as_ptr() const & {
-    return std::any_cast<T>(&m_holder);
+    return std::get_if<T>(&m_holder);
   }
   template <ObjectType T> [[nodiscard]] T *as_ptr() & {
-    return std::any_cast<T>(&m_holder);
+    return std::get_if<T>(&m_holder);
   }
   template <ObjectType T> [[nodiscard]] std::optional<T> as_opt() const & {
-    if (const T *ptr = std::any_cast<T>(&m_holder)) {
+    if (const T *ptr = std::get_if<T>(&m_holder)) {
       return *ptr;
     }
     return std::nullopt;
   }
   template <ObjectType T> [[nodiscard]] std::optional<T> as_opt() && {
-    if (T *ptr = std::any_cast<T>(&m_holder)) {
+    if (T *ptr = std::get_if<T>(&m_holder)) {
       return std::move(*ptr);
     }
     return std::nullopt;
   }
 
-  [[nodiscard]] bool is_null() const { return !m_holder.has_value(); }
+  [[nodiscard]] bool is_null() const {
+    return std::holds_alternative<std::monostate>(m_holder);
+  }
   [[nodiscard]] bool is_bool() const { return is<Boolean>(); }
   [[nodiscard]] bool is_integer() const { return is<Integer>(); }
   [[nodiscard]] bool is_real() const { return is<Real>() || is_integer(); }
@@ -245,110 +355,104 @@ private:
   Holder m_holder;
 };
 
-class Array final {
-public:
-  using Holder = std::vector<Object>;
-
-  Array() = default;
-  explicit Array(Holder holder) : m_holder{std::move(holder)} {}
-  Array(const Array &) = default;
-  Array(Array &&) = default;
-
-  Array &operator=(const Array &) = default;
-  Array &operator=(Array &&) = default;
-
-  [[nodiscard]] Holder &holder() { return m_holder; }
-  [[nodiscard]] const Holder &holder() const { return m_holder; }
-
-  [[nodiscard]] std::size_t size() const { return m_holder.size(); }
-  [[nodiscard]] bool empty() const { return m_holder.empty(); }
-  [[nodiscard]] Holder::iterator begin() { return m_holder.begin(); }
-  [[nodiscard]] Holder::iterator end() { return m_holder.end(); }
-  [[nodiscard]] Holder::const_iterator begin() const {
-    return m_holder.cbegin();
-  }
-  [[nodiscard]] Holder::const_iterator end() const { return m_holder.cend(); }
-
-  Object &operator[](const std::size_t i) { return m_holder.at(i); }
-  const Object &operator[](const std::size_t i) const { return m_holder.at(i); }
-
-  Object &front() { return m_holder.front(); }
-  [[nodiscard]] const Object &front() const { return m_holder.front(); }
-  Object &back() { return m_holder.back(); }
-  [[nodiscard]] const Object &back() const { return m_holder.back(); }
-
-  void to_stream(std::ostream &) const;
-  [[nodiscard]] std::string to_string() const;
-
-private:
-  Holder m_holder;
-};
-
-class Dictionary final {
-public:
-  using Holder = std::map<std::string, Object>;
-
-  Dictionary() = default;
-  explicit Dictionary(Holder holder) : m_holder{std::move(holder)} {}
-
-  Holder &holder() { return m_holder; }
-  [[nodiscard]] const Holder &holder() const { return m_holder; }
-
-  [[nodiscard]] std::size_t size() const { return m_holder.size(); }
-
-  using iterator = Holder::iterator;
-  using const_iterator = Holder::const_iterator;
-
-  [[nodiscard]] iterator begin() { return m_holder.begin(); }
-  [[nodiscard]] iterator end() { return m_holder.end(); }
-  [[nodiscard]] const_iterator begin() const { return m_holder.cbegin(); }
-  [[nodiscard]] const_iterator end() const { return m_holder.cend(); }
-
-  Object &operator[](const std::string &name) { return m_holder[name]; }
-  const Object &operator[](const std::string &name) const {
-    return m_holder.at(name);
-  }
-
-  [[nodiscard]] Object &at(const std::string &name) {
-    return m_holder.at(name);
-  }
-  [[nodiscard]] const Object &at(const std::string &name) const {
-    return m_holder.at(name);
-  }
-
-  [[nodiscard]] Holder::iterator find(const std::string &name) {
-    return m_holder.find(name);
-  }
-  [[nodiscard]] Holder::const_iterator find(const std::string &name) const {
-    return m_holder.find(name);
-  }
-
-  [[nodiscard]] bool has_key(const std::string &name) const {
-    return m_holder.contains(name);
-  }
-  [[nodiscard]] bool has_value(const std::string &name) const {
-    const auto it = find(name);
-    return it != end() && !it->second.is_null();
-  }
-
-  [[nodiscard]] Object &get_emplace(const std::string &name,
-                                    Object default_value = Object::null()) {
-    const auto [it, success] = m_holder.try_emplace(name, default_value);
-    return it->second;
-  }
-  [[nodiscard]] const Object &
-  get(const std::string &name,
-      const Object &default_value = Object::null()) const {
-    const auto it = find(name);
-    return it != end() ? it->second : default_value;
-  }
-
-  void to_stream(std::ostream &) const;
-  [[nodiscard]] std::string to_string() const;
-
-private:
-  Holder m_holder;
-};
+inline Array::Array(Holder holder) : m_holder{std::move(holder)} {}
+
+inline std::size_t Array::size() const { return m_holder.size(); }
+inline bool Array::empty() const { return m_holder.empty(); }
+inline Array::Holder::iterator Array::begin() { return m_holder.begin(); }
+inline Array::Holder::iterator Array::end() { return m_holder.end(); }
+inline Array::Holder::const_iterator Array::begin() const {
+  return m_holder.cbegin();
+}
+inline Array::Holder::const_iterator Array::end() const {
+  return m_holder.cend();
+}
+
+inline Object &Array::operator[](const std::size_t i) {
+  return m_holder.at(i);
+}
+inline const Object &Array::operator[](const std::size_t i) const {
+  return m_holder.at(i);
+}
+
+inline Object &Array::front() { return m_holder.front(); }
+inline const Object &Array::front() const { return m_holder.front(); }
+inline Object &Array::back() { return m_holder.back(); }
+inline const Object &Array::back() const { return m_holder.back(); }
+
+inline Dictionary::iterator
+Dictionary::lower_bound_(const std::string_view name) {
+  return std::ranges::lower_bound(
+      m_holder, name, {},
+      [](const auto &entry) { return std::string_view(entry.first); });
+}
+inline Dictionary::const_iterator
+Dictionary::lower_bound_(const std::string_view name) const {
+  return std::ranges::lower_bound(
+      m_holder, name, {},
+      [](const auto &entry) { return std::string_view(entry.first); });
+}
+
+inline Dictionary::iterator Dictionary::find(const std::string_view name) {
+  const auto it = lower_bound_(name);
+  return it != m_holder.end() && it->first == name ? it : m_holder.end();
+}
+inline Dictionary::const_iterator
+Dictionary::find(const std::string_view name) const {
+  const auto it = lower_bound_(name);
+  return it != m_holder.end() && it->first == name ? it : m_holder.end();
+}
+
+inline Object &Dictionary::get_emplace(const std::string_view name,
+                                       const Object &default_value) {
+  auto it = lower_bound_(name);
+  if (it == m_holder.end() || it->first != name) {
+    it = m_holder.emplace(it, std::string(name), default_value);
+  }
+  return it->second;
+}
+inline Object &Dictionary::get_emplace(const std::string_view name) {
+  return get_emplace(name, Object::null());
+}
+
+inline Object &Dictionary::operator[](const std::string_view name) {
+  return get_emplace(name);
+}
+inline const Object &Dictionary::operator[](const std::string_view name) const {
+  return at(name);
+}
+
+inline Object &Dictionary::at(const std::string_view name) {
+  const auto it = find(name);
+  if (it == m_holder.end()) {
+    throw std::out_of_range("no such key: " + std::string(name));
+  }
+  return it->second;
+}
+inline const Object &Dictionary::at(const std::string_view name) const {
+  const auto it = find(name);
+  if (it == m_holder.end()) {
+    throw std::out_of_range("no such key: " + std::string(name));
+  }
+  return it->second;
+}
+
+inline bool Dictionary::has_key(const std::string_view name) const {
+  return find(name) != m_holder.end();
+}
+inline bool Dictionary::has_value(const std::string_view name) const {
+  const auto it = find(name);
+  return it != m_holder.end() && !it->second.is_null();
+}
+
+inline const Object &Dictionary::get(const std::string_view name,
+                                     const Object &default_value) const {
+  const auto it = find(name);
+  return it != m_holder.end() ? it->second : default_value;
+}
+inline const Object &Dictionary::get(const std::string_view name) const {
+  return get(name, Object::null());
+}
 
 std::ostream &operator<<(std::ostream &, const StandardString &);
 std::ostream &operator<<(std::ostream &, const HexString &);
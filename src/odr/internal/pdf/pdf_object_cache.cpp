@@ -0,0 +1,51 @@
+#include <odr/internal/pdf/pdf_object_cache.hpp>
+
+#include <string>
+
+namespace odr::internal::pdf {
+
+namespace {
+
+/// Only out-of-line strings cost the heap anything.
+std::size_t heap_size(const std::string &string) {
+  return string.capacity() > std::string().capacity() ? string.capacity() : 0;
+}
+
+} // namespace
+
+std::size_t estimated_size(const Object &object) {
+  std::size_t result = sizeof(Object);
+  if (object.is_string()) {
+    result += heap_size(object.as_string());
+  } else if (object.is_array()) {
+    const Array &array = object.as_array();
+    result += (array.holder().capacity() - array.size()) * sizeof(Object);
+    for (const Object &element : array) {
+      result += estimated_size(element);
+    }
+  } else if (object.is_dictionary()) {
+    // one flat block of entries, each a key beside its value
+    const Dictionary &dictionary = object.as_dictionary();
+    result += (dictionary.holder().capacity() - dictionary.size()) *
+              sizeof(Dictionary::Holder::value_type);
+    for (const auto &[key, value] : dictionary) {
+      result += sizeof(key) + heap_size(key) + estimated_size(value);
+    }
+  }
+  return result;
+}
+
+std::size_t estimated_size(const IndirectObject &object) {
+  return sizeof(IndirectObject) - sizeof(Object) +
+         estimated_size(object.object);
+}
+
+std::size_t estimated_size(const ObjectStream &stream) {
+  std::size_t result = sizeof(ObjectStream);
+  for (const ObjectStreamMember &member : stream) {
+    result += sizeof(member) - sizeof(Object) + estimated_size(member.object);
+  }
+  return result;
+}
+
+} // namespace odr::internal::pdf
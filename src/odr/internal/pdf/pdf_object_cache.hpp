@@ -0,0 +1,126 @@
+#pragma once
+
+#include <odr/internal/pdf/pdf_file_object.hpp>
+#include <odr/internal/pdf/pdf_object.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace odr::internal::pdf {
+
+/// Approximate heap footprint, for the cache budget: exact enough to bound
+/// memory, not an accounting.
+[[nodiscard]] std::size_t estimated_size(const Object &object);
+[[nodiscard]] std::size_t estimated_size(const IndirectObject &object);
+[[nodiscard]] std::size_t estimated_size(const ObjectStream &stream);
+
+struct ObjectCacheStats {
+  std::uint64_t hits{0};
+  std::uint64_t misses{0};
+  std::uint64_t evictions{0};
+  std::size_t entries{0};
+  std::size_t bytes{0};
+};
+
+/// Least-recently-used map from `ObjectReference` to immutable values under a
+/// byte budget. Entries are handed out as `shared_ptr`s, so evicting one never
+/// pulls it from under a reader still holding it; the budget bounds what the
+/// cache keeps alive, not what its readers do.
+///
+/// Every member is safe to call concurrently.
+template <typename T> class ObjectCache final {
+public:
+  explicit ObjectCache(const std::size_t budget) : m_budget{budget} {}
+
+  /// The value cached for @p reference, counting a hit, or null, counting a
+  /// miss.
+  [[nodiscard]] std::shared_ptr<const T>
+  find(const ObjectReference &reference) {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_index.find(reference);
+    if (it == m_index.end()) {
+      ++m_stats.misses;
+      return nullptr;
+    }
+    ++m_stats.hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->value;
+  }
+
+  /// Caches @p value, then evicts from the least recently used end until the
+  /// budget holds again; a value alone over budget is handed out but not
+  /// kept. Should another reader have cached @p reference meanwhile, theirs
+  /// wins and is returned instead.
+  std::shared_ptr<const T> insert(const ObjectReference &reference, T value) {
+    const std::size_t size = estimated_size(value);
+    auto shared = std::make_shared<const T>(std::move(value));
+
+    std::lock_guard lock(m_mutex);
+    if (const auto it = m_index.find(reference); it != m_index.end()) {
+      return it->second->value;
+    }
+    m_entries.push_front({reference, shared, size});
+    m_index.emplace(reference, m_entries.begin());
+    m_stats.bytes += size;
+    evict();
+    return shared;
+  }
+
+  void set_budget(const std::size_t budget) {
+    std::lock_guard lock(m_mutex);
+    m_budget = budget;
+    evict();
+  }
+
+  [[nodiscard]] std::size_t budget() const {
+    std::lock_guard lock(m_mutex);
+    return m_budget;
+  }
+
+  /// Drops every entry; the counters carry on.
+  void clear() {
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_stats.bytes = 0;
+  }
+
+  [[nodiscard]] ObjectCacheStats stats() const {
+    std::lock_guard lock(m_mutex);
+    ObjectCacheStats result = m_stats;
+    result.entries = m_entries.size();
+    return result;
+  }
+
+private:
+  struct Entry {
+    ObjectReference reference;
+    std::shared_ptr<const T> value;
+    std::size_t size{0};
+  };
+
+  void evict() {
+    while (m_stats.bytes > m_budget && !m_entries.empty()) {
+      const Entry &entry = m_entries.back();
+      m_stats.bytes -= entry.size;
+      m_index.erase(entry.reference);
+      m_entries.pop_back();
+      ++m_stats.evictions;
+    }
+  }
+
+  mutable std::mutex m_mutex;
+  std::size_t m_budget{0};
+  /// most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<ObjectReference, typename std::list<Entry>::iterator>
+      m_index;
+  ObjectCacheStats m_stats;
+};
+
+} // namespace odr::internal::pdf
@@ -5,7 +5,6 @@
 #include <cmath>
 #include <cstdint>
 #include <optional>
-#include <sstream>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -306,7 +305,7 @@ bool ObjectParser::peek_name() {
   return c == '/';
 }
 
-void ObjectParser::read_name(std::ostream &out) {
+void ObjectParser::read_name(std::string &out) {
   if (const char_type c = bumpc(); c != '/') {
     throw std::runtime_error("not a name");
   }
@@ -326,19 +325,19 @@ void ObjectParser::read_name(std::ostream &out) {
     if (c == '#') {
       bumpc();
       const std::array hex = bumpnc<2>();
-      out.put(two_hex_to_char(hex[0], hex[1]));
+      out.push_back(two_hex_to_char(hex[0], hex[1]));
       continue;
     }
 
-    out.put(c);
+    out.push_back(c);
     bumpc();
   }
 }
 
 Name ObjectParser::read_name() {
-  std::stringstream ss;
-  read_name(ss);
-  return Name(ss.str());
+  std::string result;
+  read_name(result);
+  return Name(std::move(result));
 }
 
 bool ObjectParser::peek_null() {
@@ -566,7 +565,7 @@ Dictionary ObjectParser::read_dictionary() {
     skip_whitespace_and_comments();
     promote_indirect_reference(value);
 
-    result.emplace(std::move(name.string), std::move(value));
+    result.emplace_back(std::move(name.string), std::move(value));
   }
 }
 
@@ -68,7 +68,8 @@ public:
   [[nodiscard]] std::variant<Integer, Real> read_integer_or_real();
 
   [[nodiscard]] bool peek_name();
-  void read_name(std::ostream &);
+  /// Appends the name, decoded, to @p out.
+  void read_name(std::string &out);
   [[nodiscard]] Name read_name();
 
   [[nodiscard]] bool peek_null();
@@ -18,7 +18,7 @@
 #include <optional>
 #include <ranges>
 #include <set>
-#include <sstream>
+#include <string_view>
 #include <unordered_map>
 
 namespace odr::internal::pdf {
@@ -883,8 +883,9 @@ void run_content(const std::string &content, const Resources &resources,
                  const Logger &logger, std::set<std::string> &warned,
                  ActiveForms &active, MarkedContentStack &marked,
                  std::optional<Pen> &pen) {
-  std::istringstream ss(content);
-  GraphicsOperatorParser parser(ss, logger);
+  GraphicsOperatorParser parser(std::string_view(content), logger);
+  // one operator, and so one operand stack, for the whole stream
+  GraphicsOperator op;
 
   // Route a shown string through the Type3 char-proc renderer or the normal
   // text path, by the font kind.
@@ -897,8 +898,8 @@ void run_content(const std::string &content, const Resources &resources,
     }
   };
 
-  while (!ss.eof()) {
-    const GraphicsOperator op = parser.read_operator();
+  while (!parser.in().eof()) {
+    parser.read_operator(op);
     state.execute(op);
 
     switch (op.type) {
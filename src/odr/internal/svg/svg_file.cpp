@@ -21,7 +21,11 @@ std::string_view local_name(std::string_view name) {
 } // namespace
 
 bool svg::is_svg_file(const xml::XmlFile &file) {
-  return local_name(file.root_name()) == "svg";
+  return is_svg_root_name(file.root_name());
+}
+
+bool svg::is_svg_root_name(const std::string_view name) {
+  return local_name(name) == "svg";
 }
 
 svg::SvgFile::SvgFile(std::shared_ptr<xml::XmlFile> file)
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace odr::internal::svg {
 
@@ -13,6 +14,10 @@ namespace odr::internal::svg {
 /// any other xml - and what @ref SvgFile's constructor throws on.
 [[nodiscard]] bool is_svg_file(const xml::XmlFile &file);
 
+/// Whether an xml document element of this name, prefix and all, makes the
+/// document an svg.
+[[nodiscard]] bool is_svg_root_name(std::string_view name);
+
 /// An image whose bytes are an xml document, so the xml decoder is what
 /// recognises it and what resolves its encoding. Nothing is drawn from the
 /// tree - the markup goes into a page as the `<img>` data url every other
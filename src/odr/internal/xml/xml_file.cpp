@@ -9,25 +9,32 @@
 
 #include <pugixml.hpp>
 
+#include <cstddef>
 #include <istream>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 
 namespace odr::internal {
 
 namespace {
 
-/// The declaration beats any guess over the bytes; a name we do not know
-/// leaves the guess in place.
-TextEncoding resolve_encoding(const text::TextFile &file) {
-  const std::unique_ptr<std::istream> in = file.file()->stream();
-  const std::string declared = util::xml::read_declared_encoding(*in);
+/// The declaration at the head of @p in beats @p guess, a guess over the
+/// bytes; a name we do not know leaves the guess in place.
+TextEncoding resolve_encoding(std::istream &in, const TextEncoding guess) {
+  const std::string declared = util::xml::read_declared_encoding(in);
 
   if (const TextEncoding encoding = text_encoding_by_name(declared);
       encoding != TextEncoding::unknown) {
     return encoding;
   }
-  return file.encoding();
+  return guess;
+}
+
+TextEncoding resolve_encoding(const text::TextFile &file) {
+  const std::unique_ptr<std::istream> in = file.file()->stream();
+  return resolve_encoding(*in, file.encoding());
 }
 
 /// @throws NoXmlFile if @p text is not a well formed xml document.
@@ -47,8 +54,101 @@ std::unique_ptr<pugi::xml_document> parse_source(const std::string &text) {
   return result;
 }
 
+/// Past the markup at @p at that ends with @p terminator, npos if the text
+/// ends first.
+std::size_t past(const std::string_view text, const std::size_t at,
+                 const std::string_view terminator) {
+  const std::size_t end = text.find(terminator, at);
+  return end == std::string_view::npos ? end : end + terminator.size();
+}
+
+/// Past a doctype at @p at, its internal subset and the quoted literals in
+/// it skipped whole.
+std::size_t past_doctype(const std::string_view text, const std::size_t at) {
+  char quote = '\0';
+  bool subset = false;
+  for (std::size_t i = at; i < text.size(); ++i) {
+    if (quote != '\0') {
+      if (text[i] == quote) {
+        quote = '\0';
+      }
+    } else if (text[i] == '"' || text[i] == '\'') {
+      quote = text[i];
+    } else if (text[i] == '[') {
+      subset = true;
+    } else if (text[i] == ']') {
+      subset = false;
+    } else if (text[i] == '>' && !subset) {
+      return i + 1;
+    }
+  }
+  return std::string_view::npos;
+}
+
+/// The name of the first start tag in @p text, if only prolog comes before
+/// it and the name ends before the text does.
+std::optional<std::string> sniff_root_name(std::string_view text) {
+  static constexpr std::string_view whitespace = " \t\r\n";
+
+  if (text.starts_with("\xef\xbb\xbf")) {
+    text.remove_prefix(3);
+  }
+
+  std::size_t at = 0;
+  while (true) {
+    at = text.find_first_not_of(whitespace, at);
+    if (at == std::string_view::npos || text[at] != '<') {
+      return std::nullopt;
+    }
+    const std::string_view rest = text.substr(at);
+    if (rest.starts_with("<?")) {
+      at = past(text, at + 2, "?>");
+    } else if (rest.starts_with("<!--")) {
+      at = past(text, at + 4, "-->");
+    } else if (rest.starts_with("<!DOCTYPE")) {
+      at = past_doctype(text, at + 9);
+    } else {
+      break;
+    }
+    if (at == std::string_view::npos) {
+      return std::nullopt;
+    }
+  }
+
+  // an end tag, a CDATA section or anything else opening with `<!` is no
+  // start tag, and no prolog either
+  if (at + 1 < text.size() && (text[at + 1] == '!' || text[at + 1] == '/')) {
+    return std::nullopt;
+  }
+  const std::size_t name_end = text.find_first_of(" \t\r\n/>", at + 1);
+  if (name_end == std::string_view::npos || name_end == at + 1) {
+    return std::nullopt;
+  }
+  return std::string(text.substr(at + 1, name_end - at - 1));
+}
+
 } // namespace
 
+std::optional<std::string> xml::probe_root_name(const std::string_view bytes,
+                                                const TextEncoding guess,
+                                                const bool complete) {
+  util::stream::ViewStream in(bytes);
+  const TextEncoding encoding = resolve_encoding(in, guess);
+  if (!text_encoding_is_decodable(encoding)) {
+    return std::nullopt;
+  }
+  const std::string text = encoding::to_utf8(bytes, encoding);
+
+  if (!complete) {
+    return sniff_root_name(text);
+  }
+  try {
+    return std::string(parse_source(text)->document_element().name());
+  } catch (const NoXmlFile &) {
+    return std::nullopt;
+  }
+}
+
 xml::XmlFile::XmlFile(std::shared_ptr<text::TextFile> file)
     : m_file{std::move(file)} {
   m_encoding = resolve_encoding(*m_file);
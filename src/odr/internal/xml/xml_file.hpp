@@ -5,7 +5,9 @@
 #include <odr/internal/text/text_file.hpp>
 
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 
 namespace pugi {
 class xml_document;
@@ -13,6 +15,18 @@ class xml_document;
 
 namespace odr::internal::xml {
 
+/// The document element's name if @p bytes, a file's opening bytes, read as
+/// the head of an xml document; nullopt if they do not. @p guess is the
+/// encoding detected over them, which a declaration overrides as in
+/// @ref XmlFile. @p complete says whether that is the whole file.
+///
+/// A whole file is parsed, as @ref XmlFile would. A prefix is only sniffed:
+/// declaration, comments, processing instructions and doctype, then a start
+/// tag whose name ends before the cut - so a prefix that passes may still be
+/// malformed further on.
+[[nodiscard]] std::optional<std::string>
+probe_root_name(std::string_view bytes, TextEncoding guess, bool complete);
+
 /// An xml file. Nothing is decoded beyond the parse that recognises it: it
 /// renders as a source view, not as a document.
 class XmlFile final : public abstract::TextFile {
@@ -9,6 +9,7 @@
 #include <odr/internal/zip/zip_util.hpp>
 
 #include <algorithm>
+#include <iterator>
 #include <string>
 
 #include <miniz/miniz.h>
@@ -133,21 +134,41 @@ ZipArchive::Iterator ZipArchive::begin() const {
 ZipArchive::Iterator ZipArchive::end() const { return std::cend(m_entries); }
 
 ZipArchive::Iterator ZipArchive::find(const RelPath &path) const {
-  return std::ranges::find_if(
-      *this, [&path](const Entry &entry) { return entry.path() == path; });
+  const auto it = m_index.find(path);
+  if (it == std::end(m_index)) {
+    return end();
+  }
+  return std::next(begin(), static_cast<std::ptrdiff_t>(it->second));
 }
 
 ZipArchive::Iterator
 ZipArchive::insert_file(const Iterator at, RelPath path,
                         std::shared_ptr<abstract::File> file,
                         const std::uint32_t compression_level) {
-  return m_entries.insert(
-      at, Entry(std::move(path), std::move(file), compression_level));
+  return insert_(at,
+                 Entry(std::move(path), std::move(file), compression_level));
 }
 
 ZipArchive::Iterator ZipArchive::insert_directory(const Iterator at,
                                                   RelPath path) {
-  return m_entries.insert(at, Entry(std::move(path), nullptr, 0));
+  return insert_(at, Entry(std::move(path), nullptr, 0));
+}
+
+ZipArchive::Iterator ZipArchive::insert_(const Iterator at, Entry entry) {
+  const bool appended = at == end();
+  const auto result = m_entries.insert(at, std::move(entry));
+
+  if (appended) {
+    m_index.try_emplace(result->path(), m_entries.size() - 1);
+  } else {
+    // every later position moved
+    m_index.clear();
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+      m_index.try_emplace(m_entries[i].path(), i);
+    }
+  }
+
+  return result;
 }
 
 } // namespace odr::internal::zip
@@ -3,8 +3,10 @@
 #include <odr/internal/abstract/archive.hpp>
 #include <odr/internal/common/path.hpp>
 
+#include <cstddef>
 #include <iosfwd>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace odr::internal::abstract {
@@ -33,8 +35,10 @@ public:
   [[nodiscard]] Iterator begin() const;
   [[nodiscard]] Iterator end() const;
 
+  /// The first entry at @p path, or `end()`, looked up by hash.
   [[nodiscard]] Iterator find(const RelPath &path) const;
 
+  /// Appending keeps the path index; inserting before the end rebuilds it.
   Iterator insert_file(Iterator at, RelPath path,
                        std::shared_ptr<abstract::File> file,
                        std::uint32_t compression_level = 6);
@@ -63,6 +67,10 @@ public:
 
 private:
   std::vector<Entry> m_entries;
+  /// path to the position of the first entry of that path
+  std::unordered_map<RelPath, std::size_t> m_index;
+
+  Iterator insert_(Iterator at, Entry entry);
 };
 
 } // namespace odr::internal::zip
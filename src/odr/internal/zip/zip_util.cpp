@@ -6,60 +6,224 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
 
 namespace odr::internal::zip::util {
 
 namespace {
 
-class ReaderBuffer final : public std::streambuf {
+/// Reads one entry on a cursor of its own: the compressed bytes are taken from
+/// the archive's memory in place, or else read through a stream of the file
+/// opened for this entry alone, and inflated here rather than by miniz. An
+/// entry's reader shares nothing with another's, so entries of one archive are
+/// read in parallel without taking the archive's lock.
+///
+/// A stored entry in memory is handed out in place, without a copy. A corrupt
+/// entry, one whose inflate fails or whose CRC-32 does not match, reads short.
+class EntryBuffer final : public std::streambuf {
 public:
-  ReaderBuffer(std::shared_ptr<const Archive> archive,
-               mz_zip_reader_extract_iter_state *iter,
-               const std::size_t buffer_size = 4096)
-      : m_archive{std::move(archive)}, m_buffer(buffer_size, '\0') {
+  EntryBuffer(std::shared_ptr<const Archive> archive,
+              const mz_zip_archive_file_stat &stat)
+      : m_archive{std::move(archive)}, m_deflated{stat.m_method == MZ_DEFLATED},
+        m_compressed_remaining{stat.m_comp_size},
+        m_uncompressed_remaining{stat.m_uncomp_size},
+        m_expected_crc{stat.m_crc32} {
     if (m_archive == nullptr) {
-      throw NullPointerError("ReaderBuffer: archive is nullptr");
+      throw NullPointerError("EntryBuffer: archive is nullptr");
     }
-    if (iter == nullptr) {
-      throw NullPointerError("ReaderBuffer: iter is nullptr");
+
+    const std::shared_ptr<abstract::File> file = m_archive->file();
+    m_memory = file->memory_data();
+    if (!m_memory.has_value()) {
+      m_stream = file->stream();
+    }
+
+    std::array<char, local_header_size> header{};
+    read_(stat.m_local_header_ofs, header.data(), header.size());
+    if (read_u32(header.data()) != local_header_signature) {
+      throw NoZipFile();
+    }
+    const std::uint64_t data_offset = stat.m_local_header_ofs +
+                                      local_header_size +
+                                      read_u16(header.data() + 26) +
+                                      read_u16(header.data() + 28);
+
+    if (m_memory.has_value()) {
+      if (data_offset > m_memory->size() ||
+          m_memory->size() - data_offset < m_compressed_remaining) {
+        throw NoZipFile();
+      }
+      m_memory = m_memory->substr(data_offset, m_compressed_remaining);
+    } else {
+      m_stream->seekg(static_cast<std::streamoff>(data_offset));
+    }
+
+    if (m_deflated) {
+      // raw deflate, as a zip entry holds it
+      if (mz_inflateInit2(&m_inflate, -MZ_DEFAULT_WINDOW_BITS) != MZ_OK) {
+        throw std::runtime_error("EntryBuffer: cannot initialize inflate");
+      }
+      m_inflating = true;
+    }
+    if (m_deflated || !m_memory.has_value()) {
+      m_buffer.resize(m_archive->buffer_size());
+    }
+    if (m_deflated && !m_memory.has_value()) {
+      m_input.resize(m_archive->buffer_size());
+    }
+  }
+
+  ~EntryBuffer() override {
+    if (m_inflating) {
+      mz_inflateEnd(&m_inflate);
     }
-    m_iter = iter;
-    m_remaining = iter->file_stat.m_uncomp_size;
   }
 
+  EntryBuffer(const EntryBuffer &) = delete;
+  EntryBuffer &operator=(const EntryBuffer &) = delete;
+
 protected:
-  int underflow() override {
-    if (m_remaining <= 0) {
+  int_type underflow() override {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    if (m_uncompressed_remaining == 0) {
       return traits_type::eof();
     }
 
-    std::lock_guard lock(m_archive->mutex());
+    char *begin = m_buffer.data();
+    std::size_t produced = 0;
+    if (m_deflated) {
+      produced = inflate_();
+    } else if (m_memory.has_value()) {
+      produced = static_cast<std::size_t>(
+          std::min<std::uint64_t>(m_uncompressed_remaining, m_memory->size()));
+      // the get area is never written through
+      begin = const_cast<char *>(m_memory->data());
+      m_memory->remove_prefix(produced);
+    } else {
+      m_stream->read(m_buffer.data(),
+                     static_cast<std::streamsize>(std::min<std::uint64_t>(
+                         m_uncompressed_remaining, m_buffer.size())));
+      produced = static_cast<std::size_t>(m_stream->gcount());
+    }
+    if (produced == 0) {
+      return traits_type::eof();
+    }
 
-    const std::uint64_t amount =
-        std::min<std::uint64_t>(m_remaining, m_buffer.size());
-    const std::uint32_t result =
-        mz_zip_reader_extract_iter_read(m_iter, m_buffer.data(), amount);
-    // miniz reports a failed inflate as a short read; leaving the get area
-    // empty while claiming success would spin `underflow` forever.
-    if (result == 0) {
+    m_crc = static_cast<std::uint32_t>(mz_crc32(
+        m_crc, reinterpret_cast<const unsigned char *>(begin), produced));
+    m_uncompressed_remaining -= produced;
+    if (m_uncompressed_remaining == 0 && m_crc != m_expected_crc) {
       return traits_type::eof();
     }
-    m_remaining -= result;
-    setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + result);
 
+    setg(begin, begin, begin + produced);
     return traits_type::to_int_type(*gptr());
   }
 
 private:
+  static constexpr std::size_t local_header_size = 30;
+  static constexpr std::uint32_t local_header_signature = 0x04034b50;
+
   std::shared_ptr<const Archive> m_archive;
-  mz_zip_reader_extract_iter_state *m_iter{};
-  std::uint64_t m_remaining{0};
+  bool m_deflated{false};
+  std::uint64_t m_compressed_remaining{0};
+  std::uint64_t m_uncompressed_remaining{0};
+  std::uint32_t m_expected_crc{0};
+  std::uint32_t m_crc{MZ_CRC32_INIT};
+
+  /// The entry's compressed bytes not yet taken, if the archive is in memory.
+  std::optional<std::string_view> m_memory;
+  /// Otherwise this entry's own stream of the archive.
+  std::unique_ptr<std::istream> m_stream;
+
+  mz_stream m_inflate{};
+  bool m_inflating{false};
+  /// Compressed bytes read from `m_stream`.
+  std::vector<char> m_input;
   std::vector<char> m_buffer;
+
+  static std::uint16_t read_u16(const char *data) {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+    return static_cast<std::uint16_t>(bytes[0] | bytes[1] << 8);
+  }
+
+  static std::uint32_t read_u32(const char *data) {
+    return read_u16(data) | static_cast<std::uint32_t>(read_u16(data + 2))
+                                << 16;
+  }
+
+  void read_(const std::uint64_t offset, char *data, const std::size_t size) {
+    if (m_memory.has_value()) {
+      if (offset > m_memory->size() || m_memory->size() - offset < size) {
+        throw NoZipFile();
+      }
+      std::copy_n(m_memory->data() + offset, size, data);
+      return;
+    }
+    m_stream->seekg(static_cast<std::streamoff>(offset));
+    m_stream->read(data, static_cast<std::streamsize>(size));
+    if (static_cast<std::size_t>(m_stream->gcount()) != size) {
+      throw NoZipFile();
+    }
+  }
+
+  /// Hands inflate the next compressed bytes.
+  void refill_() {
+    if (m_memory.has_value()) {
+      const std::size_t size = static_cast<std::size_t>(
+          std::min<std::uint64_t>(m_memory->size(), UINT32_MAX));
+      m_inflate.next_in =
+          reinterpret_cast<const unsigned char *>(m_memory->data());
+      m_inflate.avail_in = static_cast<unsigned int>(size);
+      m_memory->remove_prefix(size);
+      m_compressed_remaining -= size;
+      return;
+    }
+    m_stream->read(m_input.data(),
+                   static_cast<std::streamsize>(std::min<std::uint64_t>(
+                       m_compressed_remaining, m_input.size())));
+    const auto size = static_cast<std::size_t>(m_stream->gcount());
+    m_inflate.next_in = reinterpret_cast<const unsigned char *>(m_input.data());
+    m_inflate.avail_in = static_cast<unsigned int>(size);
+    m_compressed_remaining -= size;
+  }
+
+  /// Inflates into `m_buffer`; returns how much, 0 at the end or on failure.
+  std::size_t inflate_() {
+    const std::size_t wanted = static_cast<std::size_t>(
+        std::min<std::uint64_t>(m_uncompressed_remaining, m_buffer.size()));
+    m_inflate.next_out = reinterpret_cast<unsigned char *>(m_buffer.data());
+    m_inflate.avail_out = static_cast<unsigned int>(wanted);
+
+    while (m_inflate.avail_out > 0) {
+      if (m_inflate.avail_in == 0) {
+        if (m_compressed_remaining == 0) {
+          break;
+        }
+        refill_();
+        if (m_inflate.avail_in == 0) {
+          // the file ended early
+          break;
+        }
+      }
+      const int status = mz_inflate(&m_inflate, MZ_NO_FLUSH);
+      if (status != MZ_OK) {
+        // the end of the stream, or an error, which reads short
+        break;
+      }
+    }
+
+    return wanted - m_inflate.avail_out;
+  }
 };
 
 class FileInZipIstream final : public std::istream {
 public:
-  explicit FileInZipIstream(std::unique_ptr<ReaderBuffer> sbuf)
+  explicit FileInZipIstream(std::unique_ptr<EntryBuffer> sbuf)
       : std::istream(sbuf.get()), m_sbuf{std::move(sbuf)} {
     if (m_sbuf == nullptr) {
       throw NullPointerError("FileInZipIstream: sbuf is nullptr");
@@ -67,7 +231,7 @@ public:
   }
 
 private:
-  std::unique_ptr<ReaderBuffer> m_sbuf;
+  std::unique_ptr<EntryBuffer> m_sbuf;
 };
 
 class FileInZip final : public abstract::File {
@@ -97,19 +261,23 @@ public:
   }
 
   [[nodiscard]] std::unique_ptr<std::istream> stream() const override {
-    std::lock_guard lock(m_archive->mutex());
-    if (mz_zip_reader_is_file_encrypted(m_archive->zip(), m_index)) {
-      throw UnsupportedOperation("cannot read encrypted zip entry");
-    }
-    if (!mz_zip_reader_is_file_supported(m_archive->zip(), m_index)) {
-      throw UnsupportedOperation("zip entry not supported");
-    }
-    auto iter = mz_zip_reader_extract_iter_new(m_archive->zip(), m_index, 0);
-    if (iter == nullptr) {
-      throw FileNotFound("zip entry not found " + std::to_string(m_index));
+    mz_zip_archive_file_stat stat{};
+    {
+      // only the central directory is looked at under the lock; the entry is
+      // read on a cursor of its own
+      std::lock_guard lock(m_archive->mutex());
+      if (mz_zip_reader_is_file_encrypted(m_archive->zip(), m_index)) {
+        throw UnsupportedOperation("cannot read encrypted zip entry");
+      }
+      if (!mz_zip_reader_is_file_supported(m_archive->zip(), m_index)) {
+        throw UnsupportedOperation("zip entry not supported");
+      }
+      if (!mz_zip_reader_file_stat(m_archive->zip(), m_index, &stat)) {
+        throw FileNotFound("zip entry not found " + std::to_string(m_index));
+      }
     }
     return std::make_unique<FileInZipIstream>(
-        std::make_unique<ReaderBuffer>(m_archive, iter, 4098));
+        std::make_unique<EntryBuffer>(m_archive, stat));
   }
 
 private:
@@ -130,11 +298,7 @@ bool Archive::Entry::is_directory() const {
 }
 
 RelPath Archive::Entry::path() const {
-  std::lock_guard lock(m_archive->mutex());
-  std::array<char, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE> filename{};
-  mz_zip_reader_get_filename(m_archive->zip(), m_index, filename.data(),
-                             static_cast<mz_uint>(filename.size()));
-  return RelPath(filename.data());
+  return RelPath(m_archive->m_paths.at(m_index));
 }
 
 Method Archive::Entry::method() const {
@@ -158,13 +322,21 @@ std::shared_ptr<abstract::File> Archive::Entry::file() const {
   return std::make_shared<FileInZip>(m_archive->shared_from_this(), m_index);
 }
 
-Archive::Archive(std::shared_ptr<abstract::File> file)
-    : m_file{std::move(file)} {
+Archive::Archive(std::shared_ptr<abstract::File> file,
+                 const std::size_t buffer_size)
+    : m_file{std::move(file)}, m_buffer_size{std::max<std::size_t>(
+                                   buffer_size, 1)} {
   if (m_file == nullptr) {
     throw NullPointerError("Archive: file is nullptr");
   }
-  m_stream = m_file->stream();
-  open_from_file(m_zip, *m_file, *m_stream);
+  if (const std::optional<std::string_view> data = m_file->memory_data()) {
+    // the file outlives the archive, and with it the bytes miniz reads
+    open_from_memory(m_zip, *data);
+  } else {
+    m_stream = m_file->stream();
+    open_from_file(m_zip, *m_file, *m_stream);
+  }
+  index_();
 }
 
 Archive::~Archive() {
@@ -180,6 +352,8 @@ std::shared_ptr<abstract::File> Archive::file() const noexcept {
   return m_file;
 }
 
+std::size_t Archive::buffer_size() const noexcept { return m_buffer_size; }
+
 Archive::Iterator Archive::begin() const { return {*this, 0}; }
 
 Archive::Iterator Archive::end() const {
@@ -188,9 +362,27 @@ Archive::Iterator Archive::end() const {
 }
 
 Archive::Iterator Archive::find(const RelPath &path) const {
-  return std::find_if(begin(), end(), [&path](const Entry &entry) {
-    return entry.path() == path;
-  });
+  const auto it = m_index.find(path.string());
+  if (it == std::end(m_index)) {
+    return end();
+  }
+  return {*this, it->second};
+}
+
+void Archive::index_() {
+  const mz_uint count = mz_zip_reader_get_num_files(&m_zip);
+  m_paths.reserve(count);
+  m_index.reserve(count);
+
+  std::array<char, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE> filename{};
+  for (mz_uint i = 0; i < count; ++i) {
+    mz_zip_reader_get_filename(&m_zip, i, filename.data(),
+                               static_cast<mz_uint>(filename.size()));
+    // normalized as `RelPath` compares, so "a/./b" is found as "a/b"
+    m_paths.push_back(RelPath(filename.data()).string());
+    // `try_emplace` keeps the first of duplicate names, as a scan would
+    m_index.try_emplace(m_paths.back(), i);
+  }
 }
 
 } // namespace odr::internal::zip::util
@@ -218,6 +410,16 @@ void util::open_from_file(mz_zip_archive &archive, const abstract::File &file,
   }
 }
 
+void util::open_from_memory(mz_zip_archive &archive,
+                            const std::string_view data) {
+  const bool state =
+      mz_zip_reader_init_mem(&archive, data.data(), data.size(),
+                             MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY);
+  if (!state) {
+    throw NoZipFile();
+  }
+}
+
 bool util::append_file(mz_zip_archive &archive, const std::string &path,
                        std::istream &istream, const std::size_t size,
                        const std::time_t &time, const std::string &comment,
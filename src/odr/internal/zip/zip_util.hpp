@@ -6,7 +6,11 @@
 #include <istream>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <miniz/miniz.h>
 #include <miniz/miniz_zip.h>
@@ -23,21 +27,36 @@ enum class Method {
   DEFLATED,
 };
 
+/// A zip archive as miniz reads its central directory.
+///
+/// The lock guards the central directory alone. An entry's stream reads the
+/// entry on a cursor of its own - the file's memory in place, or a stream of
+/// the file opened for it - and inflates it in @p buffer_size steps, so
+/// entries are read in parallel.
+///
+/// Every entry's path is read once on open and indexed, so `find` and
+/// `Entry::path` neither take the lock nor ask miniz.
 class Archive final : public std::enable_shared_from_this<Archive> {
 public:
-  explicit Archive(std::shared_ptr<abstract::File> file);
+  static constexpr std::size_t default_buffer_size = 64 * 1024;
+
+  explicit Archive(std::shared_ptr<abstract::File> file,
+                   std::size_t buffer_size = default_buffer_size);
   ~Archive();
 
   [[nodiscard]] std::mutex &mutex() const;
   [[nodiscard]] mz_zip_archive *zip() const;
 
   [[nodiscard]] std::shared_ptr<abstract::File> file() const noexcept;
+  /// Bytes an entry's stream inflates, or reads, at a time.
+  [[nodiscard]] std::size_t buffer_size() const noexcept;
 
   class Iterator;
 
   [[nodiscard]] Iterator begin() const;
   [[nodiscard]] Iterator end() const;
 
+  /// The first entry at @p path, or `end()`.
   [[nodiscard]] Iterator find(const RelPath &path) const;
 
   class Entry {
@@ -101,14 +120,25 @@ public:
 
 private:
   std::shared_ptr<abstract::File> m_file;
+  std::size_t m_buffer_size{default_buffer_size};
+  /// only for files without `memory_data()`, which miniz reads in place
   std::unique_ptr<std::istream> m_stream;
 
   mutable std::mutex m_mutex;
   mutable mz_zip_archive m_zip{};
+
+  /// the normalized path of every entry, by index
+  std::vector<std::string> m_paths;
+  /// normalized path to the first entry of that path
+  std::unordered_map<std::string, std::uint32_t> m_index;
+
+  void index_();
 };
 
 void open_from_file(mz_zip_archive &archive, const abstract::File &file,
                     std::istream &stream);
+/// Reads the archive in place; @p data must outlive @p archive.
+void open_from_memory(mz_zip_archive &archive, std::string_view data);
 
 bool append_file(mz_zip_archive &archive, const std::string &path,
                  std::istream &istream, std::size_t size,
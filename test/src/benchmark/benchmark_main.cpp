@@ -0,0 +1,387 @@
+#include "process_memory.hpp"
+#include "synthetic_files.hpp"
+
+#include <odr/exceptions.hpp>
+#include <odr/file.hpp>
+#include <odr/html.hpp>
+#include <odr/odr.hpp>
+
+#include <test_util.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using namespace odr;
+using namespace odr::test;
+using namespace odr::test::benchmark;
+namespace fs = std::filesystem;
+
+namespace {
+
+const char *const usage = R"(usage: odr_benchmark [options]
+
+Translates each input to html and reports wall time, peak RSS and bytes out
+for its phases: open (detection), decode, parse (translate and warm up) and
+write (every view and every resource it links).
+
+Inputs are the odt, docx, xlsx, ppt, pdf and csv files of the pinned test
+data, plus generated ones: a csv, a pdf and an xlsx of the sizes below.
+
+options:
+  --json <path>        also write the report as json, `-` for stdout
+  --filter <text>      only inputs whose name contains <text>
+  --repeat <n>         run every input <n> times (default 1)
+  --scratch <dir>      where generated inputs go (default: a temp directory)
+  --no-data            skip the pinned test data
+  --no-synthetic       skip the generated inputs
+  --csv-rows <n>       rows of the generated csv (default 1000000)
+  --pdf-pages <n>      pages of the generated pdf (default 500)
+  --xlsx-sheets <n>    sheets of the generated xlsx (default 200)
+  -h, --help           print this and exit
+)";
+
+struct Options {
+  std::optional<std::string> json_path;
+  std::string filter;
+  std::uint32_t repeat{1};
+  std::string scratch_path{
+      (fs::temp_directory_path() / "odr-benchmark").string()};
+  bool data{true};
+  bool synthetic{true};
+  std::uint32_t csv_rows{1000000};
+  std::uint32_t pdf_pages{500};
+  std::uint32_t xlsx_sheets{200};
+  bool help{false};
+};
+
+struct Input {
+  std::string name;
+  std::string path;
+  FileType type{FileType::unknown};
+  std::optional<std::string> password;
+};
+
+struct PhaseResult {
+  std::string name;
+  double wall_seconds{0};
+  std::uint64_t peak_rss_bytes{0};
+  std::uint64_t bytes_out{0};
+};
+
+struct RunResult {
+  Input input;
+  std::uint32_t run{0};
+  std::uint64_t bytes_in{0};
+  std::vector<PhaseResult> phases;
+  std::optional<std::string> error;
+};
+
+/// Discards what is written to it and counts it.
+class CountingBuffer final : public std::streambuf {
+public:
+  [[nodiscard]] std::uint64_t count() const { return m_count; }
+
+protected:
+  int overflow(const int c) override {
+    if (c != traits_type::eof()) {
+      ++m_count;
+    }
+    return c;
+  }
+
+  std::streamsize xsputn(const char *, const std::streamsize n) override {
+    m_count += static_cast<std::uint64_t>(n);
+    return n;
+  }
+
+private:
+  std::uint64_t m_count{0};
+};
+
+/// Runs @p phase and measures it. @p phase returns the bytes it wrote.
+PhaseResult measure(std::string name,
+                    const std::function<std::uint64_t()> &phase) {
+  reset_peak_rss();
+  const auto begin = std::chrono::steady_clock::now();
+  const std::uint64_t bytes_out = phase();
+  const auto end = std::chrono::steady_clock::now();
+
+  PhaseResult result;
+  result.name = std::move(name);
+  result.wall_seconds = std::chrono::duration<double>(end - begin).count();
+  result.peak_rss_bytes = peak_rss();
+  result.bytes_out = bytes_out;
+  return result;
+}
+
+RunResult run(const Input &input, const std::uint32_t run_index) {
+  RunResult result;
+  result.input = input;
+  result.run = run_index;
+
+  try {
+    std::optional<File> file;
+    std::vector<FileType> file_types;
+    result.phases.push_back(measure("open", [&] {
+      file = File(input.path);
+      file_types = DecodedFile::list_file_types(*file);
+      return 0;
+    }));
+    result.bytes_in = file->size();
+
+    std::optional<DecodedFile> decoded_file;
+    result.phases.push_back(measure("decode", [&] {
+      DecodedFile decoded(*file, input.type);
+      if (decoded.password_encrypted() && input.password.has_value()) {
+        decoded = decoded.decrypt(*input.password);
+      }
+      decoded_file = std::move(decoded);
+      return 0;
+    }));
+
+    // `translate` loads a document's tree, and `warmup` parses what a service
+    // defers, such as the pdf page tree; together that is the parse
+    std::optional<HtmlService> service;
+    result.phases.push_back(measure("parse", [&] {
+      HtmlConfig config;
+      config.embed_images = false;
+      config.embed_shipped_resources = false;
+      service = html::translate(*decoded_file, config);
+      service->warmup();
+      return 0;
+    }));
+
+    result.phases.push_back(measure("write", [&] {
+      CountingBuffer buffer;
+      std::ostream out(&buffer);
+
+      std::unordered_set<std::string> written;
+      for (const HtmlView &view : service->list_views()) {
+        for (const auto &[resource, location] :
+             service->write_html(view.path(), out)) {
+          if (!location.has_value() || resource.is_external() ||
+              !resource.is_accessible() ||
+              !written.insert(resource.path()).second) {
+            continue;
+          }
+          resource.write_resource(out);
+        }
+      }
+      return buffer.count();
+    }));
+  } catch (const std::exception &e) {
+    result.error = e.what();
+  }
+
+  return result;
+}
+
+std::vector<Input> data_inputs(const std::string &filter) {
+  static const std::unordered_set types{
+      FileType::opendocument_text,
+      FileType::office_open_xml_document,
+      FileType::office_open_xml_workbook,
+      FileType::legacy_powerpoint_presentation,
+      FileType::portable_document_format,
+      FileType::comma_separated_values,
+  };
+
+  std::vector<Input> result;
+  if (!fs::is_directory(TestData::test_input_directory())) {
+    std::cerr << "no test data at " << TestData::test_input_directory()
+              << ", configure with ODR_TEST_FETCH_DATA=ON\n";
+    return result;
+  }
+  for (const TestFile &test_file : TestData::test_files()) {
+    if (!types.contains(test_file.type) ||
+        test_file.short_path.find(filter) == std::string::npos) {
+      continue;
+    }
+    result.push_back({test_file.short_path, test_file.absolute_path,
+                      test_file.type, test_file.password});
+  }
+  return result;
+}
+
+std::vector<Input> synthetic_inputs(const Options &options) {
+  fs::create_directories(options.scratch_path);
+
+  std::vector<Input> result;
+  const auto add = [&](const std::string &name, const FileType type,
+                       const std::function<void(const std::string &)> &write) {
+    if (("synthetic/" + name).find(options.filter) == std::string::npos) {
+      return;
+    }
+    const std::string path = (fs::path(options.scratch_path) / name).string();
+    std::cerr << "generating " << path << '\n';
+    write(path);
+    result.push_back({"synthetic/" + name, path, type, std::nullopt});
+  };
+
+  add("rows-" + std::to_string(options.csv_rows) + ".csv",
+      FileType::comma_separated_values, [&](const std::string &path) {
+        write_synthetic_csv(path, options.csv_rows);
+      });
+  add("pages-" + std::to_string(options.pdf_pages) + ".pdf",
+      FileType::portable_document_format, [&](const std::string &path) {
+        write_synthetic_pdf(path, options.pdf_pages);
+      });
+  add("sheets-" + std::to_string(options.xlsx_sheets) + ".xlsx",
+      FileType::office_open_xml_workbook, [&](const std::string &path) {
+        write_synthetic_xlsx(path, options.xlsx_sheets, 100, 20);
+      });
+
+  return result;
+}
+
+nlohmann::json to_json(const std::vector<RunResult> &results) {
+  nlohmann::json json;
+  json["library"] = {
+      {"version", version()},
+      {"commit", commit_hash()},
+      {"dirty", is_dirty()},
+      {"debug", is_debug()},
+  };
+  // without a reset, a phase's peak is the process's peak so far
+  json["peak_rss_per_phase"] = peak_rss_resettable();
+
+  nlohmann::json &runs = json["runs"] = nlohmann::json::array();
+  for (const RunResult &result : results) {
+    nlohmann::json run;
+    run["input"] = result.input.name;
+    run["type"] = file_type_to_string(result.input.type);
+    run["run"] = result.run;
+    run["bytes_in"] = result.bytes_in;
+    run["phases"] = nlohmann::json::array();
+    for (const PhaseResult &phase : result.phases) {
+      run["phases"].push_back({
+          {"name", phase.name},
+          {"wall_seconds", phase.wall_seconds},
+          {"peak_rss_bytes", phase.peak_rss_bytes},
+          {"bytes_out", phase.bytes_out},
+      });
+    }
+    if (result.error.has_value()) {
+      run["error"] = *result.error;
+    }
+    runs.push_back(std::move(run));
+  }
+  return json;
+}
+
+void print(const RunResult &result) {
+  std::cerr << result.input.name << " (" << result.bytes_in << " bytes)";
+  if (result.error.has_value()) {
+    std::cerr << " error: " << *result.error;
+  }
+  std::cerr << '\n';
+  for (const PhaseResult &phase : result.phases) {
+    std::cerr << "  " << std::left << std::setw(8) << phase.name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(10)
+              << phase.wall_seconds * 1000.0 << " ms" << std::setw(10)
+              << phase.peak_rss_bytes / (1024 * 1024) << " MiB"
+              << std::setw(14) << phase.bytes_out << " B\n";
+  }
+}
+
+std::optional<Options> parse_options(const int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("missing value for " + arg);
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--help" || arg == "-h") {
+      options.help = true;
+      return options;
+    } else if (arg == "--json") {
+      options.json_path = value();
+    } else if (arg == "--filter") {
+      options.filter = value();
+    } else if (arg == "--repeat") {
+      options.repeat = std::stoul(value());
+    } else if (arg == "--scratch") {
+      options.scratch_path = value();
+    } else if (arg == "--no-data") {
+      options.data = false;
+    } else if (arg == "--no-synthetic") {
+      options.synthetic = false;
+    } else if (arg == "--csv-rows") {
+      options.csv_rows = std::stoul(value());
+    } else if (arg == "--pdf-pages") {
+      options.pdf_pages = std::stoul(value());
+    } else if (arg == "--xlsx-sheets") {
+      options.xlsx_sheets = std::stoul(value());
+    } else {
+      return std::nullopt;
+    }
+  }
+  return options;
+}
+
+} // namespace
+
+int main(const int argc, char **argv) {
+  std::optional<Options> options;
+  try {
+    options = parse_options(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << "error: " << e.what() << '\n';
+  }
+  if (!options.has_value()) {
+    std::cerr << usage;
+    return 2;
+  }
+  if (options->help) {
+    std::cout << usage;
+    return 0;
+  }
+
+  try {
+    std::vector<Input> inputs;
+    if (options->data) {
+      inputs = data_inputs(options->filter);
+    }
+    if (options->synthetic) {
+      const std::vector<Input> synthetic = synthetic_inputs(*options);
+      inputs.insert(inputs.end(), synthetic.begin(), synthetic.end());
+    }
+
+    std::vector<RunResult> results;
+    for (const Input &input : inputs) {
+      for (std::uint32_t i = 0; i < options->repeat; ++i) {
+        print(results.emplace_back(run(input, i)));
+      }
+    }
+
+    if (options->json_path.has_value()) {
+      const nlohmann::json json = to_json(results);
+      if (*options->json_path == "-") {
+        std::cout << json.dump(2) << '\n';
+      } else {
+        std::ofstream(*options->json_path) << json.dump(2) << '\n';
+      }
+    }
+
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "error: " << e.what() << '\n';
+    return 1;
+  }
+}
@@ -0,0 +1,194 @@
+#include <odr/internal/pdf/pdf_color.hpp>
+#include <odr/internal/pdf/pdf_image.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace odr::internal::pdf;
+
+namespace {
+
+const char *const usage = R"(usage: odr_image_benchmark [options]
+
+Converts a generated image of every common colour space and sample depth to a
+png, the way a pdf's images are, and reports the best wall time of the runs and
+the megapixels per second.
+
+options:
+  --filter <text>      only cases whose name contains <text>
+  --repeat <n>         run every case <n> times (default 5)
+  --width <n>          pixels per row (default 2480, A4 at 300 dpi)
+  --height <n>         rows (default 3508)
+  -h, --help           print this and exit
+)";
+
+struct Options {
+  std::string filter;
+  std::uint32_t repeat{5};
+  std::int32_t width{2480};
+  std::int32_t height{3508};
+  bool help{false};
+};
+
+struct Case {
+  std::string name;
+  ColorSpaceDef space;
+  std::int32_t bits_per_component{8};
+  std::vector<double> decode;
+  std::vector<double> color_key;
+};
+
+ColorSpaceDef device_space(const ColorSpaceKind kind,
+                           const std::int32_t components) {
+  ColorSpaceDef space;
+  space.kind = kind;
+  space.components = components;
+  return space;
+}
+
+ColorSpaceDef indexed_space(const std::int32_t bits_per_component) {
+  ColorSpaceDef space = device_space(ColorSpaceKind::indexed, 1);
+  space.base = std::make_shared<ColorSpaceDef>(
+      device_space(ColorSpaceKind::device_rgb, 3));
+  space.hival = (1 << bits_per_component) - 1;
+  for (std::int32_t i = 0; i <= space.hival; ++i) {
+    space.lookup.push_back(static_cast<char>(i * 37));
+    space.lookup.push_back(static_cast<char>(i * 91));
+    space.lookup.push_back(static_cast<char>(255 - i));
+  }
+  return space;
+}
+
+std::vector<Case> cases() {
+  const ColorSpaceDef gray = device_space(ColorSpaceKind::device_gray, 1);
+  const ColorSpaceDef rgb = device_space(ColorSpaceKind::device_rgb, 3);
+  const ColorSpaceDef cmyk = device_space(ColorSpaceKind::device_cmyk, 4);
+  const ColorSpaceDef lab = device_space(ColorSpaceKind::lab, 3);
+
+  return {
+      {"gray-1", gray, 1, {}, {}},
+      {"gray-8", gray, 8, {}, {}},
+      {"gray-8-decode", gray, 8, {1, 0}, {}},
+      {"gray-16", gray, 16, {}, {}},
+      {"rgb-8", rgb, 8, {}, {}},
+      {"rgb-8-color-key", rgb, 8, {}, {0, 15, 0, 15, 0, 15}},
+      {"rgb-16", rgb, 16, {}, {}},
+      {"cmyk-8", cmyk, 8, {}, {}},
+      {"indexed-1", indexed_space(1), 1, {}, {}},
+      {"indexed-2", indexed_space(2), 2, {}, {}},
+      {"indexed-4", indexed_space(4), 4, {}, {}},
+      {"indexed-8", indexed_space(8), 8, {}, {}},
+      {"lab-8", lab, 8, {0, 100, -100, 100, -100, 100}, {}},
+  };
+}
+
+/// Samples of a scan: stretches of paper and of a few inks, and noise where
+/// the content is.
+std::string samples(const Case &c, const Options &options) {
+  const auto row_bytes = (static_cast<std::size_t>(options.width) *
+                              static_cast<std::size_t>(c.space.components) *
+                              static_cast<std::size_t>(c.bits_per_component) +
+                          7) /
+                         8;
+  std::string result;
+  result.reserve(row_bytes * static_cast<std::size_t>(options.height));
+  std::uint32_t seed = 1;
+  for (std::int32_t y = 0; y < options.height; ++y) {
+    for (std::size_t x = 0; x < row_bytes; ++x) {
+      seed = seed * 1103515245 + 12345;
+      const bool content = (x / 64 + static_cast<std::size_t>(y) / 32) % 3 == 0;
+      result.push_back(content ? static_cast<char>(seed >> 16)
+                               : static_cast<char>(x / 256 % 2 == 0 ? 0 : 255));
+    }
+  }
+  return result;
+}
+
+std::optional<Options> parse_options(const int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("missing value for " + arg);
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--help" || arg == "-h") {
+      options.help = true;
+      return options;
+    } else if (arg == "--filter") {
+      options.filter = value();
+    } else if (arg == "--repeat") {
+      options.repeat = std::stoul(value());
+    } else if (arg == "--width") {
+      options.width = std::stoi(value());
+    } else if (arg == "--height") {
+      options.height = std::stoi(value());
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (options.repeat == 0 || options.width <= 0 || options.height <= 0) {
+    return std::nullopt;
+  }
+  return options;
+}
+
+} // namespace
+
+int main(const int argc, char **argv) {
+  std::optional<Options> options;
+  try {
+    options = parse_options(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << "error: " << e.what() << '\n';
+  }
+  if (!options.has_value()) {
+    std::cerr << usage;
+    return 2;
+  }
+  if (options->help) {
+    std::cout << usage;
+    return 0;
+  }
+
+  const double megapixels =
+      static_cast<double>(options->width) * options->height / 1e6;
+  for (const Case &c : cases()) {
+    if (c.name.find(options->filter) == std::string::npos) {
+      continue;
+    }
+    const std::string input = samples(c, *options);
+
+    double best = 0;
+    std::size_t bytes_out = 0;
+    for (std::uint32_t i = 0; i < options->repeat; ++i) {
+      const auto begin = std::chrono::steady_clock::now();
+      const std::string png = encode_image_png(
+          input, options->width, options->height, c.bits_per_component,
+          c.space, c.decode, {}, c.color_key);
+      const auto end = std::chrono::steady_clock::now();
+      const double seconds = std::chrono::duration<double>(end - begin).count();
+      best = i == 0 ? seconds : std::min(best, seconds);
+      bytes_out = png.size();
+    }
+
+    std::cout << std::left << std::setw(18) << c.name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(10)
+              << best * 1000.0 << " ms" << std::setw(10) << std::setprecision(1)
+              << megapixels / best << " MP/s" << std::setw(14) << bytes_out
+              << " B\n";
+  }
+  return 0;
+}
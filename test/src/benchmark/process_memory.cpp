@@ -0,0 +1,73 @@
+#include "process_memory.hpp"
+
+#if defined(__linux__)
+#include <fstream>
+#include <string>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace odr::test::benchmark {
+
+#if defined(__linux__)
+
+namespace {
+
+/// Writing "5" to `clear_refs` resets `VmHWM` to `VmRSS` (Linux 4.0+).
+bool try_reset_peak_rss() {
+  std::ofstream out("/proc/self/clear_refs");
+  out << "5";
+  out.flush();
+  return static_cast<bool>(out);
+}
+
+} // namespace
+
+void reset_peak_rss() { try_reset_peak_rss(); }
+
+std::uint64_t peak_rss() {
+  std::ifstream in("/proc/self/status");
+  std::string line;
+  while (std::getline(in, line)) {
+    // `VmHWM:     12345 kB`
+    if (line.starts_with("VmHWM:")) {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+  return 0;
+}
+
+bool peak_rss_resettable() {
+  static const bool resettable = try_reset_peak_rss();
+  return resettable;
+}
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+void reset_peak_rss() {}
+
+std::uint64_t peak_rss() {
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return static_cast<std::uint64_t>(usage.ru_maxrss); // bytes
+#else
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+}
+
+bool peak_rss_resettable() { return false; }
+
+#else
+
+void reset_peak_rss() {}
+
+std::uint64_t peak_rss() { return 0; }
+
+bool peak_rss_resettable() { return false; }
+
+#endif
+
+} // namespace odr::test::benchmark
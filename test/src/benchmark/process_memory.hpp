@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace odr::test::benchmark {
+
+/// Resets the process's peak resident set size to its current one, so the next
+/// @ref peak_rss covers only what ran in between. Only Linux can; elsewhere
+/// the peak stays the process-wide high-water mark and this does nothing.
+void reset_peak_rss();
+
+/// The process's peak resident set size in bytes since start, or since the
+/// last @ref reset_peak_rss where that works. 0 where it cannot be read.
+std::uint64_t peak_rss();
+
+/// Whether @ref reset_peak_rss takes effect here, so a report can say whether
+/// its per-phase peaks are per phase or cumulative.
+bool peak_rss_resettable();
+
+} // namespace odr::test::benchmark
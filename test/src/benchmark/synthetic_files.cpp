@@ -0,0 +1,203 @@
+#include "synthetic_files.hpp"
+
+#include "../internal/pdf/pdf_test_file_builder.hpp"
+
+#include <odr/internal/common/file.hpp>
+#include <odr/internal/common/path.hpp>
+#include <odr/internal/util/file_util.hpp>
+#include <odr/internal/zip/zip_archive.hpp>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace odr::internal;
+
+namespace odr::test::benchmark {
+
+namespace {
+
+/// `A`, …, `Z`, `AA`, … for the 0-based @p index.
+std::string column_name(std::uint32_t index) {
+  std::string result;
+  ++index;
+  while (index > 0) {
+    --index;
+    result.insert(result.begin(), static_cast<char>('A' + index % 26));
+    index /= 26;
+  }
+  return result;
+}
+
+void add_file(zip::ZipArchive &archive, const std::string &path,
+              std::string content) {
+  archive.insert_file(archive.end(), RelPath(path),
+                      std::make_shared<MemoryFile>(std::move(content)));
+}
+
+} // namespace
+
+void write_synthetic_csv(const std::string &path, const std::uint32_t rows) {
+  std::ofstream out = util::file::create(path);
+
+  std::string chunk = "id,name,value,date,comment\n";
+  for (std::uint32_t row = 0; row < rows; ++row) {
+    chunk += std::to_string(row);
+    chunk += ",item";
+    chunk += std::to_string(row % 997);
+    chunk += ',';
+    chunk += std::to_string(row % 10000);
+    chunk += '.';
+    chunk += std::to_string(row % 100);
+    chunk += ",2024-";
+    chunk += std::to_string(1 + row % 12);
+    chunk += '-';
+    chunk += std::to_string(1 + row % 28);
+    chunk += ",\"row ";
+    chunk += std::to_string(row);
+    chunk += ", with a comma\"\n";
+
+    if (chunk.size() > (1 << 20)) {
+      out << chunk;
+      chunk.clear();
+    }
+  }
+  out << chunk;
+}
+
+void write_synthetic_pdf(const std::string &path, const std::uint32_t pages) {
+  // 1 catalog, 2 page tree, 3 font, then a page and its content per page
+  const auto page_id = [](const std::uint32_t page) { return 4 + 2 * page; };
+
+  std::string kids;
+  for (std::uint32_t page = 0; page < pages; ++page) {
+    kids += std::to_string(page_id(page)) + " 0 R ";
+  }
+
+  pdf::PdfFileBuilder builder;
+  builder.object("<< /Type /Catalog /Pages 2 0 R >>");
+  builder.object("<< /Type /Pages /Kids [" + kids +
+                 "] /Count " + std::to_string(pages) + " >>");
+  builder.object("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica "
+                 "/Encoding /WinAnsiEncoding >>");
+
+  for (std::uint32_t page = 0; page < pages; ++page) {
+    builder.object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 595 842] "
+                   "/Resources << /Font << /F1 3 0 R >> >> /Contents " +
+                   std::to_string(page_id(page) + 1) + " 0 R >>");
+
+    std::string content = "0.5 w 50 60 m 545 60 l S 50 790 m 545 790 l S\n"
+                          "BT /F1 10 Tf 14 TL 50 770 Td\n";
+    for (std::uint32_t line = 0; line < 50; ++line) {
+      content += "(Page " + std::to_string(page + 1) + ", line " +
+                 std::to_string(line + 1) +
+                 ": the quick brown fox jumps over the lazy dog) Tj T*\n";
+    }
+    content += "ET\n";
+    builder.stream_object("", content);
+  }
+
+  builder.trailer("/Root 1 0 R");
+  util::file::write(builder.build_classic(), path);
+}
+
+void write_synthetic_xlsx(const std::string &path, const std::uint32_t sheets,
+                          const std::uint32_t rows,
+                          const std::uint32_t columns) {
+  zip::ZipArchive archive;
+
+  std::string content_types =
+      R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+      R"(<Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">)"
+      R"(<Default Extension="rels" ContentType="application/vnd.openxmlformats-package.relationships+xml"/>)"
+      R"(<Default Extension="xml" ContentType="application/xml"/>)"
+      R"(<Override PartName="/xl/workbook.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml"/>)"
+      R"(<Override PartName="/xl/styles.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml"/>)"
+      R"(<Override PartName="/xl/sharedStrings.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml"/>)";
+  std::string workbook =
+      R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+      R"(<workbook xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main" )"
+      R"(xmlns:r="http://schemas.openxmlformats.org/officeDocument/2006/relationships"><sheets>)";
+  std::string workbook_relations =
+      R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+      R"(<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">)"
+      R"(<Relationship Id="rIdStyles" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles" Target="styles.xml"/>)"
+      R"(<Relationship Id="rIdStrings" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings" Target="sharedStrings.xml"/>)";
+
+  // the same few hundred strings recur across every sheet, as in a real export
+  constexpr std::uint32_t shared_string_count = 500;
+
+  for (std::uint32_t sheet = 0; sheet < sheets; ++sheet) {
+    const std::string number = std::to_string(sheet + 1);
+    content_types += R"(<Override PartName="/xl/worksheets/sheet)" + number +
+                     R"(.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml"/>)";
+    workbook += R"(<sheet name="Sheet)" + number + R"(" sheetId=")" + number +
+                R"(" r:id="rId)" + number + R"("/>)";
+    workbook_relations +=
+        R"(<Relationship Id="rId)" + number +
+        R"(" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet" Target="worksheets/sheet)" +
+        number + R"(.xml"/>)";
+
+    std::string sheet_xml =
+        R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+        R"(<worksheet xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main"><sheetData>)";
+    for (std::uint32_t row = 0; row < rows; ++row) {
+      const std::string row_number = std::to_string(row + 1);
+      sheet_xml += R"(<row r=")" + row_number + R"(">)";
+      for (std::uint32_t column = 0; column < columns; ++column) {
+        const std::string reference = column_name(column) + row_number;
+        if (column % 2 == 0) {
+          sheet_xml += R"(<c r=")" + reference + R"("><v>)" +
+                       std::to_string(sheet * rows + row * columns + column) +
+                       "</v></c>";
+        } else {
+          sheet_xml += R"(<c r=")" + reference + R"(" t="s"><v>)" +
+                       std::to_string((row + column) % shared_string_count) +
+                       "</v></c>";
+        }
+      }
+      sheet_xml += "</row>";
+    }
+    sheet_xml += "</sheetData></worksheet>";
+    add_file(archive, "xl/worksheets/sheet" + number + ".xml",
+             std::move(sheet_xml));
+  }
+
+  content_types += "</Types>";
+  workbook += "</sheets></workbook>";
+  workbook_relations += "</Relationships>";
+
+  std::string shared_strings =
+      R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+      R"(<sst xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main" count=")" +
+      std::to_string(shared_string_count) + R"(" uniqueCount=")" +
+      std::to_string(shared_string_count) + R"(">)";
+  for (std::uint32_t i = 0; i < shared_string_count; ++i) {
+    shared_strings += "<si><t>string " + std::to_string(i) + "</t></si>";
+  }
+  shared_strings += "</sst>";
+
+  add_file(archive, "[Content_Types].xml", std::move(content_types));
+  add_file(archive, "_rels/.rels",
+           R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+           R"(<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">)"
+           R"(<Relationship Id="rId1" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument" Target="xl/workbook.xml"/>)"
+           R"(</Relationships>)");
+  add_file(archive, "xl/workbook.xml", std::move(workbook));
+  add_file(archive, "xl/_rels/workbook.xml.rels",
+           std::move(workbook_relations));
+  add_file(archive, "xl/styles.xml",
+           R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+           R"(<styleSheet xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main">)"
+           R"(<fonts count="1"><font><sz val="11"/><name val="Calibri"/></font></fonts>)"
+           R"(<fills count="1"><fill><patternFill patternType="none"/></fill></fills>)"
+           R"(<borders count="1"><border/></borders>)"
+           R"(<cellXfs count="1"><xf fontId="0" fillId="0" borderId="0"/></cellXfs>)"
+           R"(</styleSheet>)");
+  add_file(archive, "xl/sharedStrings.xml", std::move(shared_strings));
+
+  std::ofstream out = util::file::create(path);
+  archive.save(out);
+}
+
+} // namespace odr::test::benchmark
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace odr::test::benchmark {
+
+/// Writes a csv of @p rows rows and a header to @p path: an id, a word, a
+/// decimal, a date and a quoted field with an embedded separator, so the
+/// dialect detection and the quote handling are both exercised.
+void write_synthetic_csv(const std::string &path, std::uint32_t rows);
+
+/// Writes a pdf of @p pages pages to @p path. Every page sets a screenful of
+/// text in a standard-14 font and strokes a few paths, so the text and the
+/// graphics pipelines both run; nothing is embedded.
+void write_synthetic_pdf(const std::string &path, std::uint32_t pages);
+
+/// Writes an xlsx of @p sheets sheets of @p rows by @p columns cells each to
+/// @p path, half numbers and half shared strings.
+void write_synthetic_xlsx(const std::string &path, std::uint32_t sheets,
+                          std::uint32_t rows, std::uint32_t columns);
+
+} // namespace odr::test::benchmark
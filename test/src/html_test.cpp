@@ -2,6 +2,8 @@
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <odr/html.hpp>
 
@@ -418,6 +420,134 @@ TEST(html, each_view_fits_the_page_it_renders) {
   EXPECT_NEAR(wide_page, 400.0 / (1224 * 96.0 / 72 + 32), 1e-6);
 }
 
+// Pages are extracted on the workers but numbered on the writing thread, so
+// the threads must not show in the output, in either text mode.
+TEST(html, pdf_renders_the_same_on_any_number_of_threads) {
+  test::pdf::PdfFileBuilder builder;
+  builder.object("<< /Type /Catalog /Pages 2 0 R >>")
+      .object("<< /Type /Pages /Kids [4 0 R 6 0 R 8 0 R 10 0 R] /Count 4 >>")
+      .object("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+  for (int page = 0; page < 4; ++page) {
+    builder
+        .object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+                "/Resources << /Font << /F1 3 0 R >> >> /Contents " +
+                std::to_string(5 + 2 * page) + " 0 R >>")
+        .stream_object("", "1 0 0 RG 50 50 m 300 50 l S BT /F1 " +
+                               std::to_string(10 + page) +
+                               " Tf 72 700 Td (Page " +
+                               std::to_string(page + 1) + ") Tj ET");
+  }
+
+  const std::string path =
+      (std::filesystem::current_path() / "threads.pdf").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << builder.trailer("/Root 1 0 R").build_classic();
+  }
+  const DecodedFile file{path};
+
+  for (const PdfTextMode mode :
+       {PdfTextMode::dual_layer, PdfTextMode::single_layer}) {
+    const auto render = [&](const std::uint32_t threads) {
+      HtmlConfig config;
+      config.pdf_text_mode = mode;
+      config.render_threads = threads;
+      const HtmlService service = html::translate(
+          file, (std::filesystem::current_path() / "threads").string(),
+          config);
+      std::ostringstream out;
+      service.list_views().at(0).write_html(out);
+      return std::move(out).str();
+    };
+
+    const std::string serial = render(1);
+    EXPECT_NE(serial.find("Page 4"), std::string::npos);
+    EXPECT_EQ(render(4), serial);
+    EXPECT_EQ(render(0), serial);
+  }
+}
+
+// A logo on every page was base64 in the markup once per page. Not embedding
+// images makes it one resource, which every page links and the service serves.
+TEST(html, pdf_images_are_served_once_when_not_embedded) {
+  test::pdf::PdfFileBuilder builder;
+  builder.object("<< /Type /Catalog /Pages 2 0 R >>")
+      .object("<< /Type /Pages /Kids [4 0 R 6 0 R] /Count 2 >>")
+      .stream_object("/Type /XObject /Subtype /Image /Width 2 /Height 2 "
+                     "/ColorSpace /DeviceGray /BitsPerComponent 8",
+                     std::string("\x00\xff\xff\x00", 4));
+  for (int page = 0; page < 2; ++page) {
+    builder
+        .object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+                "/Resources << /XObject << /Im1 3 0 R >> >> /Contents " +
+                std::to_string(5 + 2 * page) + " 0 R >>")
+        .stream_object("", "q 100 0 0 100 50 50 cm /Im1 Do Q");
+  }
+
+  const std::string path =
+      (std::filesystem::current_path() / "logo.pdf").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << builder.trailer("/Root 1 0 R").build_classic();
+  }
+  const DecodedFile file{path};
+
+  const auto count = [](const std::string &html, const std::string &what) {
+    std::size_t result = 0;
+    for (std::size_t at = html.find(what); at != std::string::npos;
+         at = html.find(what, at + 1)) {
+      ++result;
+    }
+    return result;
+  };
+
+  {
+    const HtmlService service = html::translate(file, HtmlConfig());
+    std::ostringstream out;
+    service.list_views().at(0).write_html(out);
+    EXPECT_EQ(count(out.str(), "data:image/png"), 2);
+  }
+
+  HtmlConfig config;
+  config.embed_images = false;
+  const HtmlService service = html::translate(file, config);
+
+  std::ostringstream out;
+  const HtmlResources resources = service.list_views().at(0).write_html(out);
+  const std::string html = std::move(out).str();
+  EXPECT_EQ(html.find("data:image"), std::string::npos);
+
+  std::vector<std::string> images;
+  for (const auto &[resource, location] : resources) {
+    if (resource.type() == HtmlResourceType::image) {
+      ASSERT_TRUE(location.has_value());
+      images.push_back(*location);
+    }
+  }
+  ASSERT_EQ(images.size(), 1);
+  EXPECT_EQ(count(html, "href=\"" + images[0] + "\""), 2);
+
+  ASSERT_TRUE(service.exists(images[0]));
+  EXPECT_EQ(service.mimetype(images[0]), "image/png");
+  std::ostringstream image;
+  service.write(images[0], image);
+  EXPECT_EQ(image.str().substr(0, 8), "\x89PNG\r\n\x1a\n");
+
+  // a page view links the same resource
+  std::ostringstream page;
+  service.list_views().at(2).write_html(page);
+  EXPECT_EQ(count(page.str(), "href=\"" + images[0] + "\""), 1);
+
+  // a service that has written no view yet, as after a restart, still serves
+  // what a page from before links
+  const HtmlService restarted = html::translate(file, config);
+  ASSERT_TRUE(restarted.exists(images[0]));
+  std::ostringstream again;
+  restarted.write(images[0], again);
+  EXPECT_EQ(again.str(), image.str());
+  EXPECT_FALSE(restarted.exists("pdf/unknown.png"));
+}
+
 // An image overflowed its frame the same way a page did. Css alone fits it —
 // it has no layout width to preserve — and the reader's zoom rides on top.
 TEST(html, an_image_fits_the_viewport) {
@@ -442,3 +572,59 @@ TEST(html, an_image_fits_the_viewport) {
   actual_size.viewport_mode = HtmlViewportMode::actual_size;
   EXPECT_EQ(render(actual_size).find("img{max-width:"), std::string::npos);
 }
+
+// The shell holds the ruler and a placeholder per band of rows; each tile is
+// written only when it is asked for, and tiles of a band line up by column.
+TEST(html, a_tiled_sheet_is_served_in_tiles) {
+  std::string csv;
+  for (int row = 0; row < 25; ++row) {
+    for (int column = 0; column < 5; ++column) {
+      csv += (column == 0 ? "" : ",") + std::string("r") +
+             std::to_string(row) + "c" + std::to_string(column);
+    }
+    csv += "\n";
+  }
+  const DecodedFile file(File::from_memory(csv),
+                         FileType::comma_separated_values);
+
+  HtmlConfig config;
+  config.spreadsheet_tile = TableDimensions(10, 2);
+  const HtmlService service = html::translate(file, config);
+
+  const auto write = [&](const std::string &path) {
+    std::ostringstream out;
+    service.write(path, out);
+    return std::move(out).str();
+  };
+  const auto count = [](const std::string &html, const std::string &what) {
+    std::size_t result = 0;
+    for (std::size_t i = html.find(what); i != std::string::npos;
+         i = html.find(what, i + 1)) {
+      ++result;
+    }
+    return result;
+  };
+
+  const std::string shell = write(service.list_views().at(1).path());
+  EXPECT_NE(shell.find(R"(data-odr-tile-path="sheet0/")"), std::string::npos);
+  EXPECT_EQ(count(shell, R"(<tbody class="odr-sheet-tile")"), 3);
+  EXPECT_EQ(shell.find("r0c0"), std::string::npos);
+
+  EXPECT_TRUE(service.exists("sheet0/r2c2.html"));
+  EXPECT_EQ(service.mimetype("sheet0/r2c2.html"), "text/html");
+  EXPECT_FALSE(service.exists("sheet0/r3c0.html"));
+  EXPECT_FALSE(service.exists("sheet0/r0c3.html"));
+  EXPECT_FALSE(service.exists("sheet0/r0c0.htm"));
+
+  const std::string first = write("sheet0/r1c0.html");
+  EXPECT_EQ(count(first, "<tr"), 10);
+  EXPECT_EQ(count(first, "odr-sheet-row-header"), 10);
+  EXPECT_NE(first.find("r10c1"), std::string::npos);
+  EXPECT_EQ(first.find("r10c2"), std::string::npos);
+  EXPECT_EQ(first.find("r20c0"), std::string::npos);
+
+  const std::string last = write("sheet0/r2c1.html");
+  EXPECT_EQ(count(last, "<tr"), 5);
+  EXPECT_EQ(last.find("odr-sheet-row-header"), std::string::npos);
+  EXPECT_NE(last.find("r24c3"), std::string::npos);
+}
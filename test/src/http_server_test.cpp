@@ -1,6 +1,10 @@
 #include <odr/exceptions.hpp>
+#include <odr/html.hpp>
 #include <odr/http_server.hpp>
 
+#include <odr/internal/abstract/html_service.hpp>
+#include <odr/internal/crypto/crypto_util.hpp>
+
 #include <httplib/httplib.h>
 
 #include <gtest/gtest.h>
@@ -8,6 +12,10 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 #include <thread>
 
 using namespace odr;
@@ -47,6 +55,97 @@ private:
   std::thread m_thread;
 };
 
+/// Serves `page.html` and counts how often it was rendered.
+class CountingService final : public internal::abstract::HtmlService {
+public:
+  [[nodiscard]] const HtmlConfig &config() const override { return m_config; }
+  [[nodiscard]] const HtmlViews &list_views() const override {
+    return m_views;
+  }
+
+  void warmup() const override {}
+
+  [[nodiscard]] bool exists(const std::string &path) const override {
+    return path == "page.html";
+  }
+  [[nodiscard]] std::string
+  mimetype(const std::string & /*path*/) const override {
+    return "text/html";
+  }
+
+  void write(const std::string & /*path*/, std::ostream &out) const override {
+    ++writes;
+    out << "<p>page</p>";
+  }
+  HtmlResources
+  write_html(const std::string & /*path*/,
+             internal::html::HtmlWriter & /*out*/) const override {
+    throw std::logic_error("not rendered through a writer");
+  }
+
+  mutable std::atomic<int> writes{0};
+
+private:
+  HtmlConfig m_config;
+  HtmlViews m_views;
+};
+
+/// Serves `large.html`, a megabyte written a kilobyte at a time; `cut.html`,
+/// which fails once it is well into streaming; and `failed.html`, which fails
+/// before it writes anything.
+class StreamingService final : public internal::abstract::HtmlService {
+public:
+  static constexpr std::size_t large_size = 1024 * 1024;
+
+  static std::string large_body() {
+    std::string result;
+    for (std::size_t i = 0; i < large_size; ++i) {
+      result += static_cast<char>('a' + i % 26);
+    }
+    return result;
+  }
+
+  [[nodiscard]] const HtmlConfig &config() const override { return m_config; }
+  [[nodiscard]] const HtmlViews &list_views() const override {
+    return m_views;
+  }
+
+  void warmup() const override {}
+
+  [[nodiscard]] bool exists(const std::string &path) const override {
+    return path == "large.html" || path == "cut.html" || path == "failed.html";
+  }
+  [[nodiscard]] std::string
+  mimetype(const std::string & /*path*/) const override {
+    return "text/html";
+  }
+
+  void write(const std::string &path, std::ostream &out) const override {
+    ++writes;
+    if (path == "failed.html") {
+      throw std::runtime_error("failed");
+    }
+    const std::string body = large_body();
+    for (std::size_t at = 0; at < body.size(); at += 1024) {
+      if (path == "cut.html" && at == body.size() / 2) {
+        throw std::runtime_error("cut");
+      }
+      out << body.substr(at, 1024);
+    }
+  }
+  HtmlResources
+  write_html(const std::string & /*path*/,
+             internal::html::HtmlWriter & /*out*/) const override {
+    throw std::logic_error("not rendered through a writer");
+  }
+
+  mutable std::atomic<int> writes{0};
+
+private:
+  HtmlConfig m_config;
+  HtmlViews m_views;
+};
+
 } // namespace
 
 TEST(HttpServer, bind_reports_the_port_it_got) {
@@ -206,3 +305,172 @@ TEST(HttpServer, stop_is_prompt_after_serving_a_kept_alive_request) {
       << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
       << " ms";
 }
+
+TEST(HttpServer, repeat_requests_are_served_from_the_cache) {
+  const HttpServer server;
+  const auto service = std::make_shared<CountingService>();
+  server.connect_service(HtmlService(service), "doc");
+
+  const std::uint32_t port = server.bind("127.0.0.1", 0);
+  const ListenGuard guard{server, std::thread{[&server] { server.listen(); }}};
+  wait_until_running(server);
+
+  httplib::Client client{"127.0.0.1", static_cast<int>(port)};
+  const httplib::Result first = client.Get("/file/doc/page.html");
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first->status, 200);
+  EXPECT_EQ(first->body, "<p>page</p>");
+  EXPECT_EQ(first->get_header_value("Cache-Control"), "no-cache");
+  const std::string etag = first->get_header_value("ETag");
+  ASSERT_FALSE(etag.empty());
+
+  const httplib::Result second = client.Get("/file/doc/page.html");
+  ASSERT_TRUE(second);
+  EXPECT_EQ(second->body, "<p>page</p>");
+  EXPECT_EQ(second->get_header_value("ETag"), etag);
+  EXPECT_EQ(service->writes.load(), 1);
+
+  // weak or in a list, the tag still matches
+  for (const std::string &if_none_match :
+       {etag, "W/" + etag, "\"other\", " + etag}) {
+    const httplib::Result not_modified = client.Get(
+        "/file/doc/page.html", {{"If-None-Match", if_none_match}});
+    ASSERT_TRUE(not_modified);
+    EXPECT_EQ(not_modified->status, 304) << if_none_match;
+    EXPECT_TRUE(not_modified->body.empty());
+  }
+
+  const httplib::Result missing = client.Get("/file/doc/other.html");
+  ASSERT_TRUE(missing);
+  EXPECT_EQ(missing->status, 404);
+}
+
+TEST(HttpServer, a_new_connection_gets_new_etags) {
+  HttpServer::Config config;
+  config.response_cache_budget = 0;
+  const HttpServer server(config);
+  const auto service = std::make_shared<CountingService>();
+  server.connect_service(HtmlService(service), "doc");
+
+  const std::uint32_t port = server.bind("127.0.0.1", 0);
+  const ListenGuard guard{server, std::thread{[&server] { server.listen(); }}};
+  wait_until_running(server);
+
+  httplib::Client client{"127.0.0.1", static_cast<int>(port)};
+  const httplib::Result first = client.Get("/file/doc/page.html");
+  ASSERT_TRUE(first);
+  const std::string etag = first->get_header_value("ETag");
+
+  // nothing is cached, so a repeat renders again
+  ASSERT_TRUE(client.Get("/file/doc/page.html"));
+  EXPECT_EQ(service->writes.load(), 2);
+
+  // the prefix now names another service, which the old tag says nothing of
+  server.clear();
+  server.connect_service(HtmlService(service), "doc");
+  const httplib::Result reconnected =
+      client.Get("/file/doc/page.html", {{"If-None-Match", etag}});
+  ASSERT_TRUE(reconnected);
+  EXPECT_EQ(reconnected->status, 200);
+  EXPECT_NE(reconnected->get_header_value("ETag"), etag);
+}
+
+TEST(HttpServer, large_files_are_streamed) {
+  HttpServer::Config config;
+  config.stream_buffer = 4096;
+  const HttpServer server(config);
+  const auto service = std::make_shared<StreamingService>();
+  server.connect_service(HtmlService(service), "doc");
+
+  const std::uint32_t port = server.bind("127.0.0.1", 0);
+  const ListenGuard guard{server, std::thread{[&server] { server.listen(); }}};
+  wait_until_running(server);
+
+  httplib::Client client{"127.0.0.1", static_cast<int>(port)};
+  const httplib::Result first = client.Get("/file/doc/large.html");
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first->status, 200);
+  EXPECT_EQ(first->get_header_value("Transfer-Encoding"), "chunked");
+  EXPECT_FALSE(first->get_header_value("ETag").empty());
+  EXPECT_EQ(first->body, StreamingService::large_body());
+
+  // kept while it streamed, as it fits the cache
+  const httplib::Result second = client.Get("/file/doc/large.html");
+  ASSERT_TRUE(second);
+  EXPECT_EQ(second->body, first->body);
+  EXPECT_EQ(service->writes.load(), 1);
+}
+
+TEST(HttpServer, a_failed_rendering_is_answered_or_cut_short) {
+  HttpServer::Config config;
+  config.stream_buffer = 4096;
+  const HttpServer server(config);
+  const auto service = std::make_shared<StreamingService>();
+  server.connect_service(HtmlService(service), "doc");
+
+  const std::uint32_t port = server.bind("127.0.0.1", 0);
+  const ListenGuard guard{server, std::thread{[&server] { server.listen(); }}};
+  wait_until_running(server);
+
+  httplib::Client client{"127.0.0.1", static_cast<int>(port)};
+
+  // nothing was sent yet, so the status can still say so
+  const httplib::Result failed = client.Get("/file/doc/failed.html");
+  ASSERT_TRUE(failed);
+  EXPECT_EQ(failed->status, 500);
+
+  // the status went out with the first chunk; the connection is dropped
+  EXPECT_FALSE(client.Get("/file/doc/cut.html"));
+
+  // and nothing of either is kept, nor does the server suffer
+  EXPECT_FALSE(client.Get("/file/doc/cut.html"));
+  EXPECT_EQ(service->writes.load(), 3);
+  const httplib::Result large = client.Get("/file/doc/large.html");
+  ASSERT_TRUE(large);
+  EXPECT_EQ(large->body, StreamingService::large_body());
+}
+
+TEST(HttpServer, text_is_compressed_for_a_client_that_takes_it) {
+  HttpServer::Config config;
+  config.stream_buffer = 4096;
+  const HttpServer server(config);
+  const auto streaming = std::make_shared<StreamingService>();
+  server.connect_service(HtmlService(streaming), "large");
+  const auto counting = std::make_shared<CountingService>();
+  server.connect_service(HtmlService(counting), "small");
+
+  const std::uint32_t port = server.bind("127.0.0.1", 0);
+  const ListenGuard guard{server, std::thread{[&server] { server.listen(); }}};
+  wait_until_running(server);
+
+  httplib::Client client{"127.0.0.1", static_cast<int>(port)};
+  client.set_decompress(false);
+
+  // streamed, and compressed as it streams
+  const httplib::Result gzipped = client.Get(
+      "/file/large/large.html", {{"Accept-Encoding", "deflate;q=0.5, gzip"}});
+  ASSERT_TRUE(gzipped);
+  EXPECT_EQ(gzipped->get_header_value("Content-Encoding"), "gzip");
+  EXPECT_EQ(gzipped->get_header_value("Vary"), "Accept-Encoding");
+  ASSERT_GT(gzipped->body.size(), 10);
+  EXPECT_LT(gzipped->body.size(), StreamingService::large_size / 10);
+  EXPECT_EQ(internal::crypto::util::inflate(gzipped->body.substr(10)),
+            StreamingService::large_body());
+
+  // the other coding is compressed from the cached rendering; q=0 refuses
+  const httplib::Result deflated = client.Get(
+      "/file/small/page.html", {{"Accept-Encoding", "gzip;q=0, deflate"}});
+  ASSERT_TRUE(deflated);
+  EXPECT_EQ(deflated->get_header_value("Content-Encoding"), "deflate");
+  EXPECT_EQ(internal::crypto::util::zlib_inflate(deflated->body),
+            "<p>page</p>");
+  const httplib::Result identity = client.Get("/file/small/page.html");
+  ASSERT_TRUE(identity);
+  EXPECT_FALSE(identity->has_header("Content-Encoding"));
+  EXPECT_EQ(identity->body, "<p>page</p>");
+  EXPECT_EQ(counting->writes.load(), 1);
+
+  // each coding is a representation of its own
+  EXPECT_NE(deflated->get_header_value("ETag"),
+            identity->get_header_value("ETag"));
+}
@@ -158,3 +158,33 @@ TEST(VirtualFilesystem, an_intermediate_directory_is_a_directory) {
   EXPECT_FALSE(filesystem.exists(AbsPath("/b")));
   EXPECT_FALSE(filesystem.is_directory(AbsPath("/a/c/d.txt")));
 }
+
+TEST(VirtualFilesystem, an_intermediate_directory_goes_with_its_last_entry) {
+  VirtualFilesystem filesystem = filesystem_of({"/a/b.txt", "/a/c/d.txt"});
+
+  EXPECT_TRUE(filesystem.remove(AbsPath("/a/c/d.txt")));
+  EXPECT_FALSE(filesystem.exists(AbsPath("/a/c")));
+  EXPECT_TRUE(filesystem.is_directory(AbsPath("/a")));
+
+  EXPECT_TRUE(filesystem.move(AbsPath("/a/b.txt"), AbsPath("/e/b.txt")));
+  EXPECT_FALSE(filesystem.exists(AbsPath("/a")));
+  EXPECT_TRUE(filesystem.is_directory(AbsPath("/e")));
+  EXPECT_TRUE(filesystem.is_file(AbsPath("/e/b.txt")));
+}
+
+TEST(VirtualFilesystem, a_walk_sees_the_entries_it_began_with) {
+  VirtualFilesystem filesystem = filesystem_of({"/a.txt", "/b.txt"});
+
+  const auto walker = filesystem.file_walker(AbsPath("/"));
+  filesystem.remove(AbsPath("/b.txt"));
+  filesystem.copy(std::make_shared<MemoryFile>(std::string()),
+                  AbsPath("/c.txt"));
+
+  std::vector<std::string> walked;
+  for (; !walker->end(); walker->next()) {
+    walked.push_back(walker->path().string());
+  }
+  EXPECT_EQ(walked, (std::vector<std::string>{"/a.txt", "/b.txt"}));
+  EXPECT_EQ(walk(filesystem, AbsPath("/")),
+            (std::vector<std::string>{"/a.txt", "/c.txt"}));
+}
@@ -0,0 +1,97 @@
+#include <odr/internal/common/mapped_file.hpp>
+
+#include <odr/exceptions.hpp>
+#include <odr/file.hpp>
+
+#include <odr/internal/common/file.hpp>
+#include <odr/internal/common/path.hpp>
+#include <odr/internal/util/file_util.hpp>
+#include <odr/internal/util/stream_util.hpp>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+
+using namespace odr;
+using namespace odr::internal;
+
+namespace {
+
+/// A file of @p content in the working directory, removed again with the
+/// guard. Declared ahead of what maps it, so it goes after. Every test names
+/// its own, since ctest may run them side by side.
+class TemporaryFile final {
+public:
+  TemporaryFile(const std::string &name, const std::string &content)
+      : m_path{std::filesystem::current_path() / name} {
+    util::file::write(content, m_path.string());
+  }
+  TemporaryFile(const TemporaryFile &) = delete;
+  TemporaryFile &operator=(const TemporaryFile &) = delete;
+  ~TemporaryFile() {
+    std::error_code error;
+    std::filesystem::remove(m_path, error);
+  }
+
+  [[nodiscard]] AbsPath path() const { return AbsPath(m_path.string()); }
+
+private:
+  std::filesystem::path m_path;
+};
+
+} // namespace
+
+TEST(MappedFile, views_the_file) {
+  const std::string content("mapped\0bytes\xff", 13);
+  const TemporaryFile temporary("mapped_file_view", content);
+  const AbsPath path = temporary.path();
+  const MappedFile file(path);
+
+  EXPECT_EQ(file.location(), FileLocation::disk);
+  EXPECT_EQ(file.size(), content.size());
+  EXPECT_EQ(file.disk_path(), path);
+  ASSERT_TRUE(file.memory_data().has_value());
+  EXPECT_EQ(*file.memory_data(), content);
+  EXPECT_EQ(util::stream::read(*file.stream()), content);
+}
+
+TEST(MappedFile, stream_outlives_file) {
+  const TemporaryFile temporary("mapped_file_stream", "0123456789");
+
+  std::unique_ptr<std::istream> stream;
+  {
+    const MappedFile file(temporary.path());
+    stream = file.stream();
+  }
+  stream->seekg(4);
+  EXPECT_EQ(util::stream::read(*stream), "456789");
+}
+
+TEST(MappedFile, empty_file) {
+  const TemporaryFile temporary("mapped_file_empty", "");
+  const MappedFile file(temporary.path());
+
+  EXPECT_EQ(file.size(), 0);
+  EXPECT_EQ(file.memory_data(), std::string_view());
+  EXPECT_EQ(util::stream::read(*file.stream()), "");
+}
+
+TEST(MappedFile, missing_file) {
+  EXPECT_THROW(MappedFile(AbsPath("/odr/no/such/file")), FileNotFound);
+}
+
+TEST(MappedFile, open_disk_file_maps_only_large_files) {
+  const TemporaryFile small_file("mapped_file_small", "x");
+  const auto small = open_disk_file(small_file.path());
+  EXPECT_NE(std::dynamic_pointer_cast<DiskFile>(small), nullptr);
+  EXPECT_FALSE(small->memory_data().has_value());
+
+  const TemporaryFile large_file("mapped_file_large",
+                                 std::string(MappedFile::threshold, 'x'));
+  const auto large = open_disk_file(large_file.path());
+  EXPECT_NE(std::dynamic_pointer_cast<MappedFile>(large), nullptr);
+  EXPECT_EQ(large->memory_data()->size(), MappedFile::threshold);
+}
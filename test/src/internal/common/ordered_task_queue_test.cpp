@@ -0,0 +1,57 @@
+#include <odr/internal/common/ordered_task_queue.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace odr::internal;
+
+TEST(OrderedTaskQueue, results_in_order) {
+  for (const std::uint32_t threads : {0u, 1u, 2u, 8u}) {
+    OrderedTaskQueue<std::string> queue(
+        100, threads, [](const std::size_t i) { return std::to_string(i); });
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+      EXPECT_EQ(queue.next(), std::to_string(i));
+    }
+  }
+}
+
+TEST(OrderedTaskQueue, rethrows_in_order) {
+  OrderedTaskQueue<std::size_t> queue(10, 4, [](const std::size_t i) {
+    if (i == 3) {
+      throw std::runtime_error("task 3");
+    }
+    return i;
+  });
+  for (std::size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(queue.next(), i);
+  }
+  EXPECT_THROW((void)queue.next(), std::runtime_error);
+  EXPECT_EQ(queue.next(), 4u);
+}
+
+TEST(OrderedTaskQueue, abandoned) {
+  OrderedTaskQueue<std::size_t> queue(1000, 4,
+                                      [](const std::size_t i) { return i; });
+  EXPECT_EQ(queue.next(), 0u);
+}
+
+TEST(OrderedTaskQueue, nested_runs_inline) {
+  // a queue of another type made on a worker runs its tasks on that worker
+  OrderedTaskQueue<bool> outer(8, 4, [](std::size_t) {
+    const std::thread::id worker = std::this_thread::get_id();
+    OrderedTaskQueue<std::thread::id> inner(
+        8, 4, [](std::size_t) { return std::this_thread::get_id(); });
+    bool inline_only = true;
+    for (std::size_t i = 0; i < inner.size(); ++i) {
+      inline_only = inline_only && inner.next() == worker;
+    }
+    return inline_only;
+  });
+  for (std::size_t i = 0; i < outer.size(); ++i) {
+    EXPECT_TRUE(outer.next());
+  }
+  EXPECT_FALSE(on_ordered_task_worker);
+}
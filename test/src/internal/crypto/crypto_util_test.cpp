@@ -1,7 +1,18 @@
 #include <odr/internal/crypto/crypto_util.hpp>
 
+#include <odr/internal/crypto/crypto_argon2.hpp>
+#include <odr/internal/util/stream_util.hpp>
+
 #include <gtest/gtest.h>
 
+#include <cryptopp/aes.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/gcm.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 
@@ -68,6 +79,42 @@ TEST(CryptoUtil, argon2id_lanes) {
             "fd3d6c0350c90b38be1da55d3387c3da995b683542cf1de6af4cb06f0cbd1188");
 }
 
+// The lanes of a slice are independent, so how many threads fill them must not
+// change the tag — including more threads than lanes and uneven splits.
+TEST(CryptoUtil, argon2id_threads) {
+  using odr::internal::crypto::argon2::id;
+  for (const std::size_t threads : {1, 2, 3, 4, 8}) {
+    EXPECT_EQ(
+        hex_encode(
+            id(32, "password", "0123456789abcdef", 3, 65536, 4, threads)),
+        "b8a64b68dea6b88ca8c8862be706aac37cbecda0db7bd68b48f8fa2e7feb6f3e");
+    EXPECT_EQ(
+        hex_encode(id(32, "password", "somesalt", 2, 37, 3, threads)),
+        "fd3d6c0350c90b38be1da55d3387c3da995b683542cf1de6af4cb06f0cbd1188");
+  }
+}
+
+// Only the kernel the compiler targets is fast, and only it runs by default;
+// the scalar one is always compiled in to check it against the vectors.
+TEST(CryptoUtil, argon2id_kernels) {
+  using odr::internal::crypto::argon2::id;
+  using odr::internal::crypto::argon2::Kernel;
+  using odr::internal::crypto::argon2::native_kernel;
+  for (const Kernel kernel : {Kernel::scalar, native_kernel()}) {
+    EXPECT_EQ(
+        hex_encode(id(32, "password", "somesalt", 2, 65536, 1, 1, kernel)),
+        "09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7");
+    EXPECT_EQ(
+        hex_encode(id(32, "password", "somesalt", 2, 256, 2, 1, kernel)),
+        "6d093c501fd5999645e0ea3bf620d7b8be7fd2db59c20d9fff9539da2bf57037");
+    EXPECT_EQ(
+        hex_encode(id(32, "password", "somesalt", 2, 37, 3, 1, kernel)),
+        "fd3d6c0350c90b38be1da55d3387c3da995b683542cf1de6af4cb06f0cbd1188");
+  }
+  EXPECT_EQ(id(64, "password", "somesalt", 3, 1024, 4, 0, Kernel::scalar),
+            id(64, "password", "somesalt", 3, 1024, 4, 0, native_kernel()));
+}
+
 TEST(CryptoUtil, argon2id_rejects_bad_parameters) {
   EXPECT_THROW(argon2id(32, "password", "short", 2, 256, 1),
                std::invalid_argument);
@@ -86,3 +133,125 @@ TEST(CryptoUtil, rc4) {
   // RC4 is symmetric: re-applying the keystream restores the plaintext.
   EXPECT_EQ(rc4("Key", cipher), "Plaintext");
 }
+
+// An ODF entry is raw deflate, encrypted; the stream undoes both as it is read,
+// over more than one buffer of ciphertext.
+TEST(CryptoUtil, decrypt_inflate) {
+  std::string plain;
+  for (int i = 0; plain.size() < 300000; ++i) {
+    plain += std::to_string(i * 7919 % 100003) + ' ';
+  }
+  // zlib without its 2 byte header and 4 byte ADLER32 trailer is raw deflate
+  const std::string zlib = zlib_deflate(plain);
+  std::string deflated = zlib.substr(2, zlib.size() - 6);
+  deflated.resize((deflated.size() + 15) / 16 * 16, '\0');
+
+  const std::string key(32, 'k');
+  const std::string iv(16, 'i');
+  const std::string cipher = encrypt_aes_cbc(key, iv, deflated);
+
+  const auto stream =
+      decrypt_inflate(std::make_unique<std::istringstream>(cipher),
+                      StreamCipher::aes_cbc, key, iv);
+  EXPECT_EQ(odr::internal::util::stream::read(*stream), plain);
+
+  // a wrong key makes garbage of the deflate stream, which the read reports
+  const auto wrong =
+      decrypt_inflate(std::make_unique<std::istringstream>(cipher),
+                      StreamCipher::aes_cbc, std::string(32, 'x'), iv);
+  std::string buffer(1024, '\0');
+  EXPECT_ANY_THROW(wrong->read(buffer.data(), buffer.size()));
+
+  EXPECT_THROW(decrypt_inflate(std::make_unique<std::istringstream>(cipher),
+                               StreamCipher::aes_gcm, key, iv),
+               std::runtime_error);
+}
+
+// An ODF entry under AES-GCM is `iv || ciphertext || tag`; the tag is checked
+// by reading it through, with none of the plaintext kept.
+TEST(CryptoUtil, verify_aes_gcm) {
+  const std::string key(32, 'k');
+  const std::string iv(12, 'i');
+  const std::string plain(200000, 'p');
+
+  CryptoPP::GCM<CryptoPP::AES>::Encryption encryption;
+  encryption.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte *>(key.data()),
+                          key.size(),
+                          reinterpret_cast<const CryptoPP::byte *>(iv.data()),
+                          iv.size());
+  std::string sealed;
+  CryptoPP::StringSource(plain, true,
+                         new CryptoPP::AuthenticatedEncryptionFilter(
+                             encryption, new CryptoPP::StringSink(sealed)));
+  const std::string input = iv + sealed;
+
+  std::istringstream good(input);
+  EXPECT_TRUE(verify_aes_gcm(good, key, iv));
+
+  std::string tampered = input;
+  tampered[iv.size() + 1000] ^= 1;
+  std::istringstream bad(tampered);
+  EXPECT_FALSE(verify_aes_gcm(bad, key, iv));
+
+  std::istringstream wrong_key(input);
+  EXPECT_FALSE(verify_aes_gcm(wrong_key, std::string(32, 'x'), iv));
+
+  std::istringstream truncated(input.substr(0, iv.size() + 4));
+  EXPECT_FALSE(verify_aes_gcm(truncated, key, iv));
+}
+
+// pieces deflated apart and joined are one zlib stream, whatever the threads
+TEST(CryptoUtil, zlib_deflate_in_pieces) {
+  std::string plain;
+  for (int i = 0; plain.size() < 100000; ++i) {
+    plain += std::to_string(i * 7919 % 100003) + ' ';
+  }
+
+  const std::string one = zlib_deflate(plain, 9, 7000, 1);
+  EXPECT_EQ(zlib_deflate(plain, 9, 7000, 4), one);
+  EXPECT_EQ(zlib_inflate(one), plain);
+  EXPECT_LT(one.size(), plain.size() / 2);
+  ASSERT_GT(one.size(), 6);
+  EXPECT_EQ((static_cast<std::uint8_t>(one[0]) << 8 |
+             static_cast<std::uint8_t>(one[1])) %
+                31,
+            0);
+
+  std::uint32_t a = 1;
+  std::uint32_t b = 0;
+  for (const char c : plain) {
+    a = (a + static_cast<std::uint8_t>(c)) % 65521;
+    b = (b + a) % 65521;
+  }
+  std::uint32_t trailer = 0;
+  for (const char c : one.substr(one.size() - 4)) {
+    trailer = trailer << 8 | static_cast<std::uint8_t>(c);
+  }
+  EXPECT_EQ(trailer, b << 16 | a);
+
+  EXPECT_EQ(zlib_inflate(zlib_deflate("", 1, 7000, 2)), "");
+}
+
+TEST(CryptoUtil, deflater) {
+  std::string plain;
+  for (int i = 0; plain.size() < 300000; ++i) {
+    plain += "<span class=\"c" + std::to_string(i % 17) + "\">x</span>";
+  }
+
+  Deflater zlib(DeflateFormat::zlib);
+  std::string deflated;
+  for (std::size_t at = 0; at < plain.size(); at += 1000) {
+    deflated += zlib.put(std::string_view(plain).substr(at, 1000));
+  }
+  deflated += zlib.finish();
+  EXPECT_LT(deflated.size(), plain.size() / 10);
+  EXPECT_EQ(zlib_inflate(deflated), plain);
+
+  // gzip's member is the same raw deflate, after a 10 byte header
+  Deflater gzip(DeflateFormat::gzip, 1);
+  std::string gzipped = gzip.put(plain);
+  gzipped += gzip.finish();
+  ASSERT_GT(gzipped.size(), 18);
+  EXPECT_EQ(gzipped.substr(0, 2), "\x1f\x8b");
+  EXPECT_EQ(inflate(gzipped.substr(10)), plain);
+}
@@ -0,0 +1,42 @@
+#include <odr/internal/csv/csv_document.hpp>
+
+#include <odr/file.hpp>
+
+#include <odr/internal/common/file.hpp>
+#include <odr/internal/csv/csv_util.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+using namespace odr;
+using namespace odr::internal::csv;
+
+/// A utf-8 file in memory is not copied: the cells are ranges of its bytes,
+/// past the byte order mark, and only an escaped one is a value of its own.
+TEST(CsvDocument, cells_are_read_in_place) {
+  const auto file = std::make_shared<odr::internal::MemoryFile>(
+      std::string("\xef\xbb\xbf" "a,\"b\"\"\"\n1,2\n"));
+  const CsvDocument document(file, TextEncoding::utf8, Dialect{}, false);
+  const std::string_view bytes = *file->memory_data();
+
+  EXPECT_EQ(document.cell(0, 0), "a");
+  EXPECT_EQ(document.cell(0, 0).data(), bytes.data() + 3);
+  EXPECT_EQ(document.cell(1, 0), "b\"");
+  EXPECT_EQ(document.cell(1, 1), "2");
+  EXPECT_EQ(document.cell(1, 1).data(), bytes.data() + bytes.size() - 2);
+  EXPECT_EQ(document.cell(2, 1), "");
+}
+
+/// Bytes that are not utf-8 are decoded once, into the document.
+TEST(CsvDocument, other_encodings_are_decoded) {
+  const auto file =
+      std::make_shared<odr::internal::MemoryFile>(std::string("\xe4,b\n"));
+  const CsvDocument document(file, TextEncoding::iso_8859_1, Dialect{},
+                             false);
+
+  EXPECT_EQ(document.cell(0, 0), "\xc3\xa4");
+  EXPECT_EQ(document.cell(1, 0), "b");
+}
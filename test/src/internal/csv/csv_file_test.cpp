@@ -17,6 +17,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace odr;
@@ -208,6 +209,25 @@ TEST(RecordReader, an_unterminated_quote_still_yields_its_field) {
   EXPECT_TRUE(reader.unterminated());
 }
 
+/// Only a field unescaping rewrites is handed out raw; every other one is a
+/// view of its value in the text, quotes and line break left out.
+TEST(RecordReader, fields_view_the_text) {
+  const std::string text = "a,\"b,c\",\"d\"\"e\"\r\n";
+  csv::RecordReader reader(text, csv::Dialect{});
+  std::vector<csv::RecordReader::Field> fields;
+  ASSERT_TRUE(reader.read(fields));
+  ASSERT_EQ(fields.size(), 3);
+
+  EXPECT_EQ(fields[0].text, "a");
+  EXPECT_FALSE(fields[0].escaped);
+  EXPECT_EQ(fields[1].text, "b,c");
+  EXPECT_FALSE(fields[1].escaped);
+  EXPECT_EQ(fields[1].text.data(), text.data() + 3);
+  EXPECT_TRUE(fields[2].escaped);
+  EXPECT_EQ(reader.unescape(fields[2].text), "d\"e");
+  EXPECT_FALSE(reader.read(fields));
+}
+
 TEST(CsvOptions, detection_fills_in_what_was_not_given) {
   const CsvFile file =
       CsvFile::from_file(File::from_memory("a;b\n1;2\n"), CsvOptions{});
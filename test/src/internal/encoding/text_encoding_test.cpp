@@ -10,6 +10,9 @@
 
 #include <set>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 using namespace odr;
 using namespace odr::internal;
@@ -148,3 +151,42 @@ TEST(Detect, a_byte_order_mark_wins) {
   EXPECT_EQ(encoding::detect(std::string("\xff\xfeh\0", 4)),
             TextEncoding::utf16le);
 }
+
+/// However the bytes are cut, the pieces decode to the whole.
+TEST(Utf8Decoder, pieces_decode_as_the_whole) {
+  const std::vector<std::pair<std::string, TextEncoding>> inputs{
+      {"\xef\xbb\xbf"
+       "caf\xc3\xa9 \xf0\x9f\x98\x80!",
+       TextEncoding::utf8},
+      {std::string("\xff\xfeh\0\x3d\xd8\x00\xdei\0", 10),
+       TextEncoding::utf16le},
+      {std::string("\xff\xfe\0\0h\0\0\0\x00\xf6\x01\0", 12),
+       TextEncoding::utf32le},
+      {"caf\xe9", TextEncoding::iso_8859_1}};
+
+  for (const auto &[bytes, encoding] : inputs) {
+    const std::string whole = encoding::to_utf8(bytes, encoding);
+    for (std::size_t piece = 1; piece <= 5; ++piece) {
+      encoding::Utf8Decoder decoder(encoding);
+      std::string result;
+      for (std::size_t i = 0; i < bytes.size(); i += piece) {
+        result += decoder.put(std::string_view(bytes).substr(i, piece));
+      }
+      result += decoder.finish();
+      EXPECT_EQ(result, whole) << text_encoding_to_string(encoding) << piece;
+    }
+  }
+}
+
+TEST(Utf8Decoder, only_the_start_of_a_file_has_a_byte_order_mark) {
+  encoding::Utf8Decoder middle(TextEncoding::utf8, false);
+  EXPECT_EQ(middle.put("\xef\xbb\xbfhi") + middle.finish(), "\xef\xbb\xbfhi");
+
+  // a character the input ends in the middle of is broken, not dropped
+  encoding::Utf8Decoder cut(TextEncoding::utf8);
+  EXPECT_EQ(cut.put("a\xc3"), "a");
+  EXPECT_EQ(cut.finish(), "�");
+
+  EXPECT_THROW(encoding::Utf8Decoder(TextEncoding::shift_jis),
+               std::runtime_error);
+}
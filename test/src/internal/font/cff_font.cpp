@@ -2,6 +2,7 @@
 
 #include <odr/font.hpp>
 #include <odr/internal/font/cff_builder.hpp>
+#include <odr/internal/font/cff_subset.hpp>
 #include <odr/internal/font/cff_transform.hpp>
 #include <odr/internal/font/sfnt_font.hpp>
 #include <odr/internal/font/sfnt_transform.hpp>
@@ -317,6 +318,84 @@ std::string build_cid_keyed_cff() {
   return out;
 }
 
+/// A Type2 charstring operand that tells the subroutines apart in the output:
+/// the 3-byte `28 + int16` form of @p v.
+std::string marker(const std::uint16_t v) {
+  std::string s(1, static_cast<char>(28));
+  bs::put_u16_be(s, v);
+  return s;
+}
+
+/// Build a name-keyed CFF with subroutines: glyph 1 ("A", marker 1001) calls
+/// local subr 0 (marker 2001), which calls global subr 1 (marker 3002); glyph 2
+/// ("B", marker 1002) calls local subr 1 (marker 2002). Global subr 0 (marker
+/// 3001) is never called. @p glyph1 replaces glyph 1's charstring.
+std::string build_cff_with_subrs(std::string glyph1 = {}) {
+  // With two subrs of each kind the bias is 107: subr 0 is operand -107 (byte
+  // 32), subr 1 is -106 (byte 33). callsubr = 10, callgsubr = 29, return = 11.
+  if (glyph1.empty()) {
+    glyph1 = marker(1001) + "\x20\x0a\x0e";
+  }
+  const std::string charstrings = build_index(
+      {std::string("\x0e", 1), glyph1, marker(1002) + "\x21\x0a\x0e"});
+  const std::string local_subrs = build_index(
+      {marker(2001) + "\x21\x1d\x0b", marker(2002) + "\x0b"});
+  const std::string global_subrs =
+      build_index({marker(3001) + "\x0b", marker(3002) + "\x0b"});
+
+  // charset format 0: glyph 1 -> SID 34 ("A"), glyph 2 -> SID 35 ("B").
+  std::string charset;
+  charset += static_cast<char>(0);
+  bs::put_u16_be(charset, 34);
+  bs::put_u16_be(charset, 35);
+
+  // Private DICT: defaultWidthX 500 (op 20), nominalWidthX 200 (op 21), Subrs
+  // (op 19) right behind it, relative to the Private DICT.
+  std::string private_dict;
+  dict_int(private_dict, 500);
+  private_dict += static_cast<char>(20);
+  dict_int(private_dict, 200);
+  private_dict += static_cast<char>(21);
+  dict_int(private_dict, 18);
+  private_dict += static_cast<char>(19);
+
+  const std::string name_index = build_index({"SubrFont"});
+  const std::string string_index = build_index({});
+
+  const auto top_dict = [&](std::uint32_t cs_off, std::uint32_t charset_off,
+                            std::uint32_t priv_off) {
+    std::string d;
+    dict_int(d, static_cast<std::int32_t>(charset_off));
+    d += static_cast<char>(15); // charset
+    dict_int(d, static_cast<std::int32_t>(cs_off));
+    d += static_cast<char>(17); // CharStrings
+    dict_int(d, static_cast<std::int32_t>(private_dict.size()));
+    dict_int(d, static_cast<std::int32_t>(priv_off));
+    d += static_cast<char>(18); // Private [size offset]
+    return d;
+  };
+
+  const std::uint32_t cs_off =
+      4 + static_cast<std::uint32_t>(
+              name_index.size() + build_index({top_dict(0, 0, 0)}).size() +
+              string_index.size() + global_subrs.size());
+  const std::uint32_t charset_off =
+      cs_off + static_cast<std::uint32_t>(charstrings.size());
+  const std::uint32_t priv_off =
+      charset_off + static_cast<std::uint32_t>(charset.size());
+
+  std::string out("\x01\x00\x04\x01", 4);
+  out += name_index;
+  out += build_index({top_dict(cs_off, charset_off, priv_off)});
+  out += string_index;
+  out += global_subrs;
+  out += charstrings;
+  out += charset;
+  out += private_dict;
+  out += local_subrs;
+  return out;
+}
+
 } // namespace
 
 TEST(CffFontTest, ParsesFactsFromMinimalFont) {
@@ -505,3 +584,56 @@ TEST(CffFontTest, WrapDropsExtraEntriesPastGlyphCount) {
   EXPECT_EQ(wrapped.glyph_for_code_point('B'), 0); // dropped: not mapped
   EXPECT_EQ(wrapped.glyph_for_code_point(pua_code_point(1)), 1);
 }
+
+TEST(CffFontTest, SubsetEmptiesUnusedGlyphsAndSubrs) {
+  const std::string original = build_cff_with_subrs();
+  const auto contains = [](const std::string &data, const std::uint16_t v) {
+    return data.find(marker(v)) != std::string::npos;
+  };
+  ASSERT_TRUE(contains(original, 1002));
+
+  const std::string subset = odr::internal::font::cff::subset(original, {1});
+  EXPECT_LT(subset.size(), original.size());
+
+  // Glyph ids and names stay put; the dropped glyph falls back to the default
+  // width of its bare `endchar`.
+  const CffFont font{subset};
+  EXPECT_EQ(font.name(), "SubrFont");
+  EXPECT_EQ(font.glyph_count(), 3);
+  EXPECT_EQ(font.glyph_name(1), "A");
+  EXPECT_EQ(font.glyph_name(2), "B");
+  EXPECT_EQ(font.advance_width(2), 500);
+
+  // Only what glyph 1 reaches survives, through both subr kinds.
+  EXPECT_TRUE(contains(subset, 1001));
+  EXPECT_TRUE(contains(subset, 2001));
+  EXPECT_TRUE(contains(subset, 3002));
+  EXPECT_FALSE(contains(subset, 1002));
+  EXPECT_FALSE(contains(subset, 2002));
+  EXPECT_FALSE(contains(subset, 3001));
+}
+
+TEST(CffFontTest, SubsetKeepsEverySubrForAComputedCall) {
+  // `32 32 add callsubr`: the subr number is not a literal operand.
+  const std::string original =
+      build_cff_with_subrs(marker(1001) + "\x20\x20\x0c\x0a\x0a\x0e");
+  const std::string subset = odr::internal::font::cff::subset(original, {1});
+
+  EXPECT_EQ(subset.find(marker(1002)), std::string::npos);
+  EXPECT_NE(subset.find(marker(2002)), std::string::npos);
+  EXPECT_NE(subset.find(marker(3001)), std::string::npos);
+}
+
+TEST(CffFontTest, WrapsASubsetToLoadableOtf) {
+  using namespace odr::internal::font;
+  const CffFont cff{build_cff_with_subrs()};
+  const std::string otf = cff::wrap_to_otf(cff, {}, {1});
+
+  ASSERT_TRUE(sfnt::SfntFont::is_sfnt(otf));
+  const sfnt::SfntFont wrapped{otf};
+  EXPECT_EQ(wrapped.glyph_count(), 3);
+  EXPECT_EQ(wrapped.glyph_for_code_point(pua_code_point(2)), 2);
+  const CffFont subset{sfnt_table(otf, "CFF ")};
+  EXPECT_EQ(subset.glyph_count(), 3);
+  EXPECT_EQ(subset.glyph_name(1), "A");
+}
@@ -9,6 +9,7 @@
 #include <map>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -381,3 +382,47 @@ TEST(SfntTransform, write_keeps_existing_os2) {
   // The source `OS/2` is copied through verbatim, not replaced.
   EXPECT_EQ(table(out, "OS/2"), original_os2);
 }
+
+TEST(SfntTransform, subset_glyf_keeps_ids_and_pulls_in_components) {
+  // glyphs 0, 1 and 3 are simple outlines told apart by their first bbox byte;
+  // glyph 2 is a composite of glyph 3
+  const auto simple = [](const char tag) {
+    std::string g(12, '\0');
+    g[1] = 1; // numberOfContours
+    g[2] = tag;
+    return g;
+  };
+  std::string composite(10, '\0');
+  composite[0] = composite[1] = static_cast<char>(0xff); // numberOfContours -1
+  bs::put_u16_be(composite, 0);                          // flags: byte args
+  bs::put_u16_be(composite, 3);                          // glyphIndex
+  composite += std::string(2, '\0');                     // arg1, arg2
+
+  const std::vector<std::string> outlines = {simple('a'), simple('b'),
+                                             composite, simple('d')};
+  std::string glyf;
+  std::string loca;
+  for (const std::string &g : outlines) {
+    bs::put_u32_be(loca, static_cast<std::uint32_t>(glyf.size()));
+    glyf += g;
+  }
+  bs::put_u32_be(loca, static_cast<std::uint32_t>(glyf.size()));
+
+  const GlyfSubset subset = subset_glyf(glyf, loca, true, 4, {2});
+  ASSERT_FALSE(subset.long_offsets);
+  ASSERT_EQ(subset.loca.size(), 5 * 2);
+  const std::string_view new_loca = subset.loca;
+  std::vector<std::size_t> offsets;
+  for (std::size_t i = 0; i < 5; ++i) {
+    offsets.push_back(2 * bs::read_u16_be(new_loca.substr(2 * i)));
+  }
+  const auto outline = [&](const std::size_t glyph) {
+    return subset.glyf.substr(offsets[glyph],
+                              offsets[glyph + 1] - offsets[glyph]);
+  };
+  EXPECT_EQ(outline(0), outlines[0]); // .notdef is always kept
+  EXPECT_EQ(outline(1), "");
+  EXPECT_EQ(outline(2), outlines[2]);
+  EXPECT_EQ(outline(3), outlines[3]);
+  EXPECT_EQ(subset.glyf.size(), glyf.size() - 12);
+}
@@ -20,6 +20,7 @@ emit_viewport(const HtmlConfig &config, const bool fit_width_by_default,
   ihtml::HtmlWriter writer(out, false, "");
   ihtml::write_viewport_meta(writer, config, fit_width_by_default,
                              mode_override);
+  writer.flush();
   return out.str();
 }
 
@@ -76,6 +77,7 @@ std::string emit_zoom(const HtmlConfig &config, const bool fits,
   std::ostringstream out;
   ihtml::HtmlWriter writer(out, false, "");
   ihtml::write_zoom_style(writer, config, fits, content_pixels);
+  writer.flush();
   return out.str();
 }
 
@@ -0,0 +1,126 @@
+#include <odr/internal/html/common.hpp>
+#include <odr/internal/html/html_writer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <ios>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+using namespace odr;
+namespace ihtml = odr::internal::html;
+
+TEST(HtmlWriter, a_tag_writes_as_its_options_do) {
+  std::ostringstream options_out;
+  {
+    ihtml::HtmlWriter writer(options_out, true, "  ");
+    writer.write_element_begin(
+        "td",
+        ihtml::HtmlElementOptions()
+            .set_class("c")
+            .set_style("a:1;b:2")
+            .set_attributes(ihtml::HtmlAttributesVector{{"colspan", "2"}}));
+    writer.write_element_begin(
+        "x-s", ihtml::HtmlElementOptions().set_inline(true).set_style(""));
+    writer.write_element_end("x-s");
+    writer.write_element_begin(
+        "br", ihtml::HtmlElementOptions().set_close_type(
+                  ihtml::HtmlCloseType::trailing));
+    writer.write_element_end("td");
+  }
+
+  std::ostringstream tag_out;
+  {
+    ihtml::HtmlWriter writer(tag_out, true, "  ");
+    const ihtml::HtmlAttribute colspan[]{{"colspan", "2"}};
+    writer.write_tag_begin(
+        "td", {.clazz = "c", .style = {"a:1;", "b:2"}, .attributes = colspan});
+    writer.write_tag_begin("x-s", {.inline_element = true, .style = {"", ""}});
+    writer.write_element_end("x-s");
+    writer.write_tag_begin("br",
+                           {.close_type = ihtml::HtmlCloseType::trailing});
+    writer.write_element_end("td");
+  }
+
+  EXPECT_EQ(tag_out.str(), options_out.str());
+  EXPECT_EQ(tag_out.str(), "\n<td class=\"c\" style=\"a:1;b:2\" colspan=\"2\">"
+                           "\n  <x-s></x-s>\n  <br/>\n</td>");
+}
+
+TEST(HtmlWriter, closing_checks_the_name) {
+  std::ostringstream out;
+  ihtml::HtmlWriter writer(out, false, "");
+  writer.write_tag_begin("div");
+  writer.write_tag_begin("span", {.inline_element = true});
+  EXPECT_THROW(writer.write_element_end("div"), std::invalid_argument);
+  writer.write_element_end("span");
+  writer.write_element_end("div");
+  EXPECT_THROW(writer.write_element_end("div"), std::logic_error);
+}
+
+TEST(HtmlWriter, the_stream_has_everything_once_asked_for) {
+  std::ostringstream out;
+  ihtml::HtmlWriter writer(out, false, "");
+  writer.write_tag_begin("p");
+  writer.write_text("a < b");
+  EXPECT_EQ(out.str(), "");
+
+  writer.out() << "!";
+  writer.write_element_end("p");
+  writer.flush();
+  EXPECT_EQ(out.str(), "<p>a &lt; b!</p>");
+}
+
+TEST(HtmlWriter, text_is_escaped_as_escape_text_does) {
+  for (const std::string text :
+       {"", " ", "a  b", "  a   b ", "<&>", "\ta\t", "a    b"}) {
+    std::ostringstream out;
+    {
+      ihtml::HtmlWriter writer(out, false, "");
+      writer.write_text(text);
+    }
+    EXPECT_EQ(out.str(), ihtml::escape_text(text)) << text;
+  }
+
+  EXPECT_EQ(ihtml::escape_text("  a   b "), "&nbsp; a &nbsp; b&nbsp;");
+  EXPECT_EQ(ihtml::escape_text("a    b"), "a &nbsp; &nbsp;b");
+  EXPECT_EQ(ihtml::escape_text("<&>\t"), "&lt;&amp;&gt;&emsp;");
+}
+
+namespace {
+
+/// Fails every write, as a socket does once the client is gone.
+class FailingBuffer final : public std::streambuf {
+protected:
+  int_type overflow(int_type) override { return traits_type::eof(); }
+  std::streamsize xsputn(const char *, std::streamsize) override { return 0; }
+};
+
+} // namespace
+
+TEST(HtmlWriter, a_failing_stream_does_not_terminate) {
+  FailingBuffer buffer;
+  std::ostream out(&buffer);
+  out.exceptions(std::ios::badbit);
+
+  EXPECT_THROW(
+      {
+        ihtml::HtmlWriter writer(out, false, "");
+        writer.write_tag_begin("p");
+        writer.write_text("unsent");
+        writer.flush();
+      },
+      std::ios::failure);
+
+  // what is left to the destructor fails there, quietly
+  std::ostream fresh(&buffer);
+  fresh.exceptions(std::ios::badbit);
+  {
+    ihtml::HtmlWriter writer(fresh, false, "");
+    writer.write_text("unsent");
+  }
+  EXPECT_TRUE(fresh.bad());
+}
@@ -0,0 +1,87 @@
+#include <odr/file.hpp>
+#include <odr/html.hpp>
+#include <odr/logger.hpp>
+
+#include <odr/internal/html/text_file.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+using namespace odr;
+
+namespace {
+
+HtmlService text_service(const std::string &content, const HtmlConfig &config) {
+  const TextFile file = DecodedFile(File::from_memory(content)).as_text_file();
+  return internal::html::create_text_service(file, config, Logger::null());
+}
+
+std::string write_path(const HtmlService &service, const std::string &path) {
+  std::ostringstream out;
+  service.write(path, out);
+  return out.str();
+}
+
+} // namespace
+
+TEST(HtmlTextFile, one_view_without_paging) {
+  const HtmlService service = text_service("a\n\nb<c", HtmlConfig());
+
+  ASSERT_EQ(service.list_views().size(), 1);
+  const std::string html = write_path(service, "text.html");
+  EXPECT_NE(html.find("b&lt;c"), std::string::npos);
+  EXPECT_NE(html.find("<div><br/></div>"), std::string::npos);
+  EXPECT_NE(html.find(R"(data-first="1")"), std::string::npos);
+  EXPECT_NE(html.find("<div>3</div>"), std::string::npos);
+  EXPECT_EQ(html.find("<div>4</div>"), std::string::npos);
+}
+
+TEST(HtmlTextFile, pages_by_lines_numbered_as_the_file) {
+  std::string text;
+  for (int line = 1; line <= 7; ++line) {
+    text += "line " + std::to_string(line) + "\n";
+  }
+  HtmlConfig config;
+  config.text_lines_per_page = 3;
+  const HtmlService service = text_service(text, config);
+
+  // 8 lines, the last empty: text.html and three pages
+  const HtmlViews &views = service.list_views();
+  ASSERT_EQ(views.size(), 4);
+  EXPECT_EQ(views.at(2).path(), "page1.html");
+  EXPECT_TRUE(service.exists("page2.html"));
+  EXPECT_FALSE(service.exists("page3.html"));
+
+  const std::string second = write_path(service, "page1.html");
+  EXPECT_NE(second.find(R"(data-first="4")"), std::string::npos);
+  EXPECT_NE(second.find("<div>4</div>"), std::string::npos);
+  EXPECT_NE(second.find("<div>6</div>"), std::string::npos);
+  EXPECT_EQ(second.find("<div>7</div>"), std::string::npos);
+  EXPECT_NE(second.find("line 4"), std::string::npos);
+  EXPECT_NE(second.find("line 6"), std::string::npos);
+  EXPECT_EQ(second.find("line 3"), std::string::npos);
+  EXPECT_EQ(second.find("line 7"), std::string::npos);
+
+  const std::string last = write_path(service, "page2.html");
+  EXPECT_NE(last.find("line 7"), std::string::npos);
+  EXPECT_NE(last.find("<div>8</div>"), std::string::npos);
+}
+
+/// A page of utf-16 starts between two units and decodes from there.
+TEST(HtmlTextFile, pages_a_wide_encoding) {
+  std::string text = "\xff\xfe";
+  for (const char c : std::string("a\nb\nc\xe9")) {
+    text += c;
+    text += '\0';
+  }
+  HtmlConfig config;
+  config.text_lines_per_page = 1;
+  const HtmlService service = text_service(text, config);
+
+  ASSERT_EQ(service.list_views().size(), 4);
+  const std::string last = write_path(service, "page2.html");
+  EXPECT_NE(last.find("c\xc3\xa9"), std::string::npos);
+  EXPECT_EQ(last.find("<div>b</div>"), std::string::npos);
+}
@@ -0,0 +1,223 @@
+#include <odr/internal/html/translation_cache.hpp>
+
+#include <odr/file.hpp>
+#include <odr/html.hpp>
+#include <odr/logger.hpp>
+
+#include <odr/internal/common/random.hpp>
+#include <odr/internal/util/file_util.hpp>
+
+#include <internal/pdf/pdf_test_file_builder.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+using namespace odr;
+using namespace odr::internal;
+namespace fs = std::filesystem;
+
+namespace {
+
+/// A fresh directory under the temporary directory, removed again with it.
+class CacheDirectory final {
+public:
+  CacheDirectory()
+      : m_path{fs::temp_directory_path() /
+               ("odr_translation_cache_test_" + random_string(8))} {}
+  CacheDirectory(const CacheDirectory &) = delete;
+  CacheDirectory &operator=(const CacheDirectory &) = delete;
+  ~CacheDirectory() {
+    std::error_code error;
+    fs::remove_all(m_path, error);
+  }
+
+  [[nodiscard]] const fs::path &path() const { return m_path; }
+
+private:
+  fs::path m_path;
+};
+
+/// What @p service writes for its first view, through `write` as a host
+/// serving it would ask.
+std::string first_view(const HtmlService &service) {
+  std::ostringstream out;
+  service.write(service.list_views().at(0).path(), out);
+  return out.str();
+}
+
+/// The directory the entries under @p cache go in.
+fs::path store_of(const fs::path &cache) {
+  return cache / internal::html::translation_cache_directory;
+}
+
+/// A name shaped like an entry's, a sha256 in hex.
+std::string key(const char digit) { return std::string(64, digit); }
+
+/// An entry named @p name of @p bytes, last used @p age ago.
+void make_entry(const fs::path &cache, const std::string &name,
+                const std::size_t bytes, const std::chrono::hours age) {
+  const fs::path entry = store_of(cache) / name;
+  fs::create_directories(entry);
+  util::file::write("{}", (entry / "manifest.json").string());
+  util::file::write(std::string(bytes, 'x'), (entry / "file").string());
+  fs::last_write_time(entry, fs::file_time_type::clock::now() - age);
+}
+
+} // namespace
+
+TEST(TranslationCache, fingerprint_follows_the_output) {
+  const HtmlConfig config;
+  const std::string fingerprint = internal::html::config_fingerprint(config);
+
+  HtmlConfig same = config;
+  same.render_threads = 4;
+  same.cache_max_megabytes = 1;
+  EXPECT_EQ(internal::html::config_fingerprint(same), fingerprint);
+
+  HtmlConfig different = config;
+  different.embed_images = !different.embed_images;
+  EXPECT_NE(internal::html::config_fingerprint(different), fingerprint);
+  different = config;
+  different.page_range_end = 1;
+  EXPECT_NE(internal::html::config_fingerprint(different), fingerprint);
+  different = config;
+  different.png_compression_level = 9;
+  EXPECT_NE(internal::html::config_fingerprint(different), fingerprint);
+}
+
+TEST(TranslationCache, serves_a_repeat_translation_from_disk) {
+  const CacheDirectory cache;
+  const DecodedFile file(File::from_memory("cached text\n"));
+  const HtmlConfig config;
+
+  int translations = 0;
+  const auto translate = [&] {
+    ++translations;
+    return odr::html::translate(file, config);
+  };
+
+  const HtmlService first = internal::html::create_cached_service(
+      cache.path().string(), file, config, Logger::null(), translate);
+  const std::string written = first_view(first);
+  EXPECT_EQ(translations, 1);
+  EXPECT_NE(written.find("cached text"), std::string::npos);
+
+  const HtmlService second = internal::html::create_cached_service(
+      cache.path().string(), file, config, Logger::null(), translate);
+  EXPECT_EQ(second.list_views().size(), first.list_views().size());
+  EXPECT_TRUE(second.exists(second.list_views().at(0).path()));
+  EXPECT_EQ(first_view(second), written);
+  EXPECT_EQ(translations, 1);
+
+  // other bytes are another entry
+  const DecodedFile other(File::from_memory("other text\n"));
+  const HtmlService third = internal::html::create_cached_service(
+      cache.path().string(), other, config, Logger::null(),
+      [&] { return odr::html::translate(other, config); });
+  EXPECT_NE(first_view(third), written);
+}
+
+TEST(TranslationCache, serves_the_images_a_cached_view_links) {
+  const CacheDirectory cache;
+  test::pdf::PdfFileBuilder builder;
+  builder.object("<< /Type /Catalog /Pages 2 0 R >>")
+      .object("<< /Type /Pages /Kids [4 0 R] /Count 1 >>")
+      .stream_object("/Type /XObject /Subtype /Image /Width 2 /Height 2 "
+                     "/ColorSpace /DeviceGray /BitsPerComponent 8",
+                     std::string("\x00\xff\xff\x00", 4))
+      .object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+              "/Resources << /XObject << /Im1 3 0 R >> >> /Contents 5 0 R >>")
+      .stream_object("", "q 100 0 0 100 50 50 cm /Im1 Do Q");
+  const DecodedFile file(
+      File::from_memory(builder.trailer("/Root 1 0 R").build_classic()));
+  HtmlConfig config;
+  config.embed_images = false;
+
+  int translations = 0;
+  const auto translate = [&] {
+    ++translations;
+    return odr::html::translate(file, config);
+  };
+
+  const HtmlService first = internal::html::create_cached_service(
+      cache.path().string(), file, config, Logger::null(), translate);
+  const std::string view = first_view(first);
+  const std::size_t href = view.find("href=\"pdf/");
+  ASSERT_NE(href, std::string::npos);
+  const std::size_t begin = href + 6;
+  const std::string image = view.substr(begin, view.find('"', begin) - begin);
+
+  // the image is on disk with the view, so nothing is translated for it
+  const HtmlService second = internal::html::create_cached_service(
+      cache.path().string(), file, config, Logger::null(), translate);
+  EXPECT_EQ(first_view(second), view);
+  ASSERT_TRUE(second.exists(image));
+  EXPECT_EQ(second.mimetype(image), "image/png");
+  std::ostringstream out;
+  second.write(image, out);
+  EXPECT_EQ(out.str().substr(0, 8), "\x89PNG\r\n\x1a\n");
+  EXPECT_EQ(translations, 1);
+}
+
+TEST(TranslationCache, prunes_old_entries_then_the_least_recently_used) {
+  const CacheDirectory cache;
+  const fs::path store = store_of(cache.path());
+  make_entry(cache.path(), key('a'), 10, std::chrono::hours(48));
+  make_entry(cache.path(), key('b'), 100, std::chrono::hours(3));
+  make_entry(cache.path(), key('c'), 100, std::chrono::hours(2));
+  make_entry(cache.path(), key('d'), 100, std::chrono::hours(1));
+  fs::create_directories(store / (".trash-" + key('e') + "-left0ver"));
+
+  internal::html::prune_translation_cache(cache.path(), 250,
+                                          std::chrono::hours(24), key('d'));
+
+  EXPECT_FALSE(fs::exists(store / key('a')));
+  EXPECT_FALSE(fs::exists(store / key('b')));
+  EXPECT_TRUE(fs::exists(store / key('c')));
+  EXPECT_TRUE(fs::exists(store / key('d')));
+  EXPECT_FALSE(fs::exists(store / (".trash-" + key('e') + "-left0ver")));
+
+  // no bounds, nothing goes
+  internal::html::prune_translation_cache(cache.path(), 0,
+                                          std::chrono::seconds(0));
+  EXPECT_TRUE(fs::exists(store / key('c')));
+  EXPECT_TRUE(fs::exists(store / key('d')));
+}
+
+TEST(TranslationCache, leaves_what_is_not_an_entry_alone) {
+  const CacheDirectory cache;
+  const fs::path store = store_of(cache.path());
+  const auto make_old = [](const fs::path &directory) {
+    fs::create_directories(directory);
+    util::file::write(std::string(100, 'x'), (directory / "file").string());
+    fs::last_write_time(directory, fs::file_time_type::clock::now() -
+                                       std::chrono::hours(24 * 365));
+  };
+  // the caller's own files next to the cache, and odd ones in it
+  make_old(cache.path() / "photos");
+  make_old(cache.path() / ".trash-mine");
+  make_old(store / "notes");
+  make_old(store / key('a'));
+  make_old(store / ".trash-notes");
+
+  internal::html::prune_translation_cache(cache.path(), 1,
+                                          std::chrono::hours(1));
+  const DecodedFile file(File::from_memory("cached text\n"));
+  HtmlConfig config;
+  config.cache_max_megabytes = 1;
+  config.cache_max_age_days = 1;
+  (void)first_view(internal::html::create_cached_service(
+      cache.path().string(), file, config, Logger::null(),
+      [&] { return odr::html::translate(file, config); }));
+
+  EXPECT_TRUE(fs::exists(cache.path() / "photos" / "file"));
+  EXPECT_TRUE(fs::exists(cache.path() / ".trash-mine" / "file"));
+  EXPECT_TRUE(fs::exists(store / "notes" / "file"));
+  // named like an entry, but without a manifest it is none
+  EXPECT_TRUE(fs::exists(store / key('a') / "file"));
+  EXPECT_TRUE(fs::exists(store / ".trash-notes" / "file"));
+}
@@ -0,0 +1,71 @@
+#include <odr/internal/json/json_util.hpp>
+
+#include <odr/exceptions.hpp>
+#include <odr/file.hpp>
+
+#include <odr/internal/json/json_file.hpp>
+#include <odr/internal/text/text_file.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+using namespace odr;
+using namespace odr::internal;
+
+TEST(JsonUtil, check_accepts_what_rfc_8259_does) {
+  EXPECT_NO_THROW(json::check_json_file(R"({"a": [1, 2.5, null]})"));
+  EXPECT_NO_THROW(json::check_json_file("[]"));
+  EXPECT_NO_THROW(json::check_json_file("42"));
+  EXPECT_NO_THROW(json::check_json_file(R"("hello")"));
+
+  EXPECT_THROW(json::check_json_file(R"({"a": 1)"), NoJsonFile);
+  EXPECT_THROW(json::check_json_file("[1]]"), NoJsonFile);
+}
+
+TEST(JsonUtil, probe_takes_a_cut_document) {
+  EXPECT_TRUE(json::probe(R"({"a": 1})", true));
+  EXPECT_TRUE(json::probe("\xef\xbb\xbf  [ ]  ", true));
+
+  // running out of input is the cut, wherever it falls
+  EXPECT_TRUE(json::probe(R"({"a": [1, 2)", false));
+  EXPECT_TRUE(json::probe(R"({"a": tru)", false));
+  EXPECT_TRUE(json::probe(R"({"ab)", false));
+  EXPECT_TRUE(json::probe("[1,", false));
+  // unless there is nothing after it
+  EXPECT_FALSE(json::probe(R"({"a": [1, 2)", true));
+}
+
+TEST(JsonUtil, probe_rejects_a_syntax_error_before_the_cut) {
+  EXPECT_FALSE(json::probe(R"({"a": x)", false));
+  EXPECT_FALSE(json::probe(R"({"a" 1)", false));
+  EXPECT_FALSE(json::probe("[1]]", false));
+}
+
+TEST(JsonUtil, probe_wants_an_object_or_an_array) {
+  EXPECT_FALSE(json::probe("42", true));
+  EXPECT_FALSE(json::probe(R"("hello")", true));
+  EXPECT_FALSE(json::probe("", true));
+  EXPECT_FALSE(json::probe("a,b\n1,2\n", true));
+}
+
+TEST(JsonFile, detection_reads_a_prefix_and_the_by_type_path_all) {
+  const auto text_of = [](const std::string &content) {
+    return std::make_shared<text::TextFile>(
+        File::from_memory(content).impl());
+  };
+
+  // broken past the probe: a json to detection, not to a whole parse
+  std::string large = "[";
+  while (large.size() < 200000) {
+    large += R"({"key": "value"},)";
+  }
+  large += "oops";
+  EXPECT_NO_THROW(json::JsonFile(text_of(large)));
+  EXPECT_THROW(json::JsonFile(text_of(large), json::Validation::whole),
+               NoJsonFile);
+
+  EXPECT_THROW(json::JsonFile(text_of("42")), NoJsonFile);
+  EXPECT_NO_THROW(json::JsonFile(text_of("42"), json::Validation::whole));
+}
@@ -0,0 +1,130 @@
+#include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_document.hpp>
+#include <odr/internal/ooxml/spreadsheet/ooxml_spreadsheet_shared_strings.hpp>
+
+#include <odr/document.hpp>
+#include <odr/document_element.hpp>
+#include <odr/exceptions.hpp>
+
+#include <odr/internal/common/file.hpp>
+#include <odr/internal/common/filesystem.hpp>
+#include <odr/internal/common/path.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pugixml.hpp>
+
+using namespace odr;
+using namespace odr::internal;
+using namespace odr::internal::ooxml::spreadsheet;
+
+namespace {
+
+std::shared_ptr<MemoryFile> file_of(std::string content) {
+  return std::make_shared<MemoryFile>(std::move(content));
+}
+
+/// A workbook of sheets `First` and `Second`; `First`'s A1 refers to the
+/// second shared string, and `Second`'s part holds @p second_sheet.
+std::shared_ptr<VirtualFilesystem>
+workbook_of(const std::string &second_sheet) {
+  auto result = std::make_shared<VirtualFilesystem>();
+  result->copy(file_of(R"(<workbook xmlns:r="r"><sheets>)"
+                       R"(<sheet name="First" r:id="rId1"/>)"
+                       R"(<sheet name="Second" r:id="rId2"/>)"
+                       R"(</sheets></workbook>)"),
+               AbsPath("/xl/workbook.xml"));
+  result->copy(
+      file_of(R"(<Relationships>)"
+              R"(<Relationship Id="rId1" Target="worksheets/sheet1.xml"/>)"
+              R"(<Relationship Id="rId2" Target="worksheets/sheet2.xml"/>)"
+              R"(</Relationships>)"),
+      AbsPath("/xl/_rels/workbook.xml.rels"));
+  result->copy(file_of("<styleSheet/>"), AbsPath("/xl/styles.xml"));
+  result->copy(file_of(R"(<sst><si><t>zero</t></si><si><t>one</t></si></sst>)"),
+               AbsPath("/xl/sharedStrings.xml"));
+  result->copy(file_of(R"(<worksheet><dimension ref="A1:B2"/><sheetData>)"
+                       R"(<row r="1"><c r="A1" t="s"><v>1</v></c></row>)"
+                       R"(</sheetData></worksheet>)"),
+               AbsPath("/xl/worksheets/sheet1.xml"));
+  result->copy(file_of(second_sheet), AbsPath("/xl/worksheets/sheet2.xml"));
+  return result;
+}
+
+} // namespace
+
+TEST(SharedStrings, indexes_entries_by_offset) {
+  const SharedStrings shared_strings(file_of(
+      R"(<?xml version="1.0" encoding="UTF-8"?><!-- <si> -->)"
+      R"(<sst count="3"><si><t>a&lt;b</t></si>)"
+      R"(<si><r><rPr><b/></rPr><t><![CDATA[<si>]]></t></r></si>)"
+      R"(<x:si attr='>'/><extLst><si/></extLst></sst>)"));
+
+  EXPECT_EQ(std::string(shared_strings.at(0).child("t").text().get()), "a<b");
+  EXPECT_EQ(
+      std::string(shared_strings.at(1).child("r").child("t").text().get()),
+      "<si>");
+  EXPECT_EQ(std::string(shared_strings.at(2).name()), "x:si");
+  EXPECT_THROW(std::ignore = shared_strings.at(3), std::out_of_range);
+  // a second lookup is served from the parsed entry
+  EXPECT_EQ(shared_strings.at(0), shared_strings.at(0));
+}
+
+TEST(SharedStrings, parses_a_utf16_table_whole) {
+  const std::string text = "<sst><si><t>wide</t></si></sst>";
+  std::string utf16 = "\xff\xfe";
+  for (const char c : text) {
+    utf16 += c;
+    utf16 += '\0';
+  }
+  const SharedStrings shared_strings(file_of(utf16));
+
+  EXPECT_EQ(std::string(shared_strings.at(0).child("t").text().get()), "wide");
+  EXPECT_THROW(std::ignore = shared_strings.at(1), std::out_of_range);
+}
+
+TEST(SharedStrings, without_a_table) {
+  const SharedStrings shared_strings;
+
+  EXPECT_THROW(std::ignore = shared_strings.at(0), std::out_of_range);
+}
+
+TEST(OoxmlSpreadsheet, lazy_loads_a_sheet_when_it_is_touched) {
+  // the second sheet is no xml, so touching it is the first time it is read
+  const odr::Document document(std::make_shared<ooxml::spreadsheet::Document>(
+      workbook_of("broken"), SheetLoading::lazy));
+
+  std::vector<Sheet> sheets;
+  for (const Element child : document.root_element().children()) {
+    sheets.push_back(child.as_sheet());
+  }
+  ASSERT_EQ(sheets.size(), 2);
+  EXPECT_EQ(sheets[0].name(), "First");
+  EXPECT_EQ(sheets[1].name(), "Second");
+
+  EXPECT_EQ(sheets[0].dimensions().rows, 2);
+  EXPECT_EQ(sheets[0].dimensions().columns, 2);
+  const Element text = sheets[0].cell(0, 0).first_child();
+  EXPECT_EQ(text.as_text().content(), "one");
+
+  EXPECT_THROW(std::ignore = sheets[1].dimensions(), NoXmlFile);
+  // the failed sheet is not read as if it were empty the second time
+  EXPECT_THROW(std::ignore = sheets[1].dimensions(), NoXmlFile);
+}
+
+TEST(OoxmlSpreadsheet, eager_loads_every_sheet_up_front) {
+  EXPECT_THROW(ooxml::spreadsheet::Document(workbook_of("broken"),
+                                            SheetLoading::eager),
+               NoXmlFile);
+
+  const odr::Document document(std::make_shared<ooxml::spreadsheet::Document>(
+      workbook_of("<worksheet/>"), SheetLoading::eager));
+  const Sheet second =
+      document.root_element().first_child().next_sibling().as_sheet();
+  EXPECT_EQ(second.dimensions().rows, 0);
+}
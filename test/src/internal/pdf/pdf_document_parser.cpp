@@ -10,11 +10,13 @@
 
 #include <internal/pdf/pdf_test_file_builder.hpp>
 
+#include <atomic>
 #include <cstring>
 #include <filesystem>
 #include <memory>
 #include <optional>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -89,6 +91,124 @@ TEST(DocumentParser, mini_pdf_with_xref_stream) {
   check_mini_pdf(pdf);
 }
 
+// The caches are bounded; an evicted object is read again, and one a caller
+// still holds stays valid.
+TEST(DocumentParser, cache_evicts_over_budget) {
+  const std::string pdf = two_object_mini_pdf(true);
+  DocumentParser parser(std::make_unique<std::istringstream>(pdf));
+
+  const std::shared_ptr<const IndirectObject> catalog =
+      parser.read_object(ObjectReference(1, 0));
+  EXPECT_EQ(parser.read_object(ObjectReference(1, 0)), catalog);
+  EXPECT_EQ(parser.object_cache_stats().hits, 1);
+
+  parser.set_cache_budget(0);
+  EXPECT_EQ(parser.object_cache_stats().entries, 0);
+  EXPECT_GT(parser.object_cache_stats().evictions, 0);
+  EXPECT_EQ(catalog->object.as_dictionary()["Type"].as_name(), "Catalog");
+
+  const std::shared_ptr<const IndirectObject> reread =
+      parser.read_object(ObjectReference(1, 0));
+  EXPECT_NE(reread, catalog);
+  EXPECT_EQ(reread->object.as_dictionary()["Type"].as_name(), "Catalog");
+}
+
+TEST(DocumentParser, concurrent_reads) {
+  const std::string pdf = two_object_mini_pdf(false);
+  DocumentParser parser(std::make_unique<std::istringstream>(pdf));
+  const std::unique_ptr<Document> document = parser.parse_document();
+  const ObjectReference contents =
+      first_page(*document)->contents_reference.front();
+  // small enough that the threads keep evicting each other's reads
+  parser.set_cache_budget(256);
+
+  std::vector<std::thread> threads;
+  std::atomic<std::uint32_t> mismatches{0};
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 100; ++j) {
+        const auto pages = parser.read_object(ObjectReference(2, 0));
+        if (parser.read_decoded_stream(contents) != "BT ET" ||
+            !pages->object.is_dictionary()) {
+          ++mismatches;
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(mismatches, 0);
+}
+
+// A lazy parse leaves each page's resources to `resolve_page`, which parses
+// them once and shares what pages share, as an eager parse would.
+TEST(DocumentParser, lazy_resources_resolve_per_page) {
+  PdfFileBuilder builder;
+  builder.object("<< /Type /Catalog /Pages 2 0 R >>")
+      .object("<< /Type /Pages /Kids [3 0 R 4 0 R] /Count 2 "
+              "/Resources << /Font << /F1 5 0 R >> >> >>")
+      .object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>")
+      .object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>")
+      .object("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>")
+      .trailer("/Root 1 0 R");
+  const std::string pdf = builder.build_classic();
+
+  DocumentParser parser(std::make_unique<std::istringstream>(pdf));
+  const std::unique_ptr<Document> document =
+      parser.parse_document(ResourceLoading::lazy);
+  const std::vector<Page *> pages = document->collect_pages();
+  ASSERT_EQ(pages.size(), 2);
+  EXPECT_FALSE(pages[0]->resolved);
+  EXPECT_EQ(pages[0]->resources, nullptr);
+
+  parser.resolve_page(*pages[1]);
+  EXPECT_FALSE(pages[0]->resolved);
+  ASSERT_TRUE(pages[1]->resolved);
+  ASSERT_NE(pages[1]->resources, nullptr);
+  const Font *font = pages[1]->resources->font.at("F1");
+
+  const Resources *resources = pages[1]->resources;
+  parser.resolve_page(*pages[1]);
+  EXPECT_EQ(pages[1]->resources, resources);
+
+  parser.resolve_page(*pages[0]);
+  ASSERT_NE(pages[0]->resources, nullptr);
+  EXPECT_EQ(pages[0]->resources->font.at("F1"), font);
+}
+
+// A lazy parse reads no resource up front, so an object the cross-reference
+// table misplaces is first read when its page resolves. That recovers the way
+// an eager parse does.
+TEST(DocumentParser, lazy_resources_recover_a_damaged_xref) {
+  PdfFileBuilder builder;
+  builder.object("<< /Type /Catalog /Pages 2 0 R >>")
+      .object("<< /Type /Pages /Kids [3 0 R] /Count 1 >>")
+      .object("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] "
+              "/Resources << /Font << /F1 4 0 R >> >> >>")
+      .object("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica "
+              "/FirstChar 65 /LastChar 65 /Widths [500] >>")
+      .trailer("/Root 1 0 R");
+  std::string pdf = builder.build_classic();
+  // the font's entry points at the header instead
+  const std::string table = "xref\n0 5\n";
+  const std::size_t entries = pdf.find(table) + table.size();
+  pdf.replace(entries + 4 * 20, 10, "0000000000");
+
+  DocumentParser parser(std::make_unique<std::istringstream>(pdf));
+  const std::unique_ptr<Document> document =
+      parser.parse_document(ResourceLoading::lazy);
+  const std::vector<Page *> pages = document->collect_pages();
+  ASSERT_EQ(pages.size(), 1);
+
+  parser.resolve_page(*pages[0]);
+  ASSERT_TRUE(pages[0]->resolved);
+  ASSERT_NE(pages[0]->resources, nullptr);
+  const Font *font = pages[0]->resources->font.at("F1");
+  ASSERT_NE(font, nullptr);
+  EXPECT_EQ(font->first_char, 65);
+}
+
 namespace {
 
 void check_fixture_parses(const std::string &short_path,
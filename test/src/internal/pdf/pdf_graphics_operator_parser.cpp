@@ -0,0 +1,64 @@
+#include <odr/internal/pdf/pdf_graphics_operator.hpp>
+#include <odr/internal/pdf/pdf_graphics_operator_parser.hpp>
+
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+using namespace odr::internal::pdf;
+
+TEST(GraphicsOperatorParser, reads_operators_in_place) {
+  constexpr std::string_view content =
+      "q 1 0 0 1 72.5 -.5 cm BT/F1 12 Tf(a)Tj[(b)-250(c)]TJ ET Q "
+      "/P<</MCID 0>>BDC EMC 0 0 1 scn W* n xyz";
+  GraphicsOperatorParser parser(content);
+
+  GraphicsOperator op;
+  const auto next = [&] {
+    parser.read_operator(op);
+    return op.type;
+  };
+
+  EXPECT_EQ(next(), GraphicsOperatorType::save_state);
+  EXPECT_EQ(next(), GraphicsOperatorType::set_matrix);
+  ASSERT_EQ(op.arguments.size(), 6);
+  EXPECT_EQ(op.arguments[0].as_integer(), 1);
+  EXPECT_DOUBLE_EQ(op.arguments[4].as_real(), 72.5);
+  EXPECT_DOUBLE_EQ(op.arguments[5].as_real(), -0.5);
+  EXPECT_EQ(next(), GraphicsOperatorType::begin_text);
+  EXPECT_TRUE(op.arguments.empty());
+  EXPECT_EQ(next(), GraphicsOperatorType::set_text_font_size);
+  EXPECT_EQ(op.arguments.at(0).as_name(), "F1");
+  EXPECT_EQ(next(), GraphicsOperatorType::show_text);
+  EXPECT_EQ(op.arguments.at(0).as_string(), "a");
+  EXPECT_EQ(next(), GraphicsOperatorType::show_text_manual_spacing);
+  EXPECT_EQ(op.arguments.at(0).as_array().size(), 3);
+  EXPECT_EQ(next(), GraphicsOperatorType::end_text);
+  EXPECT_EQ(next(), GraphicsOperatorType::restore_state);
+  EXPECT_EQ(next(), GraphicsOperatorType::begin_marked_content_seq_props);
+  EXPECT_TRUE(op.arguments.at(1).is_dictionary());
+  EXPECT_EQ(next(), GraphicsOperatorType::end_marked_content_seq);
+  EXPECT_EQ(next(), GraphicsOperatorType::set_other_color_name);
+  EXPECT_EQ(op.arguments.size(), 3);
+  EXPECT_EQ(next(), GraphicsOperatorType::set_clipping_evenodd);
+  EXPECT_EQ(next(), GraphicsOperatorType::end_path);
+  EXPECT_EQ(next(), GraphicsOperatorType::unknown);
+  EXPECT_TRUE(parser.in().eof());
+}
+
+TEST(GraphicsOperatorParser, an_inline_image_carries_its_data) {
+  // the two samples spell `EI`; the image's size tells them from the end
+  constexpr std::string_view content = "BI /W 2 /H 1 /CS /G /BPC 8 ID EI EI Q";
+  GraphicsOperatorParser parser(content);
+
+  GraphicsOperator op;
+  parser.read_operator(op);
+  EXPECT_EQ(op.type, GraphicsOperatorType::begin_inline_image);
+  parser.read_operator(op);
+  EXPECT_EQ(op.type, GraphicsOperatorType::begin_inline_image_data);
+  ASSERT_EQ(op.arguments.size(), 2);
+  EXPECT_EQ(op.arguments[0].as_dictionary()["W"].as_integer(), 2);
+  EXPECT_EQ(op.arguments[1].as_string(), "EI");
+  parser.read_operator(op);
+  EXPECT_EQ(op.type, GraphicsOperatorType::restore_state);
+}
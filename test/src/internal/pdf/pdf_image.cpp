@@ -3,7 +3,12 @@
 #include <odr/internal/crypto/crypto_util.hpp>
 #include <odr/internal/pdf/pdf_color.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -26,9 +31,46 @@ std::uint32_t be32(const std::string &data, const std::size_t offset) {
              static_cast<std::uint8_t>(data[offset + 3]));
 }
 
+/// Undoes the filter each row of @p raw names (PNG 9.2), yielding the pixels.
+std::string unfilter(const std::string &raw, const std::int32_t width,
+                     const std::int32_t height, const std::size_t bpp) {
+  const std::size_t stride = static_cast<std::size_t>(width) * bpp;
+  std::string result;
+  for (std::size_t y = 0; y < static_cast<std::size_t>(height); ++y) {
+    const std::size_t row = y * (stride + 1);
+    const auto type = static_cast<std::uint8_t>(raw[row]);
+    EXPECT_LE(type, 4);
+    for (std::size_t i = 0; i < stride; ++i) {
+      const auto byte = [&](const std::size_t at) {
+        return static_cast<int>(static_cast<std::uint8_t>(result[at]));
+      };
+      const int a = i >= bpp ? byte(result.size() - bpp) : 0;
+      const int b = y > 0 ? byte(result.size() - stride) : 0;
+      const int c = i >= bpp && y > 0 ? byte(result.size() - stride - bpp) : 0;
+      int predicted = 0;
+      if (type == 1) {
+        predicted = a;
+      } else if (type == 2) {
+        predicted = b;
+      } else if (type == 3) {
+        predicted = (a + b) / 2;
+      } else if (type == 4) {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        predicted = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+      }
+      result.push_back(static_cast<char>(
+          static_cast<std::uint8_t>(raw[row + 1 + i]) + predicted));
+    }
+  }
+  return result;
+}
+
 /// Minimal PNG reader for the encoder's output: walks the chunks, inflates the
-/// concatenated IDAT and strips the per-row filter byte (the encoder only emits
-/// filter type 0), yielding the raw 8-bit RGB pixels.
+/// concatenated IDAT and undoes the per-row filters, yielding the raw 8-bit RGB
+/// pixels.
 struct DecodedPng {
   std::int32_t width{0};
   std::int32_t height{0};
@@ -62,13 +104,8 @@ DecodedPng decode_png(const std::string &png) {
     p += 12 + length;
   }
 
-  const std::string raw = odr::internal::crypto::util::zlib_inflate(idat);
-  const auto stride = static_cast<std::size_t>(result.width) * 3;
-  for (std::int32_t y = 0; y < result.height; ++y) {
-    const std::size_t row = static_cast<std::size_t>(y) * (stride + 1);
-    EXPECT_EQ(static_cast<std::uint8_t>(raw[row]), 0); // filter type None
-    result.rgb.append(raw, row + 1, stride);
-  }
+  result.rgb = unfilter(odr::internal::crypto::util::zlib_inflate(idat),
+                        result.width, result.height, 3);
   return result;
 }
 
@@ -106,13 +143,8 @@ DecodedPngRgba decode_png_rgba(const std::string &png) {
     }
     p += 12 + length;
   }
-  const std::string raw = odr::internal::crypto::util::zlib_inflate(idat);
-  const auto stride = static_cast<std::size_t>(result.width) * 4;
-  for (std::int32_t y = 0; y < result.height; ++y) {
-    const std::size_t row = static_cast<std::size_t>(y) * (stride + 1);
-    EXPECT_EQ(static_cast<std::uint8_t>(raw[row]), 0); // filter type None
-    result.rgba.append(raw, row + 1, stride);
-  }
+  result.rgba = unfilter(odr::internal::crypto::util::zlib_inflate(idat),
+                         result.width, result.height, 4);
   return result;
 }
 
@@ -135,6 +167,51 @@ ColorSpaceDef device_gray() {
   return def;
 }
 
+/// What `encode_image_png` is to make of sample @p pixel of @p samples: every
+/// pixel on its own through `to_rgb`, then whether the colour key masks it.
+std::string reference_pixel(const std::string &samples,
+                            const std::int32_t width, const std::int32_t bits,
+                            const ColorSpaceDef &space,
+                            const std::vector<double> &decode,
+                            const std::vector<double> &color_key,
+                            const std::int32_t x, const std::int32_t y) {
+  const auto components = static_cast<std::size_t>(space.components);
+  const std::size_t row_bytes =
+      (static_cast<std::size_t>(width) * components * bits + 7) / 8;
+  const std::uint32_t max = (1u << bits) - 1;
+  std::vector<double> values(components);
+  bool keyed = !color_key.empty();
+  for (std::size_t k = 0; k < components; ++k) {
+    const std::size_t bit = (static_cast<std::size_t>(x) * components + k) *
+                            static_cast<std::size_t>(bits);
+    std::uint32_t sample = 0;
+    for (std::int32_t i = 0; i < bits; ++i) {
+      const std::size_t at = bit + static_cast<std::size_t>(i);
+      const auto byte = static_cast<std::uint8_t>(
+          samples[static_cast<std::size_t>(y) * row_bytes + at / 8]);
+      sample = sample << 1 | (byte >> (7 - at % 8) & 1u);
+    }
+    if (!decode.empty()) {
+      values[k] = decode[2 * k] + sample * (decode[2 * k + 1] - decode[2 * k]) /
+                                      static_cast<double>(max);
+    } else if (space.kind == ColorSpaceKind::indexed) {
+      values[k] = sample;
+    } else {
+      values[k] = sample / static_cast<double>(max);
+    }
+    keyed =
+        keyed && sample >= color_key[2 * k] && sample <= color_key[2 * k + 1];
+  }
+  const std::array<double, 3> rgb = space.to_rgb(values);
+  std::string result;
+  for (const double c : rgb) {
+    result.push_back(
+        static_cast<char>(std::lround(std::clamp(c, 0.0, 1.0) * 255.0)));
+  }
+  result.push_back(static_cast<char>(keyed ? 0 : 255));
+  return result;
+}
+
 std::string bytes(std::initializer_list<int> values) {
   std::string result;
   for (const int v : values) {
@@ -312,3 +389,119 @@ TEST(PdfImage, decode_mask_alpha_resamples_to_base) {
       decode_mask_alpha(samples, 1, 1, 8, {}, /*stencil=*/false, 2, 2);
   EXPECT_EQ(alpha, (std::vector<std::uint8_t>{200, 200, 200, 200}));
 }
+
+/// Images large enough for the conversion tables come out as `to_rgb` would
+/// have them pixel by pixel, colour key included.
+TEST(PdfImage, encode_tables_match_to_rgb) {
+  ColorSpaceDef cmyk;
+  cmyk.kind = ColorSpaceKind::device_cmyk;
+  cmyk.components = 4;
+  ColorSpaceDef indexed;
+  indexed.kind = ColorSpaceKind::indexed;
+  indexed.base = std::make_shared<ColorSpaceDef>(device_rgb());
+  indexed.hival = 15;
+  for (int i = 0; i < 48; ++i) {
+    indexed.lookup.push_back(static_cast<char>(i * 5));
+  }
+
+  struct Case {
+    ColorSpaceDef space;
+    std::int32_t bits;
+    std::vector<double> decode;
+  };
+  const std::vector<Case> cases = {
+      {device_gray(), 8, {}},
+      {device_gray(), 1, {1, 0}},
+      {device_rgb(), 8, {}},
+      {device_rgb(), 8, {1, 0, 0, 1, 0.5, 1}},
+      {device_rgb(), 16, {}},
+      {cmyk, 8, {}},
+      {indexed, 4, {}},
+      {indexed, 2, {}},
+  };
+
+  // odd width, so packed rows end mid-byte
+  constexpr std::int32_t width = 67;
+  constexpr std::int32_t height = 4;
+  std::uint32_t seed = 1;
+  for (const Case &c : cases) {
+    const auto components = static_cast<std::size_t>(c.space.components);
+    const std::size_t row_bytes = (width * components * c.bits + 7) / 8;
+    std::string samples;
+    for (std::size_t i = 0; i < row_bytes * height; ++i) {
+      seed = seed * 1103515245 + 12345;
+      // runs of the same byte, as in a scan, and noise in between
+      samples.push_back(i % 7 < 3 ? '\x10' : static_cast<char>(seed >> 16));
+    }
+    std::vector<double> color_key;
+    for (std::size_t k = 0; k < components; ++k) {
+      color_key.push_back(0);
+      color_key.push_back((1u << c.bits) / 2.0);
+    }
+
+    for (const bool keyed : {false, true}) {
+      const std::vector<double> key = keyed ? color_key : std::vector<double>{};
+      const std::string png = encode_image_png(samples, width, height, c.bits,
+                                               c.space, c.decode, {}, key);
+      const std::string pixels =
+          keyed ? decode_png_rgba(png).rgba : decode_png(png).rgb;
+      ASSERT_EQ(pixels.size(), width * height * (keyed ? 4u : 3u));
+      for (std::int32_t y = 0; y < height; ++y) {
+        for (std::int32_t x = 0; x < width; ++x) {
+          const std::string expected = reference_pixel(
+              samples, width, c.bits, c.space, c.decode, key, x, y);
+          const std::string actual = keyed ? rgba_pixel(pixels, width, x, y)
+                                           : rgb_pixel(pixels, width, x, y);
+          ASSERT_EQ(actual, expected.substr(0, actual.size()))
+              << static_cast<int>(c.space.kind) << " " << c.bits << " " << x
+              << "," << y;
+        }
+      }
+    }
+  }
+}
+
+/// Rows are filtered the way that suits them, and the png reads back the same.
+TEST(PdfImage, write_png_filters_rows) {
+  constexpr std::int32_t width = 40;
+  constexpr std::int32_t height = 30;
+  std::string rgb;
+  for (std::int32_t y = 0; y < height; ++y) {
+    for (std::int32_t x = 0; x < width; ++x) {
+      rgb.push_back(static_cast<char>(x * 6));
+      rgb.push_back(static_cast<char>(y * 8));
+      rgb.push_back(static_cast<char>(x * 3 + y * 2));
+    }
+  }
+
+  const std::string png = write_png(rgb, width, height, 3);
+  const std::string raw = odr::internal::crypto::util::zlib_inflate(
+      png.substr(8 + 25 + 8, be32(png, 33)));
+  // a gradient predicts well from its neighbours, not from nothing
+  EXPECT_NE(raw[(width * 3 + 1) * 10], 0);
+  EXPECT_EQ(decode_png(png).rgb, rgb);
+}
+
+/// An image past a deflate piece comes out the same on any number of threads,
+/// at any level.
+TEST(PdfImage, write_png_in_pieces) {
+  constexpr std::int32_t width = 700;
+  constexpr std::int32_t height = 600;
+  std::string rgba;
+  std::uint32_t seed = 1;
+  for (std::int32_t i = 0; i < width * height; ++i) {
+    seed = seed * 1103515245 + 12345;
+    rgba.push_back(static_cast<char>(i % width));
+    rgba.push_back(static_cast<char>(seed >> 28));
+    rgba.push_back(static_cast<char>(i / width));
+    rgba.push_back(static_cast<char>(0xFF));
+  }
+
+  const std::string one = write_png(rgba, width, height, 4, {.threads = 1});
+  EXPECT_EQ(write_png(rgba, width, height, 4, {.threads = 3}), one);
+  EXPECT_EQ(decode_png_rgba(one).rgba, rgba);
+
+  const std::string fast = write_png(rgba, width, height, 4, {.level = 1});
+  EXPECT_EQ(decode_png_rgba(fast).rgba, rgba);
+  EXPECT_LE(one.size(), fast.size());
+}
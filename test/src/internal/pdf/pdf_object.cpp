@@ -1,6 +1,7 @@
 #include <odr/internal/pdf/pdf_object.hpp>
 
 #include <optional>
+#include <stdexcept>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -159,6 +160,28 @@ TEST(PdfObject, dictionary_lookup) {
   EXPECT_FALSE(dictionary.has_key("C"));
 }
 
+// The entries are kept sorted by key, one per key: the first of a repeated key
+// wins, as a parsed dictionary's always has.
+TEST(PdfObject, dictionary_is_sorted_and_unique) {
+  const Dictionary dictionary(Dictionary::Holder{{"B", Object(Integer{1})},
+                                                 {"A", Object(Integer{2})},
+                                                 {"B", Object(Integer{3})}});
+  ASSERT_EQ(dictionary.size(), 2u);
+  EXPECT_EQ(dictionary.begin()->first, "A");
+  EXPECT_EQ(dictionary.at("B").as_integer(), 1);
+  EXPECT_THROW((void)dictionary.at("C"), std::out_of_range);
+
+  Dictionary inserted;
+  inserted["C"] = Object(Integer{1});
+  inserted["A"] = Object(Integer{2});
+  inserted["B"] = Object(Integer{3});
+  std::string keys;
+  for (const auto &[key, value] : inserted) {
+    keys += key;
+  }
+  EXPECT_EQ(keys, "ABC");
+}
+
 TEST(PdfObject, to_string) {
   EXPECT_EQ(Object().to_string(), "null");
   EXPECT_EQ(Object(Boolean{true}).to_string(), "true");
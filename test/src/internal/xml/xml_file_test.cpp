@@ -4,6 +4,7 @@
 #include <odr/logger.hpp>
 #include <odr/odr.hpp>
 
+#include <odr/internal/open_strategy.hpp>
 #include <odr/internal/text/text_file.hpp>
 #include <odr/internal/util/xml_util.hpp>
 #include <odr/internal/xml/xml_file.hpp>
@@ -12,6 +13,7 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 
@@ -198,3 +200,44 @@ TEST(XmlHtml, an_attribute_values_whitespace_is_preserved) {
   EXPECT_THAT(html, HasSubstr(R"(<span class="odr-xml-value">"x  y"</span>)"));
   EXPECT_THAT(html, HasSubstr(".odr-xml-value,"));
 }
+
+TEST(XmlFile, a_complete_probe_is_parsed) {
+  EXPECT_EQ(xml::probe_root_name(R"(<?xml version="1.0"?><x:a><b/></x:a>)",
+                                 TextEncoding::utf8, true),
+            "x:a");
+  EXPECT_EQ(xml::probe_root_name("<a><b></a>", TextEncoding::utf8, true),
+            std::nullopt);
+}
+
+/// A prefix is cut mid-document, so only the prolog and root tag are read.
+TEST(XmlFile, a_cut_probe_is_sniffed_to_its_root_tag) {
+  const std::string prolog =
+      "\xef\xbb\xbf<?xml version=\"1.0\"?>\n<!-- <not-it> -->\n"
+      "<!DOCTYPE svg [ <!ENTITY e \"]>\"> ]>\n";
+
+  EXPECT_EQ(xml::probe_root_name(prolog + "<svg width=\"1\"><g>",
+                                 TextEncoding::utf8, false),
+            "svg");
+  EXPECT_EQ(xml::probe_root_name(prolog + "<sv", TextEncoding::utf8, false),
+            std::nullopt);
+  EXPECT_EQ(xml::probe_root_name("text <a>", TextEncoding::utf8, false),
+            std::nullopt);
+  EXPECT_EQ(xml::probe_root_name("</a>", TextEncoding::utf8, false),
+            std::nullopt);
+}
+
+TEST(XmlFile, listing_reads_no_further_than_the_probe) {
+  std::string content = "<svg>";
+  while (content.size() < 1000) {
+    content += "<g/>";
+  }
+  content += "</broken>";
+  const auto file = File::from_memory(content).impl();
+
+  EXPECT_THAT(open_strategy::list_file_types(file, 100, Logger::null()),
+              testing::ElementsAre(FileType::text_file, FileType::xml,
+                                   FileType::scalable_vector_graphics));
+  // all of it is malformed
+  EXPECT_THAT(open_strategy::list_file_types(file, Logger::null()),
+              testing::ElementsAre(FileType::text_file));
+}
@@ -11,8 +11,12 @@
 
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace odr;
@@ -127,3 +131,81 @@ TEST(ZipArchive, create_order) {
     EXPECT_EQ(actual, entries);
   }
 }
+
+TEST(ZipArchive, find_after_inserting_in_between) {
+  ZipArchive zip;
+  zip.insert_file(std::end(zip), RelPath("b"),
+                  std::make_shared<MemoryFile>(""));
+  zip.insert_file(std::end(zip), RelPath("c"),
+                  std::make_shared<MemoryFile>(""));
+  zip.insert_directory(std::begin(zip), RelPath("a"));
+  // a second entry of a path is never the one found
+  zip.insert_file(std::end(zip), RelPath("b"), nullptr);
+
+  ASSERT_NE(zip.find(RelPath("a")), std::end(zip));
+  EXPECT_TRUE(zip.find(RelPath("a"))->is_directory());
+  EXPECT_EQ(std::distance(std::begin(zip), zip.find(RelPath("b"))), 1);
+  EXPECT_TRUE(zip.find(RelPath("b"))->is_file());
+  EXPECT_EQ(std::distance(std::begin(zip), zip.find(RelPath("c"))), 2);
+  EXPECT_EQ(zip.find(RelPath("d")), std::end(zip));
+}
+
+TEST(ZipArchive, entries_read_in_parallel) {
+  std::map<std::string, std::string> contents;
+  for (int i = 0; i < 8; ++i) {
+    std::string content;
+    for (int j = 0; content.size() < 200000; ++j) {
+      content += "<p n=\"" + std::to_string(i * j % 977) + "\">entry</p>";
+    }
+    contents.emplace("entry" + std::to_string(i), std::move(content));
+  }
+  contents.emplace("stored", "kept as it is");
+
+  std::ostringstream saved;
+  {
+    ZipArchive zip;
+    for (const auto &[name, content] : contents) {
+      zip.insert_file(std::end(zip), RelPath(name),
+                      std::make_shared<MemoryFile>(content),
+                      name == "stored" ? 0 : 6);
+    }
+    zip.save(saved);
+  }
+  const std::string path =
+      (std::filesystem::current_path() / "parallel.zip").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << saved.str();
+  }
+
+  // in memory and on disk, with a buffer that splits every read many times
+  for (const std::shared_ptr<abstract::File> &file :
+       std::vector<std::shared_ptr<abstract::File>>{
+           std::make_shared<MemoryFile>(saved.str()),
+           std::make_shared<DiskFile>(path)}) {
+    const auto zip = std::make_shared<util::Archive>(file, 1000);
+
+    std::vector<std::pair<std::string, std::shared_ptr<abstract::File>>>
+        entries;
+    for (const util::Archive::Entry &entry : *zip) {
+      entries.emplace_back(entry.path().string(), entry.file());
+    }
+    ASSERT_EQ(entries.size(), contents.size());
+
+    std::vector<std::string> read(entries.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      threads.emplace_back([&, i] {
+        const std::unique_ptr<std::istream> in = entries[i].second->stream();
+        read[i].assign(std::istreambuf_iterator<char>(*in), {});
+      });
+    }
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      EXPECT_EQ(read[i], contents.at(entries[i].first)) << entries[i].first;
+    }
+  }
+}